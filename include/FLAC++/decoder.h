@@ -125,6 +125,11 @@ namespace FLAC {
 			virtual bool set_ogg_serial_number(long value);                        ///< See FLAC__stream_decoder_set_ogg_serial_number()
 			virtual bool set_decode_chained_stream(bool value);                    ///< See FLAC__stream_decoder_set_decode_chained_stream()
 			virtual bool set_md5_checking(bool value);                             ///< See FLAC__stream_decoder_set_md5_checking()
+			virtual uint32_t set_num_threads(uint32_t value);                      ///< See FLAC__stream_decoder_set_num_threads()
+			virtual bool set_thread_pool(::FLAC__ThreadPool *pool);                ///< See FLAC__stream_decoder_set_thread_pool()
+			virtual bool set_mmap(bool value);                                     ///< See FLAC__stream_decoder_set_mmap()
+			virtual bool set_build_seek_index(bool value);                         ///< See FLAC__stream_decoder_set_build_seek_index()
+			virtual bool set_interleaved_output(::FLAC__StreamDecoderPCMFormat format); ///< See FLAC__stream_decoder_set_interleaved_output(); interleaved_write_callback() is then called instead of write_callback()
 			virtual bool set_metadata_respond(::FLAC__MetadataType type);          ///< See FLAC__stream_decoder_set_metadata_respond()
 			virtual bool set_metadata_respond_application(const FLAC__byte id[4]); ///< See FLAC__stream_decoder_set_metadata_respond_application()
 			virtual bool set_metadata_respond_all();                               ///< See FLAC__stream_decoder_set_metadata_respond_all()
@@ -136,6 +141,8 @@ namespace FLAC {
 			State get_state() const;                                          ///< See FLAC__stream_decoder_get_state()
 			virtual bool get_decode_chained_stream() const;                   ///< See FLAC__stream_decoder_get_decode_chained_stream()
 			virtual bool get_md5_checking() const;                            ///< See FLAC__stream_decoder_get_md5_checking()
+			virtual uint32_t get_num_threads() const;                         ///< See FLAC__stream_decoder_get_num_threads()
+			virtual ::FLAC__ThreadPool *get_thread_pool() const;              ///< See FLAC__stream_decoder_get_thread_pool()
 			virtual FLAC__uint64 get_total_samples() const;                   ///< See FLAC__stream_decoder_get_total_samples()
 			virtual FLAC__uint64 find_total_samples();			  ///< See FLAC__stream_decoder_find_total_samples()
 			virtual uint32_t get_channels() const;                            ///< See FLAC__stream_decoder_get_channels()
@@ -145,6 +152,8 @@ namespace FLAC {
 			virtual uint32_t get_blocksize() const;                           ///< See FLAC__stream_decoder_get_blocksize()
 			virtual bool get_decode_position(FLAC__uint64 *position) const;   ///< See FLAC__stream_decoder_get_decode_position()
 			virtual int32_t get_link_lengths(FLAC__uint64 **link_lengths);    ///< See FLAC__stream_decoder_get_link_lengths()
+			virtual ::FLAC__StreamMetadata *get_seek_index() const;           ///< See FLAC__stream_decoder_get_seek_index()
+			virtual bool add_seek_index(const ::FLAC__StreamMetadata *seek_index); ///< See FLAC__stream_decoder_add_seek_index()
 
 			virtual ::FLAC__StreamDecoderInitStatus init();      ///< Seek FLAC__stream_decoder_init_stream()
 			virtual ::FLAC__StreamDecoderInitStatus init_ogg();  ///< Seek FLAC__stream_decoder_init_ogg_stream()
@@ -160,9 +169,12 @@ namespace FLAC {
 			virtual bool process_until_end_of_link();     ///< See FLAC__stream_decoder_process_until_end_of_link()
 			virtual bool process_until_end_of_stream();   ///< See FLAC__stream_decoder_process_until_end_of_stream()
 			virtual bool skip_single_frame();             ///< See FLAC__stream_decoder_skip_single_frame()
+			virtual bool scan_single_frame(::FLAC__FrameHeader *header, FLAC__uint64 *offset); ///< See FLAC__stream_decoder_scan_single_frame()
+			virtual bool verify_single_frame(::FLAC__FrameHeader *header); ///< See FLAC__stream_decoder_verify_single_frame()
 			virtual bool skip_single_link();              ///< See FLAC__stream_decoder_skip_single_link()
 
 			virtual bool seek_absolute(FLAC__uint64 sample); ///< See FLAC__stream_decoder_seek_absolute()
+			virtual bool process_sample_ranges(const ::FLAC__StreamDecoderSampleRange ranges[], uint32_t num_ranges); ///< See FLAC__stream_decoder_process_sample_ranges(); range_write_callback() is called with the samples
 		protected:
 			/// see FLAC__StreamDecoderReadCallback
 			virtual ::FLAC__StreamDecoderReadStatus read_callback(FLAC__byte buffer[], size_t *bytes) = 0;
@@ -182,6 +194,12 @@ namespace FLAC {
 			/// see FLAC__StreamDecoderWriteCallback
 			virtual ::FLAC__StreamDecoderWriteStatus write_callback(const ::FLAC__Frame *frame, const FLAC__int32 * const buffer[]) = 0;
 
+			/// see FLAC__StreamDecoderInterleavedWriteCallback, only called after set_interleaved_output()
+			virtual ::FLAC__StreamDecoderWriteStatus interleaved_write_callback(const ::FLAC__Frame *frame, const void *buffer, size_t bytes);
+
+			/// see FLAC__StreamDecoderRangeWriteCallback, only called from process_sample_ranges()
+			virtual ::FLAC__StreamDecoderWriteStatus range_write_callback(uint32_t range, FLAC__uint64 sample_number, uint32_t samples, const FLAC__int32 * const buffer[]);
+
 			/// see FLAC__StreamDecoderMetadataCallback
 			virtual void metadata_callback(const ::FLAC__StreamMetadata *metadata);
 
@@ -200,6 +218,8 @@ namespace FLAC {
 			static ::FLAC__StreamDecoderLengthStatus length_callback_(const ::FLAC__StreamDecoder *decoder, FLAC__uint64 *stream_length, void *client_data);
 			static FLAC__bool eof_callback_(const ::FLAC__StreamDecoder *decoder, void *client_data);
 			static ::FLAC__StreamDecoderWriteStatus write_callback_(const ::FLAC__StreamDecoder *decoder, const ::FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data);
+			static ::FLAC__StreamDecoderWriteStatus interleaved_write_callback_(const ::FLAC__StreamDecoder *decoder, const ::FLAC__Frame *frame, const void *buffer, size_t bytes, void *client_data);
+			static ::FLAC__StreamDecoderWriteStatus range_write_callback_(const ::FLAC__StreamDecoder *decoder, uint32_t range, FLAC__uint64 sample_number, uint32_t samples, const FLAC__int32 * const buffer[], void *client_data);
 			static void metadata_callback_(const ::FLAC__StreamDecoder *decoder, const ::FLAC__StreamMetadata *metadata, void *client_data);
 			static void error_callback_(const ::FLAC__StreamDecoder *decoder, ::FLAC__StreamDecoderErrorStatus status, void *client_data);
 		private:
@@ -216,8 +236,9 @@ namespace FLAC {
 		 *
 		 * The usage of this class is similar to FLAC__StreamDecoder,
 		 * except instead of providing callbacks to
-		 * FLAC__stream_decoder_init*_FILE() or
-		 * FLAC__stream_decoder_init*_file(), you will inherit from this
+		 * FLAC__stream_decoder_init*_FILE(),
+		 * FLAC__stream_decoder_init*_file() or
+		 * FLAC__stream_decoder_init*_memory(), you will inherit from this
 		 * class and override the virtual callback functions with your
 		 * own implementations, then call init() or init_off().  The rest
 		 * of the calls work the same as in the C layer.
@@ -236,10 +257,12 @@ namespace FLAC {
 			virtual ::FLAC__StreamDecoderInitStatus init(FILE *file);                      ///< See FLAC__stream_decoder_init_FILE()
 			virtual ::FLAC__StreamDecoderInitStatus init(const char *filename);            ///< See FLAC__stream_decoder_init_file()
 			virtual ::FLAC__StreamDecoderInitStatus init(const std::string &filename);     ///< See FLAC__stream_decoder_init_file()
+			virtual ::FLAC__StreamDecoderInitStatus init(const FLAC__byte *data, size_t length); ///< See FLAC__stream_decoder_init_memory()
 			using Stream::init_ogg;
 			virtual ::FLAC__StreamDecoderInitStatus init_ogg(FILE *file);                  ///< See FLAC__stream_decoder_init_ogg_FILE()
 			virtual ::FLAC__StreamDecoderInitStatus init_ogg(const char *filename);        ///< See FLAC__stream_decoder_init_ogg_file()
 			virtual ::FLAC__StreamDecoderInitStatus init_ogg(const std::string &filename); ///< See FLAC__stream_decoder_init_ogg_file()
+			virtual ::FLAC__StreamDecoderInitStatus init_ogg(const FLAC__byte *data, size_t length); ///< See FLAC__stream_decoder_init_ogg_memory()
 		protected:
 			// this is a dummy implementation to satisfy the pure virtual in Stream that is actually supplied internally by the C layer
 			virtual ::FLAC__StreamDecoderReadStatus read_callback(FLAC__byte buffer[], size_t *bytes);
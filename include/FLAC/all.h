@@ -42,6 +42,7 @@
 #include "ordinals.h"
 #include "stream_decoder.h"
 #include "stream_encoder.h"
+#include "thread_pool.h"
 
 /** \mainpage
  *
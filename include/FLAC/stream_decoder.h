@@ -36,6 +36,7 @@
 #include <stdio.h> /* for FILE */
 #include "export.h"
 #include "format.h"
+#include "thread_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -88,9 +89,11 @@ extern "C" {
  * - The program initializes the instance to validate the settings and
  *   prepare for decoding using
  *   - FLAC__stream_decoder_init_stream() or FLAC__stream_decoder_init_FILE()
- *     or FLAC__stream_decoder_init_file() for native FLAC,
+ *     or FLAC__stream_decoder_init_file() or FLAC__stream_decoder_init_memory()
+ *     for native FLAC,
  *   - FLAC__stream_decoder_init_ogg_stream() or FLAC__stream_decoder_init_ogg_FILE()
- *     or FLAC__stream_decoder_init_ogg_file() for Ogg FLAC
+ *     or FLAC__stream_decoder_init_ogg_file() or
+ *     FLAC__stream_decoder_init_ogg_memory() for Ogg FLAC
  * - The program calls the FLAC__stream_decoder_process_*() functions
  *   to decode data, which subsequently calls the callbacks.
  * - The program finishes the decoding with FLAC__stream_decoder_finish(),
@@ -104,9 +107,10 @@ extern "C" {
  * functions to override the default decoder options, and call
  * one of the FLAC__stream_decoder_init_*() functions.
  *
- * There are three initialization functions for native FLAC, one for
+ * There are four initialization functions for native FLAC, one for
  * setting up the decoder to decode FLAC data from the client via
- * callbacks, and two for decoding directly from a FLAC file.
+ * callbacks, two for decoding directly from a FLAC file and one for
+ * decoding a FLAC stream that is held in memory.
  *
  * For decoding via callbacks, use FLAC__stream_decoder_init_stream().
  * You must also supply several callbacks for handling I/O.  Some (like
@@ -117,7 +121,11 @@ extern "C" {
  * \c FILE* or filename and fewer callbacks; the decoder will handle
  * the other callbacks internally.
  *
- * There are three similarly-named init functions for decoding from Ogg
+ * For decoding a complete stream held in memory, use
+ * FLAC__stream_decoder_init_memory().  The decoder reads straight from the
+ * buffer and handles the I/O callbacks internally, like it does for files.
+ *
+ * There are four similarly-named init functions for decoding from Ogg
  * FLAC streams.  Check \c FLAC_API_SUPPORTS_OGG_FLAC to find out if the
  * library has been built with Ogg support.
  *
@@ -259,6 +267,11 @@ typedef enum {
 extern FLAC_API const char * const FLAC__StreamDecoderStateString[];
 
 
+#define FLAC__STREAM_DECODER_SET_NUM_THREADS_OK 0
+#define FLAC__STREAM_DECODER_SET_NUM_THREADS_NOT_COMPILED_WITH_MULTITHREADING_ENABLED 1
+#define FLAC__STREAM_DECODER_SET_NUM_THREADS_ALREADY_INITIALIZED 2
+#define FLAC__STREAM_DECODER_SET_NUM_THREADS_TOO_MANY_THREADS 3
+
 /** Possible return values for the FLAC__stream_decoder_init_*() functions.
  */
 typedef enum {
@@ -422,6 +435,47 @@ typedef enum {
 extern FLAC_API const char * const FLAC__StreamDecoderWriteStatusString[];
 
 
+/** Sample formats for the FLAC__StreamDecoder interleaved write callback,
+ *  see FLAC__stream_decoder_set_interleaved_output().
+ */
+typedef enum {
+
+	FLAC__STREAM_DECODER_PCM_FORMAT_S16LE,
+	/**< Signed 16-bit little-endian integers. */
+
+	FLAC__STREAM_DECODER_PCM_FORMAT_S24LE,
+	/**< Signed 24-bit little-endian integers, packed in 3 bytes. */
+
+	FLAC__STREAM_DECODER_PCM_FORMAT_S32LE,
+	/**< Signed 32-bit little-endian integers. */
+
+	FLAC__STREAM_DECODER_PCM_FORMAT_FLOAT32
+	/**< 32-bit floats in native byte order, nominally in the range
+	 *   -1.0 to 1.0.  Not available if libFLAC was built as an
+	 *   integer-only library. */
+
+} FLAC__StreamDecoderPCMFormat;
+
+/** Maps a FLAC__StreamDecoderPCMFormat to a C string.
+ *
+ *  Using a FLAC__StreamDecoderPCMFormat as the index to this array
+ *  will give the string equivalent.  The contents should not be modified.
+ */
+extern FLAC_API const char * const FLAC__StreamDecoderPCMFormatString[];
+
+
+/** A range of samples to decode with
+ *  FLAC__stream_decoder_process_sample_ranges().
+ */
+typedef struct {
+	FLAC__uint64 sample_number;
+	/**< The number of the first sample in the range. */
+
+	FLAC__uint64 samples;
+	/**< The number of samples in the range. */
+} FLAC__StreamDecoderSampleRange;
+
+
 /** Possible values passed back to the FLAC__StreamDecoder error callback.
  *  \c FLAC__STREAM_DECODER_ERROR_STATUS_LOST_SYNC is the generic catch-
  *  all.  The rest could be caused by bad sync (false synchronization on
@@ -714,6 +768,71 @@ typedef FLAC__bool (*FLAC__StreamDecoderEofCallback)(const FLAC__StreamDecoder *
  */
 typedef FLAC__StreamDecoderWriteStatus (*FLAC__StreamDecoderWriteCallback)(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data);
 
+/** Signature for the interleaved write callback.
+ *
+ *  A function pointer matching this signature may be passed to
+ *  FLAC__stream_decoder_set_interleaved_output().  If set, it is
+ *  called instead of the write callback each time the decoder has
+ *  decoded a single audio frame.  The decoder will pass the frame
+ *  metadata as well as the decoded audio, with the channels
+ *  interleaved and the samples converted to the format chosen with
+ *  FLAC__stream_decoder_set_interleaved_output().
+ *
+ *  Integer samples are left-justified to the width of the format, so
+ *  for example 16-bit samples are shifted up by 8 bits for
+ *  \c FLAC__STREAM_DECODER_PCM_FORMAT_S24LE, and 24-bit samples lose
+ *  their 8 least significant bits for
+ *  \c FLAC__STREAM_DECODER_PCM_FORMAT_S16LE.  Float samples are scaled
+ *  by 2^(1 - bits per sample).
+ *
+ * \note In general, FLAC__StreamDecoder functions which change the
+ * state should not be called on the \a decoder while in the callback.
+ *
+ * \param  decoder  The decoder instance calling the callback.
+ * \param  frame    The description of the decoded frame.  See
+ *                  FLAC__Frame.  The subframe data should not be used
+ *                  to access the decoded samples.
+ * \param  buffer   The decoded samples, \a frame->header.blocksize
+ *                  samples for each of \a frame->header.channels
+ *                  channels, interleaved.  Channels are ordered as in
+ *                  FLAC__StreamDecoderWriteCallback.
+ * \param  bytes    The size of \a buffer in bytes.
+ * \param  client_data  The callee's client data set through
+ *                      FLAC__stream_decoder_init_*().
+ * \retval FLAC__StreamDecoderWriteStatus
+ *    The callee's return status.
+ */
+typedef FLAC__StreamDecoderWriteStatus (*FLAC__StreamDecoderInterleavedWriteCallback)(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const void *buffer, size_t bytes, void *client_data);
+
+/** Signature for the range write callback.
+ *
+ *  A function pointer matching this signature must be passed to
+ *  FLAC__stream_decoder_process_sample_ranges().  It is called with
+ *  the decoded samples of each frame that overlaps a requested range,
+ *  cut to the part inside that range, so a range that spans several
+ *  frames is passed in several calls, in order.  If ranges overlap,
+ *  the same samples are passed once for each of them.  The number of
+ *  channels and bits per sample are those of
+ *  FLAC__stream_decoder_get_channels() and
+ *  FLAC__stream_decoder_get_bits_per_sample().
+ *
+ * \note In general, FLAC__StreamDecoder functions which change the
+ * state should not be called on the \a decoder while in the callback.
+ *
+ * \param  decoder        The decoder instance calling the callback.
+ * \param  range          The index of the range in the array passed to
+ *                        FLAC__stream_decoder_process_sample_ranges().
+ * \param  sample_number  The number of the first sample passed.
+ * \param  samples        The number of samples passed for each channel.
+ * \param  buffer         An array of pointers to decoded channels of
+ *                        data, as in FLAC__StreamDecoderWriteCallback.
+ * \param  client_data    The callee's client data set through
+ *                        FLAC__stream_decoder_init_*().
+ * \retval FLAC__StreamDecoderWriteStatus
+ *    The callee's return status.
+ */
+typedef FLAC__StreamDecoderWriteStatus (*FLAC__StreamDecoderRangeWriteCallback)(const FLAC__StreamDecoder *decoder, uint32_t range, FLAC__uint64 sample_number, uint32_t samples, const FLAC__int32 * const buffer[], void *client_data);
+
 /** Signature for the metadata callback.
  *
  *  A function pointer matching this signature must be passed to one of
@@ -856,6 +975,141 @@ FLAC_API FLAC__bool FLAC__stream_decoder_set_decode_chained_stream(FLAC__StreamD
  */
 FLAC_API FLAC__bool FLAC__stream_decoder_set_md5_checking(FLAC__StreamDecoder *decoder, FLAC__bool value);
 
+/** Set the maximum number of threads to use during decoding.
+ *  Set to a value different than 1 to enable multithreaded decoding.
+ *
+ *  Multithreading only affects FLAC__stream_decoder_process_until_end_of_stream():
+ *  once metadata has been read, the decoder scans ahead for frame
+ *  headers and hands each frame to a worker thread, which decodes it
+ *  into its own buffers.  Calls to the write callback are guaranteed
+ *  to be in the correct order and are always made from the thread
+ *  that called FLAC__stream_decoder_process_until_end_of_stream(), so
+ *  MD5 checking and the error callback work as with single-threaded
+ *  decoding.  Frames that cannot be decoded cleanly on their own, for
+ *  example because the stream is damaged around them, are decoded
+ *  again by the calling thread.
+ *
+ *  Multithreaded decoding needs a STREAMINFO block, and Ogg FLAC is
+ *  always decoded single-threaded.  While decoding multithreaded,
+ *  FLAC__stream_decoder_get_decode_position() does not return the
+ *  position of the frame passed to the write callback, as the decoder
+ *  has already read beyond it.
+ *
+ *  Currently, passing a value of 0 is synonymous with a value of 1,
+ *  but this might change in the future.
+ *
+ * \default \c 1
+ * \param  decoder  A decoder instance to set.
+ * \param  value    See above.
+ * \assert
+ *    \code decoder != NULL \endcode
+ * \retval uint32_t
+ *    - \c FLAC__STREAM_DECODER_SET_NUM_THREADS_OK if the number of threads was set correctly,
+ *    - \c FLAC__STREAM_DECODER_SET_NUM_THREADS_NOT_COMPILED_WITH_MULTITHREADING_ENABLED when
+ *    multithreading was not enabled at compilation,
+ *    - \c FLAC__STREAM_DECODER_SET_NUM_THREADS_ALREADY_INITIALIZED when the decoder was
+ *    already initialized,
+ *    - \c FLAC__STREAM_DECODER_SET_NUM_THREADS_TOO_MANY_THREADS when
+ *    the number of threads was larger than the maximum allowed number of threads (currently
+ *    64).
+ */
+FLAC_API uint32_t FLAC__stream_decoder_set_num_threads(FLAC__StreamDecoder *decoder, uint32_t value);
+
+/** Set a thread pool to take the threads from instead of starting
+ *  threads for this decoder.  The number of threads set with
+ *  FLAC__stream_decoder_set_num_threads() still limits how many
+ *  threads work on this decoder at once, counting the thread calling
+ *  the decoder.  See the \link flac_thread_pool thread pool module
+ *  \endlink.
+ *
+ *  The pool must not be deleted before this decoder is finished.
+ *  Passing \c NULL makes the decoder start threads of its own again.
+ *
+ * \default \c NULL
+ * \param  decoder  A decoder instance to set.
+ * \param  pool     A thread pool, or \c NULL.
+ * \assert
+ *    \code decoder != NULL \endcode
+ * \retval FLAC__bool
+ *    \c false if the decoder is already initialized, else \c true.
+ */
+FLAC_API FLAC__bool FLAC__stream_decoder_set_thread_pool(FLAC__StreamDecoder *decoder, FLAC__ThreadPool *pool);
+
+/** Set whether files are read by mapping them into memory.  If \c true,
+ *  FLAC__stream_decoder_init_file() and FLAC__stream_decoder_init_FILE()
+ *  (and their Ogg counterparts) map a regular file into memory with
+ *  mmap() and decode straight from the mapping, like
+ *  FLAC__stream_decoder_init_memory() does, which saves copying the file
+ *  through stdio.  The kernel is advised to read ahead while decoding and
+ *  not to while seeking.  Pipes, \c stdin and files that cannot be mapped
+ *  are read with stdio as usual, as is everything on platforms without
+ *  mmap().
+ *
+ *  \note The length of the file is taken when the decoder is initialized,
+ *  so data appended to the file after that is not decoded.  The file must
+ *  not be truncated while it is being decoded; on most systems, accessing
+ *  a mapping beyond the end of its file raises \c SIGBUS.
+ *
+ * \default \c false
+ * \param  decoder  A decoder instance to set.
+ * \param  value    Flag value (see above).
+ * \assert
+ *    \code decoder != NULL \endcode
+ * \retval FLAC__bool
+ *    \c false if the decoder is already initialized, else \c true.
+ */
+FLAC_API FLAC__bool FLAC__stream_decoder_set_mmap(FLAC__StreamDecoder *decoder, FLAC__bool value);
+
+/** Set whether the decoder builds a seek index.  If \c true, the
+ *  decoder records the sample number and position of every frame it
+ *  comes across, whether while decoding, skipping or seeking, and
+ *  FLAC__stream_decoder_seek_absolute() uses these to find frames with
+ *  fewer reads.  This mostly helps streams that have no \c SEEKTABLE
+ *  or a sparse one, when seeking back and forth in the same stream.
+ *
+ *  The index can be retrieved with FLAC__stream_decoder_get_seek_index()
+ *  and stored, to be handed to a later decoder of the same stream with
+ *  FLAC__stream_decoder_add_seek_index().  It is discarded by
+ *  FLAC__stream_decoder_finish().
+ *
+ *  \note Frames are only recorded when decoding native FLAC with a
+ *  tell callback, and not by the worker threads of a decoder set up
+ *  with FLAC__stream_decoder_set_num_threads().
+ *
+ * \default \c false
+ * \param  decoder  A decoder instance to set.
+ * \param  value    Flag value (see above).
+ * \assert
+ *    \code decoder != NULL \endcode
+ * \retval FLAC__bool
+ *    \c false if the decoder is already initialized, else \c true.
+ */
+FLAC_API FLAC__bool FLAC__stream_decoder_set_build_seek_index(FLAC__StreamDecoder *decoder, FLAC__bool value);
+
+/** Have the decoder pass decoded audio to \a write_callback as
+ *  interleaved samples of the given format, instead of passing it to
+ *  the write callback given to FLAC__stream_decoder_init_*() as an
+ *  array of channels.  This saves clients that need interleaved audio
+ *  a pass over the data, as the decoder undoes the stereo decorrelation
+ *  and packs the samples in one go.  The write callback given to
+ *  FLAC__stream_decoder_init_*() is not used and may be \c NULL.
+ *
+ *  Passing a \a write_callback of \c NULL turns interleaved output
+ *  off again.
+ *
+ * \default \c NULL
+ * \param  decoder         A decoder instance to set.
+ * \param  format          The format of the samples passed to
+ *                         \a write_callback.
+ * \param  write_callback  See FLAC__StreamDecoderInterleavedWriteCallback.
+ * \assert
+ *    \code decoder != NULL \endcode
+ * \retval FLAC__bool
+ *    \c false if the decoder is already initialized or \a format is
+ *    not supported, else \c true.
+ */
+FLAC_API FLAC__bool FLAC__stream_decoder_set_interleaved_output(FLAC__StreamDecoder *decoder, FLAC__StreamDecoderPCMFormat format, FLAC__StreamDecoderInterleavedWriteCallback write_callback);
+
 /** Direct the decoder to pass on all metadata blocks of type \a type.
  *
  * \default By default, only the \c STREAMINFO block is returned via the
@@ -983,6 +1237,26 @@ FLAC_API FLAC__bool FLAC__stream_decoder_get_decode_chained_stream(const FLAC__S
  */
 FLAC_API FLAC__bool FLAC__stream_decoder_get_md5_checking(const FLAC__StreamDecoder *decoder);
 
+/** Get maximum number of threads setting.
+ *
+ * \param  decoder  A decoder instance to query.
+ * \assert
+ *    \code decoder != NULL \endcode
+ * \retval uint32_t
+ *    See FLAC__stream_decoder_set_num_threads().
+ */
+FLAC_API uint32_t FLAC__stream_decoder_get_num_threads(const FLAC__StreamDecoder *decoder);
+
+/** Get the thread pool the decoder takes its threads from.
+ *
+ * \param  decoder  A decoder instance to query.
+ * \assert
+ *    \code decoder != NULL \endcode
+ * \retval FLAC__ThreadPool*
+ *    See FLAC__stream_decoder_set_thread_pool().
+ */
+FLAC_API FLAC__ThreadPool *FLAC__stream_decoder_get_thread_pool(const FLAC__StreamDecoder *decoder);
+
 /** Get the total number of samples in the stream being decoded.
  *  Will only be valid after decoding has started and will contain the
  *  value from the \c STREAMINFO block.  A value of \c 0 means "unknown".
@@ -1149,6 +1423,47 @@ FLAC_API const void *FLAC__stream_decoder_get_client_data(FLAC__StreamDecoder *d
 
 FLAC_API int32_t FLAC__stream_decoder_get_link_lengths(FLAC__StreamDecoder *decoder, FLAC__uint64 **link_lengths);
 
+/** Get a copy of the decoder's seek index as a \c SEEKTABLE metadata
+ *  object, with one seek point per frame the decoder has recorded or
+ *  been given, ordered by sample number.  See
+ *  FLAC__stream_decoder_set_build_seek_index().
+ *
+ *  The object is allocated by the call and must be deleted by the
+ *  caller with FLAC__metadata_object_delete().  It can be kept and
+ *  passed to FLAC__stream_decoder_add_seek_index() later; being a
+ *  regular seek table it can also be stored with the metadata
+ *  interfaces, though one point per frame is a lot more than a
+ *  \c SEEKTABLE block usually holds.
+ *
+ * \param  decoder  A decoder instance to query.
+ * \assert
+ *    \code decoder != NULL \endcode
+ * \retval FLAC__StreamMetadata*
+ *    The seek index, or \c NULL if memory allocation failed.
+ */
+FLAC_API FLAC__StreamMetadata *FLAC__stream_decoder_get_seek_index(const FLAC__StreamDecoder *decoder);
+
+/** Add the points of a seek table to the decoder's seek index, to be
+ *  used by FLAC__stream_decoder_seek_absolute().  Typically the seek
+ *  table was returned by FLAC__stream_decoder_get_seek_index() for an
+ *  earlier decoder of the same stream.  Placeholder points and points
+ *  with a \a frame_samples of 0 are skipped; every other point must be
+ *  the start of a frame.
+ *
+ *  This can be called before or after the decoder is initialized.
+ *  The index is discarded by FLAC__stream_decoder_finish().
+ *
+ * \param  decoder     A decoder instance.
+ * \param  seek_index  A \c SEEKTABLE metadata object.
+ * \assert
+ *    \code decoder != NULL \endcode
+ *    \code seek_index != NULL \endcode
+ * \retval FLAC__bool
+ *    \c false if \a seek_index is not a seek table or memory
+ *    allocation failed, else \c true.
+ */
+FLAC_API FLAC__bool FLAC__stream_decoder_add_seek_index(FLAC__StreamDecoder *decoder, const FLAC__StreamMetadata *seek_index);
+
 /** Initialize the decoder instance to decode native FLAC streams.
  *
  *  This flavor of initialization sets up the decoder to decode from a
@@ -1199,7 +1514,9 @@ FLAC_API int32_t FLAC__stream_decoder_get_link_lengths(FLAC__StreamDecoder *deco
  *                            may also be supplied, all though this is slightly
  *                            less efficient for the decoder.
  * \param  write_callback     See FLAC__StreamDecoderWriteCallback.  This
- *                            pointer must not be \c NULL.
+ *                            pointer must not be \c NULL, unless an
+ *                            interleaved write callback has been set with
+ *                            FLAC__stream_decoder_set_interleaved_output().
  * \param  metadata_callback  See FLAC__StreamDecoderMetadataCallback.  This
  *                            pointer may be \c NULL if the callback is not
  *                            desired.
@@ -1280,7 +1597,9 @@ FLAC_API FLAC__StreamDecoderInitStatus FLAC__stream_decoder_init_stream(
  *                            may also be supplied, all though this is slightly
  *                            less efficient for the decoder.
  * \param  write_callback     See FLAC__StreamDecoderWriteCallback.  This
- *                            pointer must not be \c NULL.
+ *                            pointer must not be \c NULL, unless an
+ *                            interleaved write callback has been set with
+ *                            FLAC__stream_decoder_set_interleaved_output().
  * \param  metadata_callback  See FLAC__StreamDecoderMetadataCallback.  This
  *                            pointer may be \c NULL if the callback is not
  *                            desired.
@@ -1329,7 +1648,9 @@ FLAC_API FLAC__StreamDecoderInitStatus FLAC__stream_decoder_init_ogg_stream(
  *                            Note however that seeking will not work when
  *                            decoding from \c stdin since it is not seekable.
  * \param  write_callback     See FLAC__StreamDecoderWriteCallback.  This
- *                            pointer must not be \c NULL.
+ *                            pointer must not be \c NULL, unless an
+ *                            interleaved write callback has been set with
+ *                            FLAC__stream_decoder_set_interleaved_output().
  * \param  metadata_callback  See FLAC__StreamDecoderMetadataCallback.  This
  *                            pointer may be \c NULL if the callback is not
  *                            desired.
@@ -1379,7 +1700,9 @@ FLAC_API FLAC__StreamDecoderInitStatus FLAC__stream_decoder_init_FILE(
  *                            Note however that seeking will not work when
  *                            decoding from \c stdin since it is not seekable.
  * \param  write_callback     See FLAC__StreamDecoderWriteCallback.  This
- *                            pointer must not be \c NULL.
+ *                            pointer must not be \c NULL, unless an
+ *                            interleaved write callback has been set with
+ *                            FLAC__stream_decoder_set_interleaved_output().
  * \param  metadata_callback  See FLAC__StreamDecoderMetadataCallback.  This
  *                            pointer may be \c NULL if the callback is not
  *                            desired.
@@ -1426,7 +1749,9 @@ FLAC_API FLAC__StreamDecoderInitStatus FLAC__stream_decoder_init_ogg_FILE(
  *                            be opened with fopen().  Use \c NULL to decode from
  *                            \c stdin.  Note that \c stdin is not seekable.
  * \param  write_callback     See FLAC__StreamDecoderWriteCallback.  This
- *                            pointer must not be \c NULL.
+ *                            pointer must not be \c NULL, unless an
+ *                            interleaved write callback has been set with
+ *                            FLAC__stream_decoder_set_interleaved_output().
  * \param  metadata_callback  See FLAC__StreamDecoderMetadataCallback.  This
  *                            pointer may be \c NULL if the callback is not
  *                            desired.
@@ -1476,7 +1801,9 @@ FLAC_API FLAC__StreamDecoderInitStatus FLAC__stream_decoder_init_file(
  *                            be opened with fopen().  Use \c NULL to decode from
  *                            \c stdin.  Note that \c stdin is not seekable.
  * \param  write_callback     See FLAC__StreamDecoderWriteCallback.  This
- *                            pointer must not be \c NULL.
+ *                            pointer must not be \c NULL, unless an
+ *                            interleaved write callback has been set with
+ *                            FLAC__stream_decoder_set_interleaved_output().
  * \param  metadata_callback  See FLAC__StreamDecoderMetadataCallback.  This
  *                            pointer may be \c NULL if the callback is not
  *                            desired.
@@ -1499,6 +1826,104 @@ FLAC_API FLAC__StreamDecoderInitStatus FLAC__stream_decoder_init_ogg_file(
 	void *client_data
 );
 
+/** Initialize the decoder instance to decode native FLAC from memory.
+ *
+ *  This flavor of initialization sets up the decoder to decode a complete
+ *  native FLAC stream that is held in a buffer in memory.  The decoder
+ *  handles reading, seeking, telling, length and end-of-stream internally,
+ *  and fills its bit buffer straight from \a data instead of going through
+ *  a read callback, which saves a copy of every byte of the stream.
+ *
+ *  This function should be called after FLAC__stream_decoder_new() and
+ *  FLAC__stream_decoder_set_*() but before any of the
+ *  FLAC__stream_decoder_process_*() functions.  Will set and return the
+ *  decoder state, which will be FLAC__STREAM_DECODER_SEARCH_FOR_METADATA
+ *  if initialization succeeded.
+ *
+ * \param  decoder            An uninitialized decoder instance.
+ * \param  data               The stream to decode.  The buffer is owned by
+ *                            the client and must stay valid and unchanged
+ *                            until FLAC__stream_decoder_finish() is called.
+ *                            This pointer may be \c NULL only if \a length
+ *                            is 0.
+ * \param  length             The length of \a data in bytes.
+ * \param  write_callback     See FLAC__StreamDecoderWriteCallback.  This
+ *                            pointer must not be \c NULL, unless an
+ *                            interleaved write callback has been set with
+ *                            FLAC__stream_decoder_set_interleaved_output().
+ * \param  metadata_callback  See FLAC__StreamDecoderMetadataCallback.  This
+ *                            pointer may be \c NULL if the callback is not
+ *                            desired.
+ * \param  error_callback     See FLAC__StreamDecoderErrorCallback.  This
+ *                            pointer must not be \c NULL.
+ * \param  client_data        This value will be supplied to callbacks in their
+ *                            \a client_data argument.
+ * \assert
+ *    \code decoder != NULL \endcode
+ * \retval FLAC__StreamDecoderInitStatus
+ *    \c FLAC__STREAM_DECODER_INIT_STATUS_OK if initialization was successful;
+ *    see FLAC__StreamDecoderInitStatus for the meanings of other return values.
+ */
+FLAC_API FLAC__StreamDecoderInitStatus FLAC__stream_decoder_init_memory(
+	FLAC__StreamDecoder *decoder,
+	const FLAC__byte *data,
+	size_t length,
+	FLAC__StreamDecoderWriteCallback write_callback,
+	FLAC__StreamDecoderMetadataCallback metadata_callback,
+	FLAC__StreamDecoderErrorCallback error_callback,
+	void *client_data
+);
+
+/** Initialize the decoder instance to decode Ogg FLAC from memory.
+ *
+ *  This flavor of initialization sets up the decoder to decode a complete
+ *  Ogg FLAC stream that is held in a buffer in memory.  The decoder
+ *  handles reading, seeking, telling, length and end-of-stream internally.
+ *
+ *  This function should be called after FLAC__stream_decoder_new() and
+ *  FLAC__stream_decoder_set_*() but before any of the
+ *  FLAC__stream_decoder_process_*() functions.  Will set and return the
+ *  decoder state, which will be FLAC__STREAM_DECODER_SEARCH_FOR_METADATA
+ *  if initialization succeeded.
+ *
+ *  \note Support for Ogg FLAC in the library is optional.  If this
+ *  library has been built without support for Ogg FLAC, this function
+ *  will return \c FLAC__STREAM_DECODER_INIT_STATUS_UNSUPPORTED_CONTAINER.
+ *
+ * \param  decoder            An uninitialized decoder instance.
+ * \param  data               The stream to decode.  The buffer is owned by
+ *                            the client and must stay valid and unchanged
+ *                            until FLAC__stream_decoder_finish() is called.
+ *                            This pointer may be \c NULL only if \a length
+ *                            is 0.
+ * \param  length             The length of \a data in bytes.
+ * \param  write_callback     See FLAC__StreamDecoderWriteCallback.  This
+ *                            pointer must not be \c NULL, unless an
+ *                            interleaved write callback has been set with
+ *                            FLAC__stream_decoder_set_interleaved_output().
+ * \param  metadata_callback  See FLAC__StreamDecoderMetadataCallback.  This
+ *                            pointer may be \c NULL if the callback is not
+ *                            desired.
+ * \param  error_callback     See FLAC__StreamDecoderErrorCallback.  This
+ *                            pointer must not be \c NULL.
+ * \param  client_data        This value will be supplied to callbacks in their
+ *                            \a client_data argument.
+ * \assert
+ *    \code decoder != NULL \endcode
+ * \retval FLAC__StreamDecoderInitStatus
+ *    \c FLAC__STREAM_DECODER_INIT_STATUS_OK if initialization was successful;
+ *    see FLAC__StreamDecoderInitStatus for the meanings of other return values.
+ */
+FLAC_API FLAC__StreamDecoderInitStatus FLAC__stream_decoder_init_ogg_memory(
+	FLAC__StreamDecoder *decoder,
+	const FLAC__byte *data,
+	size_t length,
+	FLAC__StreamDecoderWriteCallback write_callback,
+	FLAC__StreamDecoderMetadataCallback metadata_callback,
+	FLAC__StreamDecoderErrorCallback error_callback,
+	void *client_data
+);
+
 /** Finish the decoding process.
  *  Flushes the decoding buffer, releases resources, resets the decoder
  *  settings to their defaults, and returns the decoder state to
@@ -1725,6 +2150,88 @@ FLAC_API FLAC__bool FLAC__stream_decoder_process_until_end_of_stream(FLAC__Strea
  */
 FLAC_API FLAC__bool FLAC__stream_decoder_skip_single_frame(FLAC__StreamDecoder *decoder);
 
+/** Scan one audio frame without decoding it.
+ *  This version instructs the decoder to find the next frame, read its
+ *  header and skip the rest of it, then stop, unless the callbacks
+ *  return a fatal error or the read callback returns
+ *  \c FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM.
+ *
+ *  Unlike FLAC__stream_decoder_skip_single_frame(), the subframes are
+ *  not parsed at all.  After the frame header and its CRC-8 are checked,
+ *  the decoder looks for the next frame sync code at which the CRC-16
+ *  of the bytes read since the start of the frame matches, so the
+ *  integrity of the frame is checked without entropy decoding it.  A
+ *  frame for which no such sync code is found within the largest size
+ *  the frame can have is reported to the error callback with
+ *  \c FLAC__STREAM_DECODER_ERROR_STATUS_FRAME_CRC_MISMATCH and the
+ *  decoder searches on for the next frame.  This makes enumerating
+ *  the frames of a stream, for validation or to build an index, about
+ *  as fast as reading it.
+ *
+ *  The write callback is not called, and MD5 checking is turned off as
+ *  the frames are not decoded.  The last frame of the stream cannot be
+ *  told from trailing garbage by its CRC-16, as there is no sync code
+ *  after it; it is passed as long as its header is valid.
+ *
+ *  This function should only be called when the stream has advanced
+ *  past all the metadata, otherwise it will return \c false.
+ *
+ * \param  decoder  An initialized decoder instance not in a metadata
+ *                  state.
+ * \param  header   If not \c NULL, the header of the scanned frame is
+ *                  stored here.  Its \a blocksize is \c 0 if no frame
+ *                  was scanned, e.g. at the end of the stream.
+ * \param  offset   If not \c NULL, the byte offset of the scanned frame
+ *                  in the stream is stored here, or \c 0 if it is not
+ *                  known because there is no working tell callback.
+ * \assert
+ *    \code decoder != NULL \endcode
+ * \retval FLAC__bool
+ *    \c false if any fatal read, write, or memory allocation error
+ *    occurred (meaning decoding must stop), or if the decoder
+ *    is in the FLAC__STREAM_DECODER_SEARCH_FOR_METADATA or
+ *    FLAC__STREAM_DECODER_READ_METADATA state, else \c true; for more
+ *    information about the decoder, check the decoder state with
+ *    FLAC__stream_decoder_get_state().
+ */
+FLAC_API FLAC__bool FLAC__stream_decoder_scan_single_frame(FLAC__StreamDecoder *decoder, FLAC__FrameHeader *header, FLAC__uint64 *offset);
+
+/** Decode one audio frame for verification only.
+ *  This version instructs the decoder to find and decode the next
+ *  frame, then stop, unless the callbacks return a fatal error or the
+ *  read callback returns
+ *  \c FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM.
+ *
+ *  The frame is decoded in full, so its subframes, residuals and
+ *  sample ranges are checked just as with
+ *  FLAC__stream_decoder_process_single(), and if MD5 checking is on
+ *  the restored samples are fed to the MD5 context straight from the
+ *  decoder's own buffers.  The write callback is not called and no
+ *  interleaved output is packed, which spares the per-frame client
+ *  round trip when only the integrity of the stream matters.  As
+ *  usual, the MD5 sum is compared by FLAC__stream_decoder_finish() or
+ *  FLAC__stream_decoder_finish_link().
+ *
+ *  This function should only be called when the stream has advanced
+ *  past all the metadata, otherwise it will return \c false.
+ *
+ * \param  decoder  An initialized decoder instance not in a metadata
+ *                  state.
+ * \param  header   If not \c NULL, the header of the decoded frame is
+ *                  stored here.  Its \a blocksize is \c 0 if no frame
+ *                  was decoded, e.g. at the end of the stream.
+ * \assert
+ *    \code decoder != NULL \endcode
+ * \retval FLAC__bool
+ *    \c false if any fatal read or memory allocation error occurred
+ *    (meaning decoding must stop), or if the decoder is in the
+ *    FLAC__STREAM_DECODER_SEARCH_FOR_METADATA or
+ *    FLAC__STREAM_DECODER_READ_METADATA state, else \c true; for more
+ *    information about the decoder, check the decoder state with
+ *    FLAC__stream_decoder_get_state().
+ */
+FLAC_API FLAC__bool FLAC__stream_decoder_verify_single_frame(FLAC__StreamDecoder *decoder, FLAC__FrameHeader *header);
+
 /** Skip one  Ogg chain link.
  *  This version instructs the decoder to 'skip' the current ogg chain
  *  link. This function should not be  used without enabling decoding
@@ -1779,6 +2286,45 @@ FLAC_API FLAC__bool FLAC__stream_decoder_skip_single_link(FLAC__StreamDecoder *d
  */
 FLAC_API FLAC__bool FLAC__stream_decoder_seek_absolute(FLAC__StreamDecoder *decoder, FLAC__uint64 sample);
 
+/** Decode a list of sample ranges in a single pass over the stream.
+ *  Reading on from the current position, the decoder decodes only the
+ *  frames that overlap one of the \a ranges and passes the samples in
+ *  them to \a write_callback.  Other frames are skipped without being
+ *  decoded: after reading the frame header, the decoder looks for the
+ *  next frame sync code at which the CRC-16 of the bytes read since
+ *  the header matches, which is much faster than
+ *  FLAC__stream_decoder_skip_single_frame().  This suits taking many
+ *  short excerpts from one stream, where calling
+ *  FLAC__stream_decoder_seek_absolute() for each would search the
+ *  stream and decode a full frame every time.
+ *
+ *  The ranges must be sorted by sample number; they may overlap.
+ *  Samples before the decoder's position or past the end of the
+ *  stream are not passed, so a range may be passed short or not at
+ *  all.  The write callback given to FLAC__stream_decoder_init_*()
+ *  and the interleaved write callback are not called, and MD5
+ *  checking is turned off as not all samples are decoded.  The
+ *  function returns once the last range is done or the end of the
+ *  stream is reached, after which decoding can continue as usual.
+ *
+ * \param  decoder         An initialized decoder instance.
+ * \param  ranges          The ranges to decode, sorted by
+ *                         \a sample_number.
+ * \param  num_ranges      The number of entries in \a ranges.
+ * \param  write_callback  See FLAC__StreamDecoderRangeWriteCallback.
+ * \assert
+ *    \code decoder != NULL \endcode
+ *    \code ranges != NULL || num_ranges == 0 \endcode
+ *    \code write_callback != NULL \endcode
+ * \retval FLAC__bool
+ *    \c false if the ranges are not sorted, the decoder is not in a
+ *    state to decode audio or any fatal read, write, or memory
+ *    allocation error occurred (meaning decoding must stop), else
+ *    \c true; for more information about the decoder, check the
+ *    decoder state with FLAC__stream_decoder_get_state().
+ */
+FLAC_API FLAC__bool FLAC__stream_decoder_process_sample_ranges(FLAC__StreamDecoder *decoder, const FLAC__StreamDecoderSampleRange ranges[], uint32_t num_ranges, FLAC__StreamDecoderRangeWriteCallback write_callback);
+
 /* \} */
 
 #ifdef __cplusplus
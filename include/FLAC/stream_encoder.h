@@ -37,6 +37,7 @@
 #include "export.h"
 #include "format.h"
 #include "stream_decoder.h"
+#include "thread_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -1067,6 +1068,28 @@ FLAC_API FLAC__bool FLAC__stream_encoder_set_do_escape_coding(FLAC__StreamEncode
  */
 FLAC_API FLAC__bool FLAC__stream_encoder_set_do_exhaustive_model_search(FLAC__StreamEncoder *encoder, FLAC__bool value);
 
+/** Set to \c true to have the exhaustive model search skip the orders
+ *  whose size, as estimated from the prediction error of each order,
+ *  is clearly larger than that of the estimated best order.  The
+ *  residual of a skipped order is never computed, which makes the
+ *  search several times faster, most of all together with
+ *  FLAC__stream_encoder_set_do_qlp_coeff_prec_search().  Now and then
+ *  the order that would have been selected is skipped, and the frame
+ *  comes out a few bytes larger.
+ *
+ *  This has no effect unless
+ *  FLAC__stream_encoder_set_do_exhaustive_model_search() is set.
+ *
+ * \default \c false
+ * \param  encoder  An encoder instance to set.
+ * \param  value    See above.
+ * \assert
+ *    \code encoder != NULL \endcode
+ * \retval FLAC__bool
+ *    \c false if the encoder is already initialized, else \c true.
+ */
+FLAC_API FLAC__bool FLAC__stream_encoder_set_prune_lpc_orders(FLAC__StreamEncoder *encoder, FLAC__bool value);
+
 /** Set the minimum partition order to search when coding the residual.
  *  This is used in tandem with
  *  FLAC__stream_encoder_set_max_residual_partition_order().
@@ -1159,6 +1182,53 @@ FLAC_API FLAC__bool FLAC__stream_encoder_set_max_residual_partition_order(FLAC__
  */
 FLAC_API uint32_t FLAC__stream_encoder_set_num_threads(FLAC__StreamEncoder *encoder, uint32_t value);
 
+/** Set to \c true to have the threads set with
+ *  FLAC__stream_encoder_set_num_threads() work together on one frame
+ *  at a time instead of on different frames. The subframes of each
+ *  channel, and the mid and side subframes when trying mid-side
+ *  stereo, are then searched concurrently.
+ *
+ *  This gives less of a speedup than working on different frames,
+ *  but frames are written as soon as they are encoded, like
+ *  without threads, so latency stays low. It is most useful for
+ *  streams with many channels and settings that search a lot per
+ *  subframe, like an exhaustive model search. The encoded stream is
+ *  the same either way.
+ *
+ *  This has no effect with a single thread or when multithreading
+ *  was not enabled at compilation.
+ *
+ * \default \c false
+ * \param  encoder  An encoder instance to set.
+ * \param  value    Flag value (see above).
+ * \assert
+ *    \code encoder != NULL \endcode
+ * \retval FLAC__bool
+ *    \c false if the encoder is already initialized, else \c true.
+ */
+FLAC_API FLAC__bool FLAC__stream_encoder_set_intra_frame_threading(FLAC__StreamEncoder *encoder, FLAC__bool value);
+
+/** Set a thread pool to take the threads from instead of starting
+ *  threads for this encoder.  The number of threads set with
+ *  FLAC__stream_encoder_set_num_threads() still limits how many
+ *  threads work on this encoder at once, counting the thread calling
+ *  the encoder.  See the \link flac_thread_pool thread pool module
+ *  \endlink.
+ *
+ *  The pool must not be deleted before this encoder is finished.  The
+ *  encoded stream is the same with or without a pool.  Passing \c NULL
+ *  makes the encoder start threads of its own again.
+ *
+ * \default \c NULL
+ * \param  encoder  An encoder instance to set.
+ * \param  pool     A thread pool, or \c NULL.
+ * \assert
+ *    \code encoder != NULL \endcode
+ * \retval FLAC__bool
+ *    \c false if the encoder is already initialized, else \c true.
+ */
+FLAC_API FLAC__bool FLAC__stream_encoder_set_thread_pool(FLAC__StreamEncoder *encoder, FLAC__ThreadPool *pool);
+
 /** Deprecated.  Setting this value has no effect.
  *
  * \default \c 0
@@ -1472,6 +1542,16 @@ FLAC_API FLAC__bool FLAC__stream_encoder_get_do_escape_coding(const FLAC__Stream
  */
 FLAC_API FLAC__bool FLAC__stream_encoder_get_do_exhaustive_model_search(const FLAC__StreamEncoder *encoder);
 
+/** Get the "prune_lpc_orders" flag.
+ *
+ * \param  encoder  An encoder instance to query.
+ * \assert
+ *    \code encoder != NULL \endcode
+ * \retval FLAC__bool
+ *    See FLAC__stream_encoder_set_prune_lpc_orders().
+ */
+FLAC_API FLAC__bool FLAC__stream_encoder_get_prune_lpc_orders(const FLAC__StreamEncoder *encoder);
+
 /** Get the minimum residual partition order setting.
  *
  * \param  encoder  An encoder instance to query.
@@ -1502,6 +1582,26 @@ FLAC_API uint32_t FLAC__stream_encoder_get_max_residual_partition_order(const FL
  */
 FLAC_API uint32_t FLAC__stream_encoder_get_num_threads(const FLAC__StreamEncoder *encoder);
 
+/** Get the "intra_frame_threading" flag.
+ *
+ * \param  encoder  An encoder instance to query.
+ * \assert
+ *    \code encoder != NULL \endcode
+ * \retval FLAC__bool
+ *    See FLAC__stream_encoder_set_intra_frame_threading().
+ */
+FLAC_API FLAC__bool FLAC__stream_encoder_get_intra_frame_threading(const FLAC__StreamEncoder *encoder);
+
+/** Get the thread pool the encoder takes its threads from.
+ *
+ * \param  encoder  An encoder instance to query.
+ * \assert
+ *    \code encoder != NULL \endcode
+ * \retval FLAC__ThreadPool*
+ *    See FLAC__stream_encoder_set_thread_pool().
+ */
+FLAC_API FLAC__ThreadPool *FLAC__stream_encoder_get_thread_pool(const FLAC__StreamEncoder *encoder);
+
 /** Get the Rice parameter search distance setting.
  *
  * \param  encoder  An encoder instance to query.
@@ -1535,6 +1635,26 @@ FLAC_API FLAC__uint64 FLAC__stream_encoder_get_total_samples_estimate(const FLAC
  */
 FLAC_API FLAC__bool FLAC__stream_encoder_get_limit_min_bitrate(const FLAC__StreamEncoder *encoder);
 
+/** Get the number of times an encoder found the apodization window it
+ *  needed in the window cache, and the number of times it had to be
+ *  calculated.
+ *
+ *  Apodization windows depend only on the apodization function and the
+ *  blocksize, so all encoders in the process share them read-only
+ *  instead of each calculating its own when it is initialized.
+ *  Windows are kept for a while after the last encoder using them
+ *  is finished, so encoders that are set up one after another with the
+ *  same settings also find them. The counters are process-wide and
+ *  never reset. In a library built without floating point support
+ *  both are zero.
+ *
+ * \param  hits    Where to store the number of windows found in the
+ *                 cache, may be \c NULL.
+ * \param  misses  Where to store the number of windows calculated,
+ *                 may be \c NULL.
+ */
+FLAC_API void FLAC__stream_encoder_get_window_cache_statistics(FLAC__uint64 *hits, FLAC__uint64 *misses);
+
 /** Initialize the encoder instance to encode native FLAC streams.
  *
  *  This flavor of initialization sets up the encoder to encode to a
@@ -0,0 +1,128 @@
+/* libFLAC - Free Lossless Audio Codec library
+ * Copyright (C) 2025  Xiph.Org Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef FLAC__THREAD_POOL_H
+#define FLAC__THREAD_POOL_H
+
+#include "export.h"
+#include "ordinals.h"
+
+/** \file include/FLAC/thread_pool.h
+ *
+ *  \brief
+ *  This module contains the functions for creating a pool of threads
+ *  that several encoders and decoders can share.
+ *
+ *  See the detailed documentation in the
+ *  \link flac_thread_pool thread pool \endlink module.
+ */
+
+/** \defgroup flac_thread_pool FLAC/thread_pool.h: shared thread pool
+ *  \ingroup flac
+ *
+ *  \brief
+ *  This module contains the functions for creating a pool of threads
+ *  that several encoders and decoders can share.
+ *
+ *  Without a pool, every encoder or decoder set to use more than one
+ *  thread with FLAC__stream_encoder_set_num_threads() or
+ *  FLAC__stream_decoder_set_num_threads() starts threads of its own.
+ *  A process running many of them at once can end up with far more
+ *  threads than there are cores.  An encoder or decoder given a pool
+ *  with FLAC__stream_encoder_set_thread_pool() or
+ *  FLAC__stream_decoder_set_thread_pool() starts no threads, but has
+ *  its work done by the threads of the pool instead.  However many
+ *  encoders and decoders use a pool, no more than the number of
+ *  threads it was created with work for them at any time.
+ *
+ *  The threads of the pool take turns serving the encoders and
+ *  decoders that have work waiting, so one with a lot of work queued
+ *  up does not hold up the others.  The number of threads set on an
+ *  encoder or decoder still limits how many threads work for it at
+ *  once, counting the thread that calls it, which always does its
+ *  share of the work.
+ *
+ *  A pool must not be deleted before all encoders and decoders using
+ *  it have been finished or deleted.
+ *
+ * \{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The maximum number of threads a pool can have. */
+#define FLAC__THREAD_POOL_MAX_THREADS (1024u)
+
+/** The opaque structure definition for the thread pool type.
+ *  See the \link flac_thread_pool thread pool module \endlink
+ *  for a detailed description.
+ */
+typedef struct FLAC__ThreadPool FLAC__ThreadPool;
+
+/** Create a new thread pool and start its threads.
+ *
+ * \param  num_threads  The number of threads in the pool, between 1 and
+ *                      \c FLAC__THREAD_POOL_MAX_THREADS.
+ * \retval FLAC__ThreadPool*
+ *    \c NULL if \a num_threads is out of range, if multithreading was
+ *    not enabled at compilation or if the pool could not be created,
+ *    else the new pool.
+ */
+FLAC_API FLAC__ThreadPool *FLAC__thread_pool_new(uint32_t num_threads);
+
+/** Stop the threads of a pool and free it.  Deleting a \c NULL pointer
+ *  does nothing.
+ *
+ * \param  pool  A pointer to an existing pool that no initialized
+ *               encoder or decoder uses.
+ */
+FLAC_API void FLAC__thread_pool_delete(FLAC__ThreadPool *pool);
+
+/** Get the number of threads in a pool.
+ *
+ * \param  pool  A pool to query.
+ * \assert
+ *    \code pool != NULL \endcode
+ * \retval uint32_t
+ *    The number of threads the pool was created with.
+ */
+FLAC_API uint32_t FLAC__thread_pool_get_num_threads(const FLAC__ThreadPool *pool);
+
+/* \} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
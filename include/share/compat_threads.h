@@ -75,6 +75,10 @@
 #define FLAC__cnd_wait(cv, mutex)            cnd_wait(cv, mutex)
 #define FLAC__cnd_destroy(cv)                cnd_destroy(cv)
 
+#define FLAC__once_flag                      once_flag
+#define FLAC__ONCE_FLAG_INIT                 ONCE_FLAG_INIT
+#define FLAC__call_once(flag, func)          call_once(flag, func)
+
 #define FLAC__thread_return_type             int
 #define FLAC__thread_default_return_value    0
 
@@ -113,6 +117,10 @@
 #define FLAC__cnd_wait(cv, mutex)            pthread_cond_wait(cv, mutex)
 #define FLAC__cnd_destroy(cv)                pthread_cond_destroy(cv)
 
+#define FLAC__once_flag                      pthread_once_t
+#define FLAC__ONCE_FLAG_INIT                 PTHREAD_ONCE_INIT
+#define FLAC__call_once(flag, func)          pthread_once(flag, func)
+
 #define FLAC__thread_return_type             void *
 #define FLAC__thread_default_return_value    NULL
 
@@ -32,6 +32,9 @@
 #ifndef FLAC__SHARE__PRIVATE_H
 #define FLAC__SHARE__PRIVATE_H
 
+#include "FLAC/stream_decoder.h"
+#include "FLAC/stream_encoder.h"
+
 /*
  * Unpublished debug routines from libFLAC. This should not be used from any
  * client code other than code shipped with the FLAC sources.
@@ -40,6 +43,8 @@ FLAC_API FLAC__bool FLAC__stream_encoder_disable_instruction_set(FLAC__StreamEnc
 FLAC_API FLAC__bool FLAC__stream_encoder_disable_constant_subframes(FLAC__StreamEncoder *encoder, FLAC__bool value);
 FLAC_API FLAC__bool FLAC__stream_encoder_disable_fixed_subframes(FLAC__StreamEncoder *encoder, FLAC__bool value);
 FLAC_API FLAC__bool FLAC__stream_encoder_disable_verbatim_subframes(FLAC__StreamEncoder *encoder, FLAC__bool value);
+FLAC_API FLAC__bool FLAC__stream_encoder_disable_fused_window_autocorrelation(FLAC__StreamEncoder *encoder, FLAC__bool value);
+FLAC_API FLAC__bool FLAC__stream_decoder_set_fused_lpc_restore(FLAC__StreamDecoder *decoder, FLAC__bool value);
 /*
  * The following two routines were intended as debug routines and are not
  * in the public headers, but SHOULD NOT CHANGE! It is known they are used
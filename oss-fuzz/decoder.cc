@@ -400,6 +400,37 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
                     break;
             }
         }
+
+        /* Read after everything else, so that existing inputs decode as
+         * before. The threads are set before init, so the decoder is
+         * started again on the rest of the input */
+        if ( ds.Get<bool>() ) {
+            {
+                const bool res = decoder.finish();
+                fuzzing::memory::memory_test(res);
+            }
+#ifdef FUZZER_DEBUG
+            printf("set_num_threads\n");
+#endif
+            decoder.set_num_threads(ds.Get<uint32_t>());
+            {
+                ::FLAC__StreamDecoderInitStatus ret;
+                if ( !use_ogg ) {
+                    ret = decoder.init();
+                } else {
+                    ret = decoder.init_ogg();
+                }
+
+                if ( ret != FLAC__STREAM_DECODER_INIT_STATUS_OK ) {
+                    goto end;
+                }
+            }
+#ifdef FUZZER_DEBUG
+            printf("process_until_end_of_stream\n");
+#endif
+            const bool res = decoder.process_until_end_of_stream();
+            fuzzing::memory::memory_test(res);
+        }
     } catch ( ... ) { }
 
 end:
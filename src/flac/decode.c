@@ -55,6 +55,8 @@ typedef struct {
 	} replaygain;
 
 	FLAC__bool test_only;
+	TestLevel test_level;
+	FLAC__bool report_throughput;
 	FLAC__bool analysis_mode;
 	analysis_options aopts;
 	utils__SkipUntilSpecification *skip_specification;
@@ -101,6 +103,7 @@ typedef struct {
 
 	clock_t old_clock;
 	FLAC__uint64 old_samples_processed;
+	clock_t start_clock; /* for report_throughput */
 } DecoderSession;
 
 
@@ -110,10 +113,11 @@ static FLAC__bool is_big_endian_host_;
 /*
  * local routines
  */
-static FLAC__bool DecoderSession_construct(DecoderSession *d, FLAC__bool is_ogg, FLAC__bool decode_chained_stream, FLAC__bool use_first_serial_number, long serial_number, FileFormat format, FileSubFormat subformat, FLAC__bool treat_warnings_as_errors, FLAC__bool continue_through_decode_errors, FLAC__bool channel_map_none, FLAC__bool relaxed_foreign_metadata_handling, replaygain_synthesis_spec_t replaygain_synthesis_spec, FLAC__bool analysis_mode, analysis_options aopts, utils__SkipUntilSpecification *skip_specification, utils__SkipUntilSpecification *until_specification, utils__CueSpecification *cue_specification, foreign_metadata_t *foreign_metadata, const char *infilename, const char *outfilename);
+static FLAC__bool DecoderSession_construct(DecoderSession *d, FLAC__bool is_ogg, FLAC__bool decode_chained_stream, FLAC__bool use_first_serial_number, long serial_number, FileFormat format, FileSubFormat subformat, FLAC__bool treat_warnings_as_errors, FLAC__bool continue_through_decode_errors, FLAC__bool channel_map_none, FLAC__bool relaxed_foreign_metadata_handling, replaygain_synthesis_spec_t replaygain_synthesis_spec, TestLevel test_level, FLAC__bool report_throughput, FLAC__bool analysis_mode, analysis_options aopts, utils__SkipUntilSpecification *skip_specification, utils__SkipUntilSpecification *until_specification, utils__CueSpecification *cue_specification, foreign_metadata_t *foreign_metadata, const char *infilename, const char *outfilename);
 static void DecoderSession_destroy(DecoderSession *d, FLAC__bool error_occurred);
 static FLAC__bool DecoderSession_init_decoder(DecoderSession *d, const char *infilename);
 static FLAC__bool DecoderSession_process(DecoderSession *d);
+static FLAC__bool test_frames(DecoderSession *d);
 static FLAC__bool verify_streaminfo(DecoderSession *d, FLAC__bool md5_failure);
 static int DecoderSession_finish_ok(DecoderSession *d);
 static int DecoderSession_finish_error(DecoderSession *d);
@@ -128,12 +132,16 @@ static FLAC__bool write_big_endian_uint16(FILE *f, FLAC__uint16 val);
 static FLAC__bool write_big_endian_uint32(FILE *f, FLAC__uint32 val);
 static FLAC__bool write_sane_extended(FILE *f, uint32_t val);
 static FLAC__bool fixup_iff_headers(DecoderSession *d);
+static FLAC__bool check_frame_format(DecoderSession *decoder_session, const FLAC__FrameHeader *header);
+static FLAC__bool check_frame_number(DecoderSession *decoder_session, const FLAC__FrameHeader *header);
+static void update_progress(DecoderSession *decoder_session, uint32_t wide_samples);
 static FLAC__StreamDecoderWriteStatus write_callback(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data);
 static void metadata_callback(const FLAC__StreamDecoder *decoder, const FLAC__StreamMetadata *metadata, void *client_data);
 static void error_callback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data);
 static void print_error_with_init_status(const DecoderSession *d, const char *message, FLAC__StreamDecoderInitStatus init_status);
 static void print_error_with_state(const DecoderSession *d, const char *message);
 static void print_stats(const DecoderSession *decoder_session);
+static void print_throughput(const DecoderSession *decoder_session);
 
 
 /*
@@ -178,6 +186,8 @@ int flac__decode_file(const char *infilename, const char *outfilename, FLAC__boo
 			options.channel_map_none,
 			options.relaxed_foreign_metadata_handling,
 			options.replaygain_synthesis_spec,
+			options.test_level,
+			options.report_throughput,
 			analysis_mode,
 			aopts,
 			&options.skip_specification,
@@ -200,7 +210,7 @@ int flac__decode_file(const char *infilename, const char *outfilename, FLAC__boo
 	return DecoderSession_finish_ok(&decoder_session);
 }
 
-FLAC__bool DecoderSession_construct(DecoderSession *d, FLAC__bool is_ogg, FLAC__bool decode_chained_stream, FLAC__bool use_first_serial_number, long serial_number, FileFormat format, FileSubFormat subformat, FLAC__bool treat_warnings_as_errors, FLAC__bool continue_through_decode_errors, FLAC__bool channel_map_none, FLAC__bool relaxed_foreign_metadata_handling, replaygain_synthesis_spec_t replaygain_synthesis_spec, FLAC__bool analysis_mode, analysis_options aopts, utils__SkipUntilSpecification *skip_specification, utils__SkipUntilSpecification *until_specification, utils__CueSpecification *cue_specification, foreign_metadata_t *foreign_metadata, const char *infilename, const char *outfilename)
+FLAC__bool DecoderSession_construct(DecoderSession *d, FLAC__bool is_ogg, FLAC__bool decode_chained_stream, FLAC__bool use_first_serial_number, long serial_number, FileFormat format, FileSubFormat subformat, FLAC__bool treat_warnings_as_errors, FLAC__bool continue_through_decode_errors, FLAC__bool channel_map_none, FLAC__bool relaxed_foreign_metadata_handling, replaygain_synthesis_spec_t replaygain_synthesis_spec, TestLevel test_level, FLAC__bool report_throughput, FLAC__bool analysis_mode, analysis_options aopts, utils__SkipUntilSpecification *skip_specification, utils__SkipUntilSpecification *until_specification, utils__CueSpecification *cue_specification, foreign_metadata_t *foreign_metadata, const char *infilename, const char *outfilename)
 {
 #if FLAC__HAS_OGG
 	d->is_ogg = is_ogg;
@@ -225,6 +235,8 @@ FLAC__bool DecoderSession_construct(DecoderSession *d, FLAC__bool is_ogg, FLAC__
 	d->replaygain.scale = 0.0;
 	/* d->replaygain.dither_context gets initialized later once we know the sample resolution */
 	d->test_only = (0 == outfilename);
+	d->test_level = d->test_only? test_level : TEST_LEVEL_MD5;
+	d->report_throughput = d->test_only && report_throughput;
 	d->analysis_mode = analysis_mode;
 	d->aopts = aopts;
 	d->skip_specification = skip_specification;
@@ -270,6 +282,7 @@ FLAC__bool DecoderSession_construct(DecoderSession *d, FLAC__bool is_ogg, FLAC__
 
 	d->old_clock = 0;
 	d->old_samples_processed = 0;
+	d->start_clock = clock();
 
 	FLAC__ASSERT(!(d->test_only && d->analysis_mode));
 
@@ -362,7 +375,7 @@ FLAC__bool DecoderSession_init_decoder(DecoderSession *decoder_session, const ch
 		return false;
 	}
 
-	FLAC__stream_decoder_set_md5_checking(decoder_session->decoder, true);
+	FLAC__stream_decoder_set_md5_checking(decoder_session->decoder, decoder_session->test_level == TEST_LEVEL_MD5);
 	if (0 != decoder_session->cue_specification)
 		FLAC__stream_decoder_set_metadata_respond(decoder_session->decoder, FLAC__METADATA_TYPE_CUESHEET);
 	if (decoder_session->replaygain.spec.apply || !decoder_session->channel_map_none)
@@ -495,7 +508,15 @@ FLAC__bool DecoderSession_process(DecoderSession *d)
 #if FLAC__HAS_OGG
 	if(!d->decode_chained_stream) {
 #endif
-		if(!FLAC__stream_decoder_process_until_end_of_stream(d->decoder) && !d->aborting_due_to_until) {
+		if(d->test_only) {
+			if(!test_frames(d)) {
+				flac__utils_printf(stderr, 2, "\n");
+				print_error_with_state(d, d->test_level == TEST_LEVEL_CRC? "ERROR while scanning frames" : "ERROR while decoding data");
+				if(!d->continue_through_decode_errors)
+					return false;
+			}
+		}
+		else if(!FLAC__stream_decoder_process_until_end_of_stream(d->decoder) && !d->aborting_due_to_until) {
 			flac__utils_printf(stderr, 2, "\n");
 			print_error_with_state(d, "ERROR while decoding data");
 			if(!d->continue_through_decode_errors)
@@ -573,6 +594,38 @@ FLAC__bool DecoderSession_process(DecoderSession *d)
 	return true;
 }
 
+/*
+ * -t: takes the frames one by one, with no write callback in between.
+ * At --test-level=md5 and decode the decoder decodes each frame and
+ * hashes the samples itself, if MD5 checking is on, without handing
+ * them out.  At --test-level=crc the subframes are not decoded at all;
+ * the decoder still checks each frame header and its CRC-8, and finds
+ * the end of the frame by its CRC-16, so damage is caught just the
+ * same, but nothing is decoded or hashed.
+ */
+FLAC__bool test_frames(DecoderSession *d)
+{
+	FLAC__FrameHeader header;
+	FLAC__bool ok;
+
+	while(!d->abort_flag) {
+		if(d->test_level == TEST_LEVEL_CRC)
+			ok = FLAC__stream_decoder_scan_single_frame(d->decoder, &header, /*offset=*/0);
+		else
+			ok = FLAC__stream_decoder_verify_single_frame(d->decoder, &header);
+		if(!ok)
+			return false;
+		if(header.blocksize == 0 || d->abort_flag) /* end of stream, or an error on the way to this frame */
+			break;
+		if(!check_frame_format(d, &header) || !check_frame_number(d, &header)) {
+			d->abort_flag = true;
+			break;
+		}
+		update_progress(d, header.blocksize);
+	}
+	return true;
+}
+
 FLAC__bool verify_streaminfo(DecoderSession *d, FLAC__bool md5_failure)
 {
 	FLAC__bool ok = true;
@@ -593,7 +646,7 @@ FLAC__bool verify_streaminfo(DecoderSession *d, FLAC__bool md5_failure)
 			flac__utils_printf(stderr, 1, "WARNING, cannot check MD5 signature since there was no STREAMINFO\n");
 			ok = !d->treat_warnings_as_errors;
 		}
-		else if(!d->has_md5sum) {
+		else if(!d->has_md5sum && d->test_level == TEST_LEVEL_MD5) {
 			stats_print_name_and_stream_number(1, d->inbasefilename, d->stream_counter);
 			flac__utils_printf(stderr, 1, "WARNING, cannot check MD5 signature since it was unset in the STREAMINFO\n");
 			ok = !d->treat_warnings_as_errors;
@@ -621,6 +674,8 @@ int DecoderSession_finish_ok(DecoderSession *d)
 	if(d->analysis_mode)
 		flac__analyze_finish(d->aopts);
 	ok = verify_streaminfo(d, md5_failure);
+	if(ok && d->report_throughput)
+		print_throughput(d);
 	DecoderSession_destroy(d, /*error_occurred=*/!ok);
 	if(!d->analysis_mode && !d->test_only && d->format != FORMAT_RAW) {
 		if(d->iff_headers_need_fixup || (!d->got_stream_info && strcmp(d->outfilename, "-"))) {
@@ -1174,55 +1229,24 @@ FLAC__bool fixup_iff_headers(DecoderSession *d)
 	return true;
 }
 
-FLAC__StreamDecoderWriteStatus write_callback(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data)
+/* Checks that the format of a frame matches STREAMINFO or the frames before it */
+FLAC__bool check_frame_format(DecoderSession *decoder_session, const FLAC__FrameHeader *header)
 {
-	DecoderSession *decoder_session = (DecoderSession*)client_data;
-	FILE *fout = decoder_session->fout;
-	const uint32_t bps = frame->header.bits_per_sample, channels = frame->header.channels;
-	const uint32_t shift = (bps%8)? 8-(bps%8): 0;
-	FLAC__bool is_big_endian = (
-		(decoder_session->format == FORMAT_AIFF || (decoder_session->format == FORMAT_AIFF_C && decoder_session->subformat == SUBFORMAT_AIFF_C_NONE)) ? true : (
-		decoder_session->format == FORMAT_WAVE || decoder_session->format == FORMAT_WAVE64 || decoder_session->format == FORMAT_RF64 || (decoder_session->format == FORMAT_AIFF_C && decoder_session->subformat == SUBFORMAT_AIFF_C_SOWT) ? false :
-		decoder_session->is_big_endian
-	));
-	FLAC__bool is_unsigned_samples = (
-		decoder_session->format == FORMAT_AIFF || decoder_session->format == FORMAT_AIFF_C ? false : (
-		decoder_session->format == FORMAT_WAVE || decoder_session->format == FORMAT_WAVE64 || decoder_session->format == FORMAT_RF64 ? bps<=8 :
-		decoder_session->is_unsigned_samples
-	));
-	uint32_t wide_samples = frame->header.blocksize, wide_sample, sample, channel;
-	FLAC__uint64 frame_bytes = 0;
-
-	static union
-	{	/* The arrays defined within this union are all the same size. */
-		FLAC__int8	 s8buffer	[FLAC__MAX_BLOCK_SIZE * FLAC__MAX_CHANNELS * sizeof(FLAC__int32)]; /* WATCHOUT: can be up to 2 megs */
-		FLAC__uint8  u8buffer	[FLAC__MAX_BLOCK_SIZE * FLAC__MAX_CHANNELS * sizeof(FLAC__int32)];
-		FLAC__int16  s16buffer	[FLAC__MAX_BLOCK_SIZE * FLAC__MAX_CHANNELS * sizeof(FLAC__int16)];
-		FLAC__uint16 u16buffer	[FLAC__MAX_BLOCK_SIZE * FLAC__MAX_CHANNELS * sizeof(FLAC__int16)];
-		FLAC__int32  s32buffer	[FLAC__MAX_BLOCK_SIZE * FLAC__MAX_CHANNELS];
-		FLAC__uint32 u32buffer	[FLAC__MAX_BLOCK_SIZE * FLAC__MAX_CHANNELS];
-	} ubuf;
-
-	size_t bytes_to_write = 0;
-
-	(void)decoder;
-
-	if(decoder_session->abort_flag)
-		return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+	const uint32_t bps = header->bits_per_sample, channels = header->channels;
 
 	/* sanity-check the bits-per-sample */
 	if(decoder_session->bps) {
 		if(bps != decoder_session->bps) {
-			FLAC__ASSERT(frame->header.number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
+			FLAC__ASSERT(header->number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
 			if(decoder_session->got_stream_info)
-				flac__utils_printf_clear_stats(stderr, 1, "%s: ERROR, bits-per-sample is %u in frame starting at sample %" PRIu64 " but %u in STREAMINFO\n", decoder_session->inbasefilename, bps, frame->header.number.sample_number, decoder_session->bps);
+				flac__utils_printf_clear_stats(stderr, 1, "%s: ERROR, bits-per-sample is %u in frame starting at sample %" PRIu64 " but %u in STREAMINFO\n", decoder_session->inbasefilename, bps, header->number.sample_number, decoder_session->bps);
 			else
-				flac__utils_printf_clear_stats(stderr, 1, "%s: ERROR, bits-per-sample is %u in frame starting at sample %" PRIu64 " but %u in previous frames\n", decoder_session->inbasefilename, bps, frame->header.number.sample_number, decoder_session->bps);
+				flac__utils_printf_clear_stats(stderr, 1, "%s: ERROR, bits-per-sample is %u in frame starting at sample %" PRIu64 " but %u in previous frames\n", decoder_session->inbasefilename, bps, header->number.sample_number, decoder_session->bps);
 			if(!decoder_session->continue_through_decode_errors)
-				return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+				return false;
 			else if(decoder_session->replaygain.apply) {
 				flac__utils_printf(stderr, 1, "%s: ERROR, cannot decode through previous error with replaygain application turned on\n", decoder_session->inbasefilename, bps, decoder_session->bps);
-				return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+				return false;
 			}
 		}
 	}
@@ -1232,20 +1256,20 @@ FLAC__StreamDecoderWriteStatus write_callback(const FLAC__StreamDecoder *decoder
 		decoder_session->bps = bps;
 		if(decoder_session->format == FORMAT_RAW && ((decoder_session->bps % 8) != 0  || decoder_session->bps < 4)) {
 			flac__utils_printf_clear_stats(stderr, 1, "%s: ERROR: bits per sample is %u, must be 8/16/24/32 for raw format output\n", decoder_session->inbasefilename, decoder_session->bps);
-			return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+			return false;
 		}
 	}
 
 	/* sanity-check the #channels */
 	if(decoder_session->channels) {
 		if(channels != decoder_session->channels) {
-			FLAC__ASSERT(frame->header.number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
+			FLAC__ASSERT(header->number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
 			if(decoder_session->got_stream_info)
-				flac__utils_printf_clear_stats(stderr, 1, "%s: ERROR, channels is %u in frame starting at sample %" PRIu64 " but %u in STREAMINFO\n", decoder_session->inbasefilename, channels, frame->header.number.sample_number, decoder_session->channels);
+				flac__utils_printf_clear_stats(stderr, 1, "%s: ERROR, channels is %u in frame starting at sample %" PRIu64 " but %u in STREAMINFO\n", decoder_session->inbasefilename, channels, header->number.sample_number, decoder_session->channels);
 			else
-				flac__utils_printf_clear_stats(stderr, 1, "%s: ERROR, channels is %u in frame starting at sample %" PRIu64 " but %u in previous frames\n", decoder_session->inbasefilename, channels, frame->header.number.sample_number, decoder_session->channels);
+				flac__utils_printf_clear_stats(stderr, 1, "%s: ERROR, channels is %u in frame starting at sample %" PRIu64 " but %u in previous frames\n", decoder_session->inbasefilename, channels, header->number.sample_number, decoder_session->channels);
 			if(!decoder_session->continue_through_decode_errors)
-				return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+				return false;
 		}
 	}
 	else {
@@ -1256,22 +1280,113 @@ FLAC__StreamDecoderWriteStatus write_callback(const FLAC__StreamDecoder *decoder
 
 	/* sanity-check the sample rate */
 	if(decoder_session->sample_rate < UINT32_MAX) {
-		if(frame->header.sample_rate != decoder_session->sample_rate) {
-			FLAC__ASSERT(frame->header.number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
+		if(header->sample_rate != decoder_session->sample_rate) {
+			FLAC__ASSERT(header->number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
 			if(decoder_session->got_stream_info)
-				flac__utils_printf_clear_stats(stderr, 1, "%s: ERROR, sample rate is %u in frame starting at sample %" PRIu64 " but %u in STREAMINFO\n", decoder_session->inbasefilename, frame->header.sample_rate, frame->header.number.sample_number, decoder_session->sample_rate);
+				flac__utils_printf_clear_stats(stderr, 1, "%s: ERROR, sample rate is %u in frame starting at sample %" PRIu64 " but %u in STREAMINFO\n", decoder_session->inbasefilename, header->sample_rate, header->number.sample_number, decoder_session->sample_rate);
 			else
-				flac__utils_printf_clear_stats(stderr, 1, "%s: ERROR, sample rate is %u in frame starting at sample %" PRIu64 " but %u in previous frames\n", decoder_session->inbasefilename, frame->header.sample_rate, frame->header.number.sample_number, decoder_session->sample_rate);
+				flac__utils_printf_clear_stats(stderr, 1, "%s: ERROR, sample rate is %u in frame starting at sample %" PRIu64 " but %u in previous frames\n", decoder_session->inbasefilename, header->sample_rate, header->number.sample_number, decoder_session->sample_rate);
 			if(!decoder_session->continue_through_decode_errors)
-				return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+				return false;
 		}
 	}
 	else {
 		/* must not have gotten STREAMINFO, save the sample rate from the frame header */
 		FLAC__ASSERT(!decoder_session->got_stream_info);
-		decoder_session->sample_rate = frame->header.sample_rate;
+		decoder_session->sample_rate = header->sample_rate;
 	}
 
+	return true;
+}
+
+FLAC__bool check_frame_number(DecoderSession *decoder_session, const FLAC__FrameHeader *header)
+{
+	/* warn in case frame/sample number is incorrect, but only when decoding
+	 * through errors is not enabled */
+	if(!decoder_session->continue_through_decode_errors) {
+		if(decoder_session->prev_frameheader.channels > 0) {
+			FLAC__ASSERT(decoder_session->prev_frameheader.number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
+			FLAC__ASSERT(header->number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
+			if(decoder_session->prev_frameheader.number.sample_number +
+			   decoder_session->prev_frameheader.blocksize !=
+			   header->number.sample_number) {
+				stats_print_name_and_stream_number(1, decoder_session->inbasefilename, decoder_session->stream_counter);
+				flac__utils_printf(stderr, 1, "WARNING: sample or frame number does not increase correctly (%" PRIu64 " samples have been decoded), file might not be seekable\n", decoder_session->samples_processed);
+				stats_new_line();
+				if(decoder_session->treat_warnings_as_errors) {
+					decoder_session->abort_flag = true;
+					return false;
+				}
+			}
+		}
+		memcpy(&(decoder_session->prev_frameheader), header, sizeof(FLAC__FrameHeader));
+	}
+
+	return true;
+}
+
+void update_progress(DecoderSession *decoder_session, uint32_t wide_samples)
+{
+	decoder_session->samples_processed += wide_samples;
+	decoder_session->frame_counter++;
+
+#if 0 /* in case time.h with clock() isn't available for some reason */
+	if(!(decoder_session->frame_counter & 0x1ff))
+		print_stats(decoder_session);
+#else
+	if(decoder_session->samples_processed - decoder_session->old_samples_processed > 25000) {
+		/* We're assuming that even on old hardware libFLAC can easily process
+		 * 100.000 samples per second, even on old hardware. To limit the number
+		 * of (expensive) syscalls, we only check clock every 25.000 samples */
+		clock_t cur_clock = clock();
+		decoder_session->old_samples_processed = decoder_session->samples_processed;
+		if((cur_clock - decoder_session->old_clock) > (CLOCKS_PER_SEC/4)) {
+			print_stats(decoder_session);
+			decoder_session->old_clock = cur_clock;
+		}
+	}
+#endif
+}
+
+FLAC__StreamDecoderWriteStatus write_callback(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data)
+{
+	DecoderSession *decoder_session = (DecoderSession*)client_data;
+	FILE *fout = decoder_session->fout;
+	const uint32_t bps = frame->header.bits_per_sample, channels = frame->header.channels;
+	const uint32_t shift = (bps%8)? 8-(bps%8): 0;
+	FLAC__bool is_big_endian = (
+		(decoder_session->format == FORMAT_AIFF || (decoder_session->format == FORMAT_AIFF_C && decoder_session->subformat == SUBFORMAT_AIFF_C_NONE)) ? true : (
+		decoder_session->format == FORMAT_WAVE || decoder_session->format == FORMAT_WAVE64 || decoder_session->format == FORMAT_RF64 || (decoder_session->format == FORMAT_AIFF_C && decoder_session->subformat == SUBFORMAT_AIFF_C_SOWT) ? false :
+		decoder_session->is_big_endian
+	));
+	FLAC__bool is_unsigned_samples = (
+		decoder_session->format == FORMAT_AIFF || decoder_session->format == FORMAT_AIFF_C ? false : (
+		decoder_session->format == FORMAT_WAVE || decoder_session->format == FORMAT_WAVE64 || decoder_session->format == FORMAT_RF64 ? bps<=8 :
+		decoder_session->is_unsigned_samples
+	));
+	uint32_t wide_samples = frame->header.blocksize, wide_sample, sample, channel;
+	FLAC__uint64 frame_bytes = 0;
+
+	static union
+	{	/* The arrays defined within this union are all the same size. */
+		FLAC__int8	 s8buffer	[FLAC__MAX_BLOCK_SIZE * FLAC__MAX_CHANNELS * sizeof(FLAC__int32)]; /* WATCHOUT: can be up to 2 megs */
+		FLAC__uint8  u8buffer	[FLAC__MAX_BLOCK_SIZE * FLAC__MAX_CHANNELS * sizeof(FLAC__int32)];
+		FLAC__int16  s16buffer	[FLAC__MAX_BLOCK_SIZE * FLAC__MAX_CHANNELS * sizeof(FLAC__int16)];
+		FLAC__uint16 u16buffer	[FLAC__MAX_BLOCK_SIZE * FLAC__MAX_CHANNELS * sizeof(FLAC__int16)];
+		FLAC__int32  s32buffer	[FLAC__MAX_BLOCK_SIZE * FLAC__MAX_CHANNELS];
+		FLAC__uint32 u32buffer	[FLAC__MAX_BLOCK_SIZE * FLAC__MAX_CHANNELS];
+	} ubuf;
+
+	size_t bytes_to_write = 0;
+
+	(void)decoder;
+
+	if(decoder_session->abort_flag)
+		return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
+	if(!check_frame_format(decoder_session, &frame->header))
+		return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
 	/*
 	 * limit the number of samples to accept based on --until
 	 */
@@ -1325,48 +1440,11 @@ FLAC__StreamDecoderWriteStatus write_callback(const FLAC__StreamDecoder *decoder
 		decoder_session->decode_position = dpos;
 	}
 
-	/* warn in case frame/sample number is incorrect, but only when decoding
-	 * through errors is not enabled */
-	if(!decoder_session->continue_through_decode_errors) {
-		if(decoder_session->prev_frameheader.channels > 0) {
-			FLAC__ASSERT(decoder_session->prev_frameheader.number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
-			FLAC__ASSERT(frame->header.number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
-			if(decoder_session->prev_frameheader.number.sample_number +
-			   decoder_session->prev_frameheader.blocksize !=
-			   frame->header.number.sample_number) {
-				stats_print_name_and_stream_number(1, decoder_session->inbasefilename, decoder_session->stream_counter);
-				flac__utils_printf(stderr, 1, "WARNING: sample or frame number does not increase correctly (%" PRIu64 " samples have been decoded), file might not be seekable\n", decoder_session->samples_processed);
-				stats_new_line();
-				if(decoder_session->treat_warnings_as_errors) {
-					decoder_session->abort_flag = true;
-					return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
-				}
-			}
-		}
-		memcpy(&(decoder_session->prev_frameheader), &(frame->header), sizeof(FLAC__FrameHeader));
-	}
+	if(!check_frame_number(decoder_session, &frame->header))
+		return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
 
 	if(wide_samples > 0) {
-		decoder_session->samples_processed += wide_samples;
-		decoder_session->frame_counter++;
-
-#if 0 /* in case time.h with clock() isn't available for some reason */
-		if(!(decoder_session->frame_counter & 0x1ff))
-			print_stats(decoder_session);
-#else
-		if(decoder_session->samples_processed - decoder_session->old_samples_processed > 25000) {
-			/* We're assuming that even on old hardware libFLAC can easily process
-			 * 100.000 samples per second, even on old hardware. To limit the number
-			 * of (expensive) syscalls, we only check clock every 25.000 samples */
-			clock_t cur_clock = clock();
-			decoder_session->old_samples_processed = decoder_session->samples_processed;
-			if((cur_clock - decoder_session->old_clock) > (CLOCKS_PER_SEC/4)) {
-				print_stats(decoder_session);
-				decoder_session->old_clock = cur_clock;
-			}
-		}
-#endif
-
+		update_progress(decoder_session, wide_samples);
 
 		if(decoder_session->analysis_mode) {
 			flac__analyze_frame(frame, decoder_session->frame_counter-1, decoder_session->decode_position_valid, decoder_session->decode_position_valid?(decoder_session->decode_position-frame_bytes):0, frame_bytes, decoder_session->aopts, fout);
@@ -1848,3 +1926,21 @@ void print_stats(const DecoderSession *decoder_session)
 		}
 	}
 }
+
+void print_throughput(const DecoderSession *decoder_session)
+{
+	static const char * const level_names[] = { "md5", "decode", "crc" };
+	const double seconds = (double)(clock() - decoder_session->start_clock) / CLOCKS_PER_SEC;
+	const FLAC__off_t filesize = strcmp(decoder_session->infilename, "-")? grabbag__file_get_filesize(decoder_session->infilename) : -1;
+
+	/* Throughput is per second of CPU time, which is what a sweep over many
+	 * files pays for; waiting on the disk is not counted */
+	flac__utils_printf(stderr, 1, "%s: test level %s", decoder_session->inbasefilename, level_names[decoder_session->test_level]);
+	if(seconds > 0.0) {
+		if(filesize >= 0)
+			flac__utils_printf(stderr, 1, ", %.1f MB/s", (double)filesize / seconds / 1e6);
+		if(decoder_session->sample_rate > 0 && decoder_session->sample_rate < UINT32_MAX)
+			flac__utils_printf(stderr, 1, ", %.0fx realtime", (double)decoder_session->samples_processed / decoder_session->sample_rate / seconds);
+	}
+	flac__utils_printf(stderr, 1, ", %.2f s CPU\n", seconds);
+}
@@ -38,9 +38,17 @@ typedef struct {
 	double preamp;
 } replaygain_synthesis_spec_t;
 
+typedef enum {
+	TEST_LEVEL_MD5, /* decode the frames and check the MD5 signature of the audio */
+	TEST_LEVEL_DECODE, /* decode the frames but do not compute the MD5 signature */
+	TEST_LEVEL_CRC /* check the frame headers and CRCs without decoding the subframes */
+} TestLevel;
+
 typedef struct {
 	FLAC__bool treat_warnings_as_errors;
 	FLAC__bool continue_through_decode_errors;
+	TestLevel test_level; /* only used in test mode */
+	FLAC__bool report_throughput; /* report the testing speed once done; --test-level was given */
 	replaygain_synthesis_spec_t replaygain_synthesis_spec;
 #if FLAC__HAS_OGG
 	FLAC__bool is_ogg;
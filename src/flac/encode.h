@@ -83,6 +83,7 @@ typedef struct {
 	FLAC__bool ignore_chunk_sizes;
 	FLAC__bool error_on_compression_fail;
 	FLAC__bool limit_min_bitrate;
+	FLAC__bool prune_lpc_orders;
 	FLAC__bool relaxed_foreign_metadata_handling;
 
 	FLAC__StreamMetadata *vorbis_comment;
@@ -123,6 +123,7 @@ static struct share__option long_options_[] = {
 	 */
 	{ "decode-through-errors", share__no_argument, 0, 'F' },
 	{ "cue"                  , share__required_argument, 0, 0 },
+	{ "test-level"           , share__required_argument, 0, 0 },
 	{ "apply-replaygain-which-is-not-lossless", share__optional_argument, 0, 0 }, /* undocumented */
 
 	/*
@@ -182,6 +183,7 @@ static struct share__option long_options_[] = {
 	{ "input-size"                , share__required_argument, 0, 0 },
 	{ "error-on-compression-fail" , share__no_argument, 0, 0 },
 	{ "limit-min-bitrate"         , share__no_argument, 0, 0 },
+	{ "prune-lpc-orders"          , share__no_argument, 0, 0 },
 
 	/*
 	 * analysis options
@@ -243,6 +245,8 @@ static struct {
 	replaygain_synthesis_spec_t replaygain_synthesis_spec;
 	FLAC__bool lax;
 	FLAC__bool test_only;
+	TestLevel test_level;
+	FLAC__bool has_test_level; /* true iff --test-level was used */
 	FLAC__bool analyze;
 	FLAC__bool use_ogg;
 	FLAC__bool has_serial_number; /* true iff --serial-number was used */
@@ -287,6 +291,7 @@ static struct {
 	FLAC__bool channel_map_none; /* --channel-map=none specified, eventually will expand to take actual channel map */
 	FLAC__bool error_on_compression_fail;
 	FLAC__bool limit_min_bitrate;
+	FLAC__bool prune_lpc_orders;
 
 	uint32_t num_files;
 	char **filenames;
@@ -412,6 +417,8 @@ int do_it(void)
 		if(!option_values.mode_decode) {
 			if(0 != option_values.cue_specification)
 				return usage_error("ERROR: --cue must be used together with -d\n");
+			if(option_values.has_test_level)
+				return usage_error("ERROR: --test-level must be used together with -t\n");
 			if(0 != option_values.decode_chained_stream)
 				return usage_error("ERROR: --decode-chained-streams must be used together with -d, -t or -a\n");
 		}
@@ -425,7 +432,11 @@ int do_it(void)
 					return usage_error("ERROR: --cue is not allowed in test mode\n");
 				if(0 != option_values.analyze)
 					return usage_error("ERROR: analysis mode (-a/--analyze) and test mode (-t/--test) cannot be used together\n");
+				if(option_values.test_level == TEST_LEVEL_CRC && option_values.decode_chained_stream)
+					return usage_error("ERROR: --test-level=crc is not supported when decoding chained streams\n");
 			}
+			else if(option_values.has_test_level)
+				return usage_error("ERROR: --test-level must be used together with -t\n");
 		}
 
 		if(0 != option_values.cue_specification && (0 != option_values.skip_specification || 0 != option_values.until_specification))
@@ -609,6 +620,8 @@ FLAC__bool init_options(void)
 	option_values.replaygain_synthesis_spec.preamp = 0.0;
 	option_values.lax = false;
 	option_values.test_only = false;
+	option_values.test_level = TEST_LEVEL_MD5;
+	option_values.has_test_level = false;
 	option_values.analyze = false;
 	option_values.use_ogg = false;
 	option_values.decode_chained_stream = false;
@@ -655,6 +668,7 @@ FLAC__bool init_options(void)
 	option_values.channel_map_none = false;
 	option_values.error_on_compression_fail = false;
 	option_values.limit_min_bitrate = false;
+	option_values.prune_lpc_orders = false;
 
 	option_values.num_files = 0;
 	option_values.filenames = 0;
@@ -764,6 +778,18 @@ int parse_option(int short_option, const char *long_option, const char *option_a
 			FLAC__ASSERT(0 != option_argument);
 			option_values.cue_specification = option_argument;
 		}
+		else if(0 == strcmp(long_option, "test-level")) {
+			FLAC__ASSERT(0 != option_argument);
+			if(0 == strcmp(option_argument, "md5"))
+				option_values.test_level = TEST_LEVEL_MD5;
+			else if(0 == strcmp(option_argument, "decode"))
+				option_values.test_level = TEST_LEVEL_DECODE;
+			else if(0 == strcmp(option_argument, "crc"))
+				option_values.test_level = TEST_LEVEL_CRC;
+			else
+				return usage_error("ERROR: argument to --test-level must be md5, decode or crc\n");
+			option_values.has_test_level = true;
+		}
 		else if(0 == strcmp(long_option, "apply-replaygain-which-is-not-lossless")) {
 			option_values.replaygain_synthesis_spec.apply = true;
 			if (0 != option_argument) {
@@ -899,6 +925,9 @@ int parse_option(int short_option, const char *long_option, const char *option_a
 		else if(0 == strcmp(long_option, "limit-min-bitrate")) {
 			option_values.limit_min_bitrate = true;
 		}
+		else if(0 == strcmp(long_option, "prune-lpc-orders")) {
+			option_values.prune_lpc_orders = true;
+		}
 		/*
 		 * negatives
 		 */
@@ -1353,6 +1382,10 @@ void show_help(void)
 	printf("Decoding options:\n");
 	printf("  -F, --decode-through-errors  Continue decoding through stream errors\n");
 	printf("      --cue=[#.#][-[#.#]]      Set the beginning and ending cuepoints to decode\n");
+	printf("      --test-level={md5|decode|crc}  With -t, how thoroughly to test: decode\n");
+	printf("                               and check the MD5 signature (default), decode\n");
+	printf("                               only, or check the frame CRCs only; the\n");
+	printf("                               testing speed is reported for each file\n");
 #if FLAC__HAS_OGG
 	printf("      --decode-chained-stream  Decode all links in a chained Ogg stream, not\n");
 	printf("                               just the first one\n");
@@ -1380,6 +1413,7 @@ void show_help(void)
 	printf("  -r, --rice-partition-order=[#,]#   Set [min,]max residual partition order\n");
 	printf("  -A, --apodization=\"function\"       Window audio data with given function(s)\n");
 	printf("  -e, --exhaustive-model-search      Do exhaustive model search (expensive!)\n");
+	printf("      --prune-lpc-orders             Skip unpromising LPC orders in -e search\n");
 	printf("  -q, --qlp-coeff-precision=#        Specify quantization precision in bits\n");
 	printf("                                     (default: let encoder decide)\n");
 	printf("  -p, --qlp-coeff-precision-search   Exhaustively search LP coeff quantization\n");
@@ -1711,6 +1745,7 @@ int encode_file(const char *infilename, FLAC__bool is_first_file, FLAC__bool is_
 	encode_options.debug.do_md5 = option_values.debug.do_md5;
 	encode_options.error_on_compression_fail = option_values.error_on_compression_fail;
 	encode_options.limit_min_bitrate = option_values.limit_min_bitrate;
+	encode_options.prune_lpc_orders = option_values.prune_lpc_orders;
 	encode_options.relaxed_foreign_metadata_handling = option_values.keep_foreign_metadata_if_present;
 
 	/* if infilename and outfilename point to the same file, we need to write to a temporary file */
@@ -2015,6 +2050,8 @@ int decode_file(const char *infilename)
 
 	decode_options.treat_warnings_as_errors = option_values.treat_warnings_as_errors;
 	decode_options.continue_through_decode_errors = option_values.continue_through_decode_errors;
+	decode_options.test_level = option_values.test_level;
+	decode_options.report_throughput = option_values.has_test_level;
 	decode_options.relaxed_foreign_metadata_handling = option_values.keep_foreign_metadata_if_present;
 	decode_options.replaygain_synthesis_spec = option_values.replaygain_synthesis_spec;
 	decode_options.force_subformat = output_subformat;
@@ -86,6 +86,36 @@ namespace FLAC {
 			return static_cast<bool>(::FLAC__stream_decoder_set_md5_checking(decoder_, value));
 		}
 
+		uint32_t Stream::set_num_threads(uint32_t value)
+		{
+			FLAC__ASSERT(is_valid());
+			return ::FLAC__stream_decoder_set_num_threads(decoder_, value);
+		}
+
+		bool Stream::set_thread_pool(::FLAC__ThreadPool *pool)
+		{
+			FLAC__ASSERT(is_valid());
+			return static_cast<bool>(::FLAC__stream_decoder_set_thread_pool(decoder_, pool));
+		}
+
+		bool Stream::set_mmap(bool value)
+		{
+			FLAC__ASSERT(is_valid());
+			return static_cast<bool>(::FLAC__stream_decoder_set_mmap(decoder_, value));
+		}
+
+		bool Stream::set_build_seek_index(bool value)
+		{
+			FLAC__ASSERT(is_valid());
+			return static_cast<bool>(::FLAC__stream_decoder_set_build_seek_index(decoder_, value));
+		}
+
+		bool Stream::set_interleaved_output(::FLAC__StreamDecoderPCMFormat format)
+		{
+			FLAC__ASSERT(is_valid());
+			return static_cast<bool>(::FLAC__stream_decoder_set_interleaved_output(decoder_, format, interleaved_write_callback_));
+		}
+
 		bool Stream::set_metadata_respond(::FLAC__MetadataType type)
 		{
 			FLAC__ASSERT(is_valid());
@@ -140,6 +170,18 @@ namespace FLAC {
 			return static_cast<bool>(::FLAC__stream_decoder_get_md5_checking(decoder_));
 		}
 
+		uint32_t Stream::get_num_threads() const
+		{
+			FLAC__ASSERT(is_valid());
+			return ::FLAC__stream_decoder_get_num_threads(decoder_);
+		}
+
+		::FLAC__ThreadPool *Stream::get_thread_pool() const
+		{
+			FLAC__ASSERT(is_valid());
+			return ::FLAC__stream_decoder_get_thread_pool(decoder_);
+		}
+
 		FLAC__uint64 Stream::get_total_samples() const
 		{
 			FLAC__ASSERT(is_valid());
@@ -194,6 +236,18 @@ namespace FLAC {
 			return ::FLAC__stream_decoder_get_link_lengths(decoder_, link_lengths);
 		}
 
+		::FLAC__StreamMetadata *Stream::get_seek_index() const
+		{
+			FLAC__ASSERT(is_valid());
+			return ::FLAC__stream_decoder_get_seek_index(decoder_);
+		}
+
+		bool Stream::add_seek_index(const ::FLAC__StreamMetadata *seek_index)
+		{
+			FLAC__ASSERT(is_valid());
+			return static_cast<bool>(::FLAC__stream_decoder_add_seek_index(decoder_, seek_index));
+		}
+
 		::FLAC__StreamDecoderInitStatus Stream::init()
 		{
 			FLAC__ASSERT(is_valid());
@@ -260,6 +314,18 @@ namespace FLAC {
 			return static_cast<bool>(::FLAC__stream_decoder_skip_single_frame(decoder_));
 		}
 
+		bool Stream::scan_single_frame(::FLAC__FrameHeader *header, FLAC__uint64 *offset)
+		{
+			FLAC__ASSERT(is_valid());
+			return static_cast<bool>(::FLAC__stream_decoder_scan_single_frame(decoder_, header, offset));
+		}
+
+		bool Stream::verify_single_frame(::FLAC__FrameHeader *header)
+		{
+			FLAC__ASSERT(is_valid());
+			return static_cast<bool>(::FLAC__stream_decoder_verify_single_frame(decoder_, header));
+		}
+
 		bool Stream::skip_single_link()
 		{
 			FLAC__ASSERT(is_valid());
@@ -272,6 +338,12 @@ namespace FLAC {
 			return static_cast<bool>(::FLAC__stream_decoder_seek_absolute(decoder_, sample));
 		}
 
+		bool Stream::process_sample_ranges(const ::FLAC__StreamDecoderSampleRange ranges[], uint32_t num_ranges)
+		{
+			FLAC__ASSERT(is_valid());
+			return static_cast<bool>(::FLAC__stream_decoder_process_sample_ranges(decoder_, ranges, num_ranges, range_write_callback_));
+		}
+
 		::FLAC__StreamDecoderSeekStatus Stream::seek_callback(FLAC__uint64 absolute_byte_offset)
 		{
 			(void)absolute_byte_offset;
@@ -295,6 +367,18 @@ namespace FLAC {
 			return false;
 		}
 
+		::FLAC__StreamDecoderWriteStatus Stream::interleaved_write_callback(const ::FLAC__Frame *frame, const void *buffer, size_t bytes)
+		{
+			(void)frame, (void)buffer, (void)bytes;
+			return ::FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+		}
+
+		::FLAC__StreamDecoderWriteStatus Stream::range_write_callback(uint32_t range, FLAC__uint64 sample_number, uint32_t samples, const FLAC__int32 * const buffer[])
+		{
+			(void)range, (void)sample_number, (void)samples, (void)buffer;
+			return ::FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+		}
+
 		void Stream::metadata_callback(const ::FLAC__StreamMetadata *metadata)
 		{
 			(void)metadata;
@@ -354,6 +438,24 @@ namespace FLAC {
 			return instance->write_callback(frame, buffer);
 		}
 
+		::FLAC__StreamDecoderWriteStatus Stream::interleaved_write_callback_(const ::FLAC__StreamDecoder *decoder, const ::FLAC__Frame *frame, const void *buffer, size_t bytes, void *client_data)
+		{
+			(void)decoder;
+			FLAC__ASSERT(0 != client_data);
+			Stream *instance = reinterpret_cast<Stream *>(client_data);
+			FLAC__ASSERT(0 != instance);
+			return instance->interleaved_write_callback(frame, buffer, bytes);
+		}
+
+		::FLAC__StreamDecoderWriteStatus Stream::range_write_callback_(const ::FLAC__StreamDecoder *decoder, uint32_t range, FLAC__uint64 sample_number, uint32_t samples, const FLAC__int32 * const buffer[], void *client_data)
+		{
+			(void)decoder;
+			FLAC__ASSERT(0 != client_data);
+			Stream *instance = reinterpret_cast<Stream *>(client_data);
+			FLAC__ASSERT(0 != instance);
+			return instance->range_write_callback(range, sample_number, samples, buffer);
+		}
+
 		void Stream::metadata_callback_(const ::FLAC__StreamDecoder *decoder, const ::FLAC__StreamMetadata *metadata, void *client_data)
 		{
 			(void)decoder;
@@ -403,6 +505,12 @@ namespace FLAC {
 			return init(filename.c_str());
 		}
 
+		::FLAC__StreamDecoderInitStatus File::init(const FLAC__byte *data, size_t length)
+		{
+			FLAC__ASSERT(0 != decoder_);
+			return ::FLAC__stream_decoder_init_memory(decoder_, data, length, write_callback_, metadata_callback_, error_callback_, /*client_data=*/(void*)this);
+		}
+
 		::FLAC__StreamDecoderInitStatus File::init_ogg(FILE *file)
 		{
 			FLAC__ASSERT(0 != decoder_);
@@ -420,10 +528,17 @@ namespace FLAC {
 			return init_ogg(filename.c_str());
 		}
 
+		::FLAC__StreamDecoderInitStatus File::init_ogg(const FLAC__byte *data, size_t length)
+		{
+			FLAC__ASSERT(0 != decoder_);
+			return ::FLAC__stream_decoder_init_ogg_memory(decoder_, data, length, write_callback_, metadata_callback_, error_callback_, /*client_data=*/(void*)this);
+		}
+
 		// This is a dummy to satisfy the pure virtual from Stream; the
 		// read callback will never be called since we are initializing
-		// with FLAC__stream_decoder_init_FILE() or
-		// FLAC__stream_decoder_init_file() and those supply the read
+		// with FLAC__stream_decoder_init_FILE(),
+		// FLAC__stream_decoder_init_file() or
+		// FLAC__stream_decoder_init_memory() and those supply the read
 		// callback internally.
 		::FLAC__StreamDecoderReadStatus File::read_callback(FLAC__byte buffer[], size_t *bytes)
 		{
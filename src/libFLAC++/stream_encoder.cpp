@@ -165,6 +165,12 @@ namespace FLAC {
 			return static_cast<bool>(::FLAC__stream_encoder_set_do_exhaustive_model_search(encoder_, value));
 		}
 
+		bool Stream::set_prune_lpc_orders(bool value)
+		{
+			FLAC__ASSERT(is_valid());
+			return static_cast<bool>(::FLAC__stream_encoder_set_prune_lpc_orders(encoder_, value));
+		}
+
 		bool Stream::set_min_residual_partition_order(uint32_t value)
 		{
 			FLAC__ASSERT(is_valid());
@@ -223,6 +229,18 @@ namespace FLAC {
 			return ::FLAC__stream_encoder_set_num_threads(encoder_, value);
 		}
 
+		bool Stream::set_intra_frame_threading(bool value)
+		{
+			FLAC__ASSERT(is_valid());
+			return static_cast<bool>(::FLAC__stream_encoder_set_intra_frame_threading(encoder_, value));
+		}
+
+		bool Stream::set_thread_pool(::FLAC__ThreadPool *pool)
+		{
+			FLAC__ASSERT(is_valid());
+			return static_cast<bool>(::FLAC__stream_encoder_set_thread_pool(encoder_, pool));
+		}
+
 		Stream::State Stream::get_state() const
 		{
 			FLAC__ASSERT(is_valid());
@@ -319,6 +337,12 @@ namespace FLAC {
 			return static_cast<bool>(::FLAC__stream_encoder_get_do_exhaustive_model_search(encoder_));
 		}
 
+		bool Stream::get_prune_lpc_orders() const
+		{
+			FLAC__ASSERT(is_valid());
+			return static_cast<bool>(::FLAC__stream_encoder_get_prune_lpc_orders(encoder_));
+		}
+
 		uint32_t Stream::get_min_residual_partition_order() const
 		{
 			FLAC__ASSERT(is_valid());
@@ -355,6 +379,18 @@ namespace FLAC {
 			return ::FLAC__stream_encoder_get_num_threads(encoder_);
 		}
 
+		bool Stream::get_intra_frame_threading() const
+		{
+			FLAC__ASSERT(is_valid());
+			return static_cast<bool>(::FLAC__stream_encoder_get_intra_frame_threading(encoder_));
+		}
+
+		::FLAC__ThreadPool *Stream::get_thread_pool() const
+		{
+			FLAC__ASSERT(is_valid());
+			return ::FLAC__stream_encoder_get_thread_pool(encoder_);
+		}
+
 		::FLAC__StreamEncoderInitStatus Stream::init()
 		{
 			FLAC__ASSERT(is_valid());
@@ -117,6 +117,10 @@ struct FLAC__BitReader {
 	uint32_t last_seen_framesync; /* the location of the last seen framesync, if it is in the buffer, in bits from front of buffer */
 	FLAC__BitReaderReadCallback read_callback;
 	void *client_data;
+	const FLAC__byte *source; /* if set, the stream is read from here instead of through read_callback */
+	size_t source_length;
+	size_t *source_position; /* owned by whoever set the source, so it can seek */
+	FLAC__uint16 (*crc16_update_words)(const brword *words, uint32_t len, FLAC__uint16 crc); /* see FLAC__bitreader_set_cpu_info() */
 };
 
 static inline void crc16_update_word_(FLAC__BitReader *br, brword word)
@@ -139,10 +143,8 @@ static inline void crc16_update_block_(FLAC__BitReader *br)
 
 	/* Prevent OOB read due to wrap-around. */
 	if (br->consumed_words > br->crc16_offset) {
-#if FLAC__BYTES_PER_WORD == 4
-		br->read_crc16 = FLAC__crc16_update_words32(br->buffer + br->crc16_offset, br->consumed_words - br->crc16_offset, br->read_crc16);
-#elif FLAC__BYTES_PER_WORD == 8
-		br->read_crc16 = FLAC__crc16_update_words64(br->buffer + br->crc16_offset, br->consumed_words - br->crc16_offset, br->read_crc16);
+#if FLAC__BYTES_PER_WORD == 4 || FLAC__BYTES_PER_WORD == 8
+		br->read_crc16 = br->crc16_update_words(br->buffer + br->crc16_offset, br->consumed_words - br->crc16_offset, br->read_crc16);
 #else
 		unsigned i;
 
@@ -154,6 +156,53 @@ static inline void crc16_update_block_(FLAC__BitReader *br)
 	br->crc16_offset = 0;
 }
 
+/* Fills the buffer straight from the memory source, loading and byte
+ * swapping whole words in one pass instead of copying the bytes in and
+ * swapping them in place afterwards.  The unconsumed data must already
+ * have been moved to the front of the buffer. */
+static FLAC__bool bitreader_read_from_source_(FLAC__BitReader *br)
+{
+	const FLAC__byte *source;
+	size_t bytes;
+	brword word;
+
+	bytes = (br->capacity - br->words) * FLAC__BYTES_PER_WORD - br->bytes;
+	if(bytes == 0)
+		return false; /* no space left, buffer is too small; see note for FLAC__BITREADER_DEFAULT_CAPACITY  */
+	FLAC__ASSERT(*br->source_position < br->source_length);
+	if(bytes > br->source_length - *br->source_position)
+		bytes = br->source_length - *br->source_position;
+	source = br->source + *br->source_position;
+	*br->source_position += bytes;
+
+	/* complete the partial word at the tail, which is left-justified */
+	if(br->bytes) {
+		word = br->buffer[br->words] & ~(FLAC__WORD_ALL_ONES >> (8 * br->bytes));
+		for( ; bytes > 0 && br->bytes < FLAC__BYTES_PER_WORD; bytes--, br->bytes++)
+			word |= (brword)*source++ << (FLAC__BITS_PER_WORD - 8 - 8 * br->bytes);
+		br->buffer[br->words] = word;
+		if(br->bytes < FLAC__BYTES_PER_WORD)
+			return true;
+		br->words++;
+		br->bytes = 0;
+	}
+
+	for( ; bytes >= FLAC__BYTES_PER_WORD; bytes -= FLAC__BYTES_PER_WORD, source += FLAC__BYTES_PER_WORD) {
+		memcpy(&word, source, FLAC__BYTES_PER_WORD);
+		br->buffer[br->words++] = SWAP_BE_WORD_TO_HOST(word);
+	}
+
+	/* start a new partial word with what is left */
+	if(bytes > 0) {
+		word = 0;
+		for( ; br->bytes < bytes; br->bytes++)
+			word |= (brword)*source++ << (FLAC__BITS_PER_WORD - 8 - 8 * br->bytes);
+		br->buffer[br->words] = word;
+	}
+
+	return true;
+}
+
 static FLAC__bool bitreader_read_from_client_(FLAC__BitReader *br)
 {
 	uint32_t start, end;
@@ -179,6 +228,11 @@ static FLAC__bool bitreader_read_from_client_(FLAC__BitReader *br)
 		br->consumed_words = 0;
 	}
 
+	/* once the memory source is used up, the read callback gets to report
+	 * the end of the stream */
+	if(0 != br->source && *br->source_position < br->source_length)
+		return bitreader_read_from_source_(br);
+
 	/*
 	 * set the target for reading, taking into account word alignment and endianness
 	 */
@@ -265,6 +319,7 @@ FLAC__BitReader *FLAC__bitreader_new(void)
 		br->consumed_words = br->consumed_bits = 0;
 		br->read_callback = 0;
 		br->client_data = 0;
+		br->source = 0;
 	*/
 	return br;
 }
@@ -295,13 +350,39 @@ FLAC__bool FLAC__bitreader_init(FLAC__BitReader *br, FLAC__BitReaderReadCallback
 		return false;
 	br->read_callback = rcb;
 	br->client_data = cd;
+	br->source = 0;
+	br->source_length = 0;
+	br->source_position = 0;
 	br->read_limit_set = false;
 	br->read_limit = -1;
 	br->last_seen_framesync = -1;
+#if FLAC__BYTES_PER_WORD == 4
+	br->crc16_update_words = FLAC__crc16_update_words32;
+#elif FLAC__BYTES_PER_WORD == 8
+	br->crc16_update_words = FLAC__crc16_update_words64;
+#endif
 
 	return true;
 }
 
+void FLAC__bitreader_set_cpu_info(FLAC__BitReader *br, const FLAC__CPUInfo *cpuinfo)
+{
+	FLAC__ASSERT(0 != br);
+	FLAC__ASSERT(0 != cpuinfo);
+
+#if !defined FLAC__NO_ASM && (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN && defined FLAC__PCLMUL_SUPPORTED
+	if(cpuinfo->use_asm && cpuinfo->x86.pclmul && cpuinfo->x86.ssse3) {
+#if FLAC__BYTES_PER_WORD == 4
+		br->crc16_update_words = FLAC__crc16_update_words32_intrin_pclmul;
+#elif FLAC__BYTES_PER_WORD == 8
+		br->crc16_update_words = FLAC__crc16_update_words64_intrin_pclmul;
+#endif
+	}
+#else
+	(void)br, (void)cpuinfo;
+#endif
+}
+
 void FLAC__bitreader_free(FLAC__BitReader *br)
 {
 	FLAC__ASSERT(0 != br);
@@ -314,11 +395,32 @@ void FLAC__bitreader_free(FLAC__BitReader *br)
 	br->consumed_words = br->consumed_bits = 0;
 	br->read_callback = 0;
 	br->client_data = 0;
+	br->source = 0;
+	br->source_length = 0;
+	br->source_position = 0;
 	br->read_limit_set = false;
 	br->read_limit = -1;
 	br->last_seen_framesync = -1;
 }
 
+/* From now on, refill the buffer from data[*position] up to data[length],
+ * which saves going through the read callback and copying the stream into
+ * the buffer before swapping it.  *position is updated as data is read
+ * and may be changed by the caller, e.g. to seek, as long as the buffer is
+ * cleared too.  When the data runs out, the read callback is called as
+ * usual to report the end of the stream. */
+void FLAC__bitreader_set_source(FLAC__BitReader *br, const FLAC__byte *data, size_t length, size_t *position)
+{
+	FLAC__ASSERT(0 != br);
+	FLAC__ASSERT(0 != br->buffer);
+	FLAC__ASSERT(0 != data || 0 == length);
+	FLAC__ASSERT(0 != position);
+
+	br->source = data;
+	br->source_length = length;
+	br->source_position = position;
+}
+
 FLAC__bool FLAC__bitreader_clear(FLAC__BitReader *br)
 {
 	br->words = br->bytes = 0;
@@ -365,6 +467,8 @@ FLAC__uint16 FLAC__bitreader_get_read_crc16(FLAC__BitReader *br)
 
 	/* CRC consumed words up to here */
 	crc16_update_block_(br);
+	/* so the CRC can be taken again further on without CRCing the words twice */
+	br->crc16_offset = br->consumed_words;
 
 	FLAC__ASSERT((br->consumed_bits & 7) == 0);
 	FLAC__ASSERT(br->crc16_align <= br->consumed_bits);
@@ -657,6 +761,48 @@ FLAC__bool FLAC__bitreader_skip_byte_block_aligned_no_crc(FLAC__BitReader *br, u
 	return true;
 }
 
+/* tells whether any byte in word is 0xff */
+static inline FLAC__bool word_has_ff_byte_(brword word)
+{
+	const brword ones = FLAC__WORD_ALL_ONES / 0xff, inverse = ~word;
+	return ((inverse - ones) & ~inverse & (ones << 7)) != 0;
+}
+
+FLAC__bool FLAC__bitreader_skip_to_framesync(FLAC__BitReader *br, uint32_t *bytes_left, FLAC__uint32 *sync)
+{
+	/* the CRC-16 of a whole frame is 0, so right after the sync code of
+	 * the frame that follows it is one of these */
+	const uint32_t crc16_after_ff = FLAC__CRC16_UPDATE(0xff, 0);
+	const uint32_t crc16_after_sync[2] = { FLAC__CRC16_UPDATE(0xf8, crc16_after_ff), FLAC__CRC16_UPDATE(0xf9, crc16_after_ff) };
+	FLAC__uint32 previous = 0;
+
+	FLAC__ASSERT(0 != br);
+	FLAC__ASSERT(0 != br->buffer);
+	FLAC__ASSERT(FLAC__bitreader_is_consumed_byte_aligned(br));
+	FLAC__ASSERT(!br->read_limit_set);
+
+	while(*bytes_left > 0) {
+		/* whole words without a 0xff byte can neither hold nor start a
+		 * sync code; their CRC is taken in bulk on the next refill or
+		 * FLAC__bitreader_get_read_crc16() */
+		if(br->consumed_bits == 0 && previous != 0xff) {
+			while(br->consumed_words < br->words && *bytes_left >= FLAC__BYTES_PER_WORD && !word_has_ff_byte_(br->buffer[br->consumed_words])) {
+				br->consumed_words++;
+				*bytes_left -= FLAC__BYTES_PER_WORD;
+			}
+			if(*bytes_left == 0)
+				break;
+		}
+		if(!FLAC__bitreader_read_raw_uint32(br, sync, 8))
+			return false;
+		(*bytes_left)--;
+		if(previous == 0xff && *sync >> 1 == 0x7c && FLAC__bitreader_get_read_crc16(br) == crc16_after_sync[*sync & 1]) /* MAGIC NUMBER for the last 6 sync bits and reserved 7th bit */
+			return true;
+		previous = *sync;
+	}
+	return false;
+}
+
 FLAC__bool FLAC__bitreader_read_byte_block_aligned_no_crc(FLAC__BitReader *br, FLAC__byte *val, uint32_t nvals)
 {
 	FLAC__uint32 x;
@@ -840,6 +986,90 @@ FLAC__bool FLAC__bitreader_read_rice_signed_block_bmi2(FLAC__BitReader *br, int
 #include "deduplication/bitreader_read_rice_signed_block.c"
 #endif
 
+void FLAC__bitreader_build_rice_table(FLAC__BitReaderRiceTableEntry table[], uint32_t parameter)
+{
+	const uint32_t entries = 1u << FLAC__BITREADER_RICE_TABLE_BITS;
+	uint32_t index;
+
+	FLAC__ASSERT(parameter <= FLAC__BITREADER_RICE_TABLE_MAX_PARAMETER);
+
+	for(index = 0; index < entries; index++) {
+		FLAC__BitReaderRiceTableEntry *entry = &table[index];
+		uint32_t bits = 0;
+
+		memset(entry, 0, sizeof(*entry));
+		while(entry->values < FLAC__BITREADER_RICE_TABLE_MAX_VALUES) {
+			uint32_t msbs = 0, lsbs, x;
+			/* the unary MSBs and end bit */
+			while(bits + msbs < FLAC__BITREADER_RICE_TABLE_BITS && !(index >> (FLAC__BITREADER_RICE_TABLE_BITS - 1 - bits - msbs) & 1))
+				msbs++;
+			if(bits + msbs + 1 + parameter > FLAC__BITREADER_RICE_TABLE_BITS)
+				break;
+			bits += msbs + 1;
+			/* the binary LSBs */
+			lsbs = index >> (FLAC__BITREADER_RICE_TABLE_BITS - bits - parameter) & ((1u << parameter) - 1);
+			bits += parameter;
+			x = (msbs << parameter) | lsbs;
+			entry->value[entry->values++] = (FLAC__int8)((int)(x >> 1) ^ -(int)(x & 1));
+		}
+		entry->bits = (FLAC__uint8)bits;
+	}
+}
+
+/* With a small parameter many codewords are only a few bits long, and
+ * decoding them one by one is mostly the overhead of the unary search.
+ * Here each lookup of the next FLAC__BITREADER_RICE_TABLE_BITS bits in a
+ * table built by FLAC__bitreader_build_rice_table() gives all the whole
+ * codewords in them at once.  A codeword longer than that is decoded on
+ * its own; the end of the buffer is left to the regular routine. */
+FLAC__bool FLAC__bitreader_read_rice_signed_block_table(FLAC__BitReader *br, int vals[], uint32_t nvals, uint32_t parameter, const FLAC__BitReaderRiceTableEntry table[])
+{
+	uint32_t pos, end, i;
+
+	FLAC__ASSERT(0 != br);
+	FLAC__ASSERT(0 != br->buffer);
+	FLAC__ASSERT(parameter <= FLAC__BITREADER_RICE_TABLE_MAX_PARAMETER);
+	/* bit positions are kept in 32 bits */
+	FLAC__ASSERT(br->capacity < UINT32_MAX / FLAC__BITS_PER_WORD);
+
+	pos = br->consumed_words * FLAC__BITS_PER_WORD + br->consumed_bits;
+	end = br->words * FLAC__BITS_PER_WORD;
+
+	/* the window below is read from two whole words */
+	while(nvals >= FLAC__BITREADER_RICE_TABLE_MAX_VALUES && pos + 2 * FLAC__BITS_PER_WORD <= end) {
+		const uint32_t word = pos / FLAC__BITS_PER_WORD, bit = pos % FLAC__BITS_PER_WORD;
+		/* the second shift is split so that bit == 0 is not a shift by a whole word */
+		const brword window = (br->buffer[word] << bit) | (br->buffer[word + 1] >> 1 >> (FLAC__BITS_PER_WORD - 1 - bit));
+		const FLAC__BitReaderRiceTableEntry *entry = &table[window >> (FLAC__BITS_PER_WORD - FLAC__BITREADER_RICE_TABLE_BITS)];
+
+		if(entry->values > 0) {
+			/* always copy all of them, there is room for it */
+			for(i = 0; i < FLAC__BITREADER_RICE_TABLE_MAX_VALUES; i++)
+				vals[i] = entry->value[i];
+			vals += entry->values;
+			nvals -= entry->values;
+			pos += entry->bits;
+		}
+		else {
+			uint32_t msbs, x;
+			if(window == 0)
+				break;
+			msbs = COUNT_ZERO_MSBS(window);
+			if(msbs + 1 + parameter > FLAC__BITS_PER_WORD)
+				break;
+			x = (msbs << parameter) | (FLAC__uint32)(window << msbs << 1 >> 1 >> (FLAC__BITS_PER_WORD - 1 - parameter));
+			*vals++ = (int)(x >> 1) ^ -(int)(x & 1);
+			nvals--;
+			pos += msbs + 1 + parameter;
+		}
+	}
+
+	br->consumed_words = pos / FLAC__BITS_PER_WORD;
+	br->consumed_bits = pos % FLAC__BITS_PER_WORD;
+
+	return FLAC__bitreader_read_rice_signed_block(br, vals, nvals, parameter);
+}
+
 #if 0 /* UNUSED */
 FLAC__bool FLAC__bitreader_read_golomb_signed(FLAC__BitReader *br, int *val, uint32_t parameter)
 {
@@ -101,6 +101,7 @@ struct FLAC__BitWriter {
 	uint32_t capacity; /* capacity of buffer in words */
 	uint32_t words; /* # of complete words in buffer */
 	uint32_t bits; /* # of used bits in accum */
+	FLAC__uint16 (*crc16)(const FLAC__byte *data, uint32_t len); /* see FLAC__bitwriter_set_cpu_info() */
 };
 
 /* * WATCHOUT: The current implementation only grows the buffer. */
@@ -187,10 +188,24 @@ FLAC__bool FLAC__bitwriter_init(FLAC__BitWriter *bw)
 	bw->buffer = malloc(sizeof(bwword) * bw->capacity);
 	if(bw->buffer == 0)
 		return false;
+	bw->crc16 = FLAC__crc16;
 
 	return true;
 }
 
+void FLAC__bitwriter_set_cpu_info(FLAC__BitWriter *bw, const FLAC__CPUInfo *cpuinfo)
+{
+	FLAC__ASSERT(0 != bw);
+	FLAC__ASSERT(0 != cpuinfo);
+
+#if !defined FLAC__NO_ASM && (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN && defined FLAC__PCLMUL_SUPPORTED
+	if(cpuinfo->use_asm && cpuinfo->x86.pclmul && cpuinfo->x86.ssse3)
+		bw->crc16 = FLAC__crc16_intrin_pclmul;
+#else
+	(void)bw, (void)cpuinfo;
+#endif
+}
+
 void FLAC__bitwriter_free(FLAC__BitWriter *bw)
 {
 	FLAC__ASSERT(0 != bw);
@@ -217,7 +232,7 @@ FLAC__bool FLAC__bitwriter_get_write_crc16(FLAC__BitWriter *bw, FLAC__uint16 *cr
 	if(!FLAC__bitwriter_get_buffer(bw, &buffer, &bytes))
 		return false;
 
-	*crc = (FLAC__uint16)FLAC__crc16(buffer, bytes);
+	*crc = bw->crc16(buffer, bytes);
 	FLAC__bitwriter_release_buffer(bw);
 	return true;
 }
@@ -75,7 +75,7 @@ FLAC__uint8 const FLAC__crc8_table[256] = {
 
 /* CRC-16, poly = x^16 + x^15 + x^2 + x^0, init = 0 */
 
-FLAC__uint16 const FLAC__crc16_table[8][256] = {
+FLAC__uint16 const FLAC__crc16_table[16][256] = {
   { 0x0000,  0x8005,  0x800f,  0x000a,  0x801b,  0x001e,  0x0014,  0x8011,
 	0x8033,  0x0036,  0x003c,  0x8039,  0x0028,  0x802d,  0x8027,  0x0022,
 	0x8063,  0x0066,  0x006c,  0x8069,  0x0078,  0x807d,  0x8077,  0x0072,
@@ -338,7 +338,271 @@ FLAC__uint16 const FLAC__crc16_table[8][256] = {
 	0x8267,  0x9261,  0xa26b,  0xb26d,  0xc27f,  0xd279,  0xe273,  0xf275,
 	0x0257,  0x1251,  0x225b,  0x325d,  0x424f,  0x5249,  0x6243,  0x7245,
 	0x0202,  0x1204,  0x220e,  0x3208,  0x421a,  0x521c,  0x6216,  0x7210,
-	0x8232,  0x9234,  0xa23e,  0xb238,  0xc22a,  0xd22c,  0xe226,  0xf220 }
+	0x8232,  0x9234,  0xa23e,  0xb238,  0xc22a,  0xd22c,  0xe226,  0xf220 },
+
+  { 0x0000,  0x8663,  0x8cc3,  0x0aa0,  0x9983,  0x1fe0,  0x1540,  0x9323,
+	0xb303,  0x3560,  0x3fc0,  0xb9a3,  0x2a80,  0xace3,  0xa643,  0x2020,
+	0xe603,  0x6060,  0x6ac0,  0xeca3,  0x7f80,  0xf9e3,  0xf343,  0x7520,
+	0x5500,  0xd363,  0xd9c3,  0x5fa0,  0xcc83,  0x4ae0,  0x4040,  0xc623,
+	0x4c03,  0xca60,  0xc0c0,  0x46a3,  0xd580,  0x53e3,  0x5943,  0xdf20,
+	0xff00,  0x7963,  0x73c3,  0xf5a0,  0x6683,  0xe0e0,  0xea40,  0x6c23,
+	0xaa00,  0x2c63,  0x26c3,  0xa0a0,  0x3383,  0xb5e0,  0xbf40,  0x3923,
+	0x1903,  0x9f60,  0x95c0,  0x13a3,  0x8080,  0x06e3,  0x0c43,  0x8a20,
+	0x9806,  0x1e65,  0x14c5,  0x92a6,  0x0185,  0x87e6,  0x8d46,  0x0b25,
+	0x2b05,  0xad66,  0xa7c6,  0x21a5,  0xb286,  0x34e5,  0x3e45,  0xb826,
+	0x7e05,  0xf866,  0xf2c6,  0x74a5,  0xe786,  0x61e5,  0x6b45,  0xed26,
+	0xcd06,  0x4b65,  0x41c5,  0xc7a6,  0x5485,  0xd2e6,  0xd846,  0x5e25,
+	0xd405,  0x5266,  0x58c6,  0xdea5,  0x4d86,  0xcbe5,  0xc145,  0x4726,
+	0x6706,  0xe165,  0xebc5,  0x6da6,  0xfe85,  0x78e6,  0x7246,  0xf425,
+	0x3206,  0xb465,  0xbec5,  0x38a6,  0xab85,  0x2de6,  0x2746,  0xa125,
+	0x8105,  0x0766,  0x0dc6,  0x8ba5,  0x1886,  0x9ee5,  0x9445,  0x1226,
+	0xb009,  0x366a,  0x3cca,  0xbaa9,  0x298a,  0xafe9,  0xa549,  0x232a,
+	0x030a,  0x8569,  0x8fc9,  0x09aa,  0x9a89,  0x1cea,  0x164a,  0x9029,
+	0x560a,  0xd069,  0xdac9,  0x5caa,  0xcf89,  0x49ea,  0x434a,  0xc529,
+	0xe509,  0x636a,  0x69ca,  0xefa9,  0x7c8a,  0xfae9,  0xf049,  0x762a,
+	0xfc0a,  0x7a69,  0x70c9,  0xf6aa,  0x6589,  0xe3ea,  0xe94a,  0x6f29,
+	0x4f09,  0xc96a,  0xc3ca,  0x45a9,  0xd68a,  0x50e9,  0x5a49,  0xdc2a,
+	0x1a09,  0x9c6a,  0x96ca,  0x10a9,  0x838a,  0x05e9,  0x0f49,  0x892a,
+	0xa90a,  0x2f69,  0x25c9,  0xa3aa,  0x3089,  0xb6ea,  0xbc4a,  0x3a29,
+	0x280f,  0xae6c,  0xa4cc,  0x22af,  0xb18c,  0x37ef,  0x3d4f,  0xbb2c,
+	0x9b0c,  0x1d6f,  0x17cf,  0x91ac,  0x028f,  0x84ec,  0x8e4c,  0x082f,
+	0xce0c,  0x486f,  0x42cf,  0xc4ac,  0x578f,  0xd1ec,  0xdb4c,  0x5d2f,
+	0x7d0f,  0xfb6c,  0xf1cc,  0x77af,  0xe48c,  0x62ef,  0x684f,  0xee2c,
+	0x640c,  0xe26f,  0xe8cf,  0x6eac,  0xfd8f,  0x7bec,  0x714c,  0xf72f,
+	0xd70f,  0x516c,  0x5bcc,  0xddaf,  0x4e8c,  0xc8ef,  0xc24f,  0x442c,
+	0x820f,  0x046c,  0x0ecc,  0x88af,  0x1b8c,  0x9def,  0x974f,  0x112c,
+	0x310c,  0xb76f,  0xbdcf,  0x3bac,  0xa88f,  0x2eec,  0x244c,  0xa22f },
+
+  { 0x0000,  0xe017,  0x402b,  0xa03c,  0x8056,  0x6041,  0xc07d,  0x206a,
+	0x80a9,  0x60be,  0xc082,  0x2095,  0x00ff,  0xe0e8,  0x40d4,  0xa0c3,
+	0x8157,  0x6140,  0xc17c,  0x216b,  0x0101,  0xe116,  0x412a,  0xa13d,
+	0x01fe,  0xe1e9,  0x41d5,  0xa1c2,  0x81a8,  0x61bf,  0xc183,  0x2194,
+	0x82ab,  0x62bc,  0xc280,  0x2297,  0x02fd,  0xe2ea,  0x42d6,  0xa2c1,
+	0x0202,  0xe215,  0x4229,  0xa23e,  0x8254,  0x6243,  0xc27f,  0x2268,
+	0x03fc,  0xe3eb,  0x43d7,  0xa3c0,  0x83aa,  0x63bd,  0xc381,  0x2396,
+	0x8355,  0x6342,  0xc37e,  0x2369,  0x0303,  0xe314,  0x4328,  0xa33f,
+	0x8553,  0x6544,  0xc578,  0x256f,  0x0505,  0xe512,  0x452e,  0xa539,
+	0x05fa,  0xe5ed,  0x45d1,  0xa5c6,  0x85ac,  0x65bb,  0xc587,  0x2590,
+	0x0404,  0xe413,  0x442f,  0xa438,  0x8452,  0x6445,  0xc479,  0x246e,
+	0x84ad,  0x64ba,  0xc486,  0x2491,  0x04fb,  0xe4ec,  0x44d0,  0xa4c7,
+	0x07f8,  0xe7ef,  0x47d3,  0xa7c4,  0x87ae,  0x67b9,  0xc785,  0x2792,
+	0x8751,  0x6746,  0xc77a,  0x276d,  0x0707,  0xe710,  0x472c,  0xa73b,
+	0x86af,  0x66b8,  0xc684,  0x2693,  0x06f9,  0xe6ee,  0x46d2,  0xa6c5,
+	0x0606,  0xe611,  0x462d,  0xa63a,  0x8650,  0x6647,  0xc67b,  0x266c,
+	0x8aa3,  0x6ab4,  0xca88,  0x2a9f,  0x0af5,  0xeae2,  0x4ade,  0xaac9,
+	0x0a0a,  0xea1d,  0x4a21,  0xaa36,  0x8a5c,  0x6a4b,  0xca77,  0x2a60,
+	0x0bf4,  0xebe3,  0x4bdf,  0xabc8,  0x8ba2,  0x6bb5,  0xcb89,  0x2b9e,
+	0x8b5d,  0x6b4a,  0xcb76,  0x2b61,  0x0b0b,  0xeb1c,  0x4b20,  0xab37,
+	0x0808,  0xe81f,  0x4823,  0xa834,  0x885e,  0x6849,  0xc875,  0x2862,
+	0x88a1,  0x68b6,  0xc88a,  0x289d,  0x08f7,  0xe8e0,  0x48dc,  0xa8cb,
+	0x895f,  0x6948,  0xc974,  0x2963,  0x0909,  0xe91e,  0x4922,  0xa935,
+	0x09f6,  0xe9e1,  0x49dd,  0xa9ca,  0x89a0,  0x69b7,  0xc98b,  0x299c,
+	0x0ff0,  0xefe7,  0x4fdb,  0xafcc,  0x8fa6,  0x6fb1,  0xcf8d,  0x2f9a,
+	0x8f59,  0x6f4e,  0xcf72,  0x2f65,  0x0f0f,  0xef18,  0x4f24,  0xaf33,
+	0x8ea7,  0x6eb0,  0xce8c,  0x2e9b,  0x0ef1,  0xeee6,  0x4eda,  0xaecd,
+	0x0e0e,  0xee19,  0x4e25,  0xae32,  0x8e58,  0x6e4f,  0xce73,  0x2e64,
+	0x8d5b,  0x6d4c,  0xcd70,  0x2d67,  0x0d0d,  0xed1a,  0x4d26,  0xad31,
+	0x0df2,  0xede5,  0x4dd9,  0xadce,  0x8da4,  0x6db3,  0xcd8f,  0x2d98,
+	0x0c0c,  0xec1b,  0x4c27,  0xac30,  0x8c5a,  0x6c4d,  0xcc71,  0x2c66,
+	0x8ca5,  0x6cb2,  0xcc8e,  0x2c99,  0x0cf3,  0xece4,  0x4cd8,  0xaccf },
+
+  { 0x0000,  0x9543,  0xaa83,  0x3fc0,  0xd503,  0x4040,  0x7f80,  0xeac3,
+	0x2a03,  0xbf40,  0x8080,  0x15c3,  0xff00,  0x6a43,  0x5583,  0xc0c0,
+	0x5406,  0xc145,  0xfe85,  0x6bc6,  0x8105,  0x1446,  0x2b86,  0xbec5,
+	0x7e05,  0xeb46,  0xd486,  0x41c5,  0xab06,  0x3e45,  0x0185,  0x94c6,
+	0xa80c,  0x3d4f,  0x028f,  0x97cc,  0x7d0f,  0xe84c,  0xd78c,  0x42cf,
+	0x820f,  0x174c,  0x288c,  0xbdcf,  0x570c,  0xc24f,  0xfd8f,  0x68cc,
+	0xfc0a,  0x6949,  0x5689,  0xc3ca,  0x2909,  0xbc4a,  0x838a,  0x16c9,
+	0xd609,  0x434a,  0x7c8a,  0xe9c9,  0x030a,  0x9649,  0xa989,  0x3cca,
+	0xd01d,  0x455e,  0x7a9e,  0xefdd,  0x051e,  0x905d,  0xaf9d,  0x3ade,
+	0xfa1e,  0x6f5d,  0x509d,  0xc5de,  0x2f1d,  0xba5e,  0x859e,  0x10dd,
+	0x841b,  0x1158,  0x2e98,  0xbbdb,  0x5118,  0xc45b,  0xfb9b,  0x6ed8,
+	0xae18,  0x3b5b,  0x049b,  0x91d8,  0x7b1b,  0xee58,  0xd198,  0x44db,
+	0x7811,  0xed52,  0xd292,  0x47d1,  0xad12,  0x3851,  0x0791,  0x92d2,
+	0x5212,  0xc751,  0xf891,  0x6dd2,  0x8711,  0x1252,  0x2d92,  0xb8d1,
+	0x2c17,  0xb954,  0x8694,  0x13d7,  0xf914,  0x6c57,  0x5397,  0xc6d4,
+	0x0614,  0x9357,  0xac97,  0x39d4,  0xd317,  0x4654,  0x7994,  0xecd7,
+	0x203f,  0xb57c,  0x8abc,  0x1fff,  0xf53c,  0x607f,  0x5fbf,  0xcafc,
+	0x0a3c,  0x9f7f,  0xa0bf,  0x35fc,  0xdf3f,  0x4a7c,  0x75bc,  0xe0ff,
+	0x7439,  0xe17a,  0xdeba,  0x4bf9,  0xa13a,  0x3479,  0x0bb9,  0x9efa,
+	0x5e3a,  0xcb79,  0xf4b9,  0x61fa,  0x8b39,  0x1e7a,  0x21ba,  0xb4f9,
+	0x8833,  0x1d70,  0x22b0,  0xb7f3,  0x5d30,  0xc873,  0xf7b3,  0x62f0,
+	0xa230,  0x3773,  0x08b3,  0x9df0,  0x7733,  0xe270,  0xddb0,  0x48f3,
+	0xdc35,  0x4976,  0x76b6,  0xe3f5,  0x0936,  0x9c75,  0xa3b5,  0x36f6,
+	0xf636,  0x6375,  0x5cb5,  0xc9f6,  0x2335,  0xb676,  0x89b6,  0x1cf5,
+	0xf022,  0x6561,  0x5aa1,  0xcfe2,  0x2521,  0xb062,  0x8fa2,  0x1ae1,
+	0xda21,  0x4f62,  0x70a2,  0xe5e1,  0x0f22,  0x9a61,  0xa5a1,  0x30e2,
+	0xa424,  0x3167,  0x0ea7,  0x9be4,  0x7127,  0xe464,  0xdba4,  0x4ee7,
+	0x8e27,  0x1b64,  0x24a4,  0xb1e7,  0x5b24,  0xce67,  0xf1a7,  0x64e4,
+	0x582e,  0xcd6d,  0xf2ad,  0x67ee,  0x8d2d,  0x186e,  0x27ae,  0xb2ed,
+	0x722d,  0xe76e,  0xd8ae,  0x4ded,  0xa72e,  0x326d,  0x0dad,  0x98ee,
+	0x0c28,  0x996b,  0xa6ab,  0x33e8,  0xd92b,  0x4c68,  0x73a8,  0xe6eb,
+	0x262b,  0xb368,  0x8ca8,  0x19eb,  0xf328,  0x666b,  0x59ab,  0xcce8 },
+
+  { 0x0000,  0x407e,  0x80fc,  0xc082,  0x81fd,  0xc183,  0x0101,  0x417f,
+	0x83ff,  0xc381,  0x0303,  0x437d,  0x0202,  0x427c,  0x82fe,  0xc280,
+	0x87fb,  0xc785,  0x0707,  0x4779,  0x0606,  0x4678,  0x86fa,  0xc684,
+	0x0404,  0x447a,  0x84f8,  0xc486,  0x85f9,  0xc587,  0x0505,  0x457b,
+	0x8ff3,  0xcf8d,  0x0f0f,  0x4f71,  0x0e0e,  0x4e70,  0x8ef2,  0xce8c,
+	0x0c0c,  0x4c72,  0x8cf0,  0xcc8e,  0x8df1,  0xcd8f,  0x0d0d,  0x4d73,
+	0x0808,  0x4876,  0x88f4,  0xc88a,  0x89f5,  0xc98b,  0x0909,  0x4977,
+	0x8bf7,  0xcb89,  0x0b0b,  0x4b75,  0x0a0a,  0x4a74,  0x8af6,  0xca88,
+	0x9fe3,  0xdf9d,  0x1f1f,  0x5f61,  0x1e1e,  0x5e60,  0x9ee2,  0xde9c,
+	0x1c1c,  0x5c62,  0x9ce0,  0xdc9e,  0x9de1,  0xdd9f,  0x1d1d,  0x5d63,
+	0x1818,  0x5866,  0x98e4,  0xd89a,  0x99e5,  0xd99b,  0x1919,  0x5967,
+	0x9be7,  0xdb99,  0x1b1b,  0x5b65,  0x1a1a,  0x5a64,  0x9ae6,  0xda98,
+	0x1010,  0x506e,  0x90ec,  0xd092,  0x91ed,  0xd193,  0x1111,  0x516f,
+	0x93ef,  0xd391,  0x1313,  0x536d,  0x1212,  0x526c,  0x92ee,  0xd290,
+	0x97eb,  0xd795,  0x1717,  0x5769,  0x1616,  0x5668,  0x96ea,  0xd694,
+	0x1414,  0x546a,  0x94e8,  0xd496,  0x95e9,  0xd597,  0x1515,  0x556b,
+	0xbfc3,  0xffbd,  0x3f3f,  0x7f41,  0x3e3e,  0x7e40,  0xbec2,  0xfebc,
+	0x3c3c,  0x7c42,  0xbcc0,  0xfcbe,  0xbdc1,  0xfdbf,  0x3d3d,  0x7d43,
+	0x3838,  0x7846,  0xb8c4,  0xf8ba,  0xb9c5,  0xf9bb,  0x3939,  0x7947,
+	0xbbc7,  0xfbb9,  0x3b3b,  0x7b45,  0x3a3a,  0x7a44,  0xbac6,  0xfab8,
+	0x3030,  0x704e,  0xb0cc,  0xf0b2,  0xb1cd,  0xf1b3,  0x3131,  0x714f,
+	0xb3cf,  0xf3b1,  0x3333,  0x734d,  0x3232,  0x724c,  0xb2ce,  0xf2b0,
+	0xb7cb,  0xf7b5,  0x3737,  0x7749,  0x3636,  0x7648,  0xb6ca,  0xf6b4,
+	0x3434,  0x744a,  0xb4c8,  0xf4b6,  0xb5c9,  0xf5b7,  0x3535,  0x754b,
+	0x2020,  0x605e,  0xa0dc,  0xe0a2,  0xa1dd,  0xe1a3,  0x2121,  0x615f,
+	0xa3df,  0xe3a1,  0x2323,  0x635d,  0x2222,  0x625c,  0xa2de,  0xe2a0,
+	0xa7db,  0xe7a5,  0x2727,  0x6759,  0x2626,  0x6658,  0xa6da,  0xe6a4,
+	0x2424,  0x645a,  0xa4d8,  0xe4a6,  0xa5d9,  0xe5a7,  0x2525,  0x655b,
+	0xafd3,  0xefad,  0x2f2f,  0x6f51,  0x2e2e,  0x6e50,  0xaed2,  0xeeac,
+	0x2c2c,  0x6c52,  0xacd0,  0xecae,  0xadd1,  0xedaf,  0x2d2d,  0x6d53,
+	0x2828,  0x6856,  0xa8d4,  0xe8aa,  0xa9d5,  0xe9ab,  0x2929,  0x6957,
+	0xabd7,  0xeba9,  0x2b2b,  0x6b55,  0x2a2a,  0x6a54,  0xaad6,  0xeaa8 },
+
+  { 0x0000,  0xff83,  0x7f03,  0x8080,  0xfe06,  0x0185,  0x8105,  0x7e86,
+	0x7c09,  0x838a,  0x030a,  0xfc89,  0x820f,  0x7d8c,  0xfd0c,  0x028f,
+	0xf812,  0x0791,  0x8711,  0x7892,  0x0614,  0xf997,  0x7917,  0x8694,
+	0x841b,  0x7b98,  0xfb18,  0x049b,  0x7a1d,  0x859e,  0x051e,  0xfa9d,
+	0x7021,  0x8fa2,  0x0f22,  0xf0a1,  0x8e27,  0x71a4,  0xf124,  0x0ea7,
+	0x0c28,  0xf3ab,  0x732b,  0x8ca8,  0xf22e,  0x0dad,  0x8d2d,  0x72ae,
+	0x8833,  0x77b0,  0xf730,  0x08b3,  0x7635,  0x89b6,  0x0936,  0xf6b5,
+	0xf43a,  0x0bb9,  0x8b39,  0x74ba,  0x0a3c,  0xf5bf,  0x753f,  0x8abc,
+	0xe042,  0x1fc1,  0x9f41,  0x60c2,  0x1e44,  0xe1c7,  0x6147,  0x9ec4,
+	0x9c4b,  0x63c8,  0xe348,  0x1ccb,  0x624d,  0x9dce,  0x1d4e,  0xe2cd,
+	0x1850,  0xe7d3,  0x6753,  0x98d0,  0xe656,  0x19d5,  0x9955,  0x66d6,
+	0x6459,  0x9bda,  0x1b5a,  0xe4d9,  0x9a5f,  0x65dc,  0xe55c,  0x1adf,
+	0x9063,  0x6fe0,  0xef60,  0x10e3,  0x6e65,  0x91e6,  0x1166,  0xeee5,
+	0xec6a,  0x13e9,  0x9369,  0x6cea,  0x126c,  0xedef,  0x6d6f,  0x92ec,
+	0x6871,  0x97f2,  0x1772,  0xe8f1,  0x9677,  0x69f4,  0xe974,  0x16f7,
+	0x1478,  0xebfb,  0x6b7b,  0x94f8,  0xea7e,  0x15fd,  0x957d,  0x6afe,
+	0x4081,  0xbf02,  0x3f82,  0xc001,  0xbe87,  0x4104,  0xc184,  0x3e07,
+	0x3c88,  0xc30b,  0x438b,  0xbc08,  0xc28e,  0x3d0d,  0xbd8d,  0x420e,
+	0xb893,  0x4710,  0xc790,  0x3813,  0x4695,  0xb916,  0x3996,  0xc615,
+	0xc49a,  0x3b19,  0xbb99,  0x441a,  0x3a9c,  0xc51f,  0x459f,  0xba1c,
+	0x30a0,  0xcf23,  0x4fa3,  0xb020,  0xcea6,  0x3125,  0xb1a5,  0x4e26,
+	0x4ca9,  0xb32a,  0x33aa,  0xcc29,  0xb2af,  0x4d2c,  0xcdac,  0x322f,
+	0xc8b2,  0x3731,  0xb7b1,  0x4832,  0x36b4,  0xc937,  0x49b7,  0xb634,
+	0xb4bb,  0x4b38,  0xcbb8,  0x343b,  0x4abd,  0xb53e,  0x35be,  0xca3d,
+	0xa0c3,  0x5f40,  0xdfc0,  0x2043,  0x5ec5,  0xa146,  0x21c6,  0xde45,
+	0xdcca,  0x2349,  0xa3c9,  0x5c4a,  0x22cc,  0xdd4f,  0x5dcf,  0xa24c,
+	0x58d1,  0xa752,  0x27d2,  0xd851,  0xa6d7,  0x5954,  0xd9d4,  0x2657,
+	0x24d8,  0xdb5b,  0x5bdb,  0xa458,  0xdade,  0x255d,  0xa5dd,  0x5a5e,
+	0xd0e2,  0x2f61,  0xafe1,  0x5062,  0x2ee4,  0xd167,  0x51e7,  0xae64,
+	0xaceb,  0x5368,  0xd3e8,  0x2c6b,  0x52ed,  0xad6e,  0x2dee,  0xd26d,
+	0x28f0,  0xd773,  0x57f3,  0xa870,  0xd6f6,  0x2975,  0xa9f5,  0x5676,
+	0x54f9,  0xab7a,  0x2bfa,  0xd479,  0xaaff,  0x557c,  0xd5fc,  0x2a7f },
+
+  { 0x0000,  0x8102,  0x8201,  0x0303,  0x8407,  0x0505,  0x0606,  0x8704,
+	0x880b,  0x0909,  0x0a0a,  0x8b08,  0x0c0c,  0x8d0e,  0x8e0d,  0x0f0f,
+	0x9013,  0x1111,  0x1212,  0x9310,  0x1414,  0x9516,  0x9615,  0x1717,
+	0x1818,  0x991a,  0x9a19,  0x1b1b,  0x9c1f,  0x1d1d,  0x1e1e,  0x9f1c,
+	0xa023,  0x2121,  0x2222,  0xa320,  0x2424,  0xa526,  0xa625,  0x2727,
+	0x2828,  0xa92a,  0xaa29,  0x2b2b,  0xac2f,  0x2d2d,  0x2e2e,  0xaf2c,
+	0x3030,  0xb132,  0xb231,  0x3333,  0xb437,  0x3535,  0x3636,  0xb734,
+	0xb83b,  0x3939,  0x3a3a,  0xbb38,  0x3c3c,  0xbd3e,  0xbe3d,  0x3f3f,
+	0xc043,  0x4141,  0x4242,  0xc340,  0x4444,  0xc546,  0xc645,  0x4747,
+	0x4848,  0xc94a,  0xca49,  0x4b4b,  0xcc4f,  0x4d4d,  0x4e4e,  0xcf4c,
+	0x5050,  0xd152,  0xd251,  0x5353,  0xd457,  0x5555,  0x5656,  0xd754,
+	0xd85b,  0x5959,  0x5a5a,  0xdb58,  0x5c5c,  0xdd5e,  0xde5d,  0x5f5f,
+	0x6060,  0xe162,  0xe261,  0x6363,  0xe467,  0x6565,  0x6666,  0xe764,
+	0xe86b,  0x6969,  0x6a6a,  0xeb68,  0x6c6c,  0xed6e,  0xee6d,  0x6f6f,
+	0xf073,  0x7171,  0x7272,  0xf370,  0x7474,  0xf576,  0xf675,  0x7777,
+	0x7878,  0xf97a,  0xfa79,  0x7b7b,  0xfc7f,  0x7d7d,  0x7e7e,  0xff7c,
+	0x0083,  0x8181,  0x8282,  0x0380,  0x8484,  0x0586,  0x0685,  0x8787,
+	0x8888,  0x098a,  0x0a89,  0x8b8b,  0x0c8f,  0x8d8d,  0x8e8e,  0x0f8c,
+	0x9090,  0x1192,  0x1291,  0x9393,  0x1497,  0x9595,  0x9696,  0x1794,
+	0x189b,  0x9999,  0x9a9a,  0x1b98,  0x9c9c,  0x1d9e,  0x1e9d,  0x9f9f,
+	0xa0a0,  0x21a2,  0x22a1,  0xa3a3,  0x24a7,  0xa5a5,  0xa6a6,  0x27a4,
+	0x28ab,  0xa9a9,  0xaaaa,  0x2ba8,  0xacac,  0x2dae,  0x2ead,  0xafaf,
+	0x30b3,  0xb1b1,  0xb2b2,  0x33b0,  0xb4b4,  0x35b6,  0x36b5,  0xb7b7,
+	0xb8b8,  0x39ba,  0x3ab9,  0xbbbb,  0x3cbf,  0xbdbd,  0xbebe,  0x3fbc,
+	0xc0c0,  0x41c2,  0x42c1,  0xc3c3,  0x44c7,  0xc5c5,  0xc6c6,  0x47c4,
+	0x48cb,  0xc9c9,  0xcaca,  0x4bc8,  0xcccc,  0x4dce,  0x4ecd,  0xcfcf,
+	0x50d3,  0xd1d1,  0xd2d2,  0x53d0,  0xd4d4,  0x55d6,  0x56d5,  0xd7d7,
+	0xd8d8,  0x59da,  0x5ad9,  0xdbdb,  0x5cdf,  0xdddd,  0xdede,  0x5fdc,
+	0x60e3,  0xe1e1,  0xe2e2,  0x63e0,  0xe4e4,  0x65e6,  0x66e5,  0xe7e7,
+	0xe8e8,  0x69ea,  0x6ae9,  0xebeb,  0x6cef,  0xeded,  0xeeee,  0x6fec,
+	0xf0f0,  0x71f2,  0x72f1,  0xf3f3,  0x74f7,  0xf5f5,  0xf6f6,  0x77f4,
+	0x78fb,  0xf9f9,  0xfafa,  0x7bf8,  0xfcfc,  0x7dfe,  0x7efd,  0xffff },
+
+  { 0x0000,  0x0106,  0x020c,  0x030a,  0x0418,  0x051e,  0x0614,  0x0712,
+	0x0830,  0x0936,  0x0a3c,  0x0b3a,  0x0c28,  0x0d2e,  0x0e24,  0x0f22,
+	0x1060,  0x1166,  0x126c,  0x136a,  0x1478,  0x157e,  0x1674,  0x1772,
+	0x1850,  0x1956,  0x1a5c,  0x1b5a,  0x1c48,  0x1d4e,  0x1e44,  0x1f42,
+	0x20c0,  0x21c6,  0x22cc,  0x23ca,  0x24d8,  0x25de,  0x26d4,  0x27d2,
+	0x28f0,  0x29f6,  0x2afc,  0x2bfa,  0x2ce8,  0x2dee,  0x2ee4,  0x2fe2,
+	0x30a0,  0x31a6,  0x32ac,  0x33aa,  0x34b8,  0x35be,  0x36b4,  0x37b2,
+	0x3890,  0x3996,  0x3a9c,  0x3b9a,  0x3c88,  0x3d8e,  0x3e84,  0x3f82,
+	0x4180,  0x4086,  0x438c,  0x428a,  0x4598,  0x449e,  0x4794,  0x4692,
+	0x49b0,  0x48b6,  0x4bbc,  0x4aba,  0x4da8,  0x4cae,  0x4fa4,  0x4ea2,
+	0x51e0,  0x50e6,  0x53ec,  0x52ea,  0x55f8,  0x54fe,  0x57f4,  0x56f2,
+	0x59d0,  0x58d6,  0x5bdc,  0x5ada,  0x5dc8,  0x5cce,  0x5fc4,  0x5ec2,
+	0x6140,  0x6046,  0x634c,  0x624a,  0x6558,  0x645e,  0x6754,  0x6652,
+	0x6970,  0x6876,  0x6b7c,  0x6a7a,  0x6d68,  0x6c6e,  0x6f64,  0x6e62,
+	0x7120,  0x7026,  0x732c,  0x722a,  0x7538,  0x743e,  0x7734,  0x7632,
+	0x7910,  0x7816,  0x7b1c,  0x7a1a,  0x7d08,  0x7c0e,  0x7f04,  0x7e02,
+	0x8300,  0x8206,  0x810c,  0x800a,  0x8718,  0x861e,  0x8514,  0x8412,
+	0x8b30,  0x8a36,  0x893c,  0x883a,  0x8f28,  0x8e2e,  0x8d24,  0x8c22,
+	0x9360,  0x9266,  0x916c,  0x906a,  0x9778,  0x967e,  0x9574,  0x9472,
+	0x9b50,  0x9a56,  0x995c,  0x985a,  0x9f48,  0x9e4e,  0x9d44,  0x9c42,
+	0xa3c0,  0xa2c6,  0xa1cc,  0xa0ca,  0xa7d8,  0xa6de,  0xa5d4,  0xa4d2,
+	0xabf0,  0xaaf6,  0xa9fc,  0xa8fa,  0xafe8,  0xaeee,  0xade4,  0xace2,
+	0xb3a0,  0xb2a6,  0xb1ac,  0xb0aa,  0xb7b8,  0xb6be,  0xb5b4,  0xb4b2,
+	0xbb90,  0xba96,  0xb99c,  0xb89a,  0xbf88,  0xbe8e,  0xbd84,  0xbc82,
+	0xc280,  0xc386,  0xc08c,  0xc18a,  0xc698,  0xc79e,  0xc494,  0xc592,
+	0xcab0,  0xcbb6,  0xc8bc,  0xc9ba,  0xcea8,  0xcfae,  0xcca4,  0xcda2,
+	0xd2e0,  0xd3e6,  0xd0ec,  0xd1ea,  0xd6f8,  0xd7fe,  0xd4f4,  0xd5f2,
+	0xdad0,  0xdbd6,  0xd8dc,  0xd9da,  0xdec8,  0xdfce,  0xdcc4,  0xddc2,
+	0xe240,  0xe346,  0xe04c,  0xe14a,  0xe658,  0xe75e,  0xe454,  0xe552,
+	0xea70,  0xeb76,  0xe87c,  0xe97a,  0xee68,  0xef6e,  0xec64,  0xed62,
+	0xf220,  0xf326,  0xf02c,  0xf12a,  0xf638,  0xf73e,  0xf434,  0xf532,
+	0xfa10,  0xfb16,  0xf81c,  0xf91a,  0xfe08,  0xff0e,  0xfc04,  0xfd02 },
+
+  { 0x0000,  0x8605,  0x8c0f,  0x0a0a,  0x981b,  0x1e1e,  0x1414,  0x9211,
+	0xb033,  0x3636,  0x3c3c,  0xba39,  0x2828,  0xae2d,  0xa427,  0x2222,
+	0xe063,  0x6666,  0x6c6c,  0xea69,  0x7878,  0xfe7d,  0xf477,  0x7272,
+	0x5050,  0xd655,  0xdc5f,  0x5a5a,  0xc84b,  0x4e4e,  0x4444,  0xc241,
+	0x40c3,  0xc6c6,  0xcccc,  0x4ac9,  0xd8d8,  0x5edd,  0x54d7,  0xd2d2,
+	0xf0f0,  0x76f5,  0x7cff,  0xfafa,  0x68eb,  0xeeee,  0xe4e4,  0x62e1,
+	0xa0a0,  0x26a5,  0x2caf,  0xaaaa,  0x38bb,  0xbebe,  0xb4b4,  0x32b1,
+	0x1093,  0x9696,  0x9c9c,  0x1a99,  0x8888,  0x0e8d,  0x0487,  0x8282,
+	0x8186,  0x0783,  0x0d89,  0x8b8c,  0x199d,  0x9f98,  0x9592,  0x1397,
+	0x31b5,  0xb7b0,  0xbdba,  0x3bbf,  0xa9ae,  0x2fab,  0x25a1,  0xa3a4,
+	0x61e5,  0xe7e0,  0xedea,  0x6bef,  0xf9fe,  0x7ffb,  0x75f1,  0xf3f4,
+	0xd1d6,  0x57d3,  0x5dd9,  0xdbdc,  0x49cd,  0xcfc8,  0xc5c2,  0x43c7,
+	0xc145,  0x4740,  0x4d4a,  0xcb4f,  0x595e,  0xdf5b,  0xd551,  0x5354,
+	0x7176,  0xf773,  0xfd79,  0x7b7c,  0xe96d,  0x6f68,  0x6562,  0xe367,
+	0x2126,  0xa723,  0xad29,  0x2b2c,  0xb93d,  0x3f38,  0x3532,  0xb337,
+	0x9115,  0x1710,  0x1d1a,  0x9b1f,  0x090e,  0x8f0b,  0x8501,  0x0304,
+	0x8309,  0x050c,  0x0f06,  0x8903,  0x1b12,  0x9d17,  0x971d,  0x1118,
+	0x333a,  0xb53f,  0xbf35,  0x3930,  0xab21,  0x2d24,  0x272e,  0xa12b,
+	0x636a,  0xe56f,  0xef65,  0x6960,  0xfb71,  0x7d74,  0x777e,  0xf17b,
+	0xd359,  0x555c,  0x5f56,  0xd953,  0x4b42,  0xcd47,  0xc74d,  0x4148,
+	0xc3ca,  0x45cf,  0x4fc5,  0xc9c0,  0x5bd1,  0xddd4,  0xd7de,  0x51db,
+	0x73f9,  0xf5fc,  0xfff6,  0x79f3,  0xebe2,  0x6de7,  0x67ed,  0xe1e8,
+	0x23a9,  0xa5ac,  0xafa6,  0x29a3,  0xbbb2,  0x3db7,  0x37bd,  0xb1b8,
+	0x939a,  0x159f,  0x1f95,  0x9990,  0x0b81,  0x8d84,  0x878e,  0x018b,
+	0x028f,  0x848a,  0x8e80,  0x0885,  0x9a94,  0x1c91,  0x169b,  0x909e,
+	0xb2bc,  0x34b9,  0x3eb3,  0xb8b6,  0x2aa7,  0xaca2,  0xa6a8,  0x20ad,
+	0xe2ec,  0x64e9,  0x6ee3,  0xe8e6,  0x7af7,  0xfcf2,  0xf6f8,  0x70fd,
+	0x52df,  0xd4da,  0xded0,  0x58d5,  0xcac4,  0x4cc1,  0x46cb,  0xc0ce,
+	0x424c,  0xc449,  0xce43,  0x4846,  0xda57,  0x5c52,  0x5658,  0xd05d,
+	0xf27f,  0x747a,  0x7e70,  0xf875,  0x6a64,  0xec61,  0xe66b,  0x606e,
+	0xa22f,  0x242a,  0x2e20,  0xa825,  0x3a34,  0xbc31,  0xb63b,  0x303e,
+	0x121c,  0x9419,  0x9e13,  0x1816,  0x8a07,  0x0c02,  0x0608,  0x800d }
 };
 
 #if 0
@@ -358,7 +622,7 @@ void FLAC__crc16_init_table(void)
 	}
 
 	for(i = 0; i <= 0xFF; i++)
-		for(j = 1; j < 8; j++)
+		for(j = 1; j < 16; j++)
 			FLAC__crc16_table[j][i] = FLAC__crc16_table[0][FLAC__crc16_table[j - 1][i] >> 8] ^ (FLAC__crc16_table[j - 1][i] << 8);
 }
 #endif
@@ -377,7 +641,23 @@ FLAC__uint16 FLAC__crc16(const FLAC__byte *data, uint32_t len)
 {
 	FLAC__uint16 crc = 0;
 
-	while(len >= 8){
+	while(len >= 16){
+		crc ^= data[0] << 8 | data[1];
+
+		crc = FLAC__crc16_table[15][crc >> 8] ^ FLAC__crc16_table[14][crc & 0xFF] ^
+		      FLAC__crc16_table[13][data[2] ] ^ FLAC__crc16_table[12][data[3]   ] ^
+		      FLAC__crc16_table[11][data[4] ] ^ FLAC__crc16_table[10][data[5]   ] ^
+		      FLAC__crc16_table[ 9][data[6] ] ^ FLAC__crc16_table[ 8][data[7]   ] ^
+		      FLAC__crc16_table[ 7][data[8] ] ^ FLAC__crc16_table[ 6][data[9]   ] ^
+		      FLAC__crc16_table[ 5][data[10]] ^ FLAC__crc16_table[ 4][data[11]  ] ^
+		      FLAC__crc16_table[ 3][data[12]] ^ FLAC__crc16_table[ 2][data[13]  ] ^
+		      FLAC__crc16_table[ 1][data[14]] ^ FLAC__crc16_table[ 0][data[15]  ];
+
+		data += 16;
+		len -= 16;
+	}
+
+	if(len >= 8){
 		crc ^= data[0] << 8 | data[1];
 
 		crc = FLAC__crc16_table[7][crc >> 8] ^ FLAC__crc16_table[6][crc & 0xFF] ^
@@ -397,7 +677,23 @@ FLAC__uint16 FLAC__crc16(const FLAC__byte *data, uint32_t len)
 
 FLAC__uint16 FLAC__crc16_update_words32(const FLAC__uint32 *words, uint32_t len, FLAC__uint16 crc)
 {
-	while (len >= 2) {
+	while (len >= 4) {
+		crc ^= words[0] >> 16;
+
+		crc = FLAC__crc16_table[15][crc >> 8               ] ^ FLAC__crc16_table[14][crc & 0xFF             ] ^
+		      FLAC__crc16_table[13][(words[0] >>  8) & 0xFF] ^ FLAC__crc16_table[12][ words[0]        & 0xFF] ^
+		      FLAC__crc16_table[11][ words[1] >> 24        ] ^ FLAC__crc16_table[10][(words[1] >> 16) & 0xFF] ^
+		      FLAC__crc16_table[ 9][(words[1] >>  8) & 0xFF] ^ FLAC__crc16_table[ 8][ words[1]        & 0xFF] ^
+		      FLAC__crc16_table[ 7][ words[2] >> 24        ] ^ FLAC__crc16_table[ 6][(words[2] >> 16) & 0xFF] ^
+		      FLAC__crc16_table[ 5][(words[2] >>  8) & 0xFF] ^ FLAC__crc16_table[ 4][ words[2]        & 0xFF] ^
+		      FLAC__crc16_table[ 3][ words[3] >> 24        ] ^ FLAC__crc16_table[ 2][(words[3] >> 16) & 0xFF] ^
+		      FLAC__crc16_table[ 1][(words[3] >>  8) & 0xFF] ^ FLAC__crc16_table[ 0][ words[3]        & 0xFF];
+
+		words += 4;
+		len -= 4;
+	}
+
+	if (len >= 2) {
 		crc ^= words[0] >> 16;
 
 		crc = FLAC__crc16_table[7][crc >> 8               ] ^ FLAC__crc16_table[6][crc & 0xFF             ] ^
@@ -421,15 +717,29 @@ FLAC__uint16 FLAC__crc16_update_words32(const FLAC__uint32 *words, uint32_t len,
 
 FLAC__uint16 FLAC__crc16_update_words64(const FLAC__uint64 *words, uint32_t len, FLAC__uint16 crc)
 {
-	while (len--) {
+	while (len >= 2) {
+		crc ^= words[0] >> 48;
+
+		crc = FLAC__crc16_table[15][crc >> 8               ] ^ FLAC__crc16_table[14][crc & 0xFF             ] ^
+		      FLAC__crc16_table[13][(words[0] >> 40) & 0xFF] ^ FLAC__crc16_table[12][(words[0] >> 32) & 0xFF] ^
+		      FLAC__crc16_table[11][(words[0] >> 24) & 0xFF] ^ FLAC__crc16_table[10][(words[0] >> 16) & 0xFF] ^
+		      FLAC__crc16_table[ 9][(words[0] >>  8) & 0xFF] ^ FLAC__crc16_table[ 8][ words[0]        & 0xFF] ^
+		      FLAC__crc16_table[ 7][ words[1] >> 56        ] ^ FLAC__crc16_table[ 6][(words[1] >> 48) & 0xFF] ^
+		      FLAC__crc16_table[ 5][(words[1] >> 40) & 0xFF] ^ FLAC__crc16_table[ 4][(words[1] >> 32) & 0xFF] ^
+		      FLAC__crc16_table[ 3][(words[1] >> 24) & 0xFF] ^ FLAC__crc16_table[ 2][(words[1] >> 16) & 0xFF] ^
+		      FLAC__crc16_table[ 1][(words[1] >>  8) & 0xFF] ^ FLAC__crc16_table[ 0][ words[1]        & 0xFF];
+
+		words += 2;
+		len -= 2;
+	}
+
+	if (len) {
 		crc ^= words[0] >> 48;
 
 		crc = FLAC__crc16_table[7][crc >> 8               ] ^ FLAC__crc16_table[6][crc & 0xFF             ] ^
 		      FLAC__crc16_table[5][(words[0] >> 40) & 0xFF] ^ FLAC__crc16_table[4][(words[0] >> 32) & 0xFF] ^
 		      FLAC__crc16_table[3][(words[0] >> 24) & 0xFF] ^ FLAC__crc16_table[2][(words[0] >> 16) & 0xFF] ^
 		      FLAC__crc16_table[1][(words[0] >>  8) & 0xFF] ^ FLAC__crc16_table[0][ words[0]        & 0xFF];
-
-		words++;
 	}
 
 	return crc;
@@ -0,0 +1,143 @@
+/* libFLAC - Free Lossless Audio Codec library
+ * Copyright (C) 2026  Xiph.Org Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "private/cpu.h"
+
+#ifndef FLAC__NO_ASM
+#if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
+#include "private/crc.h"
+#ifdef FLAC__PCLMUL_SUPPORTED
+
+#include <tmmintrin.h> /* SSSE3 */
+#include <wmmintrin.h> /* PCLMUL */
+
+/*
+ * The data is read 16 bytes at a time into a 128-bit polynomial, first
+ * bit highest.  Such a polynomial X followed by the next block B is
+ * X * x^128 + B, and since only the remainder modulo the CRC polynomial P
+ * matters, X * x^128 is replaced by the at most 80-bit products of the
+ * two halves of X with x^192 mod P and x^128 mod P.  Four blocks are
+ * folded side by side over most of the data to hide the multiply
+ * latency.  The polynomial that is left is reduced with the tables.
+ */
+
+/* x^192 mod P in the low half, x^128 mod P in the high half */
+#define FOLD_BY_1 _mm_set_epi32(0, 0x0106, 0, 0x1666)
+/* x^576 mod P and x^512 mod P */
+#define FOLD_BY_4 _mm_set_epi32(0, 0x8107, 0, 0x1446)
+
+FLAC__SSE_TARGET("pclmul,ssse3")
+static inline __m128i fold_(__m128i x, __m128i k)
+{
+	return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x01), _mm_clmulepi64_si128(x, k, 0x10));
+}
+
+/* order puts the first byte of a block in the top byte of the register */
+FLAC__SSE_TARGET("pclmul,ssse3")
+static FLAC__uint16 crc16_blocks_(const FLAC__byte *data, uint32_t blocks, FLAC__uint16 crc, __m128i order)
+{
+	const __m128i *block = (const __m128i*)data;
+	__m128i x = _mm_shuffle_epi8(_mm_loadu_si128(block), order);
+	FLAC__uint64 remainder[2];
+	uint32_t i = 1;
+
+	/* the running CRC goes into the first 16 bits, like in the table versions */
+	x = _mm_xor_si128(x, _mm_slli_si128(_mm_cvtsi32_si128(crc), 14));
+
+	if(blocks >= 8) {
+		__m128i x1 = _mm_shuffle_epi8(_mm_loadu_si128(block + 1), order);
+		__m128i x2 = _mm_shuffle_epi8(_mm_loadu_si128(block + 2), order);
+		__m128i x3 = _mm_shuffle_epi8(_mm_loadu_si128(block + 3), order);
+
+		for(i = 4; i + 4 <= blocks; i += 4) {
+			x  = _mm_xor_si128(fold_(x , FOLD_BY_4), _mm_shuffle_epi8(_mm_loadu_si128(block + i    ), order));
+			x1 = _mm_xor_si128(fold_(x1, FOLD_BY_4), _mm_shuffle_epi8(_mm_loadu_si128(block + i + 1), order));
+			x2 = _mm_xor_si128(fold_(x2, FOLD_BY_4), _mm_shuffle_epi8(_mm_loadu_si128(block + i + 2), order));
+			x3 = _mm_xor_si128(fold_(x3, FOLD_BY_4), _mm_shuffle_epi8(_mm_loadu_si128(block + i + 3), order));
+		}
+		x = _mm_xor_si128(fold_(x, FOLD_BY_1), x1);
+		x = _mm_xor_si128(fold_(x, FOLD_BY_1), x2);
+		x = _mm_xor_si128(fold_(x, FOLD_BY_1), x3);
+	}
+	for( ; i < blocks; i++)
+		x = _mm_xor_si128(fold_(x, FOLD_BY_1), _mm_shuffle_epi8(_mm_loadu_si128(block + i), order));
+
+	/* high half first */
+	_mm_storeu_si128((__m128i*)remainder, _mm_shuffle_epi32(x, _MM_SHUFFLE(1,0,3,2)));
+	return FLAC__crc16_update_words64(remainder, 2, 0);
+}
+
+FLAC__SSE_TARGET("pclmul,ssse3")
+FLAC__uint16 FLAC__crc16_intrin_pclmul(const FLAC__byte *data, uint32_t len)
+{
+	FLAC__uint16 crc = 0;
+
+	if(len >= 64) {
+		crc = crc16_blocks_(data, len / 16, crc, _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+		data += len / 16 * 16;
+		len %= 16;
+	}
+	while(len--)
+		crc = (FLAC__uint16)FLAC__CRC16_UPDATE(*data++, crc);
+
+	return crc;
+}
+
+FLAC__SSE_TARGET("pclmul,ssse3")
+FLAC__uint16 FLAC__crc16_update_words32_intrin_pclmul(const FLAC__uint32 *words, uint32_t len, FLAC__uint16 crc)
+{
+	if(len >= 16) {
+		/* the words are in host order, most significant byte first in the stream */
+		crc = crc16_blocks_((const FLAC__byte*)words, len / 4, crc, _mm_setr_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3));
+		words += len / 4 * 4;
+		len %= 4;
+	}
+	return FLAC__crc16_update_words32(words, len, crc);
+}
+
+FLAC__SSE_TARGET("pclmul,ssse3")
+FLAC__uint16 FLAC__crc16_update_words64_intrin_pclmul(const FLAC__uint64 *words, uint32_t len, FLAC__uint16 crc)
+{
+	if(len >= 8) {
+		crc = crc16_blocks_((const FLAC__byte*)words, len / 2, crc, _mm_setr_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7));
+		words += len / 2 * 2;
+		len %= 2;
+	}
+	return FLAC__crc16_update_words64(words, len, crc);
+}
+
+#endif /* FLAC__PCLMUL_SUPPORTED */
+#endif /* (FLAC__CPU_IA32 || FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN */
+#endif /* FLAC__NO_ASM */
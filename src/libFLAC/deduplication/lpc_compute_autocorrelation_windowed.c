@@ -0,0 +1,37 @@
+/* This code is imported several times in lpc.c with different values for
+ * MAX_LAG. Each window is applied CHUNK samples at a time, converted to
+ * double once, and every windowed sample is multiplied with the MAX_LAG
+ * samples following it, so the inner loop reads forward through memory.
+ * Samples past data_len are zero and add nothing. Each lag is still summed
+ * in the same order as FLAC__lpc_compute_autocorrelation() sums it, which
+ * makes the results identical to windowing first */
+	double buffer[CHUNK + MAX_LAG];
+	double sum[MAX_LAG];
+	uint32_t k, start, i, j;
+	(void) lag;
+	FLAC__ASSERT(lag <= MAX_LAG);
+	FLAC__ASSERT(num_windows <= FLAC__MAX_LPC_WINDOWS);
+
+	for(k = 0; k < num_windows; k++) {
+		const FLAC__int32 *x = in[k];
+		const FLAC__real *w = window[k];
+
+		for(j = 0; j < MAX_LAG; j++)
+			sum[j] = 0.0;
+		/* buffer[i] holds windowed sample start+i */
+		for(i = 0; i < MAX_LAG; i++)
+			buffer[i] = i < data_len ? (FLAC__real)(x[i] * w[i]) : 0.0;
+
+		for(start = 0; start < data_len; start += CHUNK) {
+			const uint32_t len = flac_min(data_len - start, CHUNK);
+			for(i = MAX_LAG; i < CHUNK + MAX_LAG; i++)
+				buffer[i] = start + i < data_len ? (FLAC__real)(x[start+i] * w[start+i]) : 0.0;
+			for(i = 0; i < len; i++)
+				for(j = 0; j < MAX_LAG; j++)
+					sum[j] += buffer[i] * buffer[i+j];
+			memmove(buffer, buffer + CHUNK, sizeof(buffer[0]) * MAX_LAG);
+		}
+
+		for(j = 0; j < MAX_LAG; j++)
+			autoc[k][j] = sum[j];
+	}
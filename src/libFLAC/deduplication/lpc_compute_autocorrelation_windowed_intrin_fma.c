@@ -0,0 +1,40 @@
+/* This code is imported several times in lpc_intrin_fma.c with different
+ * values for NUM_VECTORS; it computes the lags up to 4*NUM_VECTORS like
+ * deduplication/lpc_compute_autocorrelation_windowed.c does, but keeps the
+ * sums in registers. As a product of two floats is exact in double
+ * precision, fused multiply-adds round the same as separate ones */
+	double buffer[CHUNK + 4*NUM_VECTORS];
+	double sums[4*NUM_VECTORS];
+	__m256d sum[NUM_VECTORS];
+	uint32_t k, start, i, v;
+	(void) lag;
+	FLAC__ASSERT(lag <= 4*NUM_VECTORS);
+	FLAC__ASSERT(num_windows <= FLAC__MAX_LPC_WINDOWS);
+
+	for(k = 0; k < num_windows; k++) {
+		const FLAC__int32 *x = in[k];
+		const FLAC__real *w = window[k];
+
+		for(v = 0; v < NUM_VECTORS; v++)
+			sum[v] = _mm256_setzero_pd();
+		/* buffer[i] holds windowed sample start+i */
+		for(i = 0; i < 4*NUM_VECTORS; i++)
+			buffer[i] = i < data_len ? (FLAC__real)(x[i] * w[i]) : 0.0;
+
+		for(start = 0; start < data_len; start += CHUNK) {
+			const uint32_t len = flac_min(data_len - start, CHUNK);
+			for(i = 4*NUM_VECTORS; i < CHUNK + 4*NUM_VECTORS; i++)
+				buffer[i] = start + i < data_len ? (FLAC__real)(x[start+i] * w[start+i]) : 0.0;
+			for(i = 0; i < len; i++) {
+				const __m256d d = _mm256_broadcast_sd(buffer + i);
+				for(v = 0; v < NUM_VECTORS; v++)
+					sum[v] = _mm256_fmadd_pd(d, _mm256_loadu_pd(buffer + i + 4*v), sum[v]);
+			}
+			memmove(buffer, buffer + CHUNK, sizeof(buffer[0]) * 4*NUM_VECTORS);
+		}
+
+		for(v = 0; v < NUM_VECTORS; v++)
+			_mm256_storeu_pd(sums + 4*v, sum[v]);
+		for(i = 0; i < 4*NUM_VECTORS && i <= FLAC__MAX_LPC_ORDER; i++)
+			autoc[k][i] = sums[i];
+	}
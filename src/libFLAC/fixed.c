@@ -628,6 +628,23 @@ void FLAC__fixed_restore_signal_wide(const FLAC__int32 residual[], uint32_t data
 	}
 }
 
+void FLAC__fixed_restore_signal_differences(const FLAC__int32 data[], uint32_t order, FLAC__int32 last_difference[])
+{
+	FLAC__uint32 diff[FLAC__MAX_FIXED_ORDER];
+	uint32_t i, j;
+
+	FLAC__ASSERT(order <= FLAC__MAX_FIXED_ORDER);
+
+	/* last_difference[i] becomes the i-th difference of data[-1] */
+	for(i = 0; i < order; i++)
+		diff[i] = (FLAC__uint32)data[-1-(int)i];
+	for(i = 0; i < order; i++) {
+		last_difference[i] = (FLAC__int32)diff[0];
+		for(j = 0; j + 1 < order - i; j++)
+			diff[j] -= diff[j+1];
+	}
+}
+
 #if defined(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION) && !defined(FUZZING_BUILD_MODE_FLAC_SANITIZE_SIGNED_INTEGER_OVERFLOW)
 /* The attribute below is to silence the undefined sanitizer of oss-fuzz.
  * Because fuzzing feeds bogus predictors and residual samples to the
@@ -36,7 +36,6 @@
 
 #include "private/cpu.h"
 
-#ifndef FLAC__INTEGER_ONLY_LIBRARY
 #ifndef FLAC__NO_ASM
 #if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
 #include "private/fixed.h"
@@ -53,6 +52,8 @@
 #endif
 #define local_abs(x) ((uint32_t)((x)<0? -(x) : (x)))
 
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+
 FLAC__SSE_TARGET("avx2")
 uint32_t FLAC__fixed_compute_best_predictor_wide_intrin_avx2(const FLAC__int32 data[], uint32_t data_len, float residual_bits_per_sample[FLAC__MAX_FIXED_ORDER + 1])
 {
@@ -337,7 +338,81 @@ uint32_t FLAC__fixed_compute_best_predictor_limit_residual_intrin_avx2(const FLA
 	return order;
 }
 
+#endif /* !defined FLAC__INTEGER_ONLY_LIBRARY */
+
+/* Same approach as FLAC__fixed_restore_signal_intrin_sse2(), but with
+ * vectors of 8 samples. The prefix sum is done within each 128-bit lane
+ * first, after which the last sample of the lower lane is added to the
+ * upper lane */
+#define RUNNING_SUM_AVX2(v, carry) \
+	v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4)); \
+	v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8)); \
+	v = _mm256_add_epi32(v, _mm256_permute2x128_si256(_mm256_setzero_si256(), _mm256_shuffle_epi32(v, _MM_SHUFFLE(3,3,3,3)), 0x20)); \
+	v = _mm256_add_epi32(v, carry); \
+	carry = _mm256_permutevar8x32_epi32(v, last_lane)
+
+FLAC__SSE_TARGET("avx2")
+void FLAC__fixed_restore_signal_intrin_avx2(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[])
+{
+	FLAC__int32 last_difference[FLAC__MAX_FIXED_ORDER] = { 0 };
+	const __m256i last_lane = _mm256_set1_epi32(7);
+	__m256i carry0, carry1, carry2, carry3, v;
+	int i = 0, idata_len = (int)data_len;
+
+	FLAC__ASSERT(order <= FLAC__MAX_FIXED_ORDER);
+
+	if(order == 0) {
+		FLAC__fixed_restore_signal(residual, data_len, order, data);
+		return;
+	}
+
+	FLAC__fixed_restore_signal_differences(data, order, last_difference);
+	carry0 = _mm256_set1_epi32(last_difference[0]);
+	carry1 = _mm256_set1_epi32(last_difference[1]);
+	carry2 = _mm256_set1_epi32(last_difference[2]);
+	carry3 = _mm256_set1_epi32(last_difference[3]);
+
+	switch(order) {
+		case 1:
+			for(; i <= idata_len - 8; i += 8) {
+				v = _mm256_loadu_si256((const __m256i*)(const void*)(residual+i));
+				RUNNING_SUM_AVX2(v, carry0);
+				_mm256_storeu_si256((__m256i*)(void*)(data+i), v);
+			}
+			break;
+		case 2:
+			for(; i <= idata_len - 8; i += 8) {
+				v = _mm256_loadu_si256((const __m256i*)(const void*)(residual+i));
+				RUNNING_SUM_AVX2(v, carry1);
+				RUNNING_SUM_AVX2(v, carry0);
+				_mm256_storeu_si256((__m256i*)(void*)(data+i), v);
+			}
+			break;
+		case 3:
+			for(; i <= idata_len - 8; i += 8) {
+				v = _mm256_loadu_si256((const __m256i*)(const void*)(residual+i));
+				RUNNING_SUM_AVX2(v, carry2);
+				RUNNING_SUM_AVX2(v, carry1);
+				RUNNING_SUM_AVX2(v, carry0);
+				_mm256_storeu_si256((__m256i*)(void*)(data+i), v);
+			}
+			break;
+		default:
+			for(; i <= idata_len - 8; i += 8) {
+				v = _mm256_loadu_si256((const __m256i*)(const void*)(residual+i));
+				RUNNING_SUM_AVX2(v, carry3);
+				RUNNING_SUM_AVX2(v, carry2);
+				RUNNING_SUM_AVX2(v, carry1);
+				RUNNING_SUM_AVX2(v, carry0);
+				_mm256_storeu_si256((__m256i*)(void*)(data+i), v);
+			}
+			break;
+	}
+	_mm256_zeroupper();
+
+	FLAC__fixed_restore_signal_wide(residual+i, data_len-i, order, data+i);
+}
+
 #endif /* FLAC__AVX2_SUPPORTED */
 #endif /* (FLAC__CPU_IA32 || FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN */
 #endif /* FLAC__NO_ASM */
-#endif /* FLAC__INTEGER_ONLY_LIBRARY */
@@ -36,7 +36,6 @@
 
 #include "private/cpu.h"
 
-#ifndef FLAC__INTEGER_ONLY_LIBRARY
 #ifndef FLAC__NO_ASM
 #if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && defined FLAC__HAS_X86INTRIN
 #include "private/fixed.h"
@@ -59,6 +58,8 @@
 #endif
 #define local_abs(x) ((uint32_t)((x)<0? -(x) : (x)))
 
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+
 FLAC__SSE_TARGET("sse2")
 uint32_t FLAC__fixed_compute_best_predictor_intrin_sse2(const FLAC__int32 data[], uint32_t data_len, float residual_bits_per_sample[FLAC__MAX_FIXED_ORDER + 1])
 {
@@ -188,7 +189,82 @@ uint32_t FLAC__fixed_compute_best_predictor_intrin_sse2(const FLAC__int32 data[]
 	return order;
 }
 
+#endif /* !defined FLAC__INTEGER_ONLY_LIBRARY */
+
+/* The fixed predictor of order k turns the k-th difference of the signal
+ * into the residual, so the signal is restored by summing the residual k
+ * times over. Each of these running sums is done for a vector of samples
+ * at once with the usual shift-and-add prefix sum, carrying the last lane
+ * into the next vector. All sums are done modulo 2^32, which gives exactly
+ * the samples FLAC__fixed_restore_signal_wide() computes, so this function
+ * serves both the 32-bit and the wide case */
+#define RUNNING_SUM_SSE2(v, carry) \
+	v = _mm_add_epi32(v, _mm_slli_si128(v, 4)); \
+	v = _mm_add_epi32(v, _mm_slli_si128(v, 8)); \
+	v = _mm_add_epi32(v, carry); \
+	carry = _mm_shuffle_epi32(v, _MM_SHUFFLE(3,3,3,3))
+
+FLAC__SSE_TARGET("sse2")
+void FLAC__fixed_restore_signal_intrin_sse2(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[])
+{
+	FLAC__int32 last_difference[FLAC__MAX_FIXED_ORDER] = { 0 };
+	__m128i carry0, carry1, carry2, carry3, v;
+	int i = 0, idata_len = (int)data_len;
+
+	FLAC__ASSERT(order <= FLAC__MAX_FIXED_ORDER);
+
+	if(order == 0) {
+		FLAC__fixed_restore_signal(residual, data_len, order, data);
+		return;
+	}
+
+	FLAC__fixed_restore_signal_differences(data, order, last_difference);
+	carry0 = _mm_set1_epi32(last_difference[0]);
+	carry1 = _mm_set1_epi32(last_difference[1]);
+	carry2 = _mm_set1_epi32(last_difference[2]);
+	carry3 = _mm_set1_epi32(last_difference[3]);
+
+	switch(order) {
+		case 1:
+			for(; i <= idata_len - 4; i += 4) {
+				v = _mm_loadu_si128((const __m128i*)(const void*)(residual+i));
+				RUNNING_SUM_SSE2(v, carry0);
+				_mm_storeu_si128((__m128i*)(void*)(data+i), v);
+			}
+			break;
+		case 2:
+			for(; i <= idata_len - 4; i += 4) {
+				v = _mm_loadu_si128((const __m128i*)(const void*)(residual+i));
+				RUNNING_SUM_SSE2(v, carry1);
+				RUNNING_SUM_SSE2(v, carry0);
+				_mm_storeu_si128((__m128i*)(void*)(data+i), v);
+			}
+			break;
+		case 3:
+			for(; i <= idata_len - 4; i += 4) {
+				v = _mm_loadu_si128((const __m128i*)(const void*)(residual+i));
+				RUNNING_SUM_SSE2(v, carry2);
+				RUNNING_SUM_SSE2(v, carry1);
+				RUNNING_SUM_SSE2(v, carry0);
+				_mm_storeu_si128((__m128i*)(void*)(data+i), v);
+			}
+			break;
+		default:
+			for(; i <= idata_len - 4; i += 4) {
+				v = _mm_loadu_si128((const __m128i*)(const void*)(residual+i));
+				RUNNING_SUM_SSE2(v, carry3);
+				RUNNING_SUM_SSE2(v, carry2);
+				RUNNING_SUM_SSE2(v, carry1);
+				RUNNING_SUM_SSE2(v, carry0);
+				_mm_storeu_si128((__m128i*)(void*)(data+i), v);
+			}
+			break;
+	}
+
+	/* the wide version wraps exactly like the vector code above */
+	FLAC__fixed_restore_signal_wide(residual+i, data_len-i, order, data+i);
+}
+
 #endif /* FLAC__SSE2_SUPPORTED */
 #endif /* (FLAC__CPU_IA32 || FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN */
 #endif /* FLAC__NO_ASM */
-#endif /* FLAC__INTEGER_ONLY_LIBRARY */
@@ -45,12 +45,29 @@ typedef struct FLAC__BitReader FLAC__BitReader;
 
 typedef FLAC__bool (*FLAC__BitReaderReadCallback)(FLAC__byte buffer[], size_t *bytes, void *client_data);
 
+/*
+ * lookup table for decoding Rice codes with a small parameter several
+ * codewords at a time, indexed by the next FLAC__BITREADER_RICE_TABLE_BITS
+ * bits of the stream
+ */
+#define FLAC__BITREADER_RICE_TABLE_BITS 10
+#define FLAC__BITREADER_RICE_TABLE_MAX_PARAMETER 2
+#define FLAC__BITREADER_RICE_TABLE_MAX_VALUES 6
+#define FLAC__BITREADER_RICE_TABLE_MIN_VALUES 32 /* shorter partitions are not worth it */
+typedef struct {
+	FLAC__uint8 values; /* # of whole codewords in the bits looked up, 0 if the first one is longer */
+	FLAC__uint8 bits; /* # of bits those codewords take */
+	FLAC__int8 value[FLAC__BITREADER_RICE_TABLE_MAX_VALUES];
+} FLAC__BitReaderRiceTableEntry;
+
 /*
  * construction, deletion, initialization, etc functions
  */
 FLAC__BitReader *FLAC__bitreader_new(void);
 void FLAC__bitreader_delete(FLAC__BitReader *br);
 FLAC__bool FLAC__bitreader_init(FLAC__BitReader *br, FLAC__BitReaderReadCallback rcb, void *cd);
+void FLAC__bitreader_set_cpu_info(FLAC__BitReader *br, const FLAC__CPUInfo *cpuinfo); /* after init, picks the CRC routine for this CPU */
+void FLAC__bitreader_set_source(FLAC__BitReader *br, const FLAC__byte *data, size_t length, size_t *position); /* refill from memory, see bitreader.c */
 void FLAC__bitreader_free(FLAC__BitReader *br); /* does not 'free(br)' */
 FLAC__bool FLAC__bitreader_clear(FLAC__BitReader *br);
 void FLAC__bitreader_set_framesync_location(FLAC__BitReader *br);
@@ -85,9 +102,12 @@ FLAC__bool FLAC__bitreader_read_uint32_little_endian(FLAC__BitReader *br, FLAC__
 FLAC__bool FLAC__bitreader_skip_bits_no_crc(FLAC__BitReader *br, uint32_t bits); /* WATCHOUT: does not CRC the skipped data! */ /*@@@@ add to unit tests */
 FLAC__bool FLAC__bitreader_skip_byte_block_aligned_no_crc(FLAC__BitReader *br, uint32_t nvals); /* WATCHOUT: does not CRC the read data! */
 FLAC__bool FLAC__bitreader_read_byte_block_aligned_no_crc(FLAC__BitReader *br, FLAC__byte *val, uint32_t nvals); /* WATCHOUT: does not CRC the read data! */
+FLAC__bool FLAC__bitreader_skip_to_framesync(FLAC__BitReader *br, uint32_t *bytes_left, FLAC__uint32 *sync); /* reads up to *bytes_left bytes until just past a frame sync code that ends a frame by the CRC-16, *sync gets the second byte */
 FLAC__bool FLAC__bitreader_read_unary_unsigned(FLAC__BitReader *br, uint32_t *val);
 FLAC__bool FLAC__bitreader_read_rice_signed(FLAC__BitReader *br, int *val, uint32_t parameter);
 FLAC__bool FLAC__bitreader_read_rice_signed_block(FLAC__BitReader *br, int vals[], uint32_t nvals, uint32_t parameter);
+void FLAC__bitreader_build_rice_table(FLAC__BitReaderRiceTableEntry table[], uint32_t parameter); /* table has 1 << FLAC__BITREADER_RICE_TABLE_BITS entries */
+FLAC__bool FLAC__bitreader_read_rice_signed_block_table(FLAC__BitReader *br, int vals[], uint32_t nvals, uint32_t parameter, const FLAC__BitReaderRiceTableEntry table[]);
 #ifdef FLAC__BMI2_SUPPORTED
 FLAC__bool FLAC__bitreader_read_rice_signed_block_bmi2(FLAC__BitReader *br, int vals[], uint32_t nvals, uint32_t parameter);
 #endif
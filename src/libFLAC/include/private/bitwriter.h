@@ -35,6 +35,7 @@
 
 #include <stdio.h> /* for FILE */
 #include "FLAC/ordinals.h"
+#include "cpu.h"
 
 /*
  * opaque structure definition
@@ -48,6 +49,7 @@ typedef struct FLAC__BitWriter FLAC__BitWriter;
 FLAC__BitWriter *FLAC__bitwriter_new(void);
 void FLAC__bitwriter_delete(FLAC__BitWriter *bw);
 FLAC__bool FLAC__bitwriter_init(FLAC__BitWriter *bw);
+void FLAC__bitwriter_set_cpu_info(FLAC__BitWriter *bw, const FLAC__CPUInfo *cpuinfo); /* after init, picks the CRC routine for this CPU */
 void FLAC__bitwriter_free(FLAC__BitWriter *bw); /* does not 'free(buffer)' */
 void FLAC__bitwriter_clear(FLAC__BitWriter *bw);
 
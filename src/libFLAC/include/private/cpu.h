@@ -70,6 +70,9 @@
     #define FLAC__SSE4_1_SUPPORTED 1
     #define FLAC__SSE4_2_SUPPORTED 1
   #endif
+  #if (__INTEL_COMPILER >= 1110) /* Intel C++ Compiler 11.1 */
+    #define FLAC__PCLMUL_SUPPORTED 1
+  #endif
   #ifdef FLAC__USE_AVX
     #if (__INTEL_COMPILER >= 1110) /* Intel C++ Compiler 11.1 */
       #define FLAC__AVX_SUPPORTED 1
@@ -86,6 +89,7 @@
   #define FLAC__SSSE3_SUPPORTED 1
   #define FLAC__SSE4_1_SUPPORTED 1
   #define FLAC__SSE4_2_SUPPORTED 1
+  #define FLAC__PCLMUL_SUPPORTED 1
   #ifdef FLAC__USE_AVX
     #define FLAC__AVX_SUPPORTED 1
     #define FLAC__AVX2_SUPPORTED 1
@@ -99,6 +103,7 @@
   #define FLAC__SSSE3_SUPPORTED 1
   #define FLAC__SSE4_1_SUPPORTED 1
   #define FLAC__SSE4_2_SUPPORTED 1
+  #define FLAC__PCLMUL_SUPPORTED 1
   #ifdef FLAC__USE_AVX
     #define FLAC__AVX_SUPPORTED 1
     #define FLAC__AVX2_SUPPORTED 1
@@ -114,6 +119,9 @@
     #define FLAC__SSE4_1_SUPPORTED 1
     #define FLAC__SSE4_2_SUPPORTED 1
   #endif
+  #if (_MSC_VER >= 1600) /* MS Visual Studio 2010 */
+    #define FLAC__PCLMUL_SUPPORTED 1
+  #endif
   #ifdef FLAC__USE_AVX
     #if (_MSC_FULL_VER >= 160040219) /* MS Visual Studio 2010 SP1 */
       #define FLAC__AVX_SUPPORTED 1
@@ -140,6 +148,9 @@
   #ifdef __SSE4_2__
     #define FLAC__SSE4_2_SUPPORTED 1
   #endif
+  #if defined __PCLMUL__ && defined __SSSE3__
+    #define FLAC__PCLMUL_SUPPORTED 1
+  #endif
   #ifdef FLAC__USE_AVX
     #ifdef __AVX__
       #define FLAC__AVX_SUPPORTED 1
@@ -154,6 +165,16 @@
 #endif /* compiler version */
 #endif /* intrinsics support */
 
+/* For intrinsics routines that are called with constant arguments, so that
+ * the compiler makes a version specialized for them at every call */
+#if defined _MSC_VER
+  #define FLAC__ALWAYS_INLINE __forceinline
+#elif defined __GNUC__
+  #define FLAC__ALWAYS_INLINE inline __attribute__ ((__always_inline__))
+#else
+  #define FLAC__ALWAYS_INLINE inline
+#endif
+
 
 #ifndef FLAC__AVX_SUPPORTED
 #define FLAC__AVX_SUPPORTED 0
@@ -177,6 +198,7 @@ typedef struct {
 	FLAC__bool ssse3;
 	FLAC__bool sse41;
 	FLAC__bool sse42;
+	FLAC__bool pclmul;
 	FLAC__bool avx;
 	FLAC__bool avx2;
 	FLAC__bool fma;
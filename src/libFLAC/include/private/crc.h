@@ -34,6 +34,7 @@
 #define FLAC__PRIVATE__CRC_H
 
 #include "FLAC/ordinals.h"
+#include "private/cpu.h"
 
 /* 8 bit CRC generator, MSB shifted first
 ** polynomial = x^8 + x^2 + x^1 + x^0
@@ -45,7 +46,7 @@ FLAC__uint8 FLAC__crc8(const FLAC__byte *data, uint32_t len);
 ** polynomial = x^16 + x^15 + x^2 + x^0
 ** init = 0
 */
-extern FLAC__uint16 const FLAC__crc16_table[8][256];
+extern FLAC__uint16 const FLAC__crc16_table[16][256];
 
 #define FLAC__CRC16_UPDATE(data, crc) ((((crc)<<8) & 0xffff) ^ FLAC__crc16_table[0][((crc)>>8) ^ (data)])
 /* this alternate may be faster on some systems/compilers */
@@ -57,4 +58,14 @@ FLAC__uint16 FLAC__crc16(const FLAC__byte *data, uint32_t len);
 FLAC__uint16 FLAC__crc16_update_words32(const FLAC__uint32 *words, uint32_t len, FLAC__uint16 crc);
 FLAC__uint16 FLAC__crc16_update_words64(const FLAC__uint64 *words, uint32_t len, FLAC__uint16 crc);
 
+#ifndef FLAC__NO_ASM
+#if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
+#ifdef FLAC__PCLMUL_SUPPORTED
+FLAC__uint16 FLAC__crc16_intrin_pclmul(const FLAC__byte *data, uint32_t len);
+FLAC__uint16 FLAC__crc16_update_words32_intrin_pclmul(const FLAC__uint32 *words, uint32_t len, FLAC__uint16 crc);
+FLAC__uint16 FLAC__crc16_update_words64_intrin_pclmul(const FLAC__uint64 *words, uint32_t len, FLAC__uint16 crc);
+#endif
+#endif
+#endif
+
 #endif
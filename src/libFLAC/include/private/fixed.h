@@ -114,4 +114,27 @@ void FLAC__fixed_restore_signal(const FLAC__int32 residual[], uint32_t data_len,
 void FLAC__fixed_restore_signal_wide(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[]);
 void FLAC__fixed_restore_signal_wide_33bit(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int64 data[]);
 
+/*
+ *	FLAC__fixed_restore_signal_differences()
+ *	--------------------------------------------------------------------
+ *	Compute the differences of the historical samples that the vector
+ *	versions of FLAC__fixed_restore_signal() start their running sums
+ *	from. Differences are taken modulo 2^32.
+ *
+ *	IN data[-order,-1]                previously-reconstructed historical samples
+ *	IN order <= FLAC__MAX_FIXED_ORDER fixed-predictor order
+ *	OUT last_difference[0,order-1]    i-th difference of data[-1]
+ */
+void FLAC__fixed_restore_signal_differences(const FLAC__int32 data[], uint32_t order, FLAC__int32 last_difference[]);
+#ifndef FLAC__NO_ASM
+#  if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
+#    ifdef FLAC__SSE2_SUPPORTED
+void FLAC__fixed_restore_signal_intrin_sse2(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[]);
+#    endif
+#    ifdef FLAC__AVX2_SUPPORTED
+void FLAC__fixed_restore_signal_intrin_avx2(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[]);
+#    endif
+#  endif
+#endif
+
 #endif
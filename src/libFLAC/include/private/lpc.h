@@ -94,6 +94,33 @@ void FLAC__lpc_compute_autocorrelation_intrin_neon_lag_14(const FLAC__real data[
 #endif
 #endif /* FLAC__NO_ASM */
 
+#define FLAC__MAX_LPC_WINDOWS (8u)
+
+/*
+ *	FLAC__lpc_compute_autocorrelation_windowed()
+ *	--------------------------------------------------------------------
+ *	Applies each window to its own input and computes the autocorrelation
+ *	of the result, a chunk at a time, without storing the windowed data.
+ *	The results are identical to those of FLAC__lpc_window_data()
+ *	followed by FLAC__lpc_compute_autocorrelation(), which makes it a
+ *	drop-in replacement where that is the autocorrelation routine used.
+ *
+ *	IN in[0,num_windows-1][0,data_len-1]
+ *	IN window[0,num_windows-1][0,data_len-1]
+ *	IN 0 < num_windows <= FLAC__MAX_LPC_WINDOWS
+ *	IN data_len
+ *	IN 0 < lag <= data_len
+ *	OUT autoc[0,num_windows-1][0,lag-1]
+ */
+void FLAC__lpc_compute_autocorrelation_windowed(const FLAC__int32 * const in[], const FLAC__real * const window[], uint32_t num_windows, uint32_t data_len, uint32_t lag, double autoc[][FLAC__MAX_LPC_ORDER+1]);
+#ifndef FLAC__NO_ASM
+#  if defined FLAC__CPU_X86_64 && FLAC__HAS_X86INTRIN
+#    ifdef FLAC__FMA_SUPPORTED
+void FLAC__lpc_compute_autocorrelation_windowed_intrin_fma(const FLAC__int32 * const in[], const FLAC__real * const window[], uint32_t num_windows, uint32_t data_len, uint32_t lag, double autoc[][FLAC__MAX_LPC_ORDER+1]);
+#    endif
+#  endif
+#endif /* FLAC__NO_ASM */
+
 /*
  *	FLAC__lpc_compute_lp_coefficients()
  *	--------------------------------------------------------------------
@@ -203,6 +230,18 @@ uint32_t FLAC__lpc_max_residual_bps(uint32_t subframe_bps, const FLAC__int32 qlp
 void FLAC__lpc_restore_signal(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[]);
 void FLAC__lpc_restore_signal_wide(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[]);
 void FLAC__lpc_restore_signal_wide_33bit(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int64 data[]);
+#ifndef FLAC__NO_ASM
+#  if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
+#    ifdef FLAC__SSE4_1_SUPPORTED
+void FLAC__lpc_restore_signal_intrin_sse41(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[]);
+void FLAC__lpc_restore_signal_wide_intrin_sse41(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[]);
+#    endif
+#    ifdef FLAC__AVX2_SUPPORTED
+void FLAC__lpc_restore_signal_intrin_avx2(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[]);
+void FLAC__lpc_restore_signal_wide_intrin_avx2(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[]);
+#    endif
+#  endif
+#endif
 
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
 
@@ -234,6 +273,24 @@ double FLAC__lpc_compute_expected_bits_per_residual_sample_with_error_scale(doub
  */
 uint32_t FLAC__lpc_compute_best_order(const double lpc_error[], uint32_t max_order, uint32_t total_samples, uint32_t overhead_bits_per_order);
 
+/*
+ *	FLAC__lpc_compute_expected_bits_per_order()
+ *	--------------------------------------------------------------------
+ *	Like FLAC__lpc_compute_best_order(), but also store the expected
+ *	number of bits of the residual plus overhead for every order, so
+ *	orders that are unlikely to win can be skipped without computing
+ *	their residual.
+ *
+ *	IN lpc_error[0,max_order-1] >= 0.0  error returned from calculating LP coefficients
+ *	IN max_order > 0                    max LP order
+ *	IN total_samples > 0                # of samples in residual signal
+ *	IN overhead_bits_per_order          # of bits overhead for each increased LP order
+ *	                                    (includes warmup sample size and quantized LP coefficient)
+ *	OUT expected_bits[0,max_order-1]    expected bits for each order (index is order-1)
+ *	RETURN [1,max_order]                best order
+ */
+uint32_t FLAC__lpc_compute_expected_bits_per_order(const double lpc_error[], uint32_t max_order, uint32_t total_samples, uint32_t overhead_bits_per_order, double expected_bits[]);
+
 #endif /* !defined FLAC__INTEGER_ONLY_LIBRARY */
 
 #endif
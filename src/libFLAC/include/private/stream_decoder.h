@@ -0,0 +1,67 @@
+/* libFLAC - Free Lossless Audio Codec library
+ * Copyright (C) 2025  Xiph.Org Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FLAC__PRIVATE__STREAM_DECODER_H
+#define FLAC__PRIVATE__STREAM_DECODER_H
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "FLAC/format.h"
+#include "FLAC/stream_decoder.h"
+
+/*
+ * Makes a decoder just initialized with FLAC__stream_decoder_init_stream()
+ * take what it reads as bare frames of a stream with the given STREAMINFO,
+ * with no metadata before them.  This is how the threadtasks of
+ * multithreaded decoding and the per-frame verification of multithreaded
+ * encoding use their private decoders; flushing the decoder before each
+ * frame lets it take the frames in any order.
+ */
+extern void FLAC__stream_decoder_set_stream_info(FLAC__StreamDecoder *decoder, const FLAC__StreamMetadata_StreamInfo *stream_info);
+
+#if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && defined FLAC__HAS_X86INTRIN
+#include "private/cpu.h"
+
+#ifdef FLAC__SSSE3_SUPPORTED
+/*
+ * Undoes the channel coding of a stereo frame and packs both channels
+ * interleaved into out, in the given format.  blocksize must be a
+ * multiple of 8.  Returns false if any decoded sample does not fit in
+ * bps bits.
+ */
+extern FLAC__bool FLAC__pack_interleaved_stereo_intrin_ssse3(const FLAC__int32 * const buffer[], FLAC__ChannelAssignment channel_assignment,
+			uint32_t blocksize, uint32_t bps, FLAC__StreamDecoderPCMFormat format, FLAC__byte out[]);
+#endif
+
+#endif
+
+#endif
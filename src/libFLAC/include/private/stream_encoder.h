@@ -67,6 +67,10 @@ extern void FLAC__precompute_partition_info_sums_intrin_ssse3(const FLAC__int32
 #ifdef FLAC__AVX2_SUPPORTED
 extern void FLAC__precompute_partition_info_sums_intrin_avx2(const FLAC__int32 residual[], FLAC__uint64 abs_residual_partition_sums[],
 			uint32_t residual_samples, uint32_t predictor_order, uint32_t min_partition_order, uint32_t max_partition_order, uint32_t bps);
+/* estimates the Rice parameters like set_partitioned_rice_() in stream_encoder.c, without its compile-time parameter search and escape codes */
+extern FLAC__bool FLAC__set_partitioned_rice_intrin_avx2(const FLAC__uint64 abs_residual_partition_sums[], const uint32_t raw_bits_per_partition[],
+			uint32_t residual_samples, uint32_t predictor_order, uint32_t rice_parameter_limit, uint32_t rice_parameter_search_dist, uint32_t partition_order,
+			FLAC__bool search_for_escapes, FLAC__EntropyCodingMethod_PartitionedRiceContents *partitioned_rice_contents, uint32_t *bits);
 #endif
 
 #endif
@@ -0,0 +1,91 @@
+/* libFLAC - Free Lossless Audio Codec library
+ * Copyright (C) 2025  Xiph.Org Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef FLAC__PRIVATE__THREAD_POOL_H
+#define FLAC__PRIVATE__THREAD_POOL_H
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "share/compat_threads.h"
+#include "FLAC/thread_pool.h"
+
+#ifdef FLAC__USE_THREADS
+
+typedef void (*FLAC__ThreadPoolJob)(void *data);
+
+/*
+ * An encoder or decoder attached to a pool.  Jobs of a client are not
+ * queued individually; the client only counts how many times its job
+ * function has to be run.  The job function finds the work to do
+ * itself, and returns right away when the calling thread already did
+ * it.  All fields are owned by the pool while attached.
+ */
+typedef struct FLAC__ThreadPoolClient {
+	FLAC__ThreadPool *pool;
+	struct FLAC__ThreadPoolClient *prev, *next; /* ring of attached clients */
+	FLAC__ThreadPoolJob job;
+	void *data;
+	uint32_t max_running; /* no more than this many threads of the pool run job at once */
+	uint32_t max_pending;
+	uint32_t num_pending;
+	uint32_t num_running;
+} FLAC__ThreadPoolClient;
+
+/*
+ *	FLAC__thread_pool_attach()
+ *	--------------------------------------------------------------------
+ *	Makes the pool serve a client.  Submitting more than max_pending
+ *	jobs that are not yet running has no further effect.
+ */
+void FLAC__thread_pool_attach(FLAC__ThreadPool *pool, FLAC__ThreadPoolClient *client, FLAC__ThreadPoolJob job, void *data, uint32_t max_running, uint32_t max_pending);
+
+/*
+ *	FLAC__thread_pool_submit()
+ *	--------------------------------------------------------------------
+ *	Has a thread of the pool run the job of the client once more.
+ */
+void FLAC__thread_pool_submit(FLAC__ThreadPoolClient *client);
+
+/*
+ *	FLAC__thread_pool_detach()
+ *	--------------------------------------------------------------------
+ *	Drops the jobs of the client that are not running yet, waits for
+ *	the running ones to return and stops serving the client.  Does
+ *	nothing when the client is not attached.
+ */
+void FLAC__thread_pool_detach(FLAC__ThreadPoolClient *client);
+
+#endif
+
+#endif
@@ -42,6 +42,48 @@
 
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
 
+typedef enum {
+	FLAC__APODIZATION_BARTLETT,
+	FLAC__APODIZATION_BARTLETT_HANN,
+	FLAC__APODIZATION_BLACKMAN,
+	FLAC__APODIZATION_BLACKMAN_HARRIS_4TERM_92DB_SIDELOBE,
+	FLAC__APODIZATION_CONNES,
+	FLAC__APODIZATION_FLATTOP,
+	FLAC__APODIZATION_GAUSS,
+	FLAC__APODIZATION_HAMMING,
+	FLAC__APODIZATION_HANN,
+	FLAC__APODIZATION_KAISER_BESSEL,
+	FLAC__APODIZATION_NUTTALL,
+	FLAC__APODIZATION_RECTANGLE,
+	FLAC__APODIZATION_TRIANGLE,
+	FLAC__APODIZATION_TUKEY,
+	FLAC__APODIZATION_PARTIAL_TUKEY,
+	FLAC__APODIZATION_PUNCHOUT_TUKEY,
+	FLAC__APODIZATION_SUBDIVIDE_TUKEY,
+	FLAC__APODIZATION_WELCH
+} FLAC__ApodizationFunction;
+
+typedef struct {
+	FLAC__ApodizationFunction type;
+	union {
+		struct {
+			FLAC__real stddev;
+		} gauss;
+		struct {
+			FLAC__real p;
+		} tukey;
+		struct {
+			FLAC__real p;
+			FLAC__real start;
+			FLAC__real end;
+		} multiple_tukey;
+		struct {
+			FLAC__real p;
+			FLAC__int32 parts;
+		} subdivide_tukey;
+	} parameters;
+} FLAC__ApodizationSpecification;
+
 /*
  *	FLAC__window_*()
  *	--------------------------------------------------------------------
@@ -69,6 +111,22 @@ void FLAC__window_partial_tukey(FLAC__real *window, const FLAC__int32 L, const F
 void FLAC__window_punchout_tukey(FLAC__real *window, const FLAC__int32 L, const FLAC__real p, const FLAC__real start, const FLAC__real end);
 void FLAC__window_welch(FLAC__real *window, const FLAC__int32 L);
 
+/*
+ *	FLAC__window_cache_acquire()
+ *	--------------------------------------------------------------------
+ *	Returns the window of L points for the given apodization function,
+ *	shared by all encoders in the process. The window is calculated on
+ *	first use and must not be written to. Every window acquired must be
+ *	given back with FLAC__window_cache_release(). Returns 0 if memory
+ *	could not be allocated.
+ *
+ *	IN apodization (SUBDIVIDE_TUKEY gets the tukey window of its p)
+ *	IN L (number of points in window)
+ */
+const FLAC__real *FLAC__window_cache_acquire(const FLAC__ApodizationSpecification *apodization, uint32_t L);
+void FLAC__window_cache_release(const FLAC__real *window);
+void FLAC__window_cache_get_statistics(FLAC__uint64 *hits, FLAC__uint64 *misses);
+
 #endif /* !defined FLAC__INTEGER_ONLY_LIBRARY */
 
 #endif
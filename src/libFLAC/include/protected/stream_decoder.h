@@ -38,6 +38,12 @@
 #include "private/ogg_decoder_aspect.h"
 #endif
 
+#ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+#define FLAC__STREAM_DECODER_MAX_THREADS 16
+#else
+#define FLAC__STREAM_DECODER_MAX_THREADS 64
+#endif
+
 typedef struct FLAC__StreamDecoderProtected {
 	FLAC__StreamDecoderState state;
 	FLAC__StreamDecoderInitStatus initstate;
@@ -47,6 +53,9 @@ typedef struct FLAC__StreamDecoderProtected {
 	uint32_t sample_rate; /* in Hz */
 	uint32_t blocksize; /* in samples (per channel) */
 	FLAC__bool md5_checking; /* if true, generate MD5 signature of decoded data and compare against signature in the STREAMINFO metadata block */
+	uint32_t num_threads;
+	FLAC__ThreadPool *thread_pool;
+	FLAC__bool fused_lpc_restore; /* if true, LPC subframes are restored one residual partition at a time; off by default, only the tests and flacbench turn it on */
 #if FLAC__HAS_OGG
 	FLAC__OggDecoderAspect ogg_decoder_aspect;
 #endif
@@ -40,52 +40,10 @@
 
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
 
-#include "private/float.h"
+#include "private/window.h"
 
 #define FLAC__MAX_APODIZATION_FUNCTIONS 32
 
-typedef enum {
-	FLAC__APODIZATION_BARTLETT,
-	FLAC__APODIZATION_BARTLETT_HANN,
-	FLAC__APODIZATION_BLACKMAN,
-	FLAC__APODIZATION_BLACKMAN_HARRIS_4TERM_92DB_SIDELOBE,
-	FLAC__APODIZATION_CONNES,
-	FLAC__APODIZATION_FLATTOP,
-	FLAC__APODIZATION_GAUSS,
-	FLAC__APODIZATION_HAMMING,
-	FLAC__APODIZATION_HANN,
-	FLAC__APODIZATION_KAISER_BESSEL,
-	FLAC__APODIZATION_NUTTALL,
-	FLAC__APODIZATION_RECTANGLE,
-	FLAC__APODIZATION_TRIANGLE,
-	FLAC__APODIZATION_TUKEY,
-	FLAC__APODIZATION_PARTIAL_TUKEY,
-	FLAC__APODIZATION_PUNCHOUT_TUKEY,
-	FLAC__APODIZATION_SUBDIVIDE_TUKEY,
-	FLAC__APODIZATION_WELCH
-} FLAC__ApodizationFunction;
-
-typedef struct {
-	FLAC__ApodizationFunction type;
-	union {
-		struct {
-			FLAC__real stddev;
-		} gauss;
-		struct {
-			FLAC__real p;
-		} tukey;
-		struct {
-			FLAC__real p;
-			FLAC__real start;
-			FLAC__real end;
-		} multiple_tukey;
-		struct {
-			FLAC__real p;
-			FLAC__int32 parts;
-		} subdivide_tukey;
-	} parameters;
-} FLAC__ApodizationSpecification;
-
 #endif // #ifndef FLAC__INTEGER_ONLY_LIBRARY
 
 typedef struct FLAC__StreamEncoderProtected {
@@ -102,11 +60,13 @@ typedef struct FLAC__StreamEncoderProtected {
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
 	uint32_t num_apodizations;
 	FLAC__ApodizationSpecification apodizations[FLAC__MAX_APODIZATION_FUNCTIONS];
+	FLAC__bool fused_window_autocorrelation; /* if true, windows are applied inside the autocorrelation routine, several at a time; chosen at init depending on the CPU */
 #endif
 	uint32_t max_lpc_order;
 	uint32_t qlp_coeff_precision;
 	FLAC__bool do_qlp_coeff_prec_search;
 	FLAC__bool do_exhaustive_model_search;
+	FLAC__bool prune_lpc_orders; /* if true, the exhaustive model search skips LPC orders whose expected size is clearly larger than that of the best guess */
 	FLAC__bool do_escape_coding;
 	uint32_t min_residual_partition_order;
 	uint32_t max_residual_partition_order;
@@ -116,6 +76,8 @@ typedef struct FLAC__StreamEncoderProtected {
 	FLAC__StreamMetadata **metadata;
 	uint32_t num_metadata_blocks;
 	uint32_t num_threads;
+	FLAC__bool intra_frame_threading;
+	FLAC__ThreadPool *thread_pool;
 	FLAC__uint64 streaminfo_offset, seektable_offset, audio_offset;
 #if FLAC__HAS_OGG
 	FLAC__OggEncoderAspect ogg_encoder_aspect;
@@ -36,6 +36,7 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "FLAC/assert.h"
 #include "FLAC/format.h"
@@ -173,6 +174,35 @@ void FLAC__lpc_compute_autocorrelation(const FLAC__real data[], uint32_t data_le
 
 }
 
+void FLAC__lpc_compute_autocorrelation_windowed(const FLAC__int32 * const in[], const FLAC__real * const window[], uint32_t num_windows, uint32_t data_len, uint32_t lag, double autoc[][FLAC__MAX_LPC_ORDER+1])
+{
+	FLAC__ASSERT(lag > 0);
+	FLAC__ASSERT(lag <= data_len);
+
+	#undef CHUNK
+	#define CHUNK 256u
+	if(lag <= 8) {
+		#undef MAX_LAG
+		#define MAX_LAG 8
+		#include "deduplication/lpc_compute_autocorrelation_windowed.c"
+	}
+	else if(lag <= 12) {
+		#undef MAX_LAG
+		#define MAX_LAG 12
+		#include "deduplication/lpc_compute_autocorrelation_windowed.c"
+	}
+	else if(lag <= 16) {
+		#undef MAX_LAG
+		#define MAX_LAG 16
+		#include "deduplication/lpc_compute_autocorrelation_windowed.c"
+	}
+	else {
+		#undef MAX_LAG
+		#define MAX_LAG (FLAC__MAX_LPC_ORDER+1)
+		#include "deduplication/lpc_compute_autocorrelation_windowed.c"
+	}
+}
+
 void FLAC__lpc_compute_lp_coefficients(const double autoc[], uint32_t *max_order, FLAC__real lp_coeff[][FLAC__MAX_LPC_ORDER], double error[])
 {
 	uint32_t i, j;
@@ -1605,10 +1635,10 @@ double FLAC__lpc_compute_expected_bits_per_residual_sample_with_error_scale(doub
 	}
 }
 
-uint32_t FLAC__lpc_compute_best_order(const double lpc_error[], uint32_t max_order, uint32_t total_samples, uint32_t overhead_bits_per_order)
+uint32_t FLAC__lpc_compute_expected_bits_per_order(const double lpc_error[], uint32_t max_order, uint32_t total_samples, uint32_t overhead_bits_per_order, double expected_bits[])
 {
 	uint32_t order, indx, best_index; /* 'index' the index into lpc_error; index==order-1 since lpc_error[0] is for order==1, lpc_error[1] is for order==2, etc */
-	double bits, best_bits, error_scale;
+	double best_bits, error_scale;
 
 	FLAC__ASSERT(max_order > 0);
 	FLAC__ASSERT(total_samples > 0);
@@ -1619,14 +1649,23 @@ uint32_t FLAC__lpc_compute_best_order(const double lpc_error[], uint32_t max_ord
 	best_bits = (uint32_t)(-1);
 
 	for(indx = 0, order = 1; indx < max_order; indx++, order++) {
-		bits = FLAC__lpc_compute_expected_bits_per_residual_sample_with_error_scale(lpc_error[indx], error_scale) * (double)(total_samples - order) + (double)(order * overhead_bits_per_order);
-		if(bits < best_bits) {
+		expected_bits[indx] = FLAC__lpc_compute_expected_bits_per_residual_sample_with_error_scale(lpc_error[indx], error_scale) * (double)(total_samples - order) + (double)(order * overhead_bits_per_order);
+		if(expected_bits[indx] < best_bits) {
 			best_index = indx;
-			best_bits = bits;
+			best_bits = expected_bits[indx];
 		}
 	}
 
 	return best_index+1; /* +1 since indx of lpc_error[] is order-1 */
 }
 
+uint32_t FLAC__lpc_compute_best_order(const double lpc_error[], uint32_t max_order, uint32_t total_samples, uint32_t overhead_bits_per_order)
+{
+	double expected_bits[FLAC__MAX_LPC_ORDER];
+
+	FLAC__ASSERT(max_order <= FLAC__MAX_LPC_ORDER);
+
+	return FLAC__lpc_compute_expected_bits_per_order(lpc_error, max_order, total_samples, overhead_bits_per_order, expected_bits);
+}
+
 #endif /* !defined FLAC__INTEGER_ONLY_LIBRARY */
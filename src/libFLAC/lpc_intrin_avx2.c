@@ -36,17 +36,19 @@
 
 #include "private/cpu.h"
 
-#ifndef FLAC__INTEGER_ONLY_LIBRARY
 #ifndef FLAC__NO_ASM
 #if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
 #include "private/lpc.h"
 #ifdef FLAC__AVX2_SUPPORTED
 
+#include <string.h> /* for memcpy() */
 #include "FLAC/assert.h"
 #include "FLAC/format.h"
 
 #include <immintrin.h> /* AVX2 */
 
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+
 FLAC__SSE_TARGET("avx2")
 void FLAC__lpc_compute_residual_from_qlp_coefficients_16_intrin_avx2(const FLAC__int32 *data, uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 residual[])
 {
@@ -1116,7 +1118,159 @@ void FLAC__lpc_compute_residual_from_qlp_coefficients_wide_intrin_avx2(const FLA
 	_mm256_zeroupper();
 }
 
+#endif /* !defined FLAC__INTEGER_ONLY_LIBRARY */
+
+/* Every restored sample depends on the one before it, so rather than the
+ * prediction of one sample, the predictions of 8 samples in a row are
+ * vectorized, as far as they depend on samples before those 8. What the
+ * samples within the block add to each other's prediction is then done
+ * one sample at a time with scalar code.
+ *
+ * These routines are always inlined, so that for the common orders 8, 12
+ * and 32, which are passed as constants, the compiler makes versions with
+ * fixed loop counts over the coefficients, unrolled where they are short.
+ */
+#if defined(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION) && !defined(FUZZING_BUILD_MODE_FLAC_SANITIZE_SIGNED_INTEGER_OVERFLOW)
+/* see FLAC__lpc_restore_signal() */
+__attribute__((no_sanitize("signed-integer-overflow")))
+#endif
+FLAC__SSE_TARGET("avx2")
+static FLAC__ALWAYS_INLINE void restore_signal_avx2_(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], const uint32_t order, int lp_quantization, FLAC__int32 data[])
+{
+	int i;
+	uint32_t j;
+	FLAC__int32 q[32+8] = { 0 }, s[8], sum;
+	FLAC__int32 d0, d1, d2, d3, d4, d5, d6, d7;
+	__m256i coeff[32], sum8;
+
+	/* lane t of coeff[j] is the coefficient of data[i-1-j] in the prediction of data[i+t] */
+	memcpy(q, qlp_coeff, sizeof(FLAC__int32) * order);
+	for(j = 0; j < order; j++)
+		coeff[j] = _mm256_loadu_si256((const __m256i*)(const void*)(q+j));
+
+	for(i = 0; i < (int)data_len-7; i+=8) {
+		/* oldest samples first, the most recent one is the last to be known */
+		sum8 = _mm256_mullo_epi32(coeff[order-1], _mm256_set1_epi32(data[i-(int)order]));
+		for(j = order-1; j > 0; j--)
+			sum8 = _mm256_add_epi32(sum8, _mm256_mullo_epi32(coeff[j-1], _mm256_set1_epi32(data[i-(int)j])));
+		_mm256_storeu_si256((__m256i*)(void*)s, sum8);
+
+		d0 = residual[i  ] + ( s[0] >> lp_quantization);
+		d1 = residual[i+1] + ((s[1] + q[0]*d0) >> lp_quantization);
+		d2 = residual[i+2] + ((s[2] + q[1]*d0 + q[0]*d1) >> lp_quantization);
+		d3 = residual[i+3] + ((s[3] + q[2]*d0 + q[1]*d1 + q[0]*d2) >> lp_quantization);
+		d4 = residual[i+4] + ((s[4] + q[3]*d0 + q[2]*d1 + q[1]*d2 + q[0]*d3) >> lp_quantization);
+		d5 = residual[i+5] + ((s[5] + q[4]*d0 + q[3]*d1 + q[2]*d2 + q[1]*d3 + q[0]*d4) >> lp_quantization);
+		d6 = residual[i+6] + ((s[6] + q[5]*d0 + q[4]*d1 + q[3]*d2 + q[2]*d3 + q[1]*d4 + q[0]*d5) >> lp_quantization);
+		d7 = residual[i+7] + ((s[7] + q[6]*d0 + q[5]*d1 + q[4]*d2 + q[3]*d3 + q[2]*d4 + q[1]*d5 + q[0]*d6) >> lp_quantization);
+		data[i  ] = d0;
+		data[i+1] = d1;
+		data[i+2] = d2;
+		data[i+3] = d3;
+		data[i+4] = d4;
+		data[i+5] = d5;
+		data[i+6] = d6;
+		data[i+7] = d7;
+	}
+	for(; i < (int)data_len; i++) {
+		sum = 0;
+		for(j = 0; j < order; j++)
+			sum += q[j] * data[i-(int)j-1];
+		data[i] = residual[i] + (sum >> lp_quantization);
+	}
+}
+
+FLAC__SSE_TARGET("avx2")
+static FLAC__ALWAYS_INLINE void restore_signal_wide_avx2_(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], const uint32_t order, int lp_quantization, FLAC__int32 data[])
+{
+	int i;
+	uint32_t j;
+	FLAC__int32 q[32+8] = { 0 };
+	FLAC__int64 s[8], sum;
+	FLAC__int64 d0, d1, d2, d3, d4, d5, d6;
+	__m256i coeff_lo[32], coeff_hi[32], sum_lo, sum_hi, d;
+
+	/* as above, with lanes 0-3 in coeff_lo and 4-7 in coeff_hi, sign-extended
+	 * because _mm256_mul_epi32() takes the low 32 bits of each 64-bit lane */
+	memcpy(q, qlp_coeff, sizeof(FLAC__int32) * order);
+	for(j = 0; j < order; j++) {
+		coeff_lo[j] = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(const void*)(q+j)));
+		coeff_hi[j] = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(const void*)(q+j+4)));
+	}
+
+	for(i = 0; i < (int)data_len-7; i+=8) {
+		d = _mm256_set1_epi32(data[i-(int)order]);
+		sum_lo = _mm256_mul_epi32(coeff_lo[order-1], d);
+		sum_hi = _mm256_mul_epi32(coeff_hi[order-1], d);
+		for(j = order-1; j > 0; j--) {
+			d = _mm256_set1_epi32(data[i-(int)j]);
+			sum_lo = _mm256_add_epi64(sum_lo, _mm256_mul_epi32(coeff_lo[j-1], d));
+			sum_hi = _mm256_add_epi64(sum_hi, _mm256_mul_epi32(coeff_hi[j-1], d));
+		}
+		_mm256_storeu_si256((__m256i*)(void*)s, sum_lo);
+		_mm256_storeu_si256((__m256i*)(void*)(s+4), sum_hi);
+
+		d0 = data[i  ] = (FLAC__int32)(residual[i  ] + ( s[0] >> lp_quantization));
+		d1 = data[i+1] = (FLAC__int32)(residual[i+1] + ((s[1] + q[0]*d0) >> lp_quantization));
+		d2 = data[i+2] = (FLAC__int32)(residual[i+2] + ((s[2] + q[1]*d0 + q[0]*d1) >> lp_quantization));
+		d3 = data[i+3] = (FLAC__int32)(residual[i+3] + ((s[3] + q[2]*d0 + q[1]*d1 + q[0]*d2) >> lp_quantization));
+		d4 = data[i+4] = (FLAC__int32)(residual[i+4] + ((s[4] + q[3]*d0 + q[2]*d1 + q[1]*d2 + q[0]*d3) >> lp_quantization));
+		d5 = data[i+5] = (FLAC__int32)(residual[i+5] + ((s[5] + q[4]*d0 + q[3]*d1 + q[2]*d2 + q[1]*d3 + q[0]*d4) >> lp_quantization));
+		d6 = data[i+6] = (FLAC__int32)(residual[i+6] + ((s[6] + q[5]*d0 + q[4]*d1 + q[3]*d2 + q[2]*d3 + q[1]*d4 + q[0]*d5) >> lp_quantization));
+		data[i+7] = (FLAC__int32)(residual[i+7] + ((s[7] + q[6]*d0 + q[5]*d1 + q[4]*d2 + q[3]*d3 + q[2]*d4 + q[1]*d5 + q[0]*d6) >> lp_quantization));
+	}
+	for(; i < (int)data_len; i++) {
+		sum = 0;
+		for(j = 0; j < order; j++)
+			sum += q[j] * (FLAC__int64)data[i-(int)j-1];
+		data[i] = (FLAC__int32)(residual[i] + (sum >> lp_quantization));
+	}
+}
+
+#if defined(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION) && !defined(FUZZING_BUILD_MODE_FLAC_SANITIZE_SIGNED_INTEGER_OVERFLOW)
+/* see FLAC__lpc_restore_signal() */
+__attribute__((no_sanitize("signed-integer-overflow")))
+#endif
+FLAC__SSE_TARGET("avx2")
+void FLAC__lpc_restore_signal_intrin_avx2(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[])
+{
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+
+	/* below order 8 the scalar code is just as fast, it is bound by the
+	 * dependency of each sample on the previous one as well */
+	if(order < 8)
+		FLAC__lpc_restore_signal(residual, data_len, qlp_coeff, order, lp_quantization, data);
+	else if(order == 8)
+		restore_signal_avx2_(residual, data_len, qlp_coeff, 8, lp_quantization, data);
+	else if(order == 12)
+		restore_signal_avx2_(residual, data_len, qlp_coeff, 12, lp_quantization, data);
+	else if(order == 32)
+		restore_signal_avx2_(residual, data_len, qlp_coeff, 32, lp_quantization, data);
+	else
+		restore_signal_avx2_(residual, data_len, qlp_coeff, order, lp_quantization, data);
+	_mm256_zeroupper();
+}
+
+FLAC__SSE_TARGET("avx2")
+void FLAC__lpc_restore_signal_wide_intrin_avx2(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[])
+{
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+
+	if(order < 8)
+		FLAC__lpc_restore_signal_wide(residual, data_len, qlp_coeff, order, lp_quantization, data);
+	else if(order == 8)
+		restore_signal_wide_avx2_(residual, data_len, qlp_coeff, 8, lp_quantization, data);
+	else if(order == 12)
+		restore_signal_wide_avx2_(residual, data_len, qlp_coeff, 12, lp_quantization, data);
+	else if(order == 32)
+		restore_signal_wide_avx2_(residual, data_len, qlp_coeff, 32, lp_quantization, data);
+	else
+		restore_signal_wide_avx2_(residual, data_len, qlp_coeff, order, lp_quantization, data);
+	_mm256_zeroupper();
+}
+
 #endif /* FLAC__AVX2_SUPPORTED */
 #endif /* (FLAC__CPU_IA32 || FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN */
 #endif /* FLAC__NO_ASM */
-#endif /* FLAC__INTEGER_ONLY_LIBRARY */
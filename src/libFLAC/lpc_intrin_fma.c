@@ -41,7 +41,10 @@
 #include "private/lpc.h"
 #ifdef FLAC__FMA_SUPPORTED
 
+#include <immintrin.h> /* AVX, FMA */
+#include <string.h>
 #include "FLAC/assert.h"
+#include "private/macros.h"
 
 FLAC__SSE_TARGET("fma")
 void FLAC__lpc_compute_autocorrelation_intrin_fma_lag_8(const FLAC__real data[], uint32_t data_len, uint32_t lag, double autoc[])
@@ -67,6 +70,38 @@ void FLAC__lpc_compute_autocorrelation_intrin_fma_lag_16(const FLAC__real data[]
 
 }
 
+FLAC__SSE_TARGET("fma")
+void FLAC__lpc_compute_autocorrelation_windowed_intrin_fma(const FLAC__int32 * const in[], const FLAC__real * const window[], uint32_t num_windows, uint32_t data_len, uint32_t lag, double autoc[][FLAC__MAX_LPC_ORDER+1])
+{
+#undef CHUNK
+#define CHUNK 256u
+	if(lag <= 8) {
+#undef NUM_VECTORS
+#define NUM_VECTORS 2
+#include "deduplication/lpc_compute_autocorrelation_windowed_intrin_fma.c"
+	}
+	else if(lag <= 12) {
+#undef NUM_VECTORS
+#define NUM_VECTORS 3
+#include "deduplication/lpc_compute_autocorrelation_windowed_intrin_fma.c"
+	}
+	else if(lag <= 16) {
+#undef NUM_VECTORS
+#define NUM_VECTORS 4
+#include "deduplication/lpc_compute_autocorrelation_windowed_intrin_fma.c"
+	}
+	else if(lag <= 24) {
+#undef NUM_VECTORS
+#define NUM_VECTORS 6
+#include "deduplication/lpc_compute_autocorrelation_windowed_intrin_fma.c"
+	}
+	else {
+#undef NUM_VECTORS
+#define NUM_VECTORS 9
+#include "deduplication/lpc_compute_autocorrelation_windowed_intrin_fma.c"
+	}
+}
+
 #endif /* FLAC__FMA_SUPPORTED */
 #endif /* FLAC__CPU_X86_64 && FLAC__HAS_X86INTRIN */
 #endif /* FLAC__NO_ASM */
@@ -36,17 +36,19 @@
 
 #include "private/cpu.h"
 
-#ifndef FLAC__INTEGER_ONLY_LIBRARY
 #ifndef FLAC__NO_ASM
 #if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
 #include "private/lpc.h"
 #ifdef FLAC__SSE4_1_SUPPORTED
 
+#include <string.h> /* for memcpy() */
 #include "FLAC/assert.h"
 #include "FLAC/format.h"
 
 #include <smmintrin.h> /* SSE4.1 */
 
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+
 #if defined FLAC__CPU_IA32 /* unused for x64 */
 
 #define RESIDUAL64_RESULT(xmmN)  residual[i] = data[i] - _mm_cvtsi128_si32(_mm_srl_epi64(xmmN, cnt))
@@ -944,7 +946,136 @@ void FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_sse41(const FLAC__i
 	}
 }
 
+#endif /* !defined FLAC__INTEGER_ONLY_LIBRARY */
+
+/* Like the AVX2 versions in lpc_intrin_avx2.c, but for blocks of 4 samples */
+#if defined(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION) && !defined(FUZZING_BUILD_MODE_FLAC_SANITIZE_SIGNED_INTEGER_OVERFLOW)
+/* see FLAC__lpc_restore_signal() */
+__attribute__((no_sanitize("signed-integer-overflow")))
+#endif
+FLAC__SSE_TARGET("sse4.1")
+static FLAC__ALWAYS_INLINE void restore_signal_sse41_(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], const uint32_t order, int lp_quantization, FLAC__int32 data[])
+{
+	int i;
+	uint32_t j;
+	FLAC__int32 q[32+4] = { 0 }, s[4], sum;
+	FLAC__int32 d0, d1, d2, d3;
+	__m128i coeff[32], sum4;
+
+	/* lane t of coeff[j] is the coefficient of data[i-1-j] in the prediction of data[i+t] */
+	memcpy(q, qlp_coeff, sizeof(FLAC__int32) * order);
+	for(j = 0; j < order; j++)
+		coeff[j] = _mm_loadu_si128((const __m128i*)(const void*)(q+j));
+
+	for(i = 0; i < (int)data_len-3; i+=4) {
+		/* oldest samples first, the most recent one is the last to be known */
+		sum4 = _mm_mullo_epi32(coeff[order-1], _mm_set1_epi32(data[i-(int)order]));
+		for(j = order-1; j > 0; j--)
+			sum4 = _mm_add_epi32(sum4, _mm_mullo_epi32(coeff[j-1], _mm_set1_epi32(data[i-(int)j])));
+		_mm_storeu_si128((__m128i*)(void*)s, sum4);
+
+		d0 = residual[i  ] + ( s[0] >> lp_quantization);
+		d1 = residual[i+1] + ((s[1] + q[0]*d0) >> lp_quantization);
+		d2 = residual[i+2] + ((s[2] + q[1]*d0 + q[0]*d1) >> lp_quantization);
+		d3 = residual[i+3] + ((s[3] + q[2]*d0 + q[1]*d1 + q[0]*d2) >> lp_quantization);
+		data[i  ] = d0;
+		data[i+1] = d1;
+		data[i+2] = d2;
+		data[i+3] = d3;
+	}
+	for(; i < (int)data_len; i++) {
+		sum = 0;
+		for(j = 0; j < order; j++)
+			sum += q[j] * data[i-(int)j-1];
+		data[i] = residual[i] + (sum >> lp_quantization);
+	}
+}
+
+FLAC__SSE_TARGET("sse4.1")
+static FLAC__ALWAYS_INLINE void restore_signal_wide_sse41_(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], const uint32_t order, int lp_quantization, FLAC__int32 data[])
+{
+	int i;
+	uint32_t j;
+	FLAC__int32 q[32+4] = { 0 };
+	FLAC__int64 s[4], sum;
+	FLAC__int64 d0, d1, d2;
+	__m128i coeff_lo[32], coeff_hi[32], sum_lo, sum_hi, d;
+
+	/* as above, with lanes 0-1 in coeff_lo and 2-3 in coeff_hi, sign-extended
+	 * because _mm_mul_epi32() takes the low 32 bits of each 64-bit lane */
+	memcpy(q, qlp_coeff, sizeof(FLAC__int32) * order);
+	for(j = 0; j < order; j++) {
+		coeff_lo[j] = _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i*)(const void*)(q+j)));
+		coeff_hi[j] = _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i*)(const void*)(q+j+2)));
+	}
+
+	for(i = 0; i < (int)data_len-3; i+=4) {
+		d = _mm_set1_epi32(data[i-(int)order]);
+		sum_lo = _mm_mul_epi32(coeff_lo[order-1], d);
+		sum_hi = _mm_mul_epi32(coeff_hi[order-1], d);
+		for(j = order-1; j > 0; j--) {
+			d = _mm_set1_epi32(data[i-(int)j]);
+			sum_lo = _mm_add_epi64(sum_lo, _mm_mul_epi32(coeff_lo[j-1], d));
+			sum_hi = _mm_add_epi64(sum_hi, _mm_mul_epi32(coeff_hi[j-1], d));
+		}
+		_mm_storeu_si128((__m128i*)(void*)s, sum_lo);
+		_mm_storeu_si128((__m128i*)(void*)(s+2), sum_hi);
+
+		d0 = data[i  ] = (FLAC__int32)(residual[i  ] + ( s[0] >> lp_quantization));
+		d1 = data[i+1] = (FLAC__int32)(residual[i+1] + ((s[1] + q[0]*d0) >> lp_quantization));
+		d2 = data[i+2] = (FLAC__int32)(residual[i+2] + ((s[2] + q[1]*d0 + q[0]*d1) >> lp_quantization));
+		data[i+3] = (FLAC__int32)(residual[i+3] + ((s[3] + q[2]*d0 + q[1]*d1 + q[0]*d2) >> lp_quantization));
+	}
+	for(; i < (int)data_len; i++) {
+		sum = 0;
+		for(j = 0; j < order; j++)
+			sum += q[j] * (FLAC__int64)data[i-(int)j-1];
+		data[i] = (FLAC__int32)(residual[i] + (sum >> lp_quantization));
+	}
+}
+
+#if defined(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION) && !defined(FUZZING_BUILD_MODE_FLAC_SANITIZE_SIGNED_INTEGER_OVERFLOW)
+/* see FLAC__lpc_restore_signal() */
+__attribute__((no_sanitize("signed-integer-overflow")))
+#endif
+FLAC__SSE_TARGET("sse4.1")
+void FLAC__lpc_restore_signal_intrin_sse41(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[])
+{
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+
+	/* below order 8 the scalar code is just as fast, it is bound by the
+	 * dependency of each sample on the previous one as well */
+	if(order < 8)
+		FLAC__lpc_restore_signal(residual, data_len, qlp_coeff, order, lp_quantization, data);
+	else if(order == 8)
+		restore_signal_sse41_(residual, data_len, qlp_coeff, 8, lp_quantization, data);
+	else if(order == 12)
+		restore_signal_sse41_(residual, data_len, qlp_coeff, 12, lp_quantization, data);
+	else if(order == 32)
+		restore_signal_sse41_(residual, data_len, qlp_coeff, 32, lp_quantization, data);
+	else
+		restore_signal_sse41_(residual, data_len, qlp_coeff, order, lp_quantization, data);
+}
+
+FLAC__SSE_TARGET("sse4.1")
+void FLAC__lpc_restore_signal_wide_intrin_sse41(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[])
+{
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+
+	if(order < 8)
+		FLAC__lpc_restore_signal_wide(residual, data_len, qlp_coeff, order, lp_quantization, data);
+	else if(order == 8)
+		restore_signal_wide_sse41_(residual, data_len, qlp_coeff, 8, lp_quantization, data);
+	else if(order == 12)
+		restore_signal_wide_sse41_(residual, data_len, qlp_coeff, 12, lp_quantization, data);
+	else if(order == 32)
+		restore_signal_wide_sse41_(residual, data_len, qlp_coeff, 32, lp_quantization, data);
+	else
+		restore_signal_wide_sse41_(residual, data_len, qlp_coeff, order, lp_quantization, data);
+}
+
 #endif /* FLAC__SSE4_1_SUPPORTED */
 #endif /* (FLAC__CPU_IA32 || FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN */
 #endif /* FLAC__NO_ASM */
-#endif /* FLAC__INTEGER_ONLY_LIBRARY */
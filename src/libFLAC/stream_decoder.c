@@ -39,9 +39,15 @@
 #include <string.h> /* for memset/memcpy() */
 #include <sys/types.h> /* for off_t */
 #include <sys/stat.h>  /* for stat() */
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h> /* for mmap() */
+#endif
 #include "share/compat.h"
+#include "share/compat_threads.h"
 #include "FLAC/assert.h"
+#include "FLAC/metadata.h"
 #include "share/alloc.h"
+#include "share/private.h"
 #include "protected/stream_decoder.h"
 #include "private/bitreader.h"
 #include "private/bitmath.h"
@@ -51,8 +57,10 @@
 #include "private/format.h"
 #include "private/lpc.h"
 #include "private/md5.h"
+#include "private/thread_pool.h"
 #include "private/memory.h"
 #include "private/macros.h"
+#include "private/stream_decoder.h"
 
 
 /* technically this should be in an "export.c" but this is convenient enough */
@@ -67,6 +75,59 @@ FLAC_API int FLAC_API_SUPPORTS_OGG_FLAC = FLAC__HAS_OGG;
 
 static const FLAC__byte ID3V2_TAG_[3] = { 'I', 'D', '3' };
 
+/* Bytes per sample of each FLAC__StreamDecoderPCMFormat */
+static const uint32_t PCM_FORMAT_BYTES_[4] = { 2, 3, 4, 4 };
+
+#ifdef FLAC__USE_THREADS
+/* Number of bytes requested from the client at a time when reading ahead
+ * for multithreaded decoding */
+static const size_t THREAD_READ_SIZE_ = 65536;
+
+/* A candidate frame that has not found the next frame header after this
+ * many bytes is decoded single-threaded instead; this is larger than any
+ * valid frame can be */
+static const size_t THREAD_MAX_FRAME_SIZE_ = 4u << 20;
+
+typedef enum {
+	THREADTASK_IDLE,
+	THREADTASK_QUEUED,
+	THREADTASK_RUNNING,
+	THREADTASK_DONE
+} FLAC__StreamDecoderThreadTaskState;
+
+/* One frame's worth of work for multithreaded decoding.  Every task
+ * owns a private single-threaded decoder, so it has its own bitreader,
+ * residual and output buffers, and decodes the raw frame bytes copied
+ * into it by the thread that reads the stream.
+ */
+typedef struct FLAC__StreamDecoderThreadTask {
+	FLAC__StreamDecoder *parent;
+	FLAC__StreamDecoder *decoder;
+	FLAC__byte *data;
+	size_t data_len, data_capacity, data_pos;
+	FLAC__uint64 stream_offset; /* read-ahead position of data[0] */
+	const FLAC__Frame *frame; /* set by the write callback, points into decoder */
+	const FLAC__int32 * const *buffer;
+	FLAC__bool forward; /* if true, frames and errors are passed on to the parent right away */
+	FLAC__bool error_occurred;
+	FLAC__bool frame_is_clean; /* exactly one valid frame spanning all of data[] was decoded */
+	FLAC__StreamDecoderThreadTaskState state;
+} FLAC__StreamDecoderThreadTask;
+#endif
+
+/*
+ * Handed to read_residual_partitioned_rice_() to restore the signal of an
+ * LPC subframe one partition at a time, right after the residual of that
+ * partition has been read and while it is still in cache.
+ */
+typedef struct FLAC__StreamDecoderPartitionRestore {
+	void (*restore_signal)(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[]);
+	const FLAC__int32 *qlp_coeff;
+	uint32_t order;
+	int quantization_level;
+	FLAC__int32 *data; /* data[0] is the sample belonging to residual[0] */
+} FLAC__StreamDecoderPartitionRestore;
+
 /***********************************************************************
  *
  * Private class method prototypes
@@ -74,8 +135,13 @@ static const FLAC__byte ID3V2_TAG_[3] = { 'I', 'D', '3' };
  ***********************************************************************/
 
 static void set_defaults_(FLAC__StreamDecoder *decoder);
+#ifdef HAVE_SYS_MMAN_H
+static FLAC__bool map_file_(FLAC__StreamDecoder *decoder);
+static void unmap_file_(FLAC__StreamDecoder *decoder);
+#endif
 static FILE *get_binary_stdin_(void);
 static FLAC__bool allocate_output_(FLAC__StreamDecoder *decoder, uint32_t size, uint32_t channels, uint32_t bps);
+static FLAC__bool allocate_interleaved_(FLAC__StreamDecoder *decoder, uint32_t blocksize, uint32_t channels);
 static FLAC__bool has_id_filtered_(FLAC__StreamDecoder *decoder, FLAC__byte *id);
 static FLAC__bool find_metadata_(FLAC__StreamDecoder *decoder);
 static FLAC__bool read_metadata_(FLAC__StreamDecoder *decoder);
@@ -88,21 +154,32 @@ static FLAC__bool skip_id3v2_tag_(FLAC__StreamDecoder *decoder);
 static FLAC__bool frame_sync_(FLAC__StreamDecoder *decoder);
 static FLAC__bool read_frame_(FLAC__StreamDecoder *decoder, FLAC__bool *got_a_frame, FLAC__bool do_full_decode);
 static FLAC__bool read_frame_header_(FLAC__StreamDecoder *decoder);
+static FLAC__bool scan_frame_(FLAC__StreamDecoder *decoder, FLAC__FrameHeader *header, FLAC__uint64 *offset, FLAC__bool do_full_decode);
+static FLAC__bool skip_frame_(FLAC__StreamDecoder *decoder);
+static FLAC__bool frame_done_(FLAC__StreamDecoder *decoder);
+static FLAC__bool rewind_to_last_framesync_(FLAC__StreamDecoder *decoder);
 static FLAC__bool read_subframe_(FLAC__StreamDecoder *decoder, uint32_t channel, uint32_t bps, FLAC__bool do_full_decode);
 static FLAC__bool read_subframe_constant_(FLAC__StreamDecoder *decoder, uint32_t channel, uint32_t bps, FLAC__bool do_full_decode);
 static FLAC__bool read_subframe_fixed_(FLAC__StreamDecoder *decoder, uint32_t channel, uint32_t bps, const uint32_t order, FLAC__bool do_full_decode);
 static FLAC__bool read_subframe_lpc_(FLAC__StreamDecoder *decoder, uint32_t channel, uint32_t bps, const uint32_t order, FLAC__bool do_full_decode);
 static FLAC__bool read_subframe_verbatim_(FLAC__StreamDecoder *decoder, uint32_t channel, uint32_t bps, FLAC__bool do_full_decode);
-static FLAC__bool read_residual_partitioned_rice_(FLAC__StreamDecoder *decoder, uint32_t predictor_order, uint32_t partition_order, FLAC__EntropyCodingMethod_PartitionedRiceContents *partitioned_rice_contents, FLAC__int32 *residual, FLAC__bool is_extended);
+static FLAC__bool read_rice_signed_block_(FLAC__StreamDecoder *decoder, FLAC__int32 *residual, uint32_t nvals, uint32_t parameter);
+static FLAC__bool read_residual_partitioned_rice_(FLAC__StreamDecoder *decoder, uint32_t predictor_order, uint32_t partition_order, FLAC__EntropyCodingMethod_PartitionedRiceContents *partitioned_rice_contents, FLAC__int32 *residual, FLAC__bool is_extended, const FLAC__StreamDecoderPartitionRestore *restore);
 static FLAC__bool read_zero_padding_(FLAC__StreamDecoder *decoder);
 static void       undo_channel_coding(FLAC__StreamDecoder *decoder);
+static FLAC__bool pack_interleaved_(const FLAC__StreamDecoder *decoder, const FLAC__int32 * const buffer[], uint32_t channels, FLAC__ChannelAssignment channel_assignment, uint32_t blocksize, uint32_t bps, FLAC__byte out[]);
 static FLAC__bool read_callback_(FLAC__byte buffer[], size_t *bytes, void *client_data);
 #if FLAC__HAS_OGG
 static FLAC__StreamDecoderReadStatus read_callback_ogg_aspect_(const FLAC__StreamDecoder *decoder, FLAC__byte buffer[], size_t *bytes);
 static FLAC__OggDecoderAspectReadStatus read_callback_proxy_(const void *void_decoder, FLAC__byte buffer[], size_t *bytes, void *client_data);
 #endif
-static FLAC__StreamDecoderWriteStatus write_audio_frame_to_client_(FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[]);
+static FLAC__StreamDecoderWriteStatus write_audio_frame_to_client_(FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], const FLAC__byte *interleaved);
+static FLAC__StreamDecoderWriteStatus call_write_callback_(FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], const FLAC__byte *interleaved);
+static void advance_ranges_(FLAC__StreamDecoder *decoder, FLAC__uint64 sample_number);
+static FLAC__bool frame_in_ranges_(FLAC__StreamDecoder *decoder, const FLAC__FrameHeader *header);
+static FLAC__StreamDecoderWriteStatus write_ranges_(FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[]);
 static void send_error_to_client_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status);
+static FLAC__bool add_seek_index_point_(FLAC__StreamDecoder *decoder, FLAC__uint64 sample_number, FLAC__uint64 stream_offset, uint32_t frame_samples);
 static FLAC__bool seek_to_absolute_sample_(FLAC__StreamDecoder *decoder, FLAC__uint64 stream_length, FLAC__uint64 target_sample);
 #if FLAC__HAS_OGG
 static FLAC__bool seek_to_absolute_sample_ogg_(FLAC__StreamDecoder *decoder, FLAC__uint64 stream_length, FLAC__uint64 target_sample);
@@ -112,7 +189,37 @@ static FLAC__StreamDecoderSeekStatus file_seek_callback_(const FLAC__StreamDecod
 static FLAC__StreamDecoderTellStatus file_tell_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 *absolute_byte_offset, void *client_data);
 static FLAC__StreamDecoderLengthStatus file_length_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 *stream_length, void *client_data);
 static FLAC__bool file_eof_callback_(const FLAC__StreamDecoder *decoder, void *client_data);
+static FLAC__StreamDecoderReadStatus memory_read_callback_(const FLAC__StreamDecoder *decoder, FLAC__byte buffer[], size_t *bytes, void *client_data);
+static FLAC__StreamDecoderSeekStatus memory_seek_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 absolute_byte_offset, void *client_data);
+static FLAC__StreamDecoderTellStatus memory_tell_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 *absolute_byte_offset, void *client_data);
+static FLAC__StreamDecoderLengthStatus memory_length_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 *stream_length, void *client_data);
+static FLAC__bool memory_eof_callback_(const FLAC__StreamDecoder *decoder, void *client_data);
 static void reset_decoder_internal_(FLAC__StreamDecoder* decoder);
+#ifdef FLAC__USE_THREADS
+static FLAC__bool process_until_end_of_stream_threaded_(FLAC__StreamDecoder *decoder);
+static FLAC__bool start_threads_(FLAC__StreamDecoder *decoder);
+static void stop_threads_(FLAC__StreamDecoder *decoder);
+static FLAC__thread_return_type decode_frame_thread_(void *data);
+static void decode_frame_pool_job_(void *data);
+static FLAC__bool run_queued_threadtask_(FLAC__StreamDecoder *decoder);
+static void decode_threadtask_(FLAC__StreamDecoderThreadTask *task);
+static FLAC__bool prepare_threadtask_(FLAC__StreamDecoder *decoder, FLAC__StreamDecoderThreadTask *task);
+static void wait_for_threadtask_(FLAC__StreamDecoder *decoder, FLAC__StreamDecoderThreadTask *task);
+static FLAC__bool decode_single_threaded_(FLAC__StreamDecoder *decoder, FLAC__uint64 *position);
+static FLAC__bool deliver_frame_(FLAC__StreamDecoder *decoder, const FLAC__StreamDecoder *source, const FLAC__Frame *frame, const FLAC__int32 * const buffer[]);
+static FLAC__bool reserve_read_ahead_(FLAC__StreamDecoder *decoder, size_t bytes);
+static FLAC__bool read_ahead_(FLAC__StreamDecoder *decoder);
+static void discard_read_ahead_(FLAC__StreamDecoder *decoder, FLAC__uint64 position);
+static int parse_raw_frame_header_(const FLAC__StreamDecoder *decoder, const FLAC__byte *raw, size_t bytes, FLAC__uint64 *sample_number, uint32_t *blocksize);
+static FLAC__bool next_sample_number_after_last_frame_(const FLAC__StreamDecoder *decoder, FLAC__uint64 *sample_number);
+static FLAC__StreamDecoderReadStatus threadtask_read_callback_(const FLAC__StreamDecoder *decoder, FLAC__byte buffer[], size_t *bytes, void *client_data);
+static FLAC__StreamDecoderWriteStatus threadtask_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data);
+static void threadtask_error_callback_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data);
+static FLAC__StreamDecoderSeekStatus threadtask_seek_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 absolute_byte_offset, void *client_data);
+static FLAC__StreamDecoderTellStatus threadtask_tell_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 *absolute_byte_offset, void *client_data);
+static FLAC__StreamDecoderLengthStatus threadtask_length_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 *stream_length, void *client_data);
+static FLAC__bool threadtask_eof_callback_(const FLAC__StreamDecoder *decoder, void *client_data);
+#endif
 
 /***********************************************************************
  *
@@ -130,13 +237,25 @@ typedef struct FLAC__StreamDecoderPrivate {
 	FLAC__StreamDecoderWriteCallback write_callback;
 	FLAC__StreamDecoderMetadataCallback metadata_callback;
 	FLAC__StreamDecoderErrorCallback error_callback;
+	FLAC__StreamDecoderInterleavedWriteCallback interleaved_write_callback; /* if set, replaces write_callback */
+	FLAC__StreamDecoderPCMFormat interleaved_format;
+	FLAC__StreamDecoderRangeWriteCallback range_write_callback; /* only set inside FLAC__stream_decoder_process_sample_ranges(), replaces the other write callbacks */
+	const FLAC__StreamDecoderSampleRange *ranges;
+	uint32_t num_ranges, next_range; /* the ranges before next_range are done */
 	void *client_data;
 	FILE *file; /* only used if FLAC__stream_decoder_init_file()/FLAC__stream_decoder_init_file() called, else NULL */
+	const FLAC__byte *memory; /* only used if FLAC__stream_decoder_init_memory()/FLAC__stream_decoder_init_ogg_memory() called, else NULL */
+	size_t memory_length, memory_position;
+	FLAC__bool use_mmap;
+	void *mapping; /* only used if the file given to FLAC__stream_decoder_init_file()/FLAC__stream_decoder_init_FILE() is memory-mapped, else NULL */
+	size_t mapping_length;
 	FLAC__BitReader *input;
 	FLAC__int32 *output[FLAC__MAX_CHANNELS];
 	FLAC__int32 *residual[FLAC__MAX_CHANNELS]; /* WATCHOUT: these are the aligned pointers; the real pointers that should be free()'d are residual_unaligned[] below */
 	FLAC__int64 *side_subframe;
 	FLAC__bool side_subframe_in_use;
+	FLAC__byte *interleaved; /* samples packed for interleaved_write_callback */
+	size_t interleaved_capacity; /* in bytes */
 	FLAC__EntropyCodingMethod_PartitionedRiceContents partitioned_rice_contents[FLAC__MAX_CHANNELS];
 	uint32_t output_capacity, output_channels;
 	FLAC__uint32 fixed_block_size, next_fixed_block_size;
@@ -158,6 +277,8 @@ typedef struct FLAC__StreamDecoderPrivate {
 	FLAC__bool internal_reset_hack; /* used only during init() so we can call reset to set up the decoder without rewinding the input */
 	FLAC__bool is_seeking;
 	FLAC__bool is_indexing; /* to be able to seek in chained streams */
+	FLAC__bool is_scanning; /* only set inside FLAC__stream_decoder_scan_single_frame() */
+	FLAC__bool is_verifying; /* only set inside FLAC__stream_decoder_verify_single_frame() */
 	FLAC__MD5Context md5context;
 	FLAC__byte computed_md5sum[16]; /* this is the sum we computed from the decoded data */
 	/* (the rest of these are only used for seeking) */
@@ -166,9 +287,18 @@ typedef struct FLAC__StreamDecoderPrivate {
 	FLAC__uint64 first_frame_offset; /* hint to the seek routine of where in the stream the first audio frame starts */
 	FLAC__uint64 last_seen_framesync; /* if tell callback works, the location of the last seen frame sync code, to rewind to if needed */
 	FLAC__uint64 target_sample;
+	FLAC__bool build_seek_index;
+	FLAC__StreamMetadata_SeekPoint *seek_index; /* frames seen so far, sorted by sample number, offsets relative to first_frame_offset like a SEEKTABLE */
+	uint32_t seek_index_length, seek_index_capacity; /* units are seek points */
 	uint32_t unparseable_frame_count; /* used to tell whether we're decoding a future version of FLAC or just got a bad sync */
 	FLAC__bool got_a_frame; /* hack needed in Ogg FLAC seek routine and find_total_samples to check when process_single() actually writes a frame */
 	FLAC__bool (*local_bitreader_read_rice_signed_block)(FLAC__BitReader *br, int vals[], uint32_t nvals, uint32_t parameter);
+	FLAC__BitReaderRiceTableEntry *rice_table[FLAC__BITREADER_RICE_TABLE_MAX_PARAMETER+1]; /* built the first time a partition with that parameter is read */
+	void (*local_lpc_restore_signal)(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[]);
+	void (*local_lpc_restore_signal_64bit)(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[]);
+	void (*local_fixed_restore_signal)(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[]);
+	void (*local_fixed_restore_signal_64bit)(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[]);
+	FLAC__bool (*local_pack_interleaved_stereo)(const FLAC__int32 * const buffer[], FLAC__ChannelAssignment channel_assignment, uint32_t blocksize, uint32_t bps, FLAC__StreamDecoderPCMFormat format, FLAC__byte out[]);
 	FLAC__bool error_has_been_sent; /* To check whether a missing frame has been signalled yet */
 #if FLAC__HAS_OGG
 	FLAC__bool ogg_decoder_aspect_allocation_failure;
@@ -176,6 +306,23 @@ typedef struct FLAC__StreamDecoderPrivate {
 #ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
 	uint32_t fuzzing_rewind_count; /* To stop excessive rewinding, as it causes timeouts */
 #endif
+#ifdef FLAC__USE_THREADS
+	/* (the rest of these are only used for multithreaded decoding) */
+	FLAC__StreamDecoderThreadTask *threadtask; /* threadtask[0] is reserved for the main thread */
+	uint32_t num_threadtasks;
+	FLAC__thrd_t *thread;
+	uint32_t num_started_threads;
+	FLAC__mtx_t mutex_work_queue;
+	FLAC__cnd_t cond_work_available;
+	FLAC__cnd_t cond_task_done;
+	FLAC__bool finish_work_threads;
+	FLAC__byte *read_ahead; /* stream data read ahead of the frames being decoded */
+	size_t read_ahead_len, read_ahead_capacity;
+	FLAC__uint64 read_ahead_offset; /* position of read_ahead[0] */
+	FLAC__uint64 read_ahead_position; /* read position of threadtask[0] */
+	FLAC__bool read_ahead_eof;
+	FLAC__ThreadPoolClient thread_pool_client; /* attached instead of starting threads when a thread pool is set */
+#endif
 } FLAC__StreamDecoderPrivate;
 
 /***********************************************************************
@@ -237,6 +384,13 @@ FLAC_API const char * const FLAC__StreamDecoderWriteStatusString[] = {
 	"FLAC__STREAM_DECODER_WRITE_STATUS_ABORT"
 };
 
+FLAC_API const char * const FLAC__StreamDecoderPCMFormatString[] = {
+	"FLAC__STREAM_DECODER_PCM_FORMAT_S16LE",
+	"FLAC__STREAM_DECODER_PCM_FORMAT_S24LE",
+	"FLAC__STREAM_DECODER_PCM_FORMAT_S32LE",
+	"FLAC__STREAM_DECODER_PCM_FORMAT_FLOAT32"
+};
+
 FLAC_API const char * const FLAC__StreamDecoderErrorStatusString[] = {
 	"FLAC__STREAM_DECODER_ERROR_STATUS_LOST_SYNC",
 	"FLAC__STREAM_DECODER_ERROR_STATUS_BAD_HEADER",
@@ -299,7 +453,12 @@ FLAC_API FLAC__StreamDecoder *FLAC__stream_decoder_new(void)
 		decoder->private_->residual_unaligned[i] = decoder->private_->residual[i] = 0;
 	}
 
+	for(i = 0; i <= FLAC__BITREADER_RICE_TABLE_MAX_PARAMETER; i++)
+		decoder->private_->rice_table[i] = 0;
+
 	decoder->private_->side_subframe = 0;
+	decoder->private_->interleaved = 0;
+	decoder->private_->interleaved_capacity = 0;
 
 	decoder->private_->output_capacity = 0;
 	decoder->private_->output_channels = 0;
@@ -309,6 +468,11 @@ FLAC_API FLAC__StreamDecoder *FLAC__stream_decoder_new(void)
 		FLAC__format_entropy_coding_method_partitioned_rice_contents_init(&decoder->private_->partitioned_rice_contents[i]);
 
 	decoder->private_->file = 0;
+	decoder->private_->memory = 0;
+	decoder->private_->mapping = 0;
+
+	decoder->private_->seek_index = 0;
+	decoder->private_->seek_index_length = decoder->private_->seek_index_capacity = 0;
 
 	set_defaults_(decoder);
 
@@ -333,11 +497,17 @@ FLAC_API void FLAC__stream_decoder_delete(FLAC__StreamDecoder *decoder)
 	if(0 != decoder->private_->metadata_filter_ids)
 		free(decoder->private_->metadata_filter_ids);
 
+	/* an index added to a decoder that was never initialized is not freed by finish() */
+	free(decoder->private_->seek_index);
+
 	FLAC__bitreader_delete(decoder->private_->input);
 
 	for(i = 0; i < FLAC__MAX_CHANNELS; i++)
 		FLAC__format_entropy_coding_method_partitioned_rice_contents_clear(&decoder->private_->partitioned_rice_contents[i]);
 
+	for(i = 0; i <= FLAC__BITREADER_RICE_TABLE_MAX_PARAMETER; i++)
+		free(decoder->private_->rice_table[i]);
+
 	free(decoder->private_);
 	free(decoder->protected_);
 	free(decoder);
@@ -373,7 +543,7 @@ static FLAC__StreamDecoderInitStatus init_stream_internal_(
 
 	if(
 		0 == read_callback ||
-		0 == write_callback ||
+		(0 == write_callback && 0 == decoder->private_->interleaved_write_callback) ||
 		0 == error_callback ||
 		(seek_callback && (0 == tell_callback || 0 == length_callback || 0 == eof_callback))
 	)
@@ -388,12 +558,55 @@ static FLAC__StreamDecoderInitStatus init_stream_internal_(
 #endif
 
 	FLAC__cpu_info(&decoder->private_->cpuinfo);
+	/* there is no vector routine: where a Rice codeword ends depends on
+	 * where the one before it ended, and AVX2 versions measured slower
+	 * than the BMI2 one at every parameter */
 	decoder->private_->local_bitreader_read_rice_signed_block = FLAC__bitreader_read_rice_signed_block;
 
 #ifdef FLAC__BMI2_SUPPORTED
 	if (decoder->private_->cpuinfo.x86.bmi2) {
 		decoder->private_->local_bitreader_read_rice_signed_block = FLAC__bitreader_read_rice_signed_block_bmi2;
 	}
+#endif
+	decoder->private_->local_lpc_restore_signal = FLAC__lpc_restore_signal;
+	decoder->private_->local_lpc_restore_signal_64bit = FLAC__lpc_restore_signal_wide;
+	decoder->private_->local_fixed_restore_signal = FLAC__fixed_restore_signal;
+	decoder->private_->local_fixed_restore_signal_64bit = FLAC__fixed_restore_signal_wide;
+	/* restoring LPC subframes partition by partition measured within
+	 * noise of restoring them after all residual is read, and slower at
+	 * large blocksizes, so fused_lpc_restore is not turned on for any CPU */
+	decoder->private_->local_pack_interleaved_stereo = 0;
+	/* now override with asm where appropriate */
+#ifndef FLAC__NO_ASM
+#if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
+	if(decoder->private_->cpuinfo.use_asm) {
+# ifdef FLAC__SSE2_SUPPORTED
+		if(decoder->private_->cpuinfo.x86.sse2) {
+			/* the vector code wraps around, which makes it fit for both */
+			decoder->private_->local_fixed_restore_signal = FLAC__fixed_restore_signal_intrin_sse2;
+			decoder->private_->local_fixed_restore_signal_64bit = FLAC__fixed_restore_signal_intrin_sse2;
+		}
+# endif
+# ifdef FLAC__SSE4_1_SUPPORTED
+		if(decoder->private_->cpuinfo.x86.sse41) {
+			decoder->private_->local_lpc_restore_signal = FLAC__lpc_restore_signal_intrin_sse41;
+			decoder->private_->local_lpc_restore_signal_64bit = FLAC__lpc_restore_signal_wide_intrin_sse41;
+		}
+# endif
+# ifdef FLAC__SSSE3_SUPPORTED
+		if(decoder->private_->cpuinfo.x86.ssse3)
+			decoder->private_->local_pack_interleaved_stereo = FLAC__pack_interleaved_stereo_intrin_ssse3;
+# endif
+# ifdef FLAC__AVX2_SUPPORTED
+		if(decoder->private_->cpuinfo.x86.avx2) {
+			decoder->private_->local_lpc_restore_signal = FLAC__lpc_restore_signal_intrin_avx2;
+			decoder->private_->local_lpc_restore_signal_64bit = FLAC__lpc_restore_signal_wide_intrin_avx2;
+			decoder->private_->local_fixed_restore_signal = FLAC__fixed_restore_signal_intrin_avx2;
+			decoder->private_->local_fixed_restore_signal_64bit = FLAC__fixed_restore_signal_intrin_avx2;
+		}
+# endif
+	}
+#endif
 #endif
 
 	/* from here on, errors are fatal */
@@ -402,6 +615,7 @@ static FLAC__StreamDecoderInitStatus init_stream_internal_(
 		decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
 		return FLAC__STREAM_DECODER_INIT_STATUS_MEMORY_ALLOCATION_ERROR;
 	}
+	FLAC__bitreader_set_cpu_info(decoder->private_->input, &decoder->private_->cpuinfo);
 
 	decoder->private_->read_callback = read_callback;
 	decoder->private_->seek_callback = seek_callback;
@@ -420,6 +634,8 @@ static FLAC__StreamDecoderInitStatus init_stream_internal_(
 	decoder->private_->do_md5_checking = decoder->protected_->md5_checking;
 	decoder->private_->is_seeking = false;
 	decoder->private_->is_indexing = false;
+	decoder->private_->is_scanning = false;
+	decoder->private_->is_verifying = false;
 
 	decoder->private_->internal_reset_hack = true; /* so the following reset does not try to rewind the input */
 	if(!FLAC__stream_decoder_reset(decoder)) {
@@ -486,6 +702,46 @@ FLAC_API FLAC__StreamDecoderInitStatus FLAC__stream_decoder_init_ogg_stream(
 	);
 }
 
+/* Initializes the decoder to read from decoder->private_->memory, which
+ * must have been set up by the caller */
+static FLAC__StreamDecoderInitStatus init_memory_stream_internal_(
+	FLAC__StreamDecoder *decoder,
+	FLAC__StreamDecoderWriteCallback write_callback,
+	FLAC__StreamDecoderMetadataCallback metadata_callback,
+	FLAC__StreamDecoderErrorCallback error_callback,
+	void *client_data,
+	FLAC__bool is_ogg
+)
+{
+	FLAC__StreamDecoderInitStatus status;
+
+	status = init_stream_internal_(
+		decoder,
+		memory_read_callback_,
+		memory_seek_callback_,
+		memory_tell_callback_,
+		memory_length_callback_,
+		memory_eof_callback_,
+		write_callback,
+		metadata_callback,
+		error_callback,
+		client_data,
+		is_ogg
+	);
+	if(status != FLAC__STREAM_DECODER_INIT_STATUS_OK) {
+		decoder->private_->memory = 0;
+		return status;
+	}
+
+	/* Native FLAC can be fed to the bitreader straight from memory.  Ogg
+	 * pages have to go through the Ogg decoder aspect, which reads from the
+	 * buffer with memory_read_callback_() */
+	if(!is_ogg)
+		FLAC__bitreader_set_source(decoder->private_->input, decoder->private_->memory, decoder->private_->memory_length, &decoder->private_->memory_position);
+
+	return status;
+}
+
 static FLAC__StreamDecoderInitStatus init_FILE_internal_(
 	FLAC__StreamDecoder *decoder,
 	FILE *file,
@@ -502,7 +758,7 @@ static FLAC__StreamDecoderInitStatus init_FILE_internal_(
 	if(decoder->protected_->state != FLAC__STREAM_DECODER_UNINITIALIZED)
 		return decoder->protected_->initstate = FLAC__STREAM_DECODER_INIT_STATUS_ALREADY_INITIALIZED;
 
-	if(0 == write_callback || 0 == error_callback)
+	if((0 == write_callback && 0 == decoder->private_->interleaved_write_callback) || 0 == error_callback)
 		return decoder->protected_->initstate = FLAC__STREAM_DECODER_INIT_STATUS_INVALID_CALLBACKS;
 
 	/*
@@ -515,6 +771,15 @@ static FLAC__StreamDecoderInitStatus init_FILE_internal_(
 
 	decoder->private_->file = file;
 
+#ifdef HAVE_SYS_MMAN_H
+	if(decoder->private_->use_mmap && file != stdin && map_file_(decoder)) {
+		const FLAC__StreamDecoderInitStatus status = init_memory_stream_internal_(decoder, write_callback, metadata_callback, error_callback, client_data, is_ogg);
+		if(status != FLAC__STREAM_DECODER_INIT_STATUS_OK)
+			unmap_file_(decoder);
+		return status;
+	}
+#endif
+
 	return init_stream_internal_(
 		decoder,
 		file_read_callback_,
@@ -576,7 +841,7 @@ static FLAC__StreamDecoderInitStatus init_file_internal_(
 	if(decoder->protected_->state != FLAC__STREAM_DECODER_UNINITIALIZED)
 		return decoder->protected_->initstate = FLAC__STREAM_DECODER_INIT_STATUS_ALREADY_INITIALIZED;
 
-	if(0 == write_callback || 0 == error_callback)
+	if((0 == write_callback && 0 == decoder->private_->interleaved_write_callback) || 0 == error_callback)
 		return decoder->protected_->initstate = FLAC__STREAM_DECODER_INIT_STATUS_INVALID_CALLBACKS;
 
 	file = filename? flac_fopen(filename, "rb") : stdin;
@@ -611,6 +876,56 @@ FLAC_API FLAC__StreamDecoderInitStatus FLAC__stream_decoder_init_ogg_file(
 	return init_file_internal_(decoder, filename, write_callback, metadata_callback, error_callback, client_data, /*is_ogg=*/true);
 }
 
+static FLAC__StreamDecoderInitStatus init_memory_internal_(
+	FLAC__StreamDecoder *decoder,
+	const FLAC__byte *data,
+	size_t length,
+	FLAC__StreamDecoderWriteCallback write_callback,
+	FLAC__StreamDecoderMetadataCallback metadata_callback,
+	FLAC__StreamDecoderErrorCallback error_callback,
+	void *client_data,
+	FLAC__bool is_ogg
+)
+{
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != data || 0 == length);
+
+	if(decoder->protected_->state != FLAC__STREAM_DECODER_UNINITIALIZED)
+		return decoder->protected_->initstate = FLAC__STREAM_DECODER_INIT_STATUS_ALREADY_INITIALIZED;
+
+	decoder->private_->memory = data;
+	decoder->private_->memory_length = length;
+	decoder->private_->memory_position = 0;
+
+	return init_memory_stream_internal_(decoder, write_callback, metadata_callback, error_callback, client_data, is_ogg);
+}
+
+FLAC_API FLAC__StreamDecoderInitStatus FLAC__stream_decoder_init_memory(
+	FLAC__StreamDecoder *decoder,
+	const FLAC__byte *data,
+	size_t length,
+	FLAC__StreamDecoderWriteCallback write_callback,
+	FLAC__StreamDecoderMetadataCallback metadata_callback,
+	FLAC__StreamDecoderErrorCallback error_callback,
+	void *client_data
+)
+{
+	return init_memory_internal_(decoder, data, length, write_callback, metadata_callback, error_callback, client_data, /*is_ogg=*/false);
+}
+
+FLAC_API FLAC__StreamDecoderInitStatus FLAC__stream_decoder_init_ogg_memory(
+	FLAC__StreamDecoder *decoder,
+	const FLAC__byte *data,
+	size_t length,
+	FLAC__StreamDecoderWriteCallback write_callback,
+	FLAC__StreamDecoderMetadataCallback metadata_callback,
+	FLAC__StreamDecoderErrorCallback error_callback,
+	void *client_data
+)
+{
+	return init_memory_internal_(decoder, data, length, write_callback, metadata_callback, error_callback, client_data, /*is_ogg=*/true);
+}
+
 FLAC_API FLAC__bool FLAC__stream_decoder_finish(FLAC__StreamDecoder *decoder)
 {
 	FLAC__bool md5_failed = false;
@@ -632,6 +947,10 @@ FLAC_API FLAC__bool FLAC__stream_decoder_finish(FLAC__StreamDecoder *decoder)
 	decoder->private_->seek_table.data.seek_table.points = 0;
 	decoder->private_->has_seek_table = false;
 
+	free(decoder->private_->seek_index);
+	decoder->private_->seek_index = 0;
+	decoder->private_->seek_index_length = decoder->private_->seek_index_capacity = 0;
+
 	FLAC__bitreader_free(decoder->private_->input);
 	for(i = 0; i < FLAC__MAX_CHANNELS; i++) {
 		/* WATCHOUT:
@@ -653,6 +972,11 @@ FLAC_API FLAC__bool FLAC__stream_decoder_finish(FLAC__StreamDecoder *decoder)
 		free(decoder->private_->side_subframe);
 		decoder->private_->side_subframe = 0;
 	}
+	if(0 != decoder->private_->interleaved) {
+		free(decoder->private_->interleaved);
+		decoder->private_->interleaved = 0;
+	}
+	decoder->private_->interleaved_capacity = 0;
 	decoder->private_->output_capacity = 0;
 	decoder->private_->output_channels = 0;
 
@@ -661,11 +985,15 @@ FLAC_API FLAC__bool FLAC__stream_decoder_finish(FLAC__StreamDecoder *decoder)
 		FLAC__ogg_decoder_aspect_finish(&decoder->protected_->ogg_decoder_aspect);
 #endif
 
+#ifdef HAVE_SYS_MMAN_H
+	unmap_file_(decoder);
+#endif
 	if(0 != decoder->private_->file) {
 		if(decoder->private_->file != stdin)
 			fclose(decoder->private_->file);
 		decoder->private_->file = 0;
 	}
+	decoder->private_->memory = 0;
 
 	if(decoder->private_->do_md5_checking) {
 		if(memcmp(decoder->private_->stream_info.data.stream_info.md5sum, decoder->private_->computed_md5sum, 16))
@@ -673,6 +1001,8 @@ FLAC_API FLAC__bool FLAC__stream_decoder_finish(FLAC__StreamDecoder *decoder)
 	}
 	decoder->private_->is_seeking = false;
 	decoder->private_->is_indexing = false;
+	decoder->private_->is_scanning = false;
+	decoder->private_->is_verifying = false;
 
 	set_defaults_(decoder);
 
@@ -723,6 +1053,79 @@ FLAC_API FLAC__bool FLAC__stream_decoder_set_md5_checking(FLAC__StreamDecoder *d
 	return true;
 }
 
+FLAC_API uint32_t FLAC__stream_decoder_set_num_threads(FLAC__StreamDecoder *decoder, uint32_t value)
+{
+#ifdef FLAC__USE_THREADS
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != decoder->private_);
+	FLAC__ASSERT(0 != decoder->protected_);
+
+	if(decoder->protected_->state != FLAC__STREAM_DECODER_UNINITIALIZED)
+		return FLAC__STREAM_DECODER_SET_NUM_THREADS_ALREADY_INITIALIZED;
+	if(value > FLAC__STREAM_DECODER_MAX_THREADS)
+		return FLAC__STREAM_DECODER_SET_NUM_THREADS_TOO_MANY_THREADS;
+	if(value == 0)
+		decoder->protected_->num_threads = 1;
+	else
+		decoder->protected_->num_threads = value;
+	return FLAC__STREAM_DECODER_SET_NUM_THREADS_OK;
+#else
+	(void)decoder;
+	(void)value;
+	return FLAC__STREAM_DECODER_SET_NUM_THREADS_NOT_COMPILED_WITH_MULTITHREADING_ENABLED;
+#endif
+}
+
+FLAC_API FLAC__bool FLAC__stream_decoder_set_thread_pool(FLAC__StreamDecoder *decoder, FLAC__ThreadPool *pool)
+{
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != decoder->protected_);
+	if(decoder->protected_->state != FLAC__STREAM_DECODER_UNINITIALIZED)
+		return false;
+	decoder->protected_->thread_pool = pool;
+	return true;
+}
+
+FLAC_API FLAC__bool FLAC__stream_decoder_set_mmap(FLAC__StreamDecoder *decoder, FLAC__bool value)
+{
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != decoder->private_);
+	FLAC__ASSERT(0 != decoder->protected_);
+	if(decoder->protected_->state != FLAC__STREAM_DECODER_UNINITIALIZED)
+		return false;
+	decoder->private_->use_mmap = value;
+	return true;
+}
+
+FLAC_API FLAC__bool FLAC__stream_decoder_set_build_seek_index(FLAC__StreamDecoder *decoder, FLAC__bool value)
+{
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != decoder->private_);
+	FLAC__ASSERT(0 != decoder->protected_);
+	if(decoder->protected_->state != FLAC__STREAM_DECODER_UNINITIALIZED)
+		return false;
+	decoder->private_->build_seek_index = value;
+	return true;
+}
+
+FLAC_API FLAC__bool FLAC__stream_decoder_set_interleaved_output(FLAC__StreamDecoder *decoder, FLAC__StreamDecoderPCMFormat format, FLAC__StreamDecoderInterleavedWriteCallback write_callback)
+{
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != decoder->private_);
+	FLAC__ASSERT(0 != decoder->protected_);
+	if(decoder->protected_->state != FLAC__STREAM_DECODER_UNINITIALIZED)
+		return false;
+	if((uint32_t)format > FLAC__STREAM_DECODER_PCM_FORMAT_FLOAT32)
+		return false;
+#ifdef FLAC__INTEGER_ONLY_LIBRARY
+	if(format == FLAC__STREAM_DECODER_PCM_FORMAT_FLOAT32)
+		return false;
+#endif
+	decoder->private_->interleaved_format = format;
+	decoder->private_->interleaved_write_callback = write_callback;
+	return true;
+}
+
 FLAC_API FLAC__bool FLAC__stream_decoder_set_metadata_respond(FLAC__StreamDecoder *decoder, FLAC__MetadataType type)
 {
 	FLAC__ASSERT(0 != decoder);
@@ -827,6 +1230,20 @@ FLAC_API FLAC__bool FLAC__stream_decoder_set_metadata_ignore_all(FLAC__StreamDec
 	return true;
 }
 
+/*
+ * This function is not static, but not publicly exposed in include/FLAC/
+ * either.  It is used by the test suite and flacbench
+ */
+FLAC_API FLAC__bool FLAC__stream_decoder_set_fused_lpc_restore(FLAC__StreamDecoder *decoder, FLAC__bool value)
+{
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != decoder->protected_);
+	if(decoder->protected_->state != FLAC__STREAM_DECODER_UNINITIALIZED)
+		return false;
+	decoder->protected_->fused_lpc_restore = value;
+	return true;
+}
+
 FLAC_API FLAC__StreamDecoderState FLAC__stream_decoder_get_state(const FLAC__StreamDecoder *decoder)
 {
 	FLAC__ASSERT(0 != decoder);
@@ -858,6 +1275,20 @@ FLAC_API FLAC__bool FLAC__stream_decoder_get_md5_checking(const FLAC__StreamDeco
 	return decoder->protected_->md5_checking;
 }
 
+FLAC_API uint32_t FLAC__stream_decoder_get_num_threads(const FLAC__StreamDecoder *decoder)
+{
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != decoder->protected_);
+	return decoder->protected_->num_threads;
+}
+
+FLAC_API FLAC__ThreadPool *FLAC__stream_decoder_get_thread_pool(const FLAC__StreamDecoder *decoder)
+{
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != decoder->protected_);
+	return decoder->protected_->thread_pool;
+}
+
 FLAC_API FLAC__uint64 FLAC__stream_decoder_get_total_samples(const FLAC__StreamDecoder *decoder)
 {
 	FLAC__ASSERT(0 != decoder);
@@ -926,6 +1357,45 @@ FLAC_API const void *FLAC__stream_decoder_get_client_data(FLAC__StreamDecoder *d
 	return decoder->private_->client_data;
 }
 
+FLAC_API FLAC__StreamMetadata *FLAC__stream_decoder_get_seek_index(const FLAC__StreamDecoder *decoder)
+{
+	FLAC__StreamMetadata *seek_index;
+
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != decoder->private_);
+
+	if(0 == (seek_index = FLAC__metadata_object_new(FLAC__METADATA_TYPE_SEEKTABLE)))
+		return 0;
+	if(!FLAC__metadata_object_seektable_resize_points(seek_index, decoder->private_->seek_index_length)) {
+		FLAC__metadata_object_delete(seek_index);
+		return 0;
+	}
+	if(decoder->private_->seek_index_length > 0)
+		memcpy(seek_index->data.seek_table.points, decoder->private_->seek_index, decoder->private_->seek_index_length * sizeof(FLAC__StreamMetadata_SeekPoint));
+	return seek_index;
+}
+
+FLAC_API FLAC__bool FLAC__stream_decoder_add_seek_index(FLAC__StreamDecoder *decoder, const FLAC__StreamMetadata *seek_index)
+{
+	uint32_t i;
+
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != decoder->private_);
+	FLAC__ASSERT(0 != seek_index);
+
+	if(seek_index->type != FLAC__METADATA_TYPE_SEEKTABLE)
+		return false;
+	for(i = 0; i < seek_index->data.seek_table.num_points; i++) {
+		const FLAC__StreamMetadata_SeekPoint *point = &seek_index->data.seek_table.points[i];
+		/* placeholders and points without a frame length say nothing about where a frame is */
+		if(point->sample_number == FLAC__STREAM_METADATA_SEEKPOINT_PLACEHOLDER || point->frame_samples == 0)
+			continue;
+		if(!add_seek_index_point_(decoder, point->sample_number, point->stream_offset, point->frame_samples))
+			return false;
+	}
+	return true;
+}
+
 FLAC_API FLAC__bool FLAC__stream_decoder_flush(FLAC__StreamDecoder *decoder)
 {
 	FLAC__ASSERT(0 != decoder);
@@ -956,6 +1426,18 @@ FLAC_API FLAC__bool FLAC__stream_decoder_flush(FLAC__StreamDecoder *decoder)
 	return true;
 }
 
+void FLAC__stream_decoder_set_stream_info(FLAC__StreamDecoder *decoder, const FLAC__StreamMetadata_StreamInfo *stream_info)
+{
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != stream_info);
+
+	decoder->private_->stream_info.type = FLAC__METADATA_TYPE_STREAMINFO;
+	decoder->private_->stream_info.is_last = true;
+	decoder->private_->stream_info.length = FLAC__STREAM_METADATA_STREAMINFO_LENGTH;
+	decoder->private_->stream_info.data.stream_info = *stream_info;
+	decoder->private_->has_stream_info = true;
+}
+
 void reset_decoder_internal_(FLAC__StreamDecoder* decoder) {
 	/* This code resets only the FLAC parser and decoder, not the Ogg part,
 	 * nor the input buffering etc. This is used to prepare the FLAC
@@ -1178,6 +1660,10 @@ FLAC_API FLAC__bool FLAC__stream_decoder_process_until_end_of_stream(FLAC__Strea
 					return false; /* above function sets the status for us */
 				break;
 			case FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC:
+#ifdef FLAC__USE_THREADS
+				if(decoder->protected_->num_threads > 1 && !decoder->private_->is_ogg && decoder->private_->has_stream_info)
+					return process_until_end_of_stream_threaded_(decoder);
+#endif
 				if(!frame_sync_(decoder) && decoder->protected_->state != FLAC__STREAM_DECODER_END_OF_LINK && decoder->protected_->state != FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR) {
 					return true; /* above function sets the status for us */
 				}
@@ -1230,6 +1716,41 @@ FLAC_API FLAC__bool FLAC__stream_decoder_skip_single_frame(FLAC__StreamDecoder *
 	}
 }
 
+FLAC_API FLAC__bool FLAC__stream_decoder_scan_single_frame(FLAC__StreamDecoder *decoder, FLAC__FrameHeader *header, FLAC__uint64 *offset)
+{
+	FLAC__bool ok;
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != decoder->protected_);
+
+	if(0 != header)
+		header->blocksize = 0;
+	if(0 != offset)
+		*offset = 0;
+
+	/* the frames are not decoded, so there is nothing to compare the MD5 sum with */
+	decoder->private_->do_md5_checking = false;
+
+	decoder->private_->is_scanning = true;
+	ok = scan_frame_(decoder, header, offset, /*do_full_decode=*/false);
+	decoder->private_->is_scanning = false;
+	return ok;
+}
+
+FLAC_API FLAC__bool FLAC__stream_decoder_verify_single_frame(FLAC__StreamDecoder *decoder, FLAC__FrameHeader *header)
+{
+	FLAC__bool ok;
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != decoder->protected_);
+
+	if(0 != header)
+		header->blocksize = 0;
+
+	decoder->private_->is_verifying = true;
+	ok = scan_frame_(decoder, header, /*offset=*/0, /*do_full_decode=*/true);
+	decoder->private_->is_verifying = false;
+	return ok;
+}
+
 FLAC_API FLAC__bool FLAC__stream_decoder_skip_single_link(FLAC__StreamDecoder *decoder)
 {
 #if FLAC__HAS_OGG
@@ -1334,18 +1855,95 @@ FLAC_API FLAC__bool FLAC__stream_decoder_seek_absolute(FLAC__StreamDecoder *deco
 	}
 
 	{
-		const FLAC__bool ok =
+		FLAC__bool ok;
+#ifdef HAVE_SYS_MMAN_H
+		/* the seek hops around the file, so don't let the kernel read
+		 * ahead of each hop; restore read-ahead for decoding after */
+		if(0 != decoder->private_->mapping)
+			(void)madvise(decoder->private_->mapping, decoder->private_->mapping_length, MADV_RANDOM);
+#endif
+		ok =
 #if FLAC__HAS_OGG
 			decoder->private_->is_ogg?
 			seek_to_absolute_sample_ogg_(decoder, length, sample) :
 #endif
 			seek_to_absolute_sample_(decoder, length, sample)
 		;
+#ifdef HAVE_SYS_MMAN_H
+		if(0 != decoder->private_->mapping)
+			(void)madvise(decoder->private_->mapping, decoder->private_->mapping_length, MADV_SEQUENTIAL);
+#endif
 		decoder->private_->is_seeking = false;
 		return ok;
 	}
 }
 
+FLAC_API FLAC__bool FLAC__stream_decoder_process_sample_ranges(FLAC__StreamDecoder *decoder, const FLAC__StreamDecoderSampleRange ranges[], uint32_t num_ranges, FLAC__StreamDecoderRangeWriteCallback write_callback)
+{
+	FLAC__bool got_a_frame, ok = true;
+	uint32_t i;
+
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != decoder->protected_);
+	FLAC__ASSERT(0 != ranges || num_ranges == 0);
+	FLAC__ASSERT(0 != write_callback);
+
+	if(
+		decoder->protected_->state != FLAC__STREAM_DECODER_SEARCH_FOR_METADATA &&
+		decoder->protected_->state != FLAC__STREAM_DECODER_READ_METADATA &&
+		decoder->protected_->state != FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC &&
+		decoder->protected_->state != FLAC__STREAM_DECODER_READ_FRAME &&
+		decoder->protected_->state != FLAC__STREAM_DECODER_END_OF_STREAM
+	)
+		return false;
+
+	for(i = 1; i < num_ranges; i++) {
+		if(ranges[i].sample_number < ranges[i-1].sample_number)
+			return false;
+	}
+
+	/* not every frame is decoded, so there is nothing to compare the MD5 sum with */
+	decoder->private_->do_md5_checking = false;
+
+	decoder->private_->range_write_callback = write_callback;
+	decoder->private_->ranges = ranges;
+	decoder->private_->num_ranges = num_ranges;
+	decoder->private_->next_range = 0;
+
+	while(ok && decoder->private_->next_range < num_ranges) {
+		switch(decoder->protected_->state) {
+			case FLAC__STREAM_DECODER_SEARCH_FOR_METADATA:
+				ok = find_metadata_(decoder); /* above function sets the status for us */
+				break;
+			case FLAC__STREAM_DECODER_READ_METADATA:
+				ok = read_metadata_(decoder); /* above function sets the status for us */
+				break;
+			case FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC:
+				(void)frame_sync_(decoder); /* above function sets the status for us */
+				break;
+			case FLAC__STREAM_DECODER_READ_FRAME:
+				/* read_frame_() skips the frames no range wants */
+				ok = read_frame_(decoder, &got_a_frame, /*do_full_decode=*/true); /* above function sets the status for us */
+				if(ok && decoder->private_->last_frame_is_set)
+					advance_ranges_(decoder, decoder->private_->last_frame.header.number.sample_number + decoder->private_->last_frame.header.blocksize);
+				break;
+			case FLAC__STREAM_DECODER_END_OF_STREAM:
+			case FLAC__STREAM_DECODER_END_OF_LINK:
+				/* whatever is left lies past the end */
+				decoder->private_->next_range = num_ranges;
+				break;
+			default:
+				ok = false;
+				break;
+		}
+	}
+
+	decoder->private_->range_write_callback = 0;
+	decoder->private_->ranges = 0;
+	decoder->private_->num_ranges = decoder->private_->next_range = 0;
+	return ok;
+}
+
 FLAC_API FLAC__uint64 FLAC__stream_decoder_find_total_samples(FLAC__StreamDecoder *decoder)
 {
 	if(
@@ -1539,13 +2137,23 @@ void set_defaults_(FLAC__StreamDecoder *decoder)
 	decoder->private_->write_callback = 0;
 	decoder->private_->metadata_callback = 0;
 	decoder->private_->error_callback = 0;
+	decoder->private_->interleaved_write_callback = 0;
+	decoder->private_->interleaved_format = FLAC__STREAM_DECODER_PCM_FORMAT_S16LE;
+	decoder->private_->range_write_callback = 0;
+	decoder->private_->ranges = 0;
+	decoder->private_->num_ranges = decoder->private_->next_range = 0;
 	decoder->private_->client_data = 0;
+	decoder->private_->use_mmap = false;
+	decoder->private_->build_seek_index = false;
 
 	memset(decoder->private_->metadata_filter, 0, sizeof(decoder->private_->metadata_filter));
 	decoder->private_->metadata_filter[FLAC__METADATA_TYPE_STREAMINFO] = true;
 	decoder->private_->metadata_filter_ids_count = 0;
 
 	decoder->protected_->md5_checking = false;
+	decoder->protected_->num_threads = 1;
+	decoder->protected_->thread_pool = 0;
+	decoder->protected_->fused_lpc_restore = false;
 
 #if FLAC__HAS_OGG
 	FLAC__ogg_decoder_aspect_set_defaults(&decoder->protected_->ogg_decoder_aspect);
@@ -1637,6 +2245,23 @@ FLAC__bool allocate_output_(FLAC__StreamDecoder *decoder, uint32_t size, uint32_
 	return true;
 }
 
+FLAC__bool allocate_interleaved_(FLAC__StreamDecoder *decoder, uint32_t blocksize, uint32_t channels)
+{
+	const size_t bytes = (size_t)blocksize * channels * PCM_FORMAT_BYTES_[decoder->private_->interleaved_format];
+
+	if(bytes <= decoder->private_->interleaved_capacity)
+		return true;
+
+	if(0 == (decoder->private_->interleaved = safe_realloc_(decoder->private_->interleaved, bytes))) {
+		decoder->private_->interleaved_capacity = 0;
+		decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+		return false;
+	}
+	decoder->private_->interleaved_capacity = bytes;
+
+	return true;
+}
+
 FLAC__bool has_id_filtered_(FLAC__StreamDecoder *decoder, FLAC__byte *id)
 {
 	size_t i;
@@ -2376,6 +3001,7 @@ FLAC__bool read_frame_(FLAC__StreamDecoder *decoder, FLAC__bool *got_a_frame, FL
 	uint32_t i;
 	uint32_t frame_crc; /* the one we calculate from the input stream */
 	FLAC__uint32 x;
+	FLAC__bool interleaved_packed = false;
 
 	*got_a_frame = false;
 	decoder->private_->side_subframe_in_use = false;
@@ -2390,7 +3016,36 @@ FLAC__bool read_frame_(FLAC__StreamDecoder *decoder, FLAC__bool *got_a_frame, FL
 		return false;
 	if(decoder->protected_->state == FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC) /* means we didn't sync on a valid header */
 		return true;
-	if(!allocate_output_(decoder, decoder->private_->frame.header.blocksize, decoder->private_->frame.header.channels, decoder->private_->frame.header.bits_per_sample))
+	if(decoder->private_->is_scanning || (0 != decoder->private_->range_write_callback && !frame_in_ranges_(decoder, &decoder->private_->frame.header))) {
+		/* the frame is not wanted, so skip it without decoding it */
+		if(!skip_frame_(decoder))
+			return false;
+		if(decoder->protected_->state == FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC) {
+			/* no frame sync code with a matching CRC-16 in reach */
+			send_error_to_client_(decoder, FLAC__STREAM_DECODER_ERROR_STATUS_FRAME_CRC_MISMATCH);
+			return rewind_to_last_framesync_(decoder);
+		}
+		if(decoder->protected_->state != FLAC__STREAM_DECODER_READ_FRAME && FLAC__bitreader_get_read_crc16(decoder->private_->input) != 0) {
+			/* the stream ended, but not on a frame with a matching CRC-16:
+			 * the last frame is damaged or followed by something else */
+			send_error_to_client_(decoder, FLAC__STREAM_DECODER_ERROR_STATUS_FRAME_CRC_MISMATCH);
+			return true;
+		}
+		*got_a_frame = true;
+		decoder->private_->error_has_been_sent = false;
+		/* the frame isn't written, so note it here or it would count as missing */
+		decoder->private_->last_frame.header = decoder->private_->frame.header;
+		decoder->private_->last_frame_is_set = true;
+		if(!frame_done_(decoder))
+			return false;
+		/* skip_frame_() read the sync code of the next frame already */
+		if(decoder->protected_->state == FLAC__STREAM_DECODER_READ_FRAME && !FLAC__stream_decoder_get_decode_position(decoder, &decoder->private_->last_seen_framesync))
+			decoder->private_->last_seen_framesync = 0;
+		return true;
+	}
+	if(!allocate_output_(decoder, decoder->private_->frame.header.blocksize, decoder->private_->frame.header.channels, decoder->private_->frame.header.bits_per_sample))
+		return false;
+	if(0 != decoder->private_->interleaved_write_callback && !decoder->private_->is_verifying && !allocate_interleaved_(decoder, decoder->private_->frame.header.blocksize, decoder->private_->frame.header.channels))
 		return false;
 	for(channel = 0; channel < decoder->private_->frame.header.channels; channel++) {
 		/*
@@ -2451,7 +3106,19 @@ FLAC__bool read_frame_(FLAC__StreamDecoder *decoder, FLAC__bool *got_a_frame, FL
 	}
 	if(decoder->protected_->state == FLAC__STREAM_DECODER_READ_FRAME && frame_crc == x) {
 #endif
-		if(do_full_decode) {
+		if(do_full_decode && 0 != decoder->private_->interleaved_write_callback && 0 == decoder->private_->range_write_callback && !decoder->private_->is_verifying && !decoder->private_->do_md5_checking && !decoder->private_->side_subframe_in_use) {
+			/* Undo any special channel coding while packing the samples for
+			 * the client, the MD5 sum being the only other user of the
+			 * decorrelated channels.  Check whether decoded data actually
+			 * fits bps on the way */
+			if(!pack_interleaved_(decoder, (const FLAC__int32 * const *)decoder->private_->output, decoder->private_->frame.header.channels, decoder->private_->frame.header.channel_assignment, decoder->private_->frame.header.blocksize, decoder->private_->frame.header.bits_per_sample, decoder->private_->interleaved)) {
+				/* Bad frame, emit error */
+				send_error_to_client_(decoder, FLAC__STREAM_DECODER_ERROR_STATUS_OUT_OF_BOUNDS);
+				decoder->protected_->state = FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC;
+			}
+			interleaved_packed = true;
+		}
+		else if(do_full_decode) {
 			/* Undo any special channel coding */
 			undo_channel_coding(decoder);
 			/* Check whether decoded data actually fits bps */
@@ -2502,6 +3169,7 @@ FLAC__bool read_frame_(FLAC__StreamDecoder *decoder, FLAC__bool *got_a_frame, FL
 			   decoder->private_->last_frame.header.blocksize >= 16) {
 				FLAC__Frame empty_frame;
 				FLAC__int32 * empty_buffer[FLAC__MAX_CHANNELS] = {NULL};
+				FLAC__byte *empty_interleaved = NULL;
 				empty_frame.header = decoder->private_->last_frame.header;
 				empty_frame.footer.crc = 0;
 				for(i = 0; i < empty_frame.header.channels; i++) {
@@ -2514,6 +3182,17 @@ FLAC__bool read_frame_(FLAC__StreamDecoder *decoder, FLAC__bool *got_a_frame, FL
 						return false;
 					}
 				}
+				/* silence is all zero bytes in every interleaved format, and
+				 * the interleaved buffer already holds the current frame */
+				if(0 != decoder->private_->interleaved_write_callback && !decoder->private_->is_verifying) {
+					empty_interleaved = safe_calloc_((size_t)empty_frame.header.blocksize * empty_frame.header.channels, PCM_FORMAT_BYTES_[decoder->private_->interleaved_format]);
+					if(empty_interleaved == NULL) {
+						for(i = 0; i < empty_frame.header.channels; i++)
+							free(empty_buffer[i]);
+						decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+						return false;
+					}
+				}
 				/* No repairs larger than 5 seconds or 50 frames are made, to not
 				 * unexpectedly create enormous files when one of the headers was
 				 * corrupt after all */
@@ -2537,17 +3216,19 @@ FLAC__bool read_frame_(FLAC__StreamDecoder *decoder, FLAC__bool *got_a_frame, FL
 						empty_frame.subframes[channel].wasted_bits = 0;
 					}
 
-					if(write_audio_frame_to_client_(decoder, &empty_frame, (const FLAC__int32 * const *)empty_buffer) != FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE) {
+					if(write_audio_frame_to_client_(decoder, &empty_frame, (const FLAC__int32 * const *)empty_buffer, empty_interleaved) != FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE) {
 						decoder->protected_->state = FLAC__STREAM_DECODER_ABORTED;
 						for(i = 0; i < empty_frame.header.channels; i++)
 							if(empty_buffer[i] != NULL)
 								free(empty_buffer[i]);
+						free(empty_interleaved);
 						return false;
 					}
 				}
 				for(i = 0; i < empty_frame.header.channels; i++)
 					if(empty_buffer[i] != NULL)
 						free(empty_buffer[i]);
+				free(empty_interleaved);
 
 			}
 		}
@@ -2556,68 +3237,173 @@ FLAC__bool read_frame_(FLAC__StreamDecoder *decoder, FLAC__bool *got_a_frame, FL
 	decoder->private_->error_has_been_sent = false;
 
 	if(decoder->protected_->state == FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC || decoder->protected_->state == FLAC__STREAM_DECODER_END_OF_STREAM) {
-#ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
-		decoder->private_->fuzzing_rewind_count++; /* To stop excessive rewinding, as it causes timeouts */
-#endif
-		/* Got corruption, rewind if possible. Return value of seek
-		* isn't checked, if the seek fails the decoder will continue anyway */
-		if(!FLAC__bitreader_rewind_to_after_last_seen_framesync(decoder->private_->input)){
-#ifndef NDEBUG
-			flac_fprintf(stderr, "Rewinding, seeking necessary\n");
-#endif
-			if(decoder->private_->seek_callback && decoder->private_->last_seen_framesync){
-				/* Last framesync isn't in bitreader anymore, rewind with seek if possible */
-#ifndef NDEBUG
-				FLAC__uint64 current_decode_position;
-				if(FLAC__stream_decoder_get_decode_position(decoder, &current_decode_position))
-					flac_fprintf(stderr, "Bitreader was %" PRIu64 " bytes short\n", current_decode_position-decoder->private_->last_seen_framesync);
-#endif
-				if(decoder->private_->seek_callback(decoder, decoder->private_->last_seen_framesync, decoder->private_->client_data) == FLAC__STREAM_DECODER_SEEK_STATUS_ERROR) {
-					decoder->protected_->state = FLAC__STREAM_DECODER_SEEK_ERROR;
-					return false;
-				}
-				if(!FLAC__bitreader_clear(decoder->private_->input)) {
-					decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
-					return false;
-				}
+		if(!rewind_to_last_framesync_(decoder))
+			return false;
+	}
+	else {
+		*got_a_frame = true;
+		if(!frame_done_(decoder))
+			return false;
+
+		/* write it */
+		if(do_full_decode) {
+			if(write_audio_frame_to_client_(decoder, &decoder->private_->frame, (const FLAC__int32 * const *)decoder->private_->output, interleaved_packed? decoder->private_->interleaved : 0) != FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE) {
+				decoder->protected_->state = FLAC__STREAM_DECODER_ABORTED;
+				return false;
 			}
 		}
-#ifndef NDEBUG
-		else{
-			flac_fprintf(stderr, "Rewinding, seeking not necessary\n");
+	}
+
+	decoder->protected_->state = FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC;
+	return true;
+}
+
+FLAC__bool scan_frame_(FLAC__StreamDecoder *decoder, FLAC__FrameHeader *header, FLAC__uint64 *offset, FLAC__bool do_full_decode)
+{
+	FLAC__bool got_a_frame;
+	FLAC__uint64 frame_offset;
+
+	while(1) {
+		switch(decoder->protected_->state) {
+			case FLAC__STREAM_DECODER_SEARCH_FOR_METADATA:
+			case FLAC__STREAM_DECODER_READ_METADATA:
+				return false;
+			case FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC:
+				if(!frame_sync_(decoder)) {
+					return true; /* above function sets the status for us */
+				}
+				break;
+			case FLAC__STREAM_DECODER_READ_FRAME:
+				/* last_seen_framesync is just past the two sync bytes */
+				frame_offset = decoder->private_->last_seen_framesync >= 2? decoder->private_->last_seen_framesync - 2 : 0;
+				if(!read_frame_(decoder, &got_a_frame, do_full_decode))
+					return false; /* above function sets the status for us */
+				if(got_a_frame) {
+					if(0 != header)
+						*header = decoder->private_->frame.header;
+					if(0 != offset)
+						*offset = frame_offset;
+					return true;
+				}
+				break;
+			case FLAC__STREAM_DECODER_END_OF_STREAM:
+			case FLAC__STREAM_DECODER_END_OF_LINK:
+			case FLAC__STREAM_DECODER_ABORTED:
+				return true;
+			default:
+				return false;
 		}
-#endif
 	}
-	else {
-		*got_a_frame = true;
+}
+
+/* Skips the rest of the frame whose header was just read, without
+ * decoding it.  The frame ends right before the first frame sync code
+ * at which the CRC-16 of everything read since the start of the frame
+ * checks out; the bitreader has been keeping that since read_frame_()
+ * seeded it.  Like frame_sync_(), it returns with the sync code read
+ * and the state set to FLAC__STREAM_DECODER_READ_FRAME, or with the
+ * state set to FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC if there is
+ * no such sync code within the largest size the frame can have, which
+ * means the frame is damaged.  If the stream ends first, the state is
+ * left at the end of the stream and the caller checks the CRC-16.
+ */
+FLAC__bool skip_frame_(FLAC__StreamDecoder *decoder)
+{
+	const FLAC__FrameHeader *header = &decoder->private_->frame.header;
+	/* a frame of verbatim subframes with all wasted bits is as large as
+	 * a frame gets; the frame header and footer are 18 bytes at most
+	 * and a subframe header with the wasted bits 6 more */
+	const FLAC__uint64 max_frame_size = 18 + (FLAC__uint64)header->channels * (6 + ((FLAC__uint64)header->blocksize * (header->bits_per_sample + 1) + 7) / 8);
+	uint32_t bytes_left = max_frame_size < UINT32_MAX? (uint32_t)max_frame_size : UINT32_MAX;
+	FLAC__uint32 x;
+
+	if(!FLAC__bitreader_skip_to_framesync(decoder->private_->input, &bytes_left, &x)) {
+		if(bytes_left == 0) {
+			decoder->protected_->state = FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC;
+			return true;
+		}
+		/* the last frame should end at the end of the stream */
+		return
+			decoder->protected_->state == FLAC__STREAM_DECODER_END_OF_STREAM ||
+			decoder->protected_->state == FLAC__STREAM_DECODER_END_OF_LINK;
+	}
+	decoder->private_->header_warmup[0] = 0xff;
+	decoder->private_->header_warmup[1] = (FLAC__byte)x;
+	decoder->protected_->state = FLAC__STREAM_DECODER_READ_FRAME;
+	FLAC__bitreader_set_framesync_location(decoder->private_->input);
+	return true;
+}
+
+/* Does the bookkeeping for a frame that has been read and checked in
+ * full, before it is written */
+FLAC__bool frame_done_(FLAC__StreamDecoder *decoder)
+{
 #ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
-		decoder->private_->fuzzing_rewind_count = 0;
+	decoder->private_->fuzzing_rewind_count = 0;
 #endif
 
-		/* we wait to update fixed_block_size until here, when we're sure we've got a proper frame and hence a correct blocksize */
-		if(decoder->private_->next_fixed_block_size)
-			decoder->private_->fixed_block_size = decoder->private_->next_fixed_block_size;
+	/* we wait to update fixed_block_size until here, when we're sure we've got a proper frame and hence a correct blocksize */
+	if(decoder->private_->next_fixed_block_size)
+		decoder->private_->fixed_block_size = decoder->private_->next_fixed_block_size;
 
-		/* put the latest values into the public section of the decoder instance */
-		decoder->protected_->channels = decoder->private_->frame.header.channels;
-		decoder->protected_->channel_assignment = decoder->private_->frame.header.channel_assignment;
-		decoder->protected_->bits_per_sample = decoder->private_->frame.header.bits_per_sample;
-		decoder->protected_->sample_rate = decoder->private_->frame.header.sample_rate;
-		decoder->protected_->blocksize = decoder->private_->frame.header.blocksize;
+	/* put the latest values into the public section of the decoder instance */
+	decoder->protected_->channels = decoder->private_->frame.header.channels;
+	decoder->protected_->channel_assignment = decoder->private_->frame.header.channel_assignment;
+	decoder->protected_->bits_per_sample = decoder->private_->frame.header.bits_per_sample;
+	decoder->protected_->sample_rate = decoder->private_->frame.header.sample_rate;
+	decoder->protected_->blocksize = decoder->private_->frame.header.blocksize;
 
-		FLAC__ASSERT(decoder->private_->frame.header.number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
-		decoder->private_->samples_decoded = decoder->private_->frame.header.number.sample_number + decoder->private_->frame.header.blocksize;
+	FLAC__ASSERT(decoder->private_->frame.header.number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
+	decoder->private_->samples_decoded = decoder->private_->frame.header.number.sample_number + decoder->private_->frame.header.blocksize;
 
-		/* write it */
-		if(do_full_decode) {
-			if(write_audio_frame_to_client_(decoder, &decoder->private_->frame, (const FLAC__int32 * const *)decoder->private_->output) != FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE) {
-				decoder->protected_->state = FLAC__STREAM_DECODER_ABORTED;
+	/* remember where the frame started; last_seen_framesync is just past the two sync bytes */
+	if(
+		decoder->private_->build_seek_index &&
+		decoder->private_->first_frame_offset > 0 &&
+		decoder->private_->last_seen_framesync >= decoder->private_->first_frame_offset + 2 &&
+		!add_seek_index_point_(decoder, decoder->private_->frame.header.number.sample_number, decoder->private_->last_seen_framesync - 2 - decoder->private_->first_frame_offset, decoder->private_->frame.header.blocksize)
+	) {
+		decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+		return false;
+	}
+	return true;
+}
+
+/* Goes back to right after the sync code of a frame that turned out to
+ * be damaged, to look for the next frame from there */
+FLAC__bool rewind_to_last_framesync_(FLAC__StreamDecoder *decoder)
+{
+#ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+	decoder->private_->fuzzing_rewind_count++; /* To stop excessive rewinding, as it causes timeouts */
+#endif
+	/* Got corruption, rewind if possible. Return value of seek
+	* isn't checked, if the seek fails the decoder will continue anyway */
+	if(!FLAC__bitreader_rewind_to_after_last_seen_framesync(decoder->private_->input)){
+#ifndef NDEBUG
+		flac_fprintf(stderr, "Rewinding, seeking necessary\n");
+#endif
+		if(decoder->private_->seek_callback && decoder->private_->last_seen_framesync){
+			/* Last framesync isn't in bitreader anymore, rewind with seek if possible */
+#ifndef NDEBUG
+			FLAC__uint64 current_decode_position;
+			if(FLAC__stream_decoder_get_decode_position(decoder, &current_decode_position))
+				flac_fprintf(stderr, "Bitreader was %" PRIu64 " bytes short\n", current_decode_position-decoder->private_->last_seen_framesync);
+#endif
+			if(decoder->private_->seek_callback(decoder, decoder->private_->last_seen_framesync, decoder->private_->client_data) == FLAC__STREAM_DECODER_SEEK_STATUS_ERROR) {
+				decoder->protected_->state = FLAC__STREAM_DECODER_SEEK_ERROR;
+				return false;
+			}
+			if(!FLAC__bitreader_clear(decoder->private_->input)) {
+				decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
 				return false;
 			}
 		}
 	}
-
-	decoder->protected_->state = FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC;
+#ifndef NDEBUG
+	else{
+		flac_fprintf(stderr, "Rewinding, seeking not necessary\n");
+	}
+#endif
 	return true;
 }
 
@@ -3124,7 +3910,7 @@ FLAC__bool read_subframe_fixed_(FLAC__StreamDecoder *decoder, uint32_t channel,
 	switch(subframe->entropy_coding_method.type) {
 		case FLAC__ENTROPY_CODING_METHOD_PARTITIONED_RICE:
 		case FLAC__ENTROPY_CODING_METHOD_PARTITIONED_RICE2:
-			if(!read_residual_partitioned_rice_(decoder, order, subframe->entropy_coding_method.data.partitioned_rice.order, &decoder->private_->partitioned_rice_contents[channel], decoder->private_->residual[channel], /*is_extended=*/subframe->entropy_coding_method.type == FLAC__ENTROPY_CODING_METHOD_PARTITIONED_RICE2))
+			if(!read_residual_partitioned_rice_(decoder, order, subframe->entropy_coding_method.data.partitioned_rice.order, &decoder->private_->partitioned_rice_contents[channel], decoder->private_->residual[channel], /*is_extended=*/subframe->entropy_coding_method.type == FLAC__ENTROPY_CODING_METHOD_PARTITIONED_RICE2, /*restore=*/0))
 				return false;
 			break;
 		default:
@@ -3138,9 +3924,9 @@ FLAC__bool read_subframe_fixed_(FLAC__StreamDecoder *decoder, uint32_t channel,
 			for(i = 0; i < order; i++)
 				decoder->private_->output[channel][i] = subframe->warmup[i];
 			if(bps+order <= 32)
-				FLAC__fixed_restore_signal(decoder->private_->residual[channel], decoder->private_->frame.header.blocksize-order, order, decoder->private_->output[channel]+order);
+				decoder->private_->local_fixed_restore_signal(decoder->private_->residual[channel], decoder->private_->frame.header.blocksize-order, order, decoder->private_->output[channel]+order);
 			else
-				FLAC__fixed_restore_signal_wide(decoder->private_->residual[channel], decoder->private_->frame.header.blocksize-order, order, decoder->private_->output[channel]+order);
+				decoder->private_->local_fixed_restore_signal_64bit(decoder->private_->residual[channel], decoder->private_->frame.header.blocksize-order, order, decoder->private_->output[channel]+order);
 		}
 		else {
 			decoder->private_->side_subframe_in_use = true;
@@ -3155,6 +3941,7 @@ FLAC__bool read_subframe_fixed_(FLAC__StreamDecoder *decoder, uint32_t channel,
 FLAC__bool read_subframe_lpc_(FLAC__StreamDecoder *decoder, uint32_t channel, uint32_t bps, const uint32_t order, FLAC__bool do_full_decode)
 {
 	FLAC__Subframe_LPC *subframe = &decoder->private_->frame.subframes[channel].data.lpc;
+	FLAC__StreamDecoderPartitionRestore restore;
 	FLAC__int32 i32;
 	FLAC__int64 i64;
 	FLAC__uint32 u32;
@@ -3223,11 +4010,28 @@ FLAC__bool read_subframe_lpc_(FLAC__StreamDecoder *decoder, uint32_t channel, ui
 			return true;
 	}
 
+	/* set up the restore, which is either done after reading all residual or for each partition as it is read */
+	if(do_full_decode && bps <= 32) {
+		for(u = 0; u < order; u++)
+			decoder->private_->output[channel][u] = subframe->warmup[u];
+		if(FLAC__lpc_max_residual_bps(bps, subframe->qlp_coeff, order, subframe->quantization_level) <= 32 &&
+		   FLAC__lpc_max_prediction_before_shift_bps(bps, subframe->qlp_coeff, order) <= 32)
+			restore.restore_signal = decoder->private_->local_lpc_restore_signal;
+		else
+			restore.restore_signal = decoder->private_->local_lpc_restore_signal_64bit;
+		restore.qlp_coeff = subframe->qlp_coeff;
+		restore.order = order;
+		restore.quantization_level = subframe->quantization_level;
+		restore.data = decoder->private_->output[channel]+order;
+	}
+	else
+		restore.restore_signal = 0;
+
 	/* read residual */
 	switch(subframe->entropy_coding_method.type) {
 		case FLAC__ENTROPY_CODING_METHOD_PARTITIONED_RICE:
 		case FLAC__ENTROPY_CODING_METHOD_PARTITIONED_RICE2:
-			if(!read_residual_partitioned_rice_(decoder, order, subframe->entropy_coding_method.data.partitioned_rice.order, &decoder->private_->partitioned_rice_contents[channel], decoder->private_->residual[channel], /*is_extended=*/subframe->entropy_coding_method.type == FLAC__ENTROPY_CODING_METHOD_PARTITIONED_RICE2))
+			if(!read_residual_partitioned_rice_(decoder, order, subframe->entropy_coding_method.data.partitioned_rice.order, &decoder->private_->partitioned_rice_contents[channel], decoder->private_->residual[channel], /*is_extended=*/subframe->entropy_coding_method.type == FLAC__ENTROPY_CODING_METHOD_PARTITIONED_RICE2, /*restore=*/(restore.restore_signal != 0 && decoder->protected_->fused_lpc_restore)? &restore : 0))
 				return false;
 			break;
 		default:
@@ -3237,14 +4041,8 @@ FLAC__bool read_subframe_lpc_(FLAC__StreamDecoder *decoder, uint32_t channel, ui
 	/* decode the subframe */
 	if(do_full_decode) {
 		if(bps <= 32) {
-			uint32_t i;
-			for(i = 0; i < order; i++)
-				decoder->private_->output[channel][i] = subframe->warmup[i];
-			if(FLAC__lpc_max_residual_bps(bps, subframe->qlp_coeff, order, subframe->quantization_level) <= 32 &&
-			   FLAC__lpc_max_prediction_before_shift_bps(bps, subframe->qlp_coeff, order) <= 32)
-				FLAC__lpc_restore_signal(decoder->private_->residual[channel], decoder->private_->frame.header.blocksize-order, subframe->qlp_coeff, order, subframe->quantization_level, decoder->private_->output[channel]+order);
-			else
-				FLAC__lpc_restore_signal_wide(decoder->private_->residual[channel], decoder->private_->frame.header.blocksize-order, subframe->qlp_coeff, order, subframe->quantization_level, decoder->private_->output[channel]+order);
+			if(!decoder->protected_->fused_lpc_restore)
+				restore.restore_signal(decoder->private_->residual[channel], decoder->private_->frame.header.blocksize-order, subframe->qlp_coeff, order, subframe->quantization_level, decoder->private_->output[channel]+order);
 		}
 		else {
 			decoder->private_->side_subframe_in_use = true;
@@ -3296,11 +4094,30 @@ FLAC__bool read_subframe_verbatim_(FLAC__StreamDecoder *decoder, uint32_t channe
 	return true;
 }
 
-FLAC__bool read_residual_partitioned_rice_(FLAC__StreamDecoder *decoder, uint32_t predictor_order, uint32_t partition_order, FLAC__EntropyCodingMethod_PartitionedRiceContents *partitioned_rice_contents, FLAC__int32 *residual, FLAC__bool is_extended)
+/* Partitions with a small parameter, as in quiet or very predictable
+ * material, are decoded several codewords at a time through a lookup
+ * table; the rest go to the regular (possibly CPU-specific) routine. */
+FLAC__bool read_rice_signed_block_(FLAC__StreamDecoder *decoder, FLAC__int32 *residual, uint32_t nvals, uint32_t parameter)
+{
+	if(parameter <= FLAC__BITREADER_RICE_TABLE_MAX_PARAMETER && nvals >= FLAC__BITREADER_RICE_TABLE_MIN_VALUES) {
+		FLAC__BitReaderRiceTableEntry **table = &decoder->private_->rice_table[parameter];
+		if(0 == *table) {
+			if(0 == (*table = safe_malloc_mul_2op_p(sizeof(**table), /*times*/(size_t)1 << FLAC__BITREADER_RICE_TABLE_BITS))) {
+				decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+				return false;
+			}
+			FLAC__bitreader_build_rice_table(*table, parameter);
+		}
+		return FLAC__bitreader_read_rice_signed_block_table(decoder->private_->input, residual, nvals, parameter, *table);
+	}
+	return decoder->private_->local_bitreader_read_rice_signed_block(decoder->private_->input, residual, nvals, parameter);
+}
+
+FLAC__bool read_residual_partitioned_rice_(FLAC__StreamDecoder *decoder, uint32_t predictor_order, uint32_t partition_order, FLAC__EntropyCodingMethod_PartitionedRiceContents *partitioned_rice_contents, FLAC__int32 *residual, FLAC__bool is_extended, const FLAC__StreamDecoderPartitionRestore *restore)
 {
 	FLAC__uint32 rice_parameter;
 	int i;
-	uint32_t partition, sample, u;
+	uint32_t partition, sample, restored, u;
 	const uint32_t partitions = 1u << partition_order;
 	const uint32_t partition_samples = decoder->private_->frame.header.blocksize >> partition_order;
 	const uint32_t plen = is_extended? FLAC__ENTROPY_CODING_METHOD_PARTITIONED_RICE2_PARAMETER_LEN : FLAC__ENTROPY_CODING_METHOD_PARTITIONED_RICE_PARAMETER_LEN;
@@ -3314,7 +4131,7 @@ FLAC__bool read_residual_partitioned_rice_(FLAC__StreamDecoder *decoder, uint32_
 		return false;
 	}
 
-	sample = 0;
+	sample = restored = 0;
 	for(partition = 0; partition < partitions; partition++) {
 		if(!FLAC__bitreader_read_raw_uint32(decoder->private_->input, &rice_parameter, plen))
 			return false; /* read_callback_ sets the state for us */
@@ -3322,7 +4139,7 @@ FLAC__bool read_residual_partitioned_rice_(FLAC__StreamDecoder *decoder, uint32_
 		if(rice_parameter < pesc) {
 			partitioned_rice_contents->raw_bits[partition] = 0;
 			u = (partition == 0) ? partition_samples - predictor_order : partition_samples;
-			if(!decoder->private_->local_bitreader_read_rice_signed_block(decoder->private_->input, residual + sample, u, rice_parameter)){
+			if(!read_rice_signed_block_(decoder, residual + sample, u, rice_parameter)){
 				if(decoder->protected_->state == FLAC__STREAM_DECODER_READ_FRAME) {
 					/* no error was set, read_callback_ didn't set it, so
 					 * invalid rice symbol was found */
@@ -3351,6 +4168,11 @@ FLAC__bool read_residual_partitioned_rice_(FLAC__StreamDecoder *decoder, uint32_
 				}
 			}
 		}
+		/* small partitions are gathered, so the restore routine gets enough samples to work on */
+		if(0 != restore && (sample - restored >= 512 || partition + 1 == partitions)) {
+			restore->restore_signal(residual + restored, sample - restored, restore->qlp_coeff, restore->order, restore->quantization_level, restore->data + restored);
+			restored = sample;
+		}
 	}
 
 	return true;
@@ -3525,6 +4347,100 @@ void undo_channel_coding(FLAC__StreamDecoder *decoder) {
 	}
 }
 
+/* Does what undo_channel_coding() does, but instead of writing the
+ * channels back to buffer[], converts the samples to the format the
+ * client asked for and stores them interleaved in out.  Returns false
+ * if a decoded sample does not fit in bps bits.
+ */
+#if defined(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION) && !defined(FUZZING_BUILD_MODE_FLAC_SANITIZE_SIGNED_INTEGER_OVERFLOW)
+/* See undo_channel_coding() as to why */
+__attribute__((no_sanitize("signed-integer-overflow")))
+#endif
+FLAC__bool pack_interleaved_(const FLAC__StreamDecoder *decoder, const FLAC__int32 * const buffer[], uint32_t channels, FLAC__ChannelAssignment channel_assignment, uint32_t blocksize, uint32_t bps, FLAC__byte out[])
+{
+	const FLAC__StreamDecoderPCMFormat format = decoder->private_->interleaved_format;
+	const uint32_t width = format == FLAC__STREAM_DECODER_PCM_FORMAT_S16LE? 16 : format == FLAC__STREAM_DECODER_PCM_FORMAT_S24LE? 24 : 32;
+	const uint32_t left_shift = bps < width? width - bps : 0;
+	const uint32_t right_shift = bps > width? bps - width : 0;
+	const FLAC__int32 lower_limit = INT32_MIN >> (32 - bps);
+	const FLAC__int32 upper_limit = INT32_MAX >> (32 - bps);
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+	const float scale = 1.0f / (float)(1u << (bps - 1));
+#endif
+	FLAC__bool in_bounds = true;
+	uint32_t i = 0, channel;
+
+	FLAC__ASSERT(channels == 2 || channel_assignment == FLAC__CHANNEL_ASSIGNMENT_INDEPENDENT);
+
+	if(channels == 2 && 0 != decoder->private_->local_pack_interleaved_stereo) {
+		i = blocksize & ~7u;
+		in_bounds = decoder->private_->local_pack_interleaved_stereo(buffer, channel_assignment, i, bps, format, out);
+		out += (size_t)i * 2 * PCM_FORMAT_BYTES_[format];
+	}
+
+	for( ; i < blocksize; i++) {
+		FLAC__int32 sample[FLAC__MAX_CHANNELS];
+		for(channel = 0; channel < channels; channel++)
+			sample[channel] = buffer[channel][i];
+		switch(channel_assignment) {
+			case FLAC__CHANNEL_ASSIGNMENT_LEFT_SIDE:
+				sample[1] = sample[0] - sample[1];
+				break;
+			case FLAC__CHANNEL_ASSIGNMENT_RIGHT_SIDE:
+				sample[0] += sample[1];
+				break;
+			case FLAC__CHANNEL_ASSIGNMENT_MID_SIDE: {
+				FLAC__int32 mid = sample[0], side = sample[1];
+				mid = ((uint32_t) mid) << 1;
+				mid |= (side & 1); /* i.e. if 'side' is odd... */
+				sample[0] = (mid + side) >> 1;
+				sample[1] = (mid - side) >> 1;
+				break;
+			}
+			default:
+				break;
+		}
+		for(channel = 0; channel < channels; channel++) {
+			const FLAC__int32 x = (FLAC__int32)((FLAC__uint32)sample[channel] << left_shift) >> right_shift;
+			if(sample[channel] < lower_limit || sample[channel] > upper_limit)
+				in_bounds = false;
+			switch(format) {
+				case FLAC__STREAM_DECODER_PCM_FORMAT_S16LE:
+					out[0] = (FLAC__byte)x;
+					out[1] = (FLAC__byte)(x >> 8);
+					out += 2;
+					break;
+				case FLAC__STREAM_DECODER_PCM_FORMAT_S24LE:
+					out[0] = (FLAC__byte)x;
+					out[1] = (FLAC__byte)(x >> 8);
+					out[2] = (FLAC__byte)(x >> 16);
+					out += 3;
+					break;
+				case FLAC__STREAM_DECODER_PCM_FORMAT_S32LE:
+					out[0] = (FLAC__byte)x;
+					out[1] = (FLAC__byte)(x >> 8);
+					out[2] = (FLAC__byte)(x >> 16);
+					out[3] = (FLAC__byte)(x >> 24);
+					out += 4;
+					break;
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+				case FLAC__STREAM_DECODER_PCM_FORMAT_FLOAT32: {
+					const float f = (float)sample[channel] * scale;
+					memcpy(out, &f, sizeof(f));
+					out += 4;
+					break;
+				}
+#endif
+				default:
+					FLAC__ASSERT(0);
+					break;
+			}
+		}
+	}
+
+	return in_bounds;
+}
+
 #if FLAC__HAS_OGG
 FLAC__StreamDecoderReadStatus read_callback_ogg_aspect_(const FLAC__StreamDecoder *decoder, FLAC__byte buffer[], size_t *bytes)
 {
@@ -3575,7 +4491,12 @@ FLAC__OggDecoderAspectReadStatus read_callback_proxy_(const void *void_decoder,
 }
 #endif
 
-FLAC__StreamDecoderWriteStatus write_audio_frame_to_client_(FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[])
+/* If the client asked for interleaved output, interleaved is either 0 or
+ * the samples of buffer[] already packed by read_frame_(), with the
+ * channel coding undone in the process.  buffer[] is then undecorrelated,
+ * so it may only be used when interleaved is 0.
+ */
+FLAC__StreamDecoderWriteStatus write_audio_frame_to_client_(FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], const FLAC__byte *interleaved)
 {
 	decoder->private_->last_frame = *frame; /* save the frame */
 	decoder->private_->last_frame_is_set = true;
@@ -3604,12 +4525,14 @@ FLAC__StreamDecoderWriteStatus write_audio_frame_to_client_(FLAC__StreamDecoder
 				}
 				decoder->private_->last_frame.header.blocksize -= delta;
 				decoder->private_->last_frame.header.number.sample_number += (FLAC__uint64)delta;
+				if(0 != interleaved)
+					interleaved += (size_t)delta * frame->header.channels * PCM_FORMAT_BYTES_[decoder->private_->interleaved_format];
 				/* write the relevant samples */
-				return decoder->private_->write_callback(decoder, &decoder->private_->last_frame, newbuffer, decoder->private_->client_data);
+				return call_write_callback_(decoder, &decoder->private_->last_frame, newbuffer, interleaved);
 			}
 			else {
 				/* write the relevant samples */
-				return decoder->private_->write_callback(decoder, frame, buffer, decoder->private_->client_data);
+				return call_write_callback_(decoder, frame, buffer, interleaved);
 			}
 		}
 		else {
@@ -3627,13 +4550,90 @@ FLAC__StreamDecoderWriteStatus write_audio_frame_to_client_(FLAC__StreamDecoder
 			if(!FLAC__MD5Accumulate(&decoder->private_->md5context, buffer, frame->header.channels, frame->header.blocksize, (frame->header.bits_per_sample+7) / 8))
 				return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
 		}
-		return decoder->private_->write_callback(decoder, frame, buffer, decoder->private_->client_data);
+		/* when verifying, the MD5 sum is the only user of the samples */
+		if(decoder->private_->is_verifying)
+			return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+		return call_write_callback_(decoder, frame, buffer, interleaved);
 	}
 	else { /* decoder->private_->is_indexing == true */
 		return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
 	}
 }
 
+FLAC__StreamDecoderWriteStatus call_write_callback_(FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], const FLAC__byte *interleaved)
+{
+	if(0 != decoder->private_->range_write_callback)
+		return write_ranges_(decoder, frame, buffer);
+
+	if(0 == decoder->private_->interleaved_write_callback)
+		return decoder->private_->write_callback(decoder, frame, buffer, decoder->private_->client_data);
+
+	if(0 == interleaved) {
+		/* the channel coding has been undone already, the buffer has been
+		 * allocated by read_frame_() or deliver_frame_() */
+		FLAC__ASSERT(decoder->private_->interleaved_capacity >= (size_t)frame->header.blocksize * frame->header.channels * PCM_FORMAT_BYTES_[decoder->private_->interleaved_format]);
+		pack_interleaved_(decoder, buffer, frame->header.channels, FLAC__CHANNEL_ASSIGNMENT_INDEPENDENT, frame->header.blocksize, frame->header.bits_per_sample, decoder->private_->interleaved);
+		interleaved = decoder->private_->interleaved;
+	}
+	return decoder->private_->interleaved_write_callback(decoder, frame, interleaved, (size_t)frame->header.blocksize * frame->header.channels * PCM_FORMAT_BYTES_[decoder->private_->interleaved_format], decoder->private_->client_data);
+}
+
+/* Moves next_range past the ranges that end at or before sample_number */
+void advance_ranges_(FLAC__StreamDecoder *decoder, FLAC__uint64 sample_number)
+{
+	const FLAC__StreamDecoderSampleRange *ranges = decoder->private_->ranges;
+	uint32_t i = decoder->private_->next_range;
+
+	while(i < decoder->private_->num_ranges && ranges[i].sample_number <= sample_number && ranges[i].samples <= sample_number - ranges[i].sample_number)
+		i++;
+	decoder->private_->next_range = i;
+}
+
+FLAC__bool frame_in_ranges_(FLAC__StreamDecoder *decoder, const FLAC__FrameHeader *header)
+{
+	const FLAC__StreamDecoderSampleRange *ranges = decoder->private_->ranges;
+	const FLAC__uint64 first = header->number.sample_number, end = first + header->blocksize;
+	uint32_t i;
+
+	FLAC__ASSERT(header->number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
+
+	advance_ranges_(decoder, first);
+	/* the ranges are sorted by where they start but may overlap, so any
+	 * of them up to the end of the frame can overlap it */
+	for(i = decoder->private_->next_range; i < decoder->private_->num_ranges && ranges[i].sample_number < end; i++) {
+		if(ranges[i].sample_number >= first? ranges[i].samples > 0 : ranges[i].samples > first - ranges[i].sample_number)
+			return true;
+	}
+	return false;
+}
+
+FLAC__StreamDecoderWriteStatus write_ranges_(FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[])
+{
+	const FLAC__StreamDecoderSampleRange *ranges = decoder->private_->ranges;
+	const FLAC__uint64 first = frame->header.number.sample_number, end = first + frame->header.blocksize;
+	const FLAC__int32 *range_buffer[FLAC__MAX_CHANNELS];
+	uint32_t i, channel;
+
+	FLAC__ASSERT(frame->header.number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
+
+	for(i = decoder->private_->next_range; i < decoder->private_->num_ranges && ranges[i].sample_number < end; i++) {
+		FLAC__uint64 from = first, to = end;
+		FLAC__StreamDecoderWriteStatus status;
+		if(ranges[i].sample_number > from)
+			from = ranges[i].sample_number;
+		if(ranges[i].samples < to - ranges[i].sample_number)
+			to = ranges[i].sample_number + ranges[i].samples;
+		if(from >= to)
+			continue;
+		for(channel = 0; channel < frame->header.channels; channel++)
+			range_buffer[channel] = buffer[channel] + (from - first);
+		status = decoder->private_->range_write_callback(decoder, i, from, (uint32_t)(to - from), range_buffer, decoder->private_->client_data);
+		if(status != FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE)
+			return status;
+	}
+	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
 void send_error_to_client_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status)
 {
 	if(!decoder->private_->is_seeking) {
@@ -3644,6 +4644,42 @@ void send_error_to_client_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecod
 		decoder->private_->unparseable_frame_count++;
 }
 
+FLAC__bool add_seek_index_point_(FLAC__StreamDecoder *decoder, FLAC__uint64 sample_number, FLAC__uint64 stream_offset, uint32_t frame_samples)
+{
+	FLAC__StreamMetadata_SeekPoint *seek_index = decoder->private_->seek_index;
+	uint32_t length = decoder->private_->seek_index_length, lo = length;
+
+	/* frames mostly come in order, so only search when this one isn't past the last */
+	if(length > 0 && seek_index[length-1].sample_number >= sample_number) {
+		uint32_t hi = length;
+		lo = 0;
+		while(lo < hi) {
+			const uint32_t mid = lo + (hi - lo) / 2;
+			if(seek_index[mid].sample_number < sample_number)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if(seek_index[lo].sample_number == sample_number)
+			return true;
+	}
+
+	if(length == decoder->private_->seek_index_capacity) {
+		const uint32_t capacity = length > 0 ? length * 2 : 64;
+		if(capacity <= length || 0 == (seek_index = safe_realloc_mul_2op_(seek_index, capacity, /*times*/sizeof(FLAC__StreamMetadata_SeekPoint))))
+			return false;
+		decoder->private_->seek_index = seek_index;
+		decoder->private_->seek_index_capacity = capacity;
+	}
+
+	memmove(seek_index + lo + 1, seek_index + lo, (length - lo) * sizeof(FLAC__StreamMetadata_SeekPoint));
+	seek_index[lo].sample_number = sample_number;
+	seek_index[lo].stream_offset = stream_offset;
+	seek_index[lo].frame_samples = frame_samples;
+	decoder->private_->seek_index_length++;
+	return true;
+}
+
 FLAC__bool seek_to_absolute_sample_(FLAC__StreamDecoder *decoder, FLAC__uint64 stream_length, FLAC__uint64 target_sample)
 {
 	FLAC__uint64 first_frame_offset = decoder->private_->first_frame_offset, lower_bound, upper_bound, lower_bound_sample, upper_bound_sample, this_frame_sample;
@@ -3760,6 +4796,52 @@ FLAC__bool seek_to_absolute_sample_(FLAC__StreamDecoder *decoder, FLAC__uint64 s
 		}
 	}
 
+	/*
+	 * Then we narrow them down further with the frames in the seek
+	 * index, if any.  These are exact frame boundaries, so if the
+	 * target sample is in an indexed frame we can go straight there.
+	 * Points outside the current bounds are ignored, which also
+	 * protects against an index that was made for another stream.
+	 */
+	if(decoder->private_->seek_index_length > 0 && upper_bound > first_frame_offset) {
+		const FLAC__StreamMetadata_SeekPoint *seek_index = decoder->private_->seek_index;
+		const FLAC__uint64 max_offset = upper_bound - first_frame_offset;
+		uint32_t lo = 0, hi = decoder->private_->seek_index_length;
+
+		/* find the first frame that starts after target_sample */
+		while(lo < hi) {
+			const uint32_t mid = lo + (hi - lo) / 2;
+			if(seek_index[mid].sample_number <= target_sample)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if(lo > 0) {
+			const FLAC__StreamMetadata_SeekPoint *point = &seek_index[lo-1];
+			if(
+				point->sample_number >= lower_bound_sample &&
+				point->stream_offset < max_offset &&
+				first_frame_offset + point->stream_offset >= lower_bound
+			) {
+				lower_bound = first_frame_offset + point->stream_offset;
+				lower_bound_sample = point->sample_number;
+				if(target_sample - point->sample_number < point->frame_samples)
+					seek_from_lower_bound = true;
+			}
+		}
+		if(lo < decoder->private_->seek_index_length) {
+			const FLAC__StreamMetadata_SeekPoint *point = &seek_index[lo];
+			if(
+				(total_samples == 0 || point->sample_number <= upper_bound_sample) &&
+				point->stream_offset < max_offset &&
+				first_frame_offset + point->stream_offset > lower_bound
+			) {
+				upper_bound = first_frame_offset + point->stream_offset;
+				upper_bound_sample = point->sample_number;
+			}
+		}
+	}
+
 #ifndef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
 	FLAC__ASSERT(upper_bound_sample >= lower_bound_sample);
 #endif
@@ -4168,3 +5250,816 @@ FLAC__bool file_eof_callback_(const FLAC__StreamDecoder *decoder, void *client_d
 
 	return feof(decoder->private_->file)? true : false;
 }
+
+#ifdef HAVE_SYS_MMAN_H
+/* Maps decoder->private_->file into memory and sets it up to be decoded
+ * like a buffer given to FLAC__stream_decoder_init_memory(), from the
+ * current position of the file on.  Returns false if the file cannot be
+ * mapped, e.g. because it is a pipe, in which case it is read with stdio
+ * instead. */
+FLAC__bool map_file_(FLAC__StreamDecoder *decoder)
+{
+	struct flac_stat_s filestats;
+	FLAC__off_t position;
+	void *mapping;
+	const int fd = fileno(decoder->private_->file);
+
+	if(flac_fstat(fd, &filestats) != 0 || !S_ISREG(filestats.st_mode) || filestats.st_size <= 0)
+		return false;
+	if((FLAC__uint64)filestats.st_size > (FLAC__uint64)SIZE_MAX)
+		return false;
+	if((position = ftello(decoder->private_->file)) < 0 || position > filestats.st_size)
+		return false;
+	mapping = mmap(0, (size_t)filestats.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(mapping == MAP_FAILED)
+		return false;
+	(void)madvise(mapping, (size_t)filestats.st_size, MADV_SEQUENTIAL);
+
+	decoder->private_->mapping = mapping;
+	decoder->private_->mapping_length = (size_t)filestats.st_size;
+	decoder->private_->memory = mapping;
+	decoder->private_->memory_length = (size_t)filestats.st_size;
+	decoder->private_->memory_position = (size_t)position;
+	return true;
+}
+
+void unmap_file_(FLAC__StreamDecoder *decoder)
+{
+	if(0 != decoder->private_->mapping) {
+		munmap(decoder->private_->mapping, decoder->private_->mapping_length);
+		decoder->private_->mapping = 0;
+		decoder->private_->memory = 0;
+	}
+}
+#endif
+
+FLAC__StreamDecoderReadStatus memory_read_callback_(const FLAC__StreamDecoder *decoder, FLAC__byte buffer[], size_t *bytes, void *client_data)
+{
+	const size_t left = decoder->private_->memory_length - decoder->private_->memory_position;
+	(void)client_data;
+
+	if(*bytes > 0) {
+		if(*bytes > left)
+			*bytes = left;
+		if(*bytes == 0)
+			return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+		memcpy(buffer, decoder->private_->memory + decoder->private_->memory_position, *bytes);
+		decoder->private_->memory_position += *bytes;
+		return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+	}
+	else
+		return FLAC__STREAM_DECODER_READ_STATUS_ABORT; /* abort to avoid a deadlock */
+}
+
+FLAC__StreamDecoderSeekStatus memory_seek_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 absolute_byte_offset, void *client_data)
+{
+	(void)client_data;
+
+	if(absolute_byte_offset > decoder->private_->memory_length)
+		return FLAC__STREAM_DECODER_SEEK_STATUS_ERROR;
+	decoder->private_->memory_position = (size_t)absolute_byte_offset;
+	return FLAC__STREAM_DECODER_SEEK_STATUS_OK;
+}
+
+FLAC__StreamDecoderTellStatus memory_tell_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 *absolute_byte_offset, void *client_data)
+{
+	(void)client_data;
+
+	*absolute_byte_offset = decoder->private_->memory_position;
+	return FLAC__STREAM_DECODER_TELL_STATUS_OK;
+}
+
+FLAC__StreamDecoderLengthStatus memory_length_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 *stream_length, void *client_data)
+{
+	(void)client_data;
+
+	*stream_length = decoder->private_->memory_length;
+	return FLAC__STREAM_DECODER_LENGTH_STATUS_OK;
+}
+
+FLAC__bool memory_eof_callback_(const FLAC__StreamDecoder *decoder, void *client_data)
+{
+	(void)client_data;
+
+	return decoder->private_->memory_position >= decoder->private_->memory_length;
+}
+
+#ifdef FLAC__USE_THREADS
+/*
+ * Multithreaded decoding works as follows: the calling thread reads the
+ * stream ahead, splits it at frame headers and queues each frame as a
+ * threadtask, which a worker thread decodes with the private decoder of
+ * that threadtask.  The calling thread then passes the decoded frames to
+ * the client in stream order.
+ *
+ * A frame header is only taken as a split point when its CRC-8 checks
+ * out and its sample number follows on the frame before it, but that is
+ * still a guess: a threadtask only counts when its decoder found exactly
+ * one frame, with a matching CRC-16, that spans all of its data.  When
+ * that is not the case, or when the data does not start with a frame
+ * header in the first place, threadtask[0] decodes from that point on
+ * in the calling thread, reading straight from the read-ahead buffer and
+ * passing on frames and errors as it goes, just like single-threaded
+ * decoding would have done.
+ */
+FLAC__bool process_until_end_of_stream_threaded_(FLAC__StreamDecoder *decoder)
+{
+	FLAC__StreamDecoderThreadTask *task;
+	FLAC__uint64 cut, scan, end, sample_number, next_sample_number = 0, candidate_sample_number;
+	uint32_t blocksize, candidate_blocksize, num_slots, first = 1, num_pending = 0, t;
+	FLAC__bool have_next_sample_number, single_threaded = false, end_of_stream = false, ok = true;
+	int ret;
+
+	FLAC__ASSERT(decoder->protected_->state == FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC);
+
+	/* make sure we're byte aligned */
+	if(!FLAC__bitreader_is_consumed_byte_aligned(decoder->private_->input)) {
+		FLAC__uint32 x;
+		if(!FLAC__bitreader_read_raw_uint32(decoder->private_->input, &x, FLAC__bitreader_bits_left_for_byte_alignment(decoder->private_->input)))
+			return decoder->protected_->state == FLAC__STREAM_DECODER_END_OF_STREAM; /* read_callback_ sets the state for us */
+	}
+
+	if(!start_threads_(decoder)) {
+		decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+		return false;
+	}
+	num_slots = decoder->private_->num_threadtasks - 1;
+
+	/* stream positions are kept as absolute byte offsets when known */
+	if(FLAC__stream_decoder_get_decode_position(decoder, &cut) && cut > 0) {
+		if(decoder->private_->cached)
+			cut--;
+		decoder->private_->read_ahead_offset = decoder->private_->read_ahead_position = cut;
+	}
+	else
+		cut = 0;
+
+	/* move whatever the bitreader has buffered to the read-ahead buffer */
+	{
+		const uint32_t bytes = FLAC__bitreader_get_input_bits_unconsumed(decoder->private_->input) / 8;
+		if(!reserve_read_ahead_(decoder, bytes + 1)) {
+			stop_threads_(decoder);
+			decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+			return false;
+		}
+		if(decoder->private_->cached) {
+			decoder->private_->read_ahead[decoder->private_->read_ahead_len++] = decoder->private_->lookahead;
+			decoder->private_->cached = false;
+		}
+		if(bytes > 0 && !FLAC__bitreader_read_byte_block_aligned_no_crc(decoder->private_->input, decoder->private_->read_ahead + decoder->private_->read_ahead_len, bytes)) {
+			stop_threads_(decoder);
+			return false; /* read_callback_ sets the state for us */
+		}
+		decoder->private_->read_ahead_len += bytes;
+		if(!FLAC__bitreader_clear(decoder->private_->input)) {
+			stop_threads_(decoder);
+			decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+			return false;
+		}
+	}
+
+	have_next_sample_number = next_sample_number_after_last_frame_(decoder, &next_sample_number);
+
+	while(ok) {
+		/* Pass on the oldest frame when all threadtasks are in use, or when
+		 * everything queued has to be written before going on */
+		if(num_pending > 0 && (num_pending == num_slots || single_threaded || end_of_stream)) {
+			task = &decoder->private_->threadtask[first];
+			wait_for_threadtask_(decoder, task);
+			if(task->frame_is_clean) {
+				ok = deliver_frame_(decoder, task->decoder, task->frame, task->buffer);
+				task->state = THREADTASK_IDLE;
+				first = first % num_slots + 1;
+				num_pending--;
+				discard_read_ahead_(decoder, num_pending > 0 ? decoder->private_->threadtask[first].stream_offset : cut);
+			}
+			else {
+				/* The frame did not end where the next frame header was
+				 * found, so everything queued after it is of no use */
+				cut = task->stream_offset;
+				FLAC__mtx_lock(&decoder->private_->mutex_work_queue);
+				for(t = 0; t < num_pending; t++) {
+					task = &decoder->private_->threadtask[(first - 1 + t) % num_slots + 1];
+					while(task->state == THREADTASK_RUNNING)
+						FLAC__cnd_wait(&decoder->private_->cond_task_done, &decoder->private_->mutex_work_queue);
+					task->state = THREADTASK_IDLE;
+				}
+				FLAC__mtx_unlock(&decoder->private_->mutex_work_queue);
+				num_pending = 0;
+				single_threaded = true;
+				end_of_stream = false;
+			}
+			continue;
+		}
+
+		if(single_threaded) {
+			if(!decode_single_threaded_(decoder, &cut)) {
+				ok = false;
+				break;
+			}
+			if(decoder->private_->threadtask[0].decoder->protected_->state == FLAC__STREAM_DECODER_END_OF_STREAM)
+				end_of_stream = true;
+			single_threaded = false;
+			have_next_sample_number = next_sample_number_after_last_frame_(decoder, &next_sample_number);
+			continue;
+		}
+
+		if(end_of_stream)
+			break;
+
+		/* check for a frame header at the current position */
+		ret = parse_raw_frame_header_(decoder, decoder->private_->read_ahead + (size_t)(cut - decoder->private_->read_ahead_offset), (size_t)(decoder->private_->read_ahead_offset + decoder->private_->read_ahead_len - cut), &sample_number, &blocksize);
+		if(ret < 0) {
+			if(!decoder->private_->read_ahead_eof)
+				ok = read_ahead_(decoder);
+			else if(cut == decoder->private_->read_ahead_offset + decoder->private_->read_ahead_len)
+				end_of_stream = true;
+			else
+				single_threaded = true;
+			continue;
+		}
+		if(ret == 0 || (have_next_sample_number && sample_number != next_sample_number)) {
+			single_threaded = true;
+			continue;
+		}
+
+		/* find the header of the frame after it */
+		scan = cut + 1;
+		end = 0;
+		while(1) {
+			const FLAC__byte *raw = decoder->private_->read_ahead + (size_t)(scan - decoder->private_->read_ahead_offset), *sync;
+			const size_t bytes = (size_t)(decoder->private_->read_ahead_offset + decoder->private_->read_ahead_len - scan);
+
+			if(scan - cut > THREAD_MAX_FRAME_SIZE_)
+				break;
+			sync = bytes > 0 ? memchr(raw, 0xff, bytes) : 0;
+			if(0 == sync) {
+				scan += bytes;
+				if(decoder->private_->read_ahead_eof) {
+					end = scan;
+					break;
+				}
+				if(!(ok = read_ahead_(decoder)))
+					break;
+				continue;
+			}
+			scan += (FLAC__uint64)(sync - raw);
+			ret = parse_raw_frame_header_(decoder, sync, (size_t)(decoder->private_->read_ahead_offset + decoder->private_->read_ahead_len - scan), &candidate_sample_number, &candidate_blocksize);
+			if(ret < 0 && !decoder->private_->read_ahead_eof) {
+				if(!(ok = read_ahead_(decoder)))
+					break;
+				continue;
+			}
+			/* frames may be missing in between, but not too many */
+			if(ret > 0 && candidate_sample_number >= sample_number + blocksize && candidate_sample_number - (sample_number + blocksize) <= (FLAC__uint64)blocksize * 64) {
+				end = scan;
+				break;
+			}
+			scan++;
+		}
+		if(!ok)
+			break;
+		if(end == 0) {
+			single_threaded = true;
+			continue;
+		}
+
+		/* queue the frame */
+		task = &decoder->private_->threadtask[(first - 1 + num_pending) % num_slots + 1];
+		FLAC__ASSERT(task->state == THREADTASK_IDLE);
+		if(!prepare_threadtask_(decoder, task)) {
+			ok = false;
+			break;
+		}
+		if(task->data_capacity < end - cut) {
+			if(0 == (task->data = safe_realloc_(task->data, (size_t)(end - cut)))) {
+				task->data_capacity = 0;
+				decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+				ok = false;
+				break;
+			}
+			task->data_capacity = (size_t)(end - cut);
+		}
+		memcpy(task->data, decoder->private_->read_ahead + (size_t)(cut - decoder->private_->read_ahead_offset), (size_t)(end - cut));
+		task->data_len = (size_t)(end - cut);
+		task->stream_offset = cut;
+		FLAC__mtx_lock(&decoder->private_->mutex_work_queue);
+		task->state = THREADTASK_QUEUED;
+		FLAC__cnd_signal(&decoder->private_->cond_work_available);
+		FLAC__mtx_unlock(&decoder->private_->mutex_work_queue);
+		if(0 != decoder->protected_->thread_pool)
+			FLAC__thread_pool_submit(&decoder->private_->thread_pool_client);
+		num_pending++;
+
+		cut = end;
+		have_next_sample_number = true;
+		next_sample_number = sample_number + blocksize;
+	}
+
+	stop_threads_(decoder);
+	if(ok)
+		decoder->protected_->state = FLAC__STREAM_DECODER_END_OF_STREAM;
+	return ok;
+}
+
+FLAC__bool start_threads_(FLAC__StreamDecoder *decoder)
+{
+	uint32_t t;
+
+	if(FLAC__mtx_init(&decoder->private_->mutex_work_queue, FLAC__mtx_plain) != FLAC__thrd_success)
+		return false;
+	if(FLAC__cnd_init(&decoder->private_->cond_work_available) != FLAC__thrd_success) {
+		FLAC__mtx_destroy(&decoder->private_->mutex_work_queue);
+		return false;
+	}
+	if(FLAC__cnd_init(&decoder->private_->cond_task_done) != FLAC__thrd_success) {
+		FLAC__mtx_destroy(&decoder->private_->mutex_work_queue);
+		FLAC__cnd_destroy(&decoder->private_->cond_work_available);
+		return false;
+	}
+	decoder->private_->finish_work_threads = false;
+	decoder->private_->read_ahead_len = 0;
+	decoder->private_->read_ahead_offset = 0;
+	decoder->private_->read_ahead_position = 0;
+	decoder->private_->read_ahead_eof = false;
+
+	/* from here on, stop_threads_() cleans up after a failure */
+	if(0 == (decoder->private_->threadtask = safe_calloc_(decoder->protected_->num_threads * 2 + 1, sizeof(FLAC__StreamDecoderThreadTask)))) {
+		stop_threads_(decoder);
+		return false;
+	}
+	decoder->private_->num_threadtasks = decoder->protected_->num_threads * 2 + 1;
+	for(t = 0; t < decoder->private_->num_threadtasks; t++) {
+		FLAC__StreamDecoderThreadTask *task = &decoder->private_->threadtask[t];
+		task->parent = decoder;
+		task->forward = (t == 0);
+		task->state = THREADTASK_IDLE;
+		if(0 == (task->decoder = FLAC__stream_decoder_new())) {
+			stop_threads_(decoder);
+			return false;
+		}
+		/* Like the decoder it stands in for, the single-threaded decoder
+		 * can go back to a frame that turns out to be corrupt, so it
+		 * resynchronizes at the same place */
+		if(task->forward && 0 != decoder->private_->seek_callback && 0 != decoder->private_->tell_callback) {
+			if(FLAC__stream_decoder_init_stream(task->decoder, threadtask_read_callback_, threadtask_seek_callback_, threadtask_tell_callback_, threadtask_length_callback_, threadtask_eof_callback_, threadtask_write_callback_, /*metadata_callback=*/0, threadtask_error_callback_, task) != FLAC__STREAM_DECODER_INIT_STATUS_OK) {
+				stop_threads_(decoder);
+				return false;
+			}
+		}
+		else if(FLAC__stream_decoder_init_stream(task->decoder, threadtask_read_callback_, /*seek_callback=*/0, /*tell_callback=*/0, /*length_callback=*/0, /*eof_callback=*/0, threadtask_write_callback_, /*metadata_callback=*/0, threadtask_error_callback_, task) != FLAC__STREAM_DECODER_INIT_STATUS_OK) {
+			stop_threads_(decoder);
+			return false;
+		}
+		FLAC__stream_decoder_set_stream_info(task->decoder, &decoder->private_->stream_info.data.stream_info);
+	}
+
+	/* the calling thread does its share of the work too, so one less is started */
+	if(0 != decoder->protected_->thread_pool) {
+		FLAC__thread_pool_attach(decoder->protected_->thread_pool, &decoder->private_->thread_pool_client, decode_frame_pool_job_, decoder, decoder->protected_->num_threads - 1, decoder->private_->num_threadtasks);
+		return true;
+	}
+	if(0 == (decoder->private_->thread = safe_malloc_mul_2op_p(sizeof(FLAC__thrd_t), /*times*/decoder->protected_->num_threads))) {
+		stop_threads_(decoder);
+		return false;
+	}
+	for(t = 0; t + 1 < decoder->protected_->num_threads; t++) {
+		/* if a thread cannot be started, do with the ones that were */
+		if(FLAC__thrd_create(&decoder->private_->thread[t], decode_frame_thread_, decoder) != FLAC__thrd_success)
+			break;
+		decoder->private_->num_started_threads++;
+	}
+	return true;
+}
+
+void stop_threads_(FLAC__StreamDecoder *decoder)
+{
+	uint32_t t;
+
+	FLAC__mtx_lock(&decoder->private_->mutex_work_queue);
+	for(t = 0; t < decoder->private_->num_threadtasks; t++)
+		if(decoder->private_->threadtask[t].state == THREADTASK_QUEUED)
+			decoder->private_->threadtask[t].state = THREADTASK_IDLE;
+	decoder->private_->finish_work_threads = true;
+	FLAC__cnd_broadcast(&decoder->private_->cond_work_available);
+	FLAC__mtx_unlock(&decoder->private_->mutex_work_queue);
+
+	FLAC__thread_pool_detach(&decoder->private_->thread_pool_client);
+	for(t = 0; t < decoder->private_->num_started_threads; t++)
+		FLAC__thrd_join(decoder->private_->thread[t], NULL);
+	decoder->private_->num_started_threads = 0;
+	free(decoder->private_->thread);
+	decoder->private_->thread = 0;
+
+	for(t = 0; t < decoder->private_->num_threadtasks; t++) {
+		if(0 != decoder->private_->threadtask[t].decoder)
+			FLAC__stream_decoder_delete(decoder->private_->threadtask[t].decoder);
+		free(decoder->private_->threadtask[t].data);
+	}
+	free(decoder->private_->threadtask);
+	decoder->private_->threadtask = 0;
+	decoder->private_->num_threadtasks = 0;
+
+	FLAC__mtx_destroy(&decoder->private_->mutex_work_queue);
+	FLAC__cnd_destroy(&decoder->private_->cond_work_available);
+	FLAC__cnd_destroy(&decoder->private_->cond_task_done);
+
+	free(decoder->private_->read_ahead);
+	decoder->private_->read_ahead = 0;
+	decoder->private_->read_ahead_len = decoder->private_->read_ahead_capacity = 0;
+}
+
+FLAC__thread_return_type decode_frame_thread_(void *data)
+{
+	FLAC__StreamDecoder *decoder = (FLAC__StreamDecoder *)data;
+
+	FLAC__mtx_lock(&decoder->private_->mutex_work_queue);
+	while(1) {
+		if(run_queued_threadtask_(decoder))
+			continue;
+		if(decoder->private_->finish_work_threads)
+			break;
+		FLAC__cnd_wait(&decoder->private_->cond_work_available, &decoder->private_->mutex_work_queue);
+	}
+	FLAC__mtx_unlock(&decoder->private_->mutex_work_queue);
+	return FLAC__thread_default_return_value;
+}
+
+/* Run by a thread of the thread pool once for every queued frame, which
+ * might have been decoded by the calling thread already */
+void decode_frame_pool_job_(void *data)
+{
+	FLAC__StreamDecoder *decoder = (FLAC__StreamDecoder *)data;
+
+	FLAC__mtx_lock(&decoder->private_->mutex_work_queue);
+	run_queued_threadtask_(decoder);
+	FLAC__mtx_unlock(&decoder->private_->mutex_work_queue);
+}
+
+/* Decodes the queued frame that comes first in the stream, if there is
+ * one.  Must be called with mutex_work_queue locked, which is released
+ * while decoding
+ */
+FLAC__bool run_queued_threadtask_(FLAC__StreamDecoder *decoder)
+{
+	FLAC__StreamDecoderThreadTask *task = 0;
+	uint32_t t;
+
+	for(t = 1; t < decoder->private_->num_threadtasks; t++)
+		if(decoder->private_->threadtask[t].state == THREADTASK_QUEUED && (0 == task || decoder->private_->threadtask[t].stream_offset < task->stream_offset))
+			task = &decoder->private_->threadtask[t];
+	if(0 == task)
+		return false;
+	task->state = THREADTASK_RUNNING;
+	FLAC__mtx_unlock(&decoder->private_->mutex_work_queue);
+	decode_threadtask_(task);
+	FLAC__mtx_lock(&decoder->private_->mutex_work_queue);
+	task->state = THREADTASK_DONE;
+	FLAC__cnd_broadcast(&decoder->private_->cond_task_done);
+	return true;
+}
+
+void decode_threadtask_(FLAC__StreamDecoderThreadTask *task)
+{
+	FLAC__StreamDecoder *decoder = task->decoder;
+	size_t unconsumed;
+
+	if(!FLAC__stream_decoder_process_single(decoder))
+		return;
+	if(decoder->protected_->state != FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC || 0 == task->frame || task->error_occurred)
+		return;
+	unconsumed = FLAC__bitreader_get_input_bits_unconsumed(decoder->private_->input) / 8 + (decoder->private_->cached? 1 : 0);
+	task->frame_is_clean = (task->data_pos - unconsumed == task->data_len);
+}
+
+FLAC__bool prepare_threadtask_(FLAC__StreamDecoder *decoder, FLAC__StreamDecoderThreadTask *task)
+{
+	if(!FLAC__stream_decoder_flush(task->decoder)) {
+		decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+		return false;
+	}
+	task->decoder->private_->cached = false;
+	task->decoder->private_->fixed_block_size = decoder->private_->fixed_block_size;
+	task->decoder->private_->next_fixed_block_size = 0;
+	task->decoder->private_->unparseable_frame_count = 0;
+	task->decoder->private_->error_has_been_sent = false;
+	task->data_pos = 0;
+	task->frame = 0;
+	task->buffer = 0;
+	task->error_occurred = false;
+	task->frame_is_clean = false;
+	return true;
+}
+
+void wait_for_threadtask_(FLAC__StreamDecoder *decoder, FLAC__StreamDecoderThreadTask *task)
+{
+	FLAC__mtx_lock(&decoder->private_->mutex_work_queue);
+	if(task->state == THREADTASK_QUEUED) {
+		/* no worker got to it yet, so decode it here rather than wait */
+		task->state = THREADTASK_RUNNING;
+		FLAC__mtx_unlock(&decoder->private_->mutex_work_queue);
+		decode_threadtask_(task);
+		FLAC__mtx_lock(&decoder->private_->mutex_work_queue);
+		task->state = THREADTASK_DONE;
+	}
+	while(task->state != THREADTASK_DONE)
+		FLAC__cnd_wait(&decoder->private_->cond_task_done, &decoder->private_->mutex_work_queue);
+	FLAC__mtx_unlock(&decoder->private_->mutex_work_queue);
+}
+
+/* Decodes the next frame at *position, or whatever comes before it, in
+ * the calling thread and moves *position past it.
+ */
+FLAC__bool decode_single_threaded_(FLAC__StreamDecoder *decoder, FLAC__uint64 *position)
+{
+	FLAC__StreamDecoderThreadTask *task = &decoder->private_->threadtask[0];
+	FLAC__StreamDecoderState state;
+
+	if(!prepare_threadtask_(decoder, task))
+		return false;
+	task->decoder->private_->last_frame = decoder->private_->last_frame;
+	task->decoder->private_->last_frame_is_set = decoder->private_->last_frame_is_set;
+	decoder->private_->read_ahead_position = *position;
+
+	FLAC__stream_decoder_process_single(task->decoder);
+	state = task->decoder->protected_->state;
+	if(state != FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC && state != FLAC__STREAM_DECODER_END_OF_STREAM) {
+		/* a failing read or write callback has set the state already */
+		if(decoder->protected_->state == FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC)
+			decoder->protected_->state = (state == FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR)? state : FLAC__STREAM_DECODER_ABORTED;
+		return false;
+	}
+	*position = decoder->private_->read_ahead_position - FLAC__bitreader_get_input_bits_unconsumed(task->decoder->private_->input) / 8 - (task->decoder->private_->cached? 1 : 0);
+	return true;
+}
+
+/* Does for a frame decoded by a threadtask what read_frame_() does after
+ * decoding a frame.
+ */
+FLAC__bool deliver_frame_(FLAC__StreamDecoder *decoder, const FLAC__StreamDecoder *source, const FLAC__Frame *frame, const FLAC__int32 * const buffer[])
+{
+	if(source->private_->fixed_block_size)
+		decoder->private_->fixed_block_size = source->private_->fixed_block_size;
+
+	decoder->protected_->channels = frame->header.channels;
+	decoder->protected_->channel_assignment = frame->header.channel_assignment;
+	decoder->protected_->bits_per_sample = frame->header.bits_per_sample;
+	decoder->protected_->sample_rate = frame->header.sample_rate;
+	decoder->protected_->blocksize = frame->header.blocksize;
+
+	FLAC__ASSERT(frame->header.number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
+	decoder->private_->samples_decoded = frame->header.number.sample_number + frame->header.blocksize;
+	decoder->private_->error_has_been_sent = false;
+
+	if(0 != decoder->private_->interleaved_write_callback && !allocate_interleaved_(decoder, frame->header.blocksize, frame->header.channels))
+		return false;
+	if(write_audio_frame_to_client_(decoder, frame, buffer, /*interleaved=*/0) != FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE) {
+		decoder->protected_->state = FLAC__STREAM_DECODER_ABORTED;
+		return false;
+	}
+	return true;
+}
+
+FLAC__bool reserve_read_ahead_(FLAC__StreamDecoder *decoder, size_t bytes)
+{
+	size_t capacity = decoder->private_->read_ahead_capacity;
+
+	if(capacity - decoder->private_->read_ahead_len >= bytes)
+		return true;
+	if(capacity == 0)
+		capacity = THREAD_READ_SIZE_ * 4;
+	while(capacity - decoder->private_->read_ahead_len < bytes)
+		capacity *= 2;
+	if(0 == (decoder->private_->read_ahead = safe_realloc_(decoder->private_->read_ahead, capacity))) {
+		decoder->private_->read_ahead_len = decoder->private_->read_ahead_capacity = 0;
+		return false;
+	}
+	decoder->private_->read_ahead_capacity = capacity;
+	return true;
+}
+
+FLAC__bool read_ahead_(FLAC__StreamDecoder *decoder)
+{
+	size_t bytes = THREAD_READ_SIZE_;
+
+	if(!reserve_read_ahead_(decoder, bytes)) {
+		decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+		return false;
+	}
+	if(!read_callback_(decoder->private_->read_ahead + decoder->private_->read_ahead_len, &bytes, decoder)) {
+		if(decoder->protected_->state != FLAC__STREAM_DECODER_END_OF_STREAM)
+			return false; /* read_callback_ sets the state for us */
+		decoder->private_->read_ahead_eof = true;
+		decoder->protected_->state = FLAC__STREAM_DECODER_SEARCH_FOR_FRAME_SYNC;
+		return true;
+	}
+	decoder->private_->read_ahead_len += bytes;
+	return true;
+}
+
+/* Drops read-ahead data before position once that is worth the move */
+void discard_read_ahead_(FLAC__StreamDecoder *decoder, FLAC__uint64 position)
+{
+	const size_t bytes = (size_t)(position - decoder->private_->read_ahead_offset);
+
+	FLAC__ASSERT(position >= decoder->private_->read_ahead_offset);
+	FLAC__ASSERT(bytes <= decoder->private_->read_ahead_len);
+	if(bytes < THREAD_READ_SIZE_ || bytes < decoder->private_->read_ahead_len / 2)
+		return;
+	memmove(decoder->private_->read_ahead, decoder->private_->read_ahead + bytes, decoder->private_->read_ahead_len - bytes);
+	decoder->private_->read_ahead_len -= bytes;
+	decoder->private_->read_ahead_offset = position;
+}
+
+/* Checks whether raw[] starts with a frame header that read_frame_header_()
+ * would accept.  Returns 1 if so, with the sample number and blocksize of
+ * the frame, 0 if not, and -1 if that cannot be told from the given bytes.
+ * Unlike read_frame_header_(), only the blocking strategy bit tells whether
+ * the header holds a frame or a sample number, so that a fixed-blocksize
+ * stream with a short last frame in its STREAMINFO is numbered in samples.
+ */
+int parse_raw_frame_header_(const FLAC__StreamDecoder *decoder, const FLAC__byte *raw, size_t bytes, FLAC__uint64 *sample_number, uint32_t *blocksize)
+{
+	FLAC__uint64 number;
+	FLAC__bool is_variable_blocksize;
+	uint32_t i, utf8_len, header_len, blocksize_code, sample_rate_code;
+
+	if(bytes < 4)
+		return (bytes == 0 || (raw[0] == 0xff && (bytes < 2 || raw[1] >> 1 == 0x7c)))? -1 : 0;
+	if(raw[0] != 0xff || raw[1] >> 1 != 0x7c) /* MAGIC NUMBER for the sync code and reserved 7th bit */
+		return 0;
+	if(raw[2] == 0xff || raw[3] == 0xff)
+		return 0;
+	blocksize_code = raw[2] >> 4;
+	sample_rate_code = raw[2] & 0x0f;
+	if(blocksize_code == 0 || sample_rate_code == 15)
+		return 0;
+	if((raw[3] >> 4) > 10 || ((raw[3] & 0x0e) >> 1) == 3 || (raw[3] & 0x01)) /* MAGIC NUMBERs for the reserved channel assignments, sample size and bit */
+		return 0;
+
+	is_variable_blocksize = raw[1] & 0x01;
+
+	if(bytes < 5)
+		return -1;
+	i = raw[4];
+	if(!(i & 0x80)) { number = i; utf8_len = 0; }
+	else if((i & 0xE0) == 0xC0) { number = i & 0x1F; utf8_len = 1; }
+	else if((i & 0xF0) == 0xE0) { number = i & 0x0F; utf8_len = 2; }
+	else if((i & 0xF8) == 0xF0) { number = i & 0x07; utf8_len = 3; }
+	else if((i & 0xFC) == 0xF8) { number = i & 0x03; utf8_len = 4; }
+	else if((i & 0xFE) == 0xFC) { number = i & 0x01; utf8_len = 5; }
+	else if(i == 0xFE && is_variable_blocksize) { number = 0; utf8_len = 6; }
+	else
+		return 0;
+
+	header_len = 5 + utf8_len;
+	if(blocksize_code == 6 || blocksize_code == 7)
+		header_len += blocksize_code - 5;
+	if(sample_rate_code == 12)
+		header_len += 1;
+	else if(sample_rate_code == 13 || sample_rate_code == 14)
+		header_len += 2;
+	if(bytes < header_len + 1)
+		return -1;
+
+	for(i = 0; i < utf8_len; i++) {
+		if(!(raw[5+i] & 0x80) || (raw[5+i] & 0x40))
+			return 0;
+		number = (number << 6) | (raw[5+i] & 0x3F);
+	}
+
+	if(blocksize_code == 1)
+		*blocksize = 192;
+	else if(blocksize_code <= 5)
+		*blocksize = 576 << (blocksize_code - 2);
+	else if(blocksize_code == 6)
+		*blocksize = (uint32_t)raw[5+utf8_len] + 1;
+	else if(blocksize_code == 7) {
+		*blocksize = ((uint32_t)raw[5+utf8_len] << 8 | raw[6+utf8_len]) + 1;
+		if(*blocksize > 65535)
+			return 0;
+	}
+	else
+		*blocksize = 256 << (blocksize_code - 8);
+
+	if(FLAC__crc8(raw, header_len) != raw[header_len])
+		return 0;
+
+	if(!is_variable_blocksize)
+		number *= decoder->private_->fixed_block_size? decoder->private_->fixed_block_size : decoder->private_->stream_info.data.stream_info.max_blocksize;
+	*sample_number = number;
+	return 1;
+}
+
+/* Gives the sample number parse_raw_frame_header_() should find in the
+ * frame after the last one decoded, if known.  When the STREAMINFO block
+ * sizes differ, read_frame_header_() takes the frame number of a
+ * fixed-blocksize frame for a sample number, so the last frame does not
+ * tell in that case.
+ */
+FLAC__bool next_sample_number_after_last_frame_(const FLAC__StreamDecoder *decoder, FLAC__uint64 *sample_number)
+{
+	if(!decoder->private_->last_frame_is_set || decoder->private_->stream_info.data.stream_info.min_blocksize != decoder->private_->stream_info.data.stream_info.max_blocksize)
+		return false;
+	*sample_number = decoder->private_->last_frame.header.number.sample_number + decoder->private_->last_frame.header.blocksize;
+	return true;
+}
+
+FLAC__StreamDecoderReadStatus threadtask_read_callback_(const FLAC__StreamDecoder *decoder, FLAC__byte buffer[], size_t *bytes, void *client_data)
+{
+	FLAC__StreamDecoderThreadTask *task = (FLAC__StreamDecoderThreadTask *)client_data;
+	size_t available;
+	(void)decoder;
+
+	if(task->forward) {
+		FLAC__StreamDecoder *parent = task->parent;
+		while((available = (size_t)(parent->private_->read_ahead_offset + parent->private_->read_ahead_len - parent->private_->read_ahead_position)) == 0 && !parent->private_->read_ahead_eof) {
+			if(!read_ahead_(parent))
+				return FLAC__STREAM_DECODER_READ_STATUS_ABORT;
+		}
+		if(available == 0) {
+			*bytes = 0;
+			return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+		}
+		if(*bytes > available)
+			*bytes = available;
+		memcpy(buffer, parent->private_->read_ahead + (size_t)(parent->private_->read_ahead_position - parent->private_->read_ahead_offset), *bytes);
+		parent->private_->read_ahead_position += *bytes;
+	}
+	else {
+		available = task->data_len - task->data_pos;
+		if(available == 0) {
+			*bytes = 0;
+			return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+		}
+		if(*bytes > available)
+			*bytes = available;
+		memcpy(buffer, task->data + task->data_pos, *bytes);
+		task->data_pos += *bytes;
+	}
+	return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+}
+
+FLAC__StreamDecoderWriteStatus threadtask_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data)
+{
+	FLAC__StreamDecoderThreadTask *task = (FLAC__StreamDecoderThreadTask *)client_data;
+
+	if(task->forward)
+		return deliver_frame_(task->parent, decoder, frame, buffer)? FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE : FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
+	/* the frame stays in the threadtask's decoder until it is written */
+	task->frame = frame;
+	task->buffer = buffer;
+	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+void threadtask_error_callback_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data)
+{
+	FLAC__StreamDecoderThreadTask *task = (FLAC__StreamDecoderThreadTask *)client_data;
+	(void)decoder;
+
+	if(task->forward)
+		send_error_to_client_(task->parent, status);
+	else
+		task->error_occurred = true;
+}
+FLAC__StreamDecoderSeekStatus threadtask_seek_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 absolute_byte_offset, void *client_data)
+{
+	FLAC__StreamDecoderThreadTask *task = (FLAC__StreamDecoderThreadTask *)client_data;
+	FLAC__StreamDecoder *parent = task->parent;
+	(void)decoder;
+
+	FLAC__ASSERT(task->forward);
+	/* nothing before the read-ahead buffer is needed again */
+	if(absolute_byte_offset < parent->private_->read_ahead_offset || absolute_byte_offset > parent->private_->read_ahead_offset + parent->private_->read_ahead_len)
+		return FLAC__STREAM_DECODER_SEEK_STATUS_ERROR;
+	parent->private_->read_ahead_position = absolute_byte_offset;
+	return FLAC__STREAM_DECODER_SEEK_STATUS_OK;
+}
+
+FLAC__StreamDecoderTellStatus threadtask_tell_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 *absolute_byte_offset, void *client_data)
+{
+	FLAC__StreamDecoderThreadTask *task = (FLAC__StreamDecoderThreadTask *)client_data;
+	(void)decoder;
+
+	FLAC__ASSERT(task->forward);
+	*absolute_byte_offset = task->parent->private_->read_ahead_position;
+	return FLAC__STREAM_DECODER_TELL_STATUS_OK;
+}
+
+FLAC__StreamDecoderLengthStatus threadtask_length_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 *stream_length, void *client_data)
+{
+	(void)decoder, (void)stream_length, (void)client_data;
+	return FLAC__STREAM_DECODER_LENGTH_STATUS_UNSUPPORTED;
+}
+
+FLAC__bool threadtask_eof_callback_(const FLAC__StreamDecoder *decoder, void *client_data)
+{
+	FLAC__StreamDecoderThreadTask *task = (FLAC__StreamDecoderThreadTask *)client_data;
+	FLAC__StreamDecoder *parent = task->parent;
+	(void)decoder;
+
+	FLAC__ASSERT(task->forward);
+	return parent->private_->read_ahead_eof && parent->private_->read_ahead_position == parent->private_->read_ahead_offset + parent->private_->read_ahead_len;
+}
+#endif
@@ -0,0 +1,136 @@
+/* libFLAC - Free Lossless Audio Codec library
+ * Copyright (C) 2025  Xiph.Org Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "private/cpu.h"
+
+#ifndef FLAC__NO_ASM
+#if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
+#include "private/stream_decoder.h"
+#ifdef FLAC__SSSE3_SUPPORTED
+
+#include <tmmintrin.h> /* SSSE3 */
+#include "FLAC/assert.h"
+
+FLAC__SSE_TARGET("ssse3")
+FLAC__bool FLAC__pack_interleaved_stereo_intrin_ssse3(const FLAC__int32 * const buffer[], FLAC__ChannelAssignment channel_assignment,
+		uint32_t blocksize, uint32_t bps, FLAC__StreamDecoderPCMFormat format, FLAC__byte out[])
+{
+	const uint32_t width = format == FLAC__STREAM_DECODER_PCM_FORMAT_S16LE? 16 : format == FLAC__STREAM_DECODER_PCM_FORMAT_S24LE? 24 : 32;
+	const __m128i left_shift = _mm_cvtsi32_si128(bps < width? width - bps : 0);
+	const __m128i right_shift = _mm_cvtsi32_si128(bps > width? bps - width : 0);
+	const __m128i lower_limit = _mm_set1_epi32(INT32_MIN >> (32 - bps));
+	const __m128i upper_limit = _mm_set1_epi32(INT32_MAX >> (32 - bps));
+	/* picks the 3 low bytes of each 32-bit sample */
+	const __m128i pack24 = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+	const __m128 scale = _mm_set1_ps(1.0f / (float)(1u << (bps - 1)));
+#endif
+	__m128i out_of_bounds = _mm_setzero_si128();
+	uint32_t i, j;
+
+	FLAC__ASSERT(blocksize % 8 == 0);
+	FLAC__ASSERT(bps >= FLAC__MIN_BITS_PER_SAMPLE && bps <= 32);
+	FLAC__ASSERT(bps < 32 || channel_assignment == FLAC__CHANNEL_ASSIGNMENT_INDEPENDENT);
+
+	for(i = 0; i < blocksize; i += 8) {
+		__m128i v[4];
+
+		/* undo the channel coding of 8 samples per channel and interleave them */
+		for(j = 0; j < 2; j++) {
+			__m128i left = _mm_loadu_si128((const __m128i*)(buffer[0] + i + 4*j));
+			__m128i right = _mm_loadu_si128((const __m128i*)(buffer[1] + i + 4*j));
+			switch(channel_assignment) {
+				case FLAC__CHANNEL_ASSIGNMENT_LEFT_SIDE:
+					right = _mm_sub_epi32(left, right);
+					break;
+				case FLAC__CHANNEL_ASSIGNMENT_RIGHT_SIDE:
+					left = _mm_add_epi32(left, right);
+					break;
+				case FLAC__CHANNEL_ASSIGNMENT_MID_SIDE: {
+					const __m128i mid = _mm_or_si128(_mm_slli_epi32(left, 1), _mm_and_si128(right, _mm_set1_epi32(1)));
+					left = _mm_srai_epi32(_mm_add_epi32(mid, right), 1);
+					right = _mm_srai_epi32(_mm_sub_epi32(mid, right), 1);
+					break;
+				}
+				default:
+					break;
+			}
+			out_of_bounds = _mm_or_si128(out_of_bounds, _mm_or_si128(_mm_cmplt_epi32(left, lower_limit), _mm_cmpgt_epi32(left, upper_limit)));
+			out_of_bounds = _mm_or_si128(out_of_bounds, _mm_or_si128(_mm_cmplt_epi32(right, lower_limit), _mm_cmpgt_epi32(right, upper_limit)));
+			v[2*j] = _mm_unpacklo_epi32(left, right);
+			v[2*j+1] = _mm_unpackhi_epi32(left, right);
+		}
+
+		switch(format) {
+			case FLAC__STREAM_DECODER_PCM_FORMAT_S16LE:
+				for(j = 0; j < 4; j++)
+					v[j] = _mm_sra_epi32(_mm_sll_epi32(v[j], left_shift), right_shift);
+				_mm_storeu_si128((__m128i*)out, _mm_packs_epi32(v[0], v[1]));
+				_mm_storeu_si128((__m128i*)(out + 16), _mm_packs_epi32(v[2], v[3]));
+				out += 32;
+				break;
+			case FLAC__STREAM_DECODER_PCM_FORMAT_S24LE:
+				for(j = 0; j < 4; j++)
+					v[j] = _mm_shuffle_epi8(_mm_sra_epi32(_mm_sll_epi32(v[j], left_shift), right_shift), pack24);
+				/* each vector now holds 12 bytes, store 4 vectors in 48 bytes */
+				_mm_storeu_si128((__m128i*)out, _mm_or_si128(v[0], _mm_slli_si128(v[1], 12)));
+				_mm_storeu_si128((__m128i*)(out + 16), _mm_or_si128(_mm_srli_si128(v[1], 4), _mm_slli_si128(v[2], 8)));
+				_mm_storeu_si128((__m128i*)(out + 32), _mm_or_si128(_mm_srli_si128(v[2], 8), _mm_slli_si128(v[3], 4)));
+				out += 48;
+				break;
+			case FLAC__STREAM_DECODER_PCM_FORMAT_S32LE:
+				for(j = 0; j < 4; j++)
+					_mm_storeu_si128((__m128i*)(out + 16*j), _mm_sll_epi32(v[j], left_shift));
+				out += 64;
+				break;
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+			case FLAC__STREAM_DECODER_PCM_FORMAT_FLOAT32:
+				for(j = 0; j < 4; j++)
+					_mm_storeu_ps((float*)(out + 16*j), _mm_mul_ps(_mm_cvtepi32_ps(v[j]), scale));
+				out += 64;
+				break;
+#endif
+			default:
+				FLAC__ASSERT(0);
+				break;
+		}
+	}
+
+	return _mm_movemask_epi8(out_of_bounds) == 0;
+}
+
+#endif /* FLAC__SSSE3_SUPPORTED */
+#endif /* (FLAC__CPU_IA32 || FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN */
+#endif /* FLAC__NO_ASM */
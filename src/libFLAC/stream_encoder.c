@@ -62,8 +62,10 @@
 #include "private/ogg_helper.h"
 #include "private/ogg_mapping.h"
 #endif
+#include "private/stream_decoder.h"
 #include "private/stream_encoder.h"
 #include "private/stream_encoder_framing.h"
+#include "private/thread_pool.h"
 #include "private/window.h"
 #include "share/alloc.h"
 #include "share/private.h"
@@ -99,12 +101,26 @@ typedef struct {
 	uint32_t bytes;
 } verify_output;
 
+typedef struct {
+	FLAC__uint64 absolute_sample;
+	uint32_t frame_number;
+	uint32_t channel;
+	uint32_t sample;
+	FLAC__int32 expected;
+	FLAC__int32 got;
+} verify_error_stats;
+
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
 typedef struct {
 	uint32_t a, b, c;
 	FLAC__ApodizationSpecification * current_apodization;
 	double autoc_root[FLAC__MAX_LPC_ORDER+1];
 	double autoc[FLAC__MAX_LPC_ORDER+1];
+	/* autocorrelations computed ahead by FLAC__lpc_compute_autocorrelation_windowed():
+	 * with batch_b == 1 those of the whole block for apodizations batch_first and on,
+	 * otherwise those of parts batch_first and on of apodization batch_a at depth batch_b */
+	uint32_t batch_a, batch_b, batch_first, batch_count;
+	double autoc_batch[FLAC__MAX_LPC_WINDOWS][FLAC__MAX_LPC_ORDER+1];
 } apply_apodization_state_struct;
 #endif
 
@@ -173,8 +189,18 @@ typedef struct FLAC__StreamEncoderThreadTask {
 	uint32_t *raw_bits_per_partition;                 /* workspace where the sum of silog2(candidate residual) for each partition is stored */
 	FLAC__BitWriter *frame;                           /* the current frame being worked on */
 	uint32_t current_frame_number;
+	/* only used when the encoder has verify.per_threadtask set */
+	FLAC__StreamDecoder *verify_decoder;              /* decodes the frame again, taking it from verify_output */
+	FLAC__int32 *verify_signal[FLAC__MAX_CHANNELS];   /* copy of integer_signal[] to compare with, as encoding shifts out wasted bits in place */
+	verify_output verify_output;
+	verify_error_stats verify_error_stats;
+	uint32_t verify_blocksize;                        /* blocksize of the decoded frame, 0 if none was decoded */
+	FLAC__uint64 verify_sample_number;
+	FLAC__bool verify_mismatch;
+	FLAC__bool verify_decoder_error;
 	/* unaligned (original) pointers to allocated data */
 	FLAC__int32 *integer_signal_unaligned[FLAC__MAX_CHANNELS];
+	FLAC__int32 *verify_signal_unaligned[FLAC__MAX_CHANNELS];
 	FLAC__int32 *integer_signal_mid_side_unaligned[2];
 	FLAC__int64 *integer_signal_33bit_side_unaligned;
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
@@ -201,6 +227,20 @@ typedef struct FLAC__StreamEncoderThreadTask {
 #endif
 } FLAC__StreamEncoderThreadTask;
 
+#ifdef FLAC__USE_THREADS
+/* A subframe for process_subframe_() to search, with everything it needs
+ * except for the scratch space, which comes from the thread doing the search */
+typedef struct FLAC__StreamEncoderSubframeJob {
+	uint32_t subframe_bps;
+	const void *integer_signal;
+	FLAC__Subframe **subframe;
+	FLAC__EntropyCodingMethod_PartitionedRiceContents **partitioned_rice_contents;
+	FLAC__int32 **residual;
+	uint32_t *best_subframe;
+	uint32_t *best_bits;
+} FLAC__StreamEncoderSubframeJob;
+#endif
+
 /***********************************************************************
  *
  * Private class method prototypes
@@ -219,8 +259,19 @@ static void update_ogg_metadata_(FLAC__StreamEncoder *encoder);
 static FLAC__bool process_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_last_block);
 #ifdef FLAC__USE_THREADS
 FLAC__thread_return_type process_frame_thread_(void * encoder);
+static void process_frame_pool_job_(void * encoder);
 #endif
 FLAC__bool process_frame_thread_inner_(FLAC__StreamEncoder * encoder, FLAC__StreamEncoderThreadTask *threadtask);
+#ifdef FLAC__USE_THREADS
+static void destroy_thread_locks_(FLAC__StreamEncoder *encoder);
+static FLAC__StreamEncoderThreadTask * take_threadtask_(FLAC__StreamEncoder *encoder);
+static FLAC__bool accumulate_md5_fifo_(FLAC__StreamEncoder *encoder);
+FLAC__thread_return_type process_subframe_thread_(void * encoder);
+static void process_subframe_pool_job_(void * encoder);
+static FLAC__bool process_subframes_concurrently_(FLAC__StreamEncoder *encoder, FLAC__StreamEncoderThreadTask *threadtask, uint32_t min_partition_order, uint32_t max_partition_order, const FLAC__FrameHeader *frame_header, FLAC__bool do_independent, FLAC__bool do_mid_side);
+static void run_subframe_jobs_(FLAC__StreamEncoder *encoder, FLAC__StreamEncoderThreadTask *threadtask);
+static FLAC__bool run_subframe_job_(FLAC__StreamEncoder *encoder, FLAC__StreamEncoderThreadTask *threadtask, const FLAC__StreamEncoderSubframeJob *job);
+#endif
 static FLAC__bool process_subframes_(FLAC__StreamEncoder *encoder, FLAC__StreamEncoderThreadTask *threadtask);
 
 static FLAC__bool process_subframe_(
@@ -245,6 +296,7 @@ static FLAC__bool apply_apodization_(
 	apply_apodization_state_struct *apply_apodization_state,
 	uint32_t blocksize,
 	double *lpc_error,
+	double *lpc_expected_bits,
 	uint32_t *max_lpc_order_this_apodization,
 	uint32_t subframe_bps,
 	const void *integer_signal,
@@ -390,6 +442,10 @@ static void append_to_verify_fifo_interleaved_(
 	uint32_t wide_samples
 );
 
+static FLAC__bool verify_threadtask_frame_(FLAC__StreamEncoder *encoder, FLAC__StreamEncoderThreadTask *threadtask);
+static FLAC__StreamDecoderReadStatus verify_threadtask_read_callback_(const FLAC__StreamDecoder *decoder, FLAC__byte buffer[], size_t *bytes, void *client_data);
+static FLAC__StreamDecoderWriteStatus verify_threadtask_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data);
+static void verify_threadtask_error_callback_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data);
 static FLAC__StreamDecoderReadStatus verify_read_callback_(const FLAC__StreamDecoder *decoder, FLAC__byte buffer[], size_t *bytes, void *client_data);
 static FLAC__StreamDecoderWriteStatus verify_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data);
 static void verify_metadata_callback_(const FLAC__StreamDecoder *decoder, const FLAC__StreamMetadata *metadata, void *client_data);
@@ -415,8 +471,7 @@ typedef struct FLAC__StreamEncoderPrivate {
 #endif
 	uint32_t input_capacity;                          /* current size (in samples) of the signal and residual buffers */
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
-	FLAC__real *window[FLAC__MAX_APODIZATION_FUNCTIONS]; /* the pre-computed floating-point window for each apodization function */
-	FLAC__real *window_unaligned[FLAC__MAX_APODIZATION_FUNCTIONS];
+	const FLAC__real *window[FLAC__MAX_APODIZATION_FUNCTIONS]; /* the pre-computed floating-point window for each apodization function, shared through the window cache */
 #endif
 	FLAC__StreamMetadata streaminfo;                  /* scratchpad for STREAMINFO as it is built */
 	FLAC__StreamMetadata_SeekTable *seek_table;       /* pointer into encoder->protected_->metadata_ where the seek table is */
@@ -425,6 +480,9 @@ typedef struct FLAC__StreamEncoderPrivate {
 	FLAC__MD5Context md5context;
 	FLAC__CPUInfo cpuinfo;
 	void (*local_precompute_partition_info_sums)(const FLAC__int32 residual[], FLAC__uint64 abs_residual_partition_sums[], uint32_t residual_samples, uint32_t predictor_order, uint32_t min_partition_order, uint32_t max_partition_order, uint32_t bps);
+#ifndef EXACT_RICE_BITS_CALCULATION
+	FLAC__bool (*local_set_partitioned_rice)(const FLAC__uint64 abs_residual_partition_sums[], const uint32_t raw_bits_per_partition[], uint32_t residual_samples, uint32_t predictor_order, uint32_t rice_parameter_limit, uint32_t rice_parameter_search_dist, uint32_t partition_order, FLAC__bool search_for_escapes, FLAC__EntropyCodingMethod_PartitionedRiceContents *partitioned_rice_contents, uint32_t *bits);
+#endif
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
 	uint32_t (*local_fixed_compute_best_predictor)(const FLAC__int32 data[], uint32_t data_len, float residual_bits_per_sample[FLAC__MAX_FIXED_ORDER+1]);
 	uint32_t (*local_fixed_compute_best_predictor_wide)(const FLAC__int32 data[], uint32_t data_len, float residual_bits_per_sample[FLAC__MAX_FIXED_ORDER+1]);
@@ -436,6 +494,7 @@ typedef struct FLAC__StreamEncoderPrivate {
 #endif
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
 	void (*local_lpc_compute_autocorrelation)(const FLAC__real data[], uint32_t data_len, uint32_t lag, double autoc[]);
+	void (*local_lpc_compute_autocorrelation_windowed)(const FLAC__int32 * const in[], const FLAC__real * const window[], uint32_t num_windows, uint32_t data_len, uint32_t lag, double autoc[][FLAC__MAX_LPC_ORDER+1]);
 	void (*local_lpc_compute_residual_from_qlp_coefficients)(const FLAC__int32 *data, uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 residual[]);
 	void (*local_lpc_compute_residual_from_qlp_coefficients_64bit)(const FLAC__int32 *data, uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 residual[]);
 	void (*local_lpc_compute_residual_from_qlp_coefficients_16bit)(const FLAC__int32 *data, uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 residual[]);
@@ -450,6 +509,7 @@ typedef struct FLAC__StreamEncoderPrivate {
 	FLAC__bool disable_constant_subframes;
 	FLAC__bool disable_fixed_subframes;
 	FLAC__bool disable_verbatim_subframes;
+	FLAC__bool disable_fused_window_autocorrelation;
 	FLAC__bool is_ogg;
 	FLAC__StreamEncoderReadCallback read_callback; /* currently only needed for Ogg FLAC */
 	FLAC__StreamEncoderSeekCallback seek_callback;
@@ -473,14 +533,8 @@ typedef struct FLAC__StreamEncoderPrivate {
 		FLAC__bool needs_magic_hack;
 		verify_input_fifo input_fifo;
 		verify_output output;
-		struct {
-			FLAC__uint64 absolute_sample;
-			uint32_t frame_number;
-			uint32_t channel;
-			uint32_t sample;
-			FLAC__int32 expected;
-			FLAC__int32 got;
-		} error_stats;
+		verify_error_stats error_stats;
+		FLAC__bool per_threadtask; /* audio frames are verified by the threadtask that made them, see verify_threadtask_frame_() */
 	} verify;
 	FLAC__bool is_being_deleted; /* if true, call to ..._finish() from ..._delete() will not call the callbacks */
 	uint32_t num_threadtasks;
@@ -500,6 +554,24 @@ typedef struct FLAC__StreamEncoderPrivate {
 	FLAC__bool finish_work_threads;
 	int32_t overcommitted_indicator;
 	verify_input_fifo md5_fifo;
+	/* only used with intra_frame_threading, see process_subframes_concurrently_() */
+	FLAC__bool subframe_threading;
+	FLAC__StreamEncoderSubframeJob subframe_job[FLAC__MAX_CHANNELS + 2];
+	uint32_t num_subframe_jobs;
+	uint32_t next_subframe_job; /* Next job no thread has picked up yet */
+	uint32_t num_subframe_jobs_done;
+	uint32_t subframe_min_partition_order, subframe_max_partition_order;
+	const FLAC__FrameHeader *subframe_frame_header;
+	FLAC__bool subframe_jobs_ok;
+	uint32_t next_subframe_threadtask; /* Next threadtask a new thread takes as scratch space */
+	FLAC__bool finish_subframe_threads;
+	FLAC__mtx_t mutex_subframe_jobs; /* To lock the subframe job variables in this struct */
+	FLAC__cnd_t cond_subframe_jobs_available;
+	FLAC__cnd_t cond_subframe_jobs_done;
+	uint32_t free_subframe_threadtask[FLAC__STREAM_ENCODER_MAX_THREADS]; /* Scratch threadtasks not in use by a job of the thread pool */
+	uint32_t num_free_subframe_threadtasks;
+	/* only used with a thread pool, which is attached instead of creating the first thread */
+	FLAC__ThreadPoolClient thread_pool_client;
 #endif
 } FLAC__StreamEncoderPrivate;
 
@@ -575,6 +647,14 @@ FLAC_API const char * const FLAC__StreamEncoderTellStatusString[] = {
  */
 static const uint32_t OVERREAD_ = 1;
 
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+/* In bits per sample: how much larger than that of the guessed best LPC
+ * order the expected size of another order may be for the exhaustive model
+ * search to still try it. The expected sizes assume a Gaussian residual,
+ * but the order that wins usually is within this margin */
+static const double LPC_ORDER_PRUNING_MARGIN_ = 1.0 / 256.0;
+#endif
+
 /***********************************************************************
  *
  * Class constructor/destructor
@@ -946,8 +1026,16 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 	/* first default to the non-asm routines */
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
 	encoder->private_->local_lpc_compute_autocorrelation = FLAC__lpc_compute_autocorrelation;
+	/* the windowed routines sum in the order of the C and FMA autocorrelation
+	 * routines, but not in that of the SSE2 and NEON ones, so they are only
+	 * used together with the former to keep the output the same */
+	encoder->private_->local_lpc_compute_autocorrelation_windowed = FLAC__lpc_compute_autocorrelation_windowed;
+	encoder->protected_->fused_window_autocorrelation = true;
 #endif
 	encoder->private_->local_precompute_partition_info_sums = precompute_partition_info_sums_;
+#ifndef EXACT_RICE_BITS_CALCULATION
+	encoder->private_->local_set_partitioned_rice = set_partitioned_rice_;
+#endif
 	encoder->private_->local_fixed_compute_best_predictor = FLAC__fixed_compute_best_predictor;
 	encoder->private_->local_fixed_compute_best_predictor_wide = FLAC__fixed_compute_best_predictor_wide;
 	encoder->private_->local_fixed_compute_best_predictor_limit_residual = FLAC__fixed_compute_best_predictor_limit_residual;
@@ -969,6 +1057,7 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 		encoder->private_->local_lpc_compute_autocorrelation = FLAC__lpc_compute_autocorrelation_intrin_neon_lag_14;
 	else
 		encoder->private_->local_lpc_compute_autocorrelation = FLAC__lpc_compute_autocorrelation;
+	encoder->protected_->fused_window_autocorrelation = encoder->protected_->max_lpc_order >= 14;
 #endif
     encoder->private_->local_lpc_compute_residual_from_qlp_coefficients_16bit = FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_neon;
     encoder->private_->local_lpc_compute_residual_from_qlp_coefficients       = FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_neon;
@@ -987,6 +1076,7 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 				encoder->private_->local_lpc_compute_autocorrelation = FLAC__lpc_compute_autocorrelation_intrin_sse2_lag_10;
 			else if(encoder->protected_->max_lpc_order < 14)
 				encoder->private_->local_lpc_compute_autocorrelation = FLAC__lpc_compute_autocorrelation_intrin_sse2_lag_14;
+			encoder->protected_->fused_window_autocorrelation = encoder->protected_->max_lpc_order >= 14;
 
 			encoder->private_->local_lpc_compute_residual_from_qlp_coefficients       = FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_sse2;
 			encoder->private_->local_lpc_compute_residual_from_qlp_coefficients_16bit = FLAC__lpc_compute_residual_from_qlp_coefficients_16_intrin_sse2;
@@ -1039,6 +1129,7 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 				encoder->private_->local_lpc_compute_autocorrelation = FLAC__lpc_compute_autocorrelation_intrin_sse2_lag_10;
 			else if(encoder->protected_->max_lpc_order < 14)
 				encoder->private_->local_lpc_compute_autocorrelation = FLAC__lpc_compute_autocorrelation_intrin_sse2_lag_14;
+			encoder->protected_->fused_window_autocorrelation = encoder->protected_->max_lpc_order >= 14;
 
 			encoder->private_->local_lpc_compute_residual_from_qlp_coefficients_16bit = FLAC__lpc_compute_residual_from_qlp_coefficients_16_intrin_sse2;
 		}
@@ -1063,6 +1154,8 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 				encoder->private_->local_lpc_compute_autocorrelation = FLAC__lpc_compute_autocorrelation_intrin_fma_lag_12;
 			else if(encoder->protected_->max_lpc_order < 16)
 				encoder->private_->local_lpc_compute_autocorrelation = FLAC__lpc_compute_autocorrelation_intrin_fma_lag_16;
+			encoder->private_->local_lpc_compute_autocorrelation_windowed = FLAC__lpc_compute_autocorrelation_windowed_intrin_fma;
+			encoder->protected_->fused_window_autocorrelation = true;
 		}
 #    endif
 
@@ -1092,6 +1185,8 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 #  endif /* FLAC__CPU_... */
 	}
 # endif /* !FLAC__NO_ASM */
+	if(encoder->private_->disable_fused_window_autocorrelation)
+		encoder->protected_->fused_window_autocorrelation = false;
 
 #endif /* !FLAC__INTEGER_ONLY_LIBRARY */
 #if !defined FLAC__NO_ASM && FLAC__HAS_X86INTRIN
@@ -1106,8 +1201,13 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 			encoder->private_->local_precompute_partition_info_sums = FLAC__precompute_partition_info_sums_intrin_ssse3;
 #  endif
 #  ifdef FLAC__AVX2_SUPPORTED
-		if (encoder->private_->cpuinfo.x86.avx2)
+		if (encoder->private_->cpuinfo.x86.avx2) {
 			encoder->private_->local_precompute_partition_info_sums = FLAC__precompute_partition_info_sums_intrin_avx2;
+#   if !defined EXACT_RICE_BITS_CALCULATION && !defined ENABLE_RICE_PARAMETER_SEARCH
+			if(!encoder->protected_->do_escape_coding)
+				encoder->private_->local_set_partitioned_rice = FLAC__set_partitioned_rice_intrin_avx2;
+#   endif
+		}
 #  endif
 # endif /* FLAC__CPU_... */
 	}
@@ -1133,23 +1233,54 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 
 	if(encoder->protected_->num_threads > 1) {
 #ifdef FLAC__USE_THREADS
-		encoder->private_->num_threadtasks = encoder->protected_->num_threads * 2 + 2; /* First threadtask is reserved for main thread */
+		encoder->private_->subframe_threading = encoder->protected_->intra_frame_threading;
+		if(encoder->private_->subframe_threading)
+			encoder->private_->num_threadtasks = encoder->protected_->num_threads; /* Every thread but the main thread takes one as scratch space */
+		else
+			encoder->private_->num_threadtasks = encoder->protected_->num_threads * 2 + 2; /* First threadtask is reserved for main thread */
+		if(FLAC__mtx_init(&encoder->private_->mutex_subframe_jobs, FLAC__mtx_plain) != FLAC__thrd_success) {
+			encoder->protected_->state = FLAC__STREAM_ENCODER_MEMORY_ALLOCATION_ERROR;
+			return FLAC__STREAM_ENCODER_INIT_STATUS_ENCODER_ERROR;
+		}
+		if(FLAC__cnd_init(&encoder->private_->cond_subframe_jobs_available) != FLAC__thrd_success) {
+			FLAC__mtx_destroy(&encoder->private_->mutex_subframe_jobs);
+			encoder->protected_->state = FLAC__STREAM_ENCODER_MEMORY_ALLOCATION_ERROR;
+			return FLAC__STREAM_ENCODER_INIT_STATUS_ENCODER_ERROR;
+		}
+		if(FLAC__cnd_init(&encoder->private_->cond_subframe_jobs_done) != FLAC__thrd_success) {
+			FLAC__mtx_destroy(&encoder->private_->mutex_subframe_jobs);
+			FLAC__cnd_destroy(&encoder->private_->cond_subframe_jobs_available);
+			encoder->protected_->state = FLAC__STREAM_ENCODER_MEMORY_ALLOCATION_ERROR;
+			return FLAC__STREAM_ENCODER_INIT_STATUS_ENCODER_ERROR;
+		}
 		if(FLAC__mtx_init(&encoder->private_->mutex_md5_fifo, FLAC__mtx_plain) != FLAC__thrd_success) {
+			FLAC__mtx_destroy(&encoder->private_->mutex_subframe_jobs);
+			FLAC__cnd_destroy(&encoder->private_->cond_subframe_jobs_available);
+			FLAC__cnd_destroy(&encoder->private_->cond_subframe_jobs_done);
 			encoder->protected_->state = FLAC__STREAM_ENCODER_MEMORY_ALLOCATION_ERROR;
 			return FLAC__STREAM_ENCODER_INIT_STATUS_ENCODER_ERROR;
 		}
 		if(FLAC__mtx_init(&encoder->private_->mutex_work_queue, FLAC__mtx_plain) != FLAC__thrd_success) {
+			FLAC__mtx_destroy(&encoder->private_->mutex_subframe_jobs);
+			FLAC__cnd_destroy(&encoder->private_->cond_subframe_jobs_available);
+			FLAC__cnd_destroy(&encoder->private_->cond_subframe_jobs_done);
 			FLAC__mtx_destroy(&encoder->private_->mutex_md5_fifo);
 			encoder->protected_->state = FLAC__STREAM_ENCODER_MEMORY_ALLOCATION_ERROR;
 			return FLAC__STREAM_ENCODER_INIT_STATUS_ENCODER_ERROR;
 		}
 		if(FLAC__cnd_init(&encoder->private_->cond_md5_emptied) != FLAC__thrd_success) {
+			FLAC__mtx_destroy(&encoder->private_->mutex_subframe_jobs);
+			FLAC__cnd_destroy(&encoder->private_->cond_subframe_jobs_available);
+			FLAC__cnd_destroy(&encoder->private_->cond_subframe_jobs_done);
 			FLAC__mtx_destroy(&encoder->private_->mutex_md5_fifo);
 			FLAC__mtx_destroy(&encoder->private_->mutex_work_queue);
 			encoder->protected_->state = FLAC__STREAM_ENCODER_MEMORY_ALLOCATION_ERROR;
 			return FLAC__STREAM_ENCODER_INIT_STATUS_ENCODER_ERROR;
 		}
 		if(FLAC__cnd_init(&encoder->private_->cond_work_available) != FLAC__thrd_success) {
+			FLAC__mtx_destroy(&encoder->private_->mutex_subframe_jobs);
+			FLAC__cnd_destroy(&encoder->private_->cond_subframe_jobs_available);
+			FLAC__cnd_destroy(&encoder->private_->cond_subframe_jobs_done);
 			FLAC__mtx_destroy(&encoder->private_->mutex_md5_fifo);
 			FLAC__mtx_destroy(&encoder->private_->mutex_work_queue);
 			FLAC__cnd_destroy(&encoder->private_->cond_md5_emptied);
@@ -1157,6 +1288,9 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 			return FLAC__STREAM_ENCODER_INIT_STATUS_ENCODER_ERROR;
 		}
 		if(FLAC__cnd_init(&encoder->private_->cond_wake_up_thread) != FLAC__thrd_success) {
+			FLAC__mtx_destroy(&encoder->private_->mutex_subframe_jobs);
+			FLAC__cnd_destroy(&encoder->private_->cond_subframe_jobs_available);
+			FLAC__cnd_destroy(&encoder->private_->cond_subframe_jobs_done);
 			FLAC__mtx_destroy(&encoder->private_->mutex_md5_fifo);
 			FLAC__mtx_destroy(&encoder->private_->mutex_work_queue);
 			FLAC__cnd_destroy(&encoder->private_->cond_md5_emptied);
@@ -1168,11 +1302,7 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 			encoder->private_->md5_fifo.size = (encoder->protected_->blocksize+OVERREAD_) * (encoder->private_->num_threadtasks + 2);
 			for(i = 0; i < encoder->protected_->channels; i++) {
 				if(0 == (encoder->private_->md5_fifo.data[i] = safe_malloc_mul_2op_p(sizeof(FLAC__int32), /*times*/encoder->private_->md5_fifo.size))) {
-					FLAC__mtx_destroy(&encoder->private_->mutex_md5_fifo);
-					FLAC__mtx_destroy(&encoder->private_->mutex_work_queue);
-					FLAC__cnd_destroy(&encoder->private_->cond_md5_emptied);
-					FLAC__cnd_destroy(&encoder->private_->cond_work_available);
-					FLAC__cnd_destroy(&encoder->private_->cond_wake_up_thread);
+					destroy_thread_locks_(encoder);
 					encoder->protected_->state = FLAC__STREAM_ENCODER_MEMORY_ALLOCATION_ERROR;
 					return FLAC__STREAM_ENCODER_INIT_STATUS_ENCODER_ERROR;
 				}
@@ -1243,11 +1373,12 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
 	for(i = 0; i < encoder->protected_->num_apodizations; i++)
-		encoder->private_->window_unaligned[i] = encoder->private_->window[i] = 0;
+		encoder->private_->window[i] = 0;
 #endif
 	for(t = 0; t < encoder->private_->num_threadtasks; t++) {
 		for(i = 0; i < encoder->protected_->channels; i++) {
 			encoder->private_->threadtask[t]->integer_signal_unaligned[i] = encoder->private_->threadtask[t]->integer_signal[i] = 0;
+			encoder->private_->threadtask[t]->verify_signal_unaligned[i] = encoder->private_->threadtask[t]->verify_signal[i] = 0;
 		}
 		for(i = 0; i < 2; i++) {
 			encoder->private_->threadtask[t]->integer_signal_mid_side_unaligned[i] = encoder->private_->threadtask[t]->integer_signal_mid_side[i] = 0;
@@ -1270,6 +1401,13 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 		encoder->private_->threadtask[t]->raw_bits_per_partition_unaligned = encoder->private_->threadtask[t]->raw_bits_per_partition = 0;
 	}
 
+	/* With more than one thread, the frames are verified by the
+	 * threadtasks making them, so verification keeps up with encoding */
+#ifdef FLAC__USE_THREADS
+	encoder->private_->verify.per_threadtask = encoder->protected_->verify && encoder->protected_->num_threads > 1 && !encoder->private_->subframe_threading;
+#else
+	encoder->private_->verify.per_threadtask = false;
+#endif
 
 	if(!resize_buffers_(encoder, encoder->protected_->blocksize)) {
 		/* the above function sets the state for us in case of an error */
@@ -1281,6 +1419,7 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 			encoder->protected_->state = FLAC__STREAM_ENCODER_MEMORY_ALLOCATION_ERROR;
 			return FLAC__STREAM_ENCODER_INIT_STATUS_ENCODER_ERROR;
 		}
+		FLAC__bitwriter_set_cpu_info(encoder->private_->threadtask[t]->frame, &encoder->private_->cpuinfo);
 	}
 
 	/*
@@ -1292,7 +1431,7 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 		 * original signal to compare against
 		 */
 		encoder->private_->verify.input_fifo.size = (encoder->protected_->blocksize+OVERREAD_) * encoder->private_->num_threadtasks;
-		for(i = 0; i < encoder->protected_->channels; i++) {
+		for(i = 0; !encoder->private_->verify.per_threadtask && i < encoder->protected_->channels; i++) {
 			if(0 == (encoder->private_->verify.input_fifo.data[i] = safe_malloc_mul_2op_p(sizeof(FLAC__int32), /*times*/encoder->private_->verify.input_fifo.size))) {
 				encoder->protected_->state = FLAC__STREAM_ENCODER_MEMORY_ALLOCATION_ERROR;
 				return FLAC__STREAM_ENCODER_INIT_STATUS_ENCODER_ERROR;
@@ -1315,6 +1454,22 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 			encoder->protected_->state = FLAC__STREAM_ENCODER_VERIFY_DECODER_ERROR;
 			return FLAC__STREAM_ENCODER_INIT_STATUS_ENCODER_ERROR;
 		}
+
+		/*
+		 * The decoder above then only checks the metadata, and every
+		 * threadtask gets a decoder of its own for its frames
+		 */
+		for(t = 0; encoder->private_->verify.per_threadtask && t < encoder->private_->num_threadtasks; t++) {
+			FLAC__StreamEncoderThreadTask *threadtask = encoder->private_->threadtask[t];
+			if(0 == (threadtask->verify_decoder = FLAC__stream_decoder_new())) {
+				encoder->protected_->state = FLAC__STREAM_ENCODER_VERIFY_DECODER_ERROR;
+				return FLAC__STREAM_ENCODER_INIT_STATUS_ENCODER_ERROR;
+			}
+			if(FLAC__stream_decoder_init_stream(threadtask->verify_decoder, verify_threadtask_read_callback_, /*seek_callback=*/0, /*tell_callback=*/0, /*length_callback=*/0, /*eof_callback=*/0, verify_threadtask_write_callback_, /*metadata_callback=*/0, verify_threadtask_error_callback_, /*client_data=*/threadtask) != FLAC__STREAM_DECODER_INIT_STATUS_OK) {
+				encoder->protected_->state = FLAC__STREAM_ENCODER_VERIFY_DECODER_ERROR;
+				return FLAC__STREAM_ENCODER_INIT_STATUS_ENCODER_ERROR;
+			}
+		}
 	}
 	encoder->private_->verify.error_stats.absolute_sample = 0;
 	encoder->private_->verify.error_stats.frame_number = 0;
@@ -1364,6 +1519,8 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 	encoder->private_->streaminfo.data.stream_info.bits_per_sample = encoder->protected_->bits_per_sample;
 	encoder->private_->streaminfo.data.stream_info.total_samples = encoder->protected_->total_samples_estimate; /* we will replace this later with the real total */
 	memset(encoder->private_->streaminfo.data.stream_info.md5sum, 0, 16); /* we don't know this yet; have to fill it in later */
+	for(t = 0; encoder->private_->verify.per_threadtask && t < encoder->private_->num_threadtasks; t++)
+		FLAC__stream_decoder_set_stream_info(encoder->private_->threadtask[t]->verify_decoder, &encoder->private_->streaminfo.data.stream_info);
 	if(encoder->protected_->do_md5)
 		FLAC__MD5Init(&encoder->private_->md5context);
 	if(!FLAC__add_metadata_block(&encoder->private_->streaminfo, encoder->private_->threadtask[0]->frame, true)) {
@@ -1649,7 +1806,7 @@ FLAC_API FLAC__bool FLAC__stream_encoder_finish(FLAC__StreamEncoder *encoder)
 	if(encoder->protected_->state == FLAC__STREAM_ENCODER_OK && !encoder->private_->is_being_deleted) {
 		FLAC__bool ok = true;
 		/* first finish threads */
-		if(encoder->protected_->num_threads > 1) {
+		if(encoder->protected_->num_threads > 1 && !encoder->private_->subframe_threading) {
 #ifdef FLAC__USE_THREADS
 			/* This is quite complicated, so here is an explanation on what is supposed to happen
 			 *
@@ -1684,8 +1841,11 @@ FLAC_API FLAC__bool FLAC__stream_encoder_finish(FLAC__StreamEncoder *encoder)
 				while(!encoder->private_->threadtask[t]->task_done)
 					FLAC__cnd_wait(&encoder->private_->threadtask[t]->cond_task_done,&encoder->private_->threadtask[t]->mutex_this_task);
 
-				if(!encoder->private_->threadtask[t]->returnvalue)
+				if(!encoder->private_->threadtask[t]->returnvalue) {
+					if(ok && encoder->private_->threadtask[t]->verify_mismatch)
+						encoder->private_->verify.error_stats = encoder->private_->threadtask[t]->verify_error_stats;
 					ok = false;
+				}
 				if(ok && !write_bitbuffer_(encoder, encoder->private_->threadtask[t], encoder->protected_->blocksize, 0))
 					ok = false;
 				FLAC__mtx_unlock(&encoder->private_->threadtask[t]->mutex_this_task);
@@ -1715,6 +1875,12 @@ FLAC_API FLAC__bool FLAC__stream_encoder_finish(FLAC__StreamEncoder *encoder)
 #ifdef FLAC__USE_THREADS
 		/* Properly finish all threads */
 		uint32_t t;
+		if(encoder->private_->subframe_threading) {
+			FLAC__mtx_lock(&encoder->private_->mutex_subframe_jobs);
+			encoder->private_->finish_subframe_threads = true;
+			FLAC__cnd_broadcast(&encoder->private_->cond_subframe_jobs_available);
+			FLAC__mtx_unlock(&encoder->private_->mutex_subframe_jobs);
+		}
 		FLAC__mtx_lock(&encoder->private_->mutex_work_queue);
 		for(t = 1; t < encoder->private_->num_created_threads; t++)
 			encoder->private_->finish_work_threads = true;
@@ -1722,8 +1888,12 @@ FLAC_API FLAC__bool FLAC__stream_encoder_finish(FLAC__StreamEncoder *encoder)
 		FLAC__cnd_broadcast(&encoder->private_->cond_work_available);
 		FLAC__mtx_unlock(&encoder->private_->mutex_work_queue);
 
-		for(t = 1; t < encoder->private_->num_created_threads; t++)
-			FLAC__thrd_join(encoder->private_->thread[t], NULL);
+		if(0 != encoder->protected_->thread_pool)
+			FLAC__thread_pool_detach(&encoder->private_->thread_pool_client);
+		else {
+			for(t = 1; t < encoder->private_->num_created_threads; t++)
+				FLAC__thrd_join(encoder->private_->thread[t], NULL);
+		}
 #else
 			FLAC__ASSERT(0);
 #endif
@@ -2126,6 +2296,17 @@ FLAC_API FLAC__bool FLAC__stream_encoder_set_do_exhaustive_model_search(FLAC__St
 	return true;
 }
 
+FLAC_API FLAC__bool FLAC__stream_encoder_set_prune_lpc_orders(FLAC__StreamEncoder *encoder, FLAC__bool value)
+{
+	FLAC__ASSERT(0 != encoder);
+	FLAC__ASSERT(0 != encoder->private_);
+	FLAC__ASSERT(0 != encoder->protected_);
+	if(encoder->protected_->state != FLAC__STREAM_ENCODER_UNINITIALIZED)
+		return false;
+	encoder->protected_->prune_lpc_orders = value;
+	return true;
+}
+
 FLAC_API FLAC__bool FLAC__stream_encoder_set_min_residual_partition_order(FLAC__StreamEncoder *encoder, uint32_t value)
 {
 	FLAC__ASSERT(0 != encoder);
@@ -2171,6 +2352,28 @@ FLAC_API uint32_t FLAC__stream_encoder_set_num_threads(FLAC__StreamEncoder *enco
 #endif
 }
 
+FLAC_API FLAC__bool FLAC__stream_encoder_set_intra_frame_threading(FLAC__StreamEncoder *encoder, FLAC__bool value)
+{
+	FLAC__ASSERT(0 != encoder);
+	FLAC__ASSERT(0 != encoder->private_);
+	FLAC__ASSERT(0 != encoder->protected_);
+	if(encoder->protected_->state != FLAC__STREAM_ENCODER_UNINITIALIZED)
+		return false;
+	encoder->protected_->intra_frame_threading = value;
+	return true;
+}
+
+FLAC_API FLAC__bool FLAC__stream_encoder_set_thread_pool(FLAC__StreamEncoder *encoder, FLAC__ThreadPool *pool)
+{
+	FLAC__ASSERT(0 != encoder);
+	FLAC__ASSERT(0 != encoder->private_);
+	FLAC__ASSERT(0 != encoder->protected_);
+	if(encoder->protected_->state != FLAC__STREAM_ENCODER_UNINITIALIZED)
+		return false;
+	encoder->protected_->thread_pool = pool;
+	return true;
+}
+
 FLAC_API FLAC__bool FLAC__stream_encoder_set_rice_parameter_search_dist(FLAC__StreamEncoder *encoder, uint32_t value)
 {
 	FLAC__ASSERT(0 != encoder);
@@ -2243,7 +2446,7 @@ FLAC_API FLAC__bool FLAC__stream_encoder_set_limit_min_bitrate(FLAC__StreamEncod
 }
 
 /*
- * These four functions are not static, but not publicly exposed in
+ * These five functions are not static, but not publicly exposed in
  * include/FLAC/ either.  They are used by the test suite and in fuzzing
  */
 FLAC_API FLAC__bool FLAC__stream_encoder_disable_instruction_set(FLAC__StreamEncoder *encoder, FLAC__bool value)
@@ -2296,6 +2499,17 @@ FLAC_API FLAC__bool FLAC__stream_encoder_disable_verbatim_subframes(FLAC__Stream
 	return true;
 }
 
+FLAC_API FLAC__bool FLAC__stream_encoder_disable_fused_window_autocorrelation(FLAC__StreamEncoder *encoder, FLAC__bool value)
+{
+	FLAC__ASSERT(0 != encoder);
+	FLAC__ASSERT(0 != encoder->private_);
+	FLAC__ASSERT(0 != encoder->protected_);
+	if(encoder->protected_->state != FLAC__STREAM_ENCODER_UNINITIALIZED)
+		return false;
+	encoder->private_->disable_fused_window_autocorrelation = value;
+	return true;
+}
+
 FLAC_API FLAC__StreamEncoderState FLAC__stream_encoder_get_state(const FLAC__StreamEncoder *encoder)
 {
 	FLAC__ASSERT(0 != encoder);
@@ -2462,6 +2676,14 @@ FLAC_API FLAC__bool FLAC__stream_encoder_get_do_exhaustive_model_search(const FL
 	return encoder->protected_->do_exhaustive_model_search;
 }
 
+FLAC_API FLAC__bool FLAC__stream_encoder_get_prune_lpc_orders(const FLAC__StreamEncoder *encoder)
+{
+	FLAC__ASSERT(0 != encoder);
+	FLAC__ASSERT(0 != encoder->private_);
+	FLAC__ASSERT(0 != encoder->protected_);
+	return encoder->protected_->prune_lpc_orders;
+}
+
 FLAC_API uint32_t FLAC__stream_encoder_get_min_residual_partition_order(const FLAC__StreamEncoder *encoder)
 {
 	FLAC__ASSERT(0 != encoder);
@@ -2478,6 +2700,22 @@ FLAC_API uint32_t FLAC__stream_encoder_get_num_threads(const FLAC__StreamEncoder
 	return encoder->protected_->num_threads;
 }
 
+FLAC_API FLAC__bool FLAC__stream_encoder_get_intra_frame_threading(const FLAC__StreamEncoder *encoder)
+{
+	FLAC__ASSERT(0 != encoder);
+	FLAC__ASSERT(0 != encoder->private_);
+	FLAC__ASSERT(0 != encoder->protected_);
+	return encoder->protected_->intra_frame_threading;
+}
+
+FLAC_API FLAC__ThreadPool *FLAC__stream_encoder_get_thread_pool(const FLAC__StreamEncoder *encoder)
+{
+	FLAC__ASSERT(0 != encoder);
+	FLAC__ASSERT(0 != encoder->private_);
+	FLAC__ASSERT(0 != encoder->protected_);
+	return encoder->protected_->thread_pool;
+}
+
 FLAC_API uint32_t FLAC__stream_encoder_get_max_residual_partition_order(const FLAC__StreamEncoder *encoder)
 {
 	FLAC__ASSERT(0 != encoder);
@@ -2510,6 +2748,18 @@ FLAC_API FLAC__bool FLAC__stream_encoder_get_limit_min_bitrate(const FLAC__Strea
 	return encoder->protected_->limit_min_bitrate;
 }
 
+FLAC_API void FLAC__stream_encoder_get_window_cache_statistics(FLAC__uint64 *hits, FLAC__uint64 *misses)
+{
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+	FLAC__window_cache_get_statistics(hits, misses);
+#else
+	if(0 != hits)
+		*hits = 0;
+	if(0 != misses)
+		*misses = 0;
+#endif
+}
+
 FLAC_API FLAC__bool FLAC__stream_encoder_process(FLAC__StreamEncoder *encoder, const FLAC__int32 * const buffer[], uint32_t samples)
 {
 	uint32_t i, j = 0, k = 0, channel;
@@ -2527,7 +2777,7 @@ FLAC_API FLAC__bool FLAC__stream_encoder_process(FLAC__StreamEncoder *encoder, c
 	do {
 		const uint32_t n = flac_min(blocksize+OVERREAD_-encoder->private_->current_sample_number, samples-j);
 
-		if(encoder->protected_->verify)
+		if(encoder->protected_->verify && !encoder->private_->verify.per_threadtask)
 			append_to_verify_fifo_(&encoder->private_->verify.input_fifo, buffer, j, channels, n);
 
 		for(channel = 0; channel < channels; channel++) {
@@ -2577,7 +2827,7 @@ FLAC_API FLAC__bool FLAC__stream_encoder_process_interleaved(FLAC__StreamEncoder
 
 	j = k = 0;
 	do {
-		if(encoder->protected_->verify)
+		if(encoder->protected_->verify && !encoder->private_->verify.per_threadtask)
 			append_to_verify_fifo_interleaved_(&encoder->private_->verify.input_fifo, buffer, j, channels, flac_min(blocksize+OVERREAD_-encoder->private_->current_sample_number, samples-j));
 
 			/* "i <= blocksize" to overread 1 sample; see comment in OVERREAD_ decl */
@@ -2639,6 +2889,7 @@ void set_defaults_(FLAC__StreamEncoder *encoder)
 	encoder->protected_->qlp_coeff_precision = 0;
 	encoder->protected_->do_qlp_coeff_prec_search = false;
 	encoder->protected_->do_exhaustive_model_search = false;
+	encoder->protected_->prune_lpc_orders = false;
 	encoder->protected_->do_escape_coding = false;
 	encoder->protected_->min_residual_partition_order = 0;
 	encoder->protected_->max_residual_partition_order = 0;
@@ -2648,6 +2899,8 @@ void set_defaults_(FLAC__StreamEncoder *encoder)
 	encoder->protected_->metadata = 0;
 	encoder->protected_->num_metadata_blocks = 0;
 	encoder->protected_->num_threads = 1;
+	encoder->protected_->intra_frame_threading = false;
+	encoder->protected_->thread_pool = 0;
 
 	encoder->private_->seek_table = 0;
 	encoder->private_->disable_mmx = false;
@@ -2659,6 +2912,7 @@ void set_defaults_(FLAC__StreamEncoder *encoder)
 	encoder->private_->disable_constant_subframes = false;
 	encoder->private_->disable_fixed_subframes = false;
 	encoder->private_->disable_verbatim_subframes = false;
+	encoder->private_->disable_fused_window_autocorrelation = false;
 	encoder->private_->is_ogg = false;
 	encoder->private_->read_callback = 0;
 	encoder->private_->write_callback = 0;
@@ -2678,6 +2932,12 @@ void set_defaults_(FLAC__StreamEncoder *encoder)
 	encoder->private_->next_threadtask = 1;
 	encoder->private_->md5_active = false;
 	encoder->private_->finish_work_threads = false;
+	encoder->private_->subframe_threading = false;
+	encoder->private_->num_subframe_jobs = 0;
+	encoder->private_->next_subframe_job = 0;
+	encoder->private_->next_subframe_threadtask = 1;
+	encoder->private_->finish_subframe_threads = false;
+	encoder->private_->num_free_subframe_threadtasks = 0;
 #endif
 
 #if FLAC__HAS_OGG
@@ -2699,10 +2959,8 @@ void free_(FLAC__StreamEncoder *encoder)
 	}
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
 	for(i = 0; i < encoder->protected_->num_apodizations; i++) {
-		if(0 != encoder->private_->window_unaligned[i]) {
-			free(encoder->private_->window_unaligned[i]);
-			encoder->private_->window_unaligned[i] = 0;
-		}
+		FLAC__window_cache_release(encoder->private_->window[i]);
+		encoder->private_->window[i] = 0;
 	}
 #endif
 	for(t = 0; t < encoder->private_->num_threadtasks; t++) {
@@ -2713,6 +2971,14 @@ void free_(FLAC__StreamEncoder *encoder)
 				free(encoder->private_->threadtask[t]->integer_signal_unaligned[i]);
 				encoder->private_->threadtask[t]->integer_signal_unaligned[i] = 0;
 			}
+			if(0 != encoder->private_->threadtask[t]->verify_signal_unaligned[i]) {
+				free(encoder->private_->threadtask[t]->verify_signal_unaligned[i]);
+				encoder->private_->threadtask[t]->verify_signal_unaligned[i] = 0;
+			}
+		}
+		if(0 != encoder->private_->threadtask[t]->verify_decoder) {
+			FLAC__stream_decoder_delete(encoder->private_->threadtask[t]->verify_decoder);
+			encoder->private_->threadtask[t]->verify_decoder = 0;
 		}
 		for(i = 0; i < 2; i++) {
 			if(0 != encoder->private_->threadtask[t]->integer_signal_mid_side_unaligned[i]) {
@@ -2779,11 +3045,7 @@ void free_(FLAC__StreamEncoder *encoder)
 	}
 #ifdef FLAC__USE_THREADS
 	if(encoder->protected_->num_threads > 1) {
-		FLAC__mtx_destroy(&encoder->private_->mutex_md5_fifo);
-		FLAC__mtx_destroy(&encoder->private_->mutex_work_queue);
-		FLAC__cnd_destroy(&encoder->private_->cond_md5_emptied);
-		FLAC__cnd_destroy(&encoder->private_->cond_work_available);
-		FLAC__cnd_destroy(&encoder->private_->cond_wake_up_thread);
+		destroy_thread_locks_(encoder);
 		if(encoder->protected_->do_md5) {
 			for(i = 0; i < encoder->protected_->channels; i++) {
 				if(0 != encoder->private_->md5_fifo.data[i]) {
@@ -2823,12 +3085,6 @@ FLAC__bool resize_buffers_(FLAC__StreamEncoder *encoder, uint32_t new_blocksize)
 		 * have a buffer of up to 3 zeroes in front (at negative indices) for
 		 * alignment purposes; we use 4 in front to keep the data well-aligned.
 		 */
-#ifndef FLAC__INTEGER_ONLY_LIBRARY
-		if(ok && encoder->protected_->max_lpc_order > 0) {
-			for(i = 0; ok && i < encoder->protected_->num_apodizations; i++)
-				ok = ok && FLAC__memory_alloc_aligned_real_array(new_blocksize, &encoder->private_->window_unaligned[i], &encoder->private_->window[i]);
-		}
-#endif
 		for(t = 0; t < encoder->private_->num_threadtasks; t++) {
 			for(i = 0; ok && i < encoder->protected_->channels; i++) {
 				ok = ok && FLAC__memory_alloc_aligned_int32_array(new_blocksize+4+OVERREAD_, &encoder->private_->threadtask[t]->integer_signal_unaligned[i], &encoder->private_->threadtask[t]->integer_signal[i]);
@@ -2836,6 +3092,8 @@ FLAC__bool resize_buffers_(FLAC__StreamEncoder *encoder, uint32_t new_blocksize)
 					memset(encoder->private_->threadtask[t]->integer_signal[i], 0, sizeof(FLAC__int32)*4);
 					encoder->private_->threadtask[t]->integer_signal[i] += 4;
 				}
+				if(encoder->private_->verify.per_threadtask)
+					ok = ok && FLAC__memory_alloc_aligned_int32_array(new_blocksize, &encoder->private_->threadtask[t]->verify_signal_unaligned[i], &encoder->private_->threadtask[t]->verify_signal[i]);
 			}
 			for(i = 0; ok && i < 2; i++) {
 				ok = ok && FLAC__memory_alloc_aligned_int32_array(new_blocksize+4+OVERREAD_, &encoder->private_->threadtask[t]->integer_signal_mid_side_unaligned[i], &encoder->private_->threadtask[t]->integer_signal_mid_side[i]);
@@ -2896,71 +3154,18 @@ FLAC__bool resize_buffers_(FLAC__StreamEncoder *encoder, uint32_t new_blocksize)
 	}
 
 
-	/* now adjust the windows if the blocksize has changed */
+	/* now adjust the windows if the blocksize has changed; they are
+	 * shared with other encoders using the same apodization functions */
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
 	if(encoder->protected_->max_lpc_order > 0 && new_blocksize > 1) {
 		for(i = 0; i < encoder->protected_->num_apodizations; i++) {
-			switch(encoder->protected_->apodizations[i].type) {
-				case FLAC__APODIZATION_BARTLETT:
-					FLAC__window_bartlett(encoder->private_->window[i], new_blocksize);
-					break;
-				case FLAC__APODIZATION_BARTLETT_HANN:
-					FLAC__window_bartlett_hann(encoder->private_->window[i], new_blocksize);
-					break;
-				case FLAC__APODIZATION_BLACKMAN:
-					FLAC__window_blackman(encoder->private_->window[i], new_blocksize);
-					break;
-				case FLAC__APODIZATION_BLACKMAN_HARRIS_4TERM_92DB_SIDELOBE:
-					FLAC__window_blackman_harris_4term_92db_sidelobe(encoder->private_->window[i], new_blocksize);
-					break;
-				case FLAC__APODIZATION_CONNES:
-					FLAC__window_connes(encoder->private_->window[i], new_blocksize);
-					break;
-				case FLAC__APODIZATION_FLATTOP:
-					FLAC__window_flattop(encoder->private_->window[i], new_blocksize);
-					break;
-				case FLAC__APODIZATION_GAUSS:
-					FLAC__window_gauss(encoder->private_->window[i], new_blocksize, encoder->protected_->apodizations[i].parameters.gauss.stddev);
-					break;
-				case FLAC__APODIZATION_HAMMING:
-					FLAC__window_hamming(encoder->private_->window[i], new_blocksize);
-					break;
-				case FLAC__APODIZATION_HANN:
-					FLAC__window_hann(encoder->private_->window[i], new_blocksize);
-					break;
-				case FLAC__APODIZATION_KAISER_BESSEL:
-					FLAC__window_kaiser_bessel(encoder->private_->window[i], new_blocksize);
-					break;
-				case FLAC__APODIZATION_NUTTALL:
-					FLAC__window_nuttall(encoder->private_->window[i], new_blocksize);
-					break;
-				case FLAC__APODIZATION_RECTANGLE:
-					FLAC__window_rectangle(encoder->private_->window[i], new_blocksize);
-					break;
-				case FLAC__APODIZATION_TRIANGLE:
-					FLAC__window_triangle(encoder->private_->window[i], new_blocksize);
-					break;
-				case FLAC__APODIZATION_TUKEY:
-					FLAC__window_tukey(encoder->private_->window[i], new_blocksize, encoder->protected_->apodizations[i].parameters.tukey.p);
-					break;
-				case FLAC__APODIZATION_PARTIAL_TUKEY:
-					FLAC__window_partial_tukey(encoder->private_->window[i], new_blocksize, encoder->protected_->apodizations[i].parameters.multiple_tukey.p, encoder->protected_->apodizations[i].parameters.multiple_tukey.start, encoder->protected_->apodizations[i].parameters.multiple_tukey.end);
-					break;
-				case FLAC__APODIZATION_PUNCHOUT_TUKEY:
-					FLAC__window_punchout_tukey(encoder->private_->window[i], new_blocksize, encoder->protected_->apodizations[i].parameters.multiple_tukey.p, encoder->protected_->apodizations[i].parameters.multiple_tukey.start, encoder->protected_->apodizations[i].parameters.multiple_tukey.end);
-					break;
-				case FLAC__APODIZATION_SUBDIVIDE_TUKEY:
-					FLAC__window_tukey(encoder->private_->window[i], new_blocksize, encoder->protected_->apodizations[i].parameters.tukey.p);
-					break;
-				case FLAC__APODIZATION_WELCH:
-					FLAC__window_welch(encoder->private_->window[i], new_blocksize);
-					break;
-				default:
-					FLAC__ASSERT(0);
-					/* double protection */
-					FLAC__window_hann(encoder->private_->window[i], new_blocksize);
-					break;
+			const FLAC__real *window = FLAC__window_cache_acquire(&encoder->protected_->apodizations[i], new_blocksize);
+			if(0 == window) {
+				encoder->protected_->state = FLAC__STREAM_ENCODER_MEMORY_ALLOCATION_ERROR;
+				return false;
 			}
+			FLAC__window_cache_release(encoder->private_->window[i]);
+			encoder->private_->window[i] = window;
 		}
 	}
 	if (new_blocksize <= FLAC__MAX_LPC_ORDER) {
@@ -2985,7 +3190,8 @@ FLAC__bool write_bitbuffer_(FLAC__StreamEncoder *encoder, FLAC__StreamEncoderThr
 		return false;
 	}
 
-	if(encoder->protected_->verify) {
+	/* frames verified by their threadtask already are not passed on */
+	if(encoder->protected_->verify && !(samples > 0 && encoder->private_->verify.per_threadtask)) {
 		encoder->private_->verify.output.data = buffer;
 		encoder->private_->verify.output.bytes = bytes;
 		if(encoder->private_->verify.state_hint == ENCODER_IN_MAGIC) {
@@ -3423,10 +3629,8 @@ void update_ogg_metadata_(FLAC__StreamEncoder *encoder)
 FLAC__bool process_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_last_block)
 {
 	FLAC__uint16 crc;
-#ifdef FLAC__USE_THREADS
 	uint32_t i;
-#endif
-	if(encoder->protected_->num_threads < 2 || is_last_block) {
+	if(encoder->protected_->num_threads < 2 || is_last_block || encoder->private_->subframe_threading) {
 
 		FLAC__ASSERT(encoder->protected_->state == FLAC__STREAM_ENCODER_OK);
 
@@ -3438,6 +3642,11 @@ FLAC__bool process_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_last_block
 			return false;
 		}
 
+		if(encoder->private_->verify.per_threadtask) {
+			for(i = 0; i < encoder->protected_->channels; i++)
+				memcpy(encoder->private_->threadtask[0]->verify_signal[i], encoder->private_->threadtask[0]->integer_signal[i], encoder->protected_->blocksize * sizeof(encoder->private_->threadtask[0]->integer_signal[i][0]));
+		}
+
 		/*
 		 * Process the frame header and subframes into the frame bitbuffer
 		 */
@@ -3467,6 +3676,13 @@ FLAC__bool process_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_last_block
 			return false;
 		}
 
+		if(encoder->private_->verify.per_threadtask && !verify_threadtask_frame_(encoder, encoder->private_->threadtask[0])) {
+			/* the above function sets the state for us in case of an error */
+			if(encoder->private_->threadtask[0]->verify_mismatch)
+				encoder->private_->verify.error_stats = encoder->private_->threadtask[0]->verify_error_stats;
+			return false;
+		}
+
 		/*
 		 * Write it
 		 */
@@ -3510,9 +3726,16 @@ FLAC__bool process_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_last_block
 		 * and next_threadtask start at 1
 		 */
 		if(encoder->private_->num_created_threads < encoder->protected_->num_threads) {
-			/* Create a new thread */
-			FLAC__thrd_create(&encoder->private_->thread[encoder->private_->next_thread],
-					process_frame_thread_, encoder);
+			if(0 != encoder->protected_->thread_pool) {
+				/* The threads of the pool take the place of the threads of this encoder */
+				if(encoder->private_->num_created_threads == 1)
+					FLAC__thread_pool_attach(encoder->protected_->thread_pool, &encoder->private_->thread_pool_client, process_frame_pool_job_, encoder, encoder->protected_->num_threads - 1, encoder->private_->num_threadtasks);
+			}
+			else {
+				/* Create a new thread */
+				FLAC__thrd_create(&encoder->private_->thread[encoder->private_->next_thread],
+						process_frame_thread_, encoder);
+			}
 			encoder->private_->num_created_threads++;
 		}
 		else if(encoder->private_->num_started_threadtasks == encoder->private_->num_threadtasks) {
@@ -3521,20 +3744,17 @@ FLAC__bool process_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_last_block
 			 * First, check whether the mutex for the next due task is locked or free. If it is free (and thus acquired now) and
 			 * the task is done, proceed to the next bit (writing the bitbuffer). If it is either currently locked or not yet
 			 * processed, choose between starting on some work (if there is enough work in the queue) or waiting for the task
-			 * to finish. Either way, release the mutex first, so it doesn't get interlocked with the work queue mutex  */
+			 * to finish. Either way, release the mutex first, so it doesn't get interlocked with the work queue mutex.
+			 * With a thread pool, the threads of the pool might all be busy with other encoders, so any work left is started on */
+			const uint32_t min_available = 0 != encoder->protected_->thread_pool ? 1 : encoder->protected_->num_threads;
 			int mutex_result = (FLAC__mtx_trylock(&encoder->private_->threadtask[encoder->private_->next_thread]->mutex_this_task) == FLAC__thrd_success) ? 0 : 1;
 			while(mutex_result || !encoder->private_->threadtask[encoder->private_->next_thread]->task_done) {
 				if(!mutex_result)
 					FLAC__mtx_unlock(&encoder->private_->threadtask[encoder->private_->next_thread]->mutex_this_task);
 
 				FLAC__mtx_lock(&encoder->private_->mutex_work_queue);
-				if(encoder->private_->num_available_threadtasks > (encoder->protected_->num_threads - 1)) {
-					FLAC__StreamEncoderThreadTask * task = NULL;
-					task = encoder->private_->threadtask[encoder->private_->next_threadtask];
-					encoder->private_->num_available_threadtasks--;
-					encoder->private_->next_threadtask++;
-					if(encoder->private_->next_threadtask == encoder->private_->num_threadtasks)
-						encoder->private_->next_threadtask = 1;
+				if(encoder->private_->num_available_threadtasks >= min_available) {
+					FLAC__StreamEncoderThreadTask * task = take_threadtask_(encoder);
 					FLAC__mtx_unlock(&encoder->private_->mutex_work_queue);
 					FLAC__mtx_lock(&task->mutex_this_task);
 					process_frame_thread_inner_(encoder, task);
@@ -3550,6 +3770,8 @@ FLAC__bool process_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_last_block
 			}
 			/* Task is finished, write bitbuffer */
 			if(!encoder->private_->threadtask[encoder->private_->next_thread]->returnvalue) {
+				if(encoder->private_->threadtask[encoder->private_->next_thread]->verify_mismatch)
+					encoder->private_->verify.error_stats = encoder->private_->threadtask[encoder->private_->next_thread]->verify_error_stats;
 				FLAC__mtx_unlock(&encoder->private_->threadtask[encoder->private_->next_thread]->mutex_this_task);
 				return false;
 			}
@@ -3579,8 +3801,11 @@ FLAC__bool process_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_last_block
 
 		/* Copy input data for frame creation */
 		FLAC__mtx_lock(&encoder->private_->threadtask[encoder->private_->next_thread]->mutex_this_task);
-		for(i = 0; i < encoder->protected_->channels; i++)
+		for(i = 0; i < encoder->protected_->channels; i++) {
 			memcpy(encoder->private_->threadtask[encoder->private_->next_thread]->integer_signal[i], encoder->private_->threadtask[0]->integer_signal[i], encoder->protected_->blocksize * sizeof(encoder->private_->threadtask[0]->integer_signal[i][0]));
+			if(encoder->private_->verify.per_threadtask)
+				memcpy(encoder->private_->threadtask[encoder->private_->next_thread]->verify_signal[i], encoder->private_->threadtask[0]->integer_signal[i], encoder->protected_->blocksize * sizeof(encoder->private_->threadtask[0]->integer_signal[i][0]));
+		}
 
 		encoder->private_->threadtask[encoder->private_->next_thread]->current_frame_number = encoder->private_->current_frame_number;
 		FLAC__mtx_unlock(&encoder->private_->threadtask[encoder->private_->next_thread]->mutex_this_task);
@@ -3592,6 +3817,8 @@ FLAC__bool process_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_last_block
 		encoder->private_->threadtask[encoder->private_->next_thread]->task_done = false;
 		FLAC__cnd_signal(&encoder->private_->cond_work_available);
 		FLAC__mtx_unlock(&encoder->private_->mutex_work_queue);
+		if(0 != encoder->protected_->thread_pool)
+			FLAC__thread_pool_submit(&encoder->private_->thread_pool_client);
 
 		encoder->private_->next_thread++;
 		if(encoder->private_->next_thread == encoder->private_->num_threadtasks)
@@ -3614,7 +3841,6 @@ FLAC__bool process_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_last_block
 #ifdef FLAC__USE_THREADS
 FLAC__thread_return_type process_frame_thread_(void * args) {
 	FLAC__StreamEncoder * encoder = args;
-	uint32_t channel;
 
 	FLAC__mtx_lock(&encoder->private_->mutex_work_queue);
 	encoder->private_->num_running_threads++;
@@ -3652,33 +3878,12 @@ FLAC__thread_return_type process_frame_thread_(void * args) {
 			FLAC__cnd_wait(&encoder->private_->cond_work_available, &encoder->private_->mutex_work_queue);
 		}
 		if(encoder->protected_->do_md5 && !encoder->private_->md5_active && encoder->private_->md5_fifo.tail > 0) {
-			uint32_t length = 0;
-			encoder->private_->md5_active = true;
-			while(encoder->private_->md5_fifo.tail > 0) {
-				length = encoder->private_->md5_fifo.tail;
-				FLAC__mtx_unlock(&encoder->private_->mutex_work_queue);
-				if(!FLAC__MD5Accumulate(&encoder->private_->md5context, (const FLAC__int32 * const *)encoder->private_->md5_fifo.data, encoder->protected_->channels, length, (encoder->protected_->bits_per_sample+7) / 8)) {
-					encoder->protected_->state = FLAC__STREAM_ENCODER_MEMORY_ALLOCATION_ERROR;
-					return FLAC__thread_default_return_value;
-				}
-				FLAC__mtx_lock(&encoder->private_->mutex_md5_fifo);
-				for(channel = 0; channel < encoder->protected_->channels; channel++)
-					memmove(&encoder->private_->md5_fifo.data[channel][0], &encoder->private_->md5_fifo.data[channel][length], (encoder->private_->md5_fifo.tail-length) * sizeof(encoder->private_->md5_fifo.data[0][0]));
-				FLAC__mtx_lock(&encoder->private_->mutex_work_queue);
-				encoder->private_->md5_fifo.tail -= length;
-				FLAC__cnd_signal(&encoder->private_->cond_md5_emptied);
-				FLAC__mtx_unlock(&encoder->private_->mutex_md5_fifo);
-			}
-			encoder->private_->md5_active = false;
+			if(!accumulate_md5_fifo_(encoder))
+				return FLAC__thread_default_return_value;
 			FLAC__mtx_unlock(&encoder->private_->mutex_work_queue);
 		}
 		else if(encoder->private_->num_available_threadtasks > 0) {
-			FLAC__StreamEncoderThreadTask * task = NULL;
-			task = encoder->private_->threadtask[encoder->private_->next_threadtask];
-			encoder->private_->num_available_threadtasks--;
-			encoder->private_->next_threadtask++;
-			if(encoder->private_->next_threadtask == encoder->private_->num_threadtasks)
-				encoder->private_->next_threadtask = 1;
+			FLAC__StreamEncoderThreadTask * task = take_threadtask_(encoder);
 			FLAC__mtx_unlock(&encoder->private_->mutex_work_queue);
 			FLAC__mtx_lock(&task->mutex_this_task);
 			if(!process_frame_thread_inner_(encoder, task))
@@ -3690,6 +3895,248 @@ FLAC__thread_return_type process_frame_thread_(void * args) {
 	}
 }
 
+/* Run by a thread of the thread pool once for every queued threadtask. It does
+ * what a thread of the encoder does when woken up, but returns instead of
+ * waiting for more work. The task it was run for might have been taken already */
+void process_frame_pool_job_(void * args) {
+	FLAC__StreamEncoder * encoder = args;
+
+	FLAC__mtx_lock(&encoder->private_->mutex_work_queue);
+	if(encoder->protected_->do_md5 && !encoder->private_->md5_active && encoder->private_->md5_fifo.tail > 0) {
+		if(!accumulate_md5_fifo_(encoder))
+			return;
+	}
+	if(encoder->private_->num_available_threadtasks > 0) {
+		FLAC__StreamEncoderThreadTask * task = take_threadtask_(encoder);
+		FLAC__mtx_unlock(&encoder->private_->mutex_work_queue);
+		FLAC__mtx_lock(&task->mutex_this_task);
+		process_frame_thread_inner_(encoder, task);
+	}
+	else
+		FLAC__mtx_unlock(&encoder->private_->mutex_work_queue);
+}
+
+void destroy_thread_locks_(FLAC__StreamEncoder *encoder)
+{
+	FLAC__mtx_destroy(&encoder->private_->mutex_md5_fifo);
+	FLAC__mtx_destroy(&encoder->private_->mutex_work_queue);
+	FLAC__cnd_destroy(&encoder->private_->cond_md5_emptied);
+	FLAC__cnd_destroy(&encoder->private_->cond_work_available);
+	FLAC__cnd_destroy(&encoder->private_->cond_wake_up_thread);
+	FLAC__mtx_destroy(&encoder->private_->mutex_subframe_jobs);
+	FLAC__cnd_destroy(&encoder->private_->cond_subframe_jobs_available);
+	FLAC__cnd_destroy(&encoder->private_->cond_subframe_jobs_done);
+}
+
+/* Takes the next threadtask that is available to work on. Must be called
+ * with mutex_work_queue locked */
+FLAC__StreamEncoderThreadTask * take_threadtask_(FLAC__StreamEncoder *encoder)
+{
+	FLAC__StreamEncoderThreadTask * task = encoder->private_->threadtask[encoder->private_->next_threadtask];
+
+	FLAC__ASSERT(encoder->private_->num_available_threadtasks > 0);
+	encoder->private_->num_available_threadtasks--;
+	encoder->private_->next_threadtask++;
+	if(encoder->private_->next_threadtask == encoder->private_->num_threadtasks)
+		encoder->private_->next_threadtask = 1;
+	return task;
+}
+
+/* Feeds everything in the MD5 FIFO to the MD5 context. Must be called with
+ * mutex_work_queue locked, which is released while the MD5 is calculated. It
+ * is locked again on return, unless the MD5 calculation failed */
+FLAC__bool accumulate_md5_fifo_(FLAC__StreamEncoder *encoder)
+{
+	uint32_t channel, length;
+
+	encoder->private_->md5_active = true;
+	while(encoder->private_->md5_fifo.tail > 0) {
+		length = encoder->private_->md5_fifo.tail;
+		FLAC__mtx_unlock(&encoder->private_->mutex_work_queue);
+		if(!FLAC__MD5Accumulate(&encoder->private_->md5context, (const FLAC__int32 * const *)encoder->private_->md5_fifo.data, encoder->protected_->channels, length, (encoder->protected_->bits_per_sample+7) / 8)) {
+			encoder->protected_->state = FLAC__STREAM_ENCODER_MEMORY_ALLOCATION_ERROR;
+			return false;
+		}
+		FLAC__mtx_lock(&encoder->private_->mutex_md5_fifo);
+		for(channel = 0; channel < encoder->protected_->channels; channel++)
+			memmove(&encoder->private_->md5_fifo.data[channel][0], &encoder->private_->md5_fifo.data[channel][length], (encoder->private_->md5_fifo.tail-length) * sizeof(encoder->private_->md5_fifo.data[0][0]));
+		FLAC__mtx_lock(&encoder->private_->mutex_work_queue);
+		encoder->private_->md5_fifo.tail -= length;
+		FLAC__cnd_signal(&encoder->private_->cond_md5_emptied);
+		FLAC__mtx_unlock(&encoder->private_->mutex_md5_fifo);
+	}
+	encoder->private_->md5_active = false;
+	return true;
+}
+
+FLAC__thread_return_type process_subframe_thread_(void * args) {
+	FLAC__StreamEncoder * encoder = args;
+	FLAC__StreamEncoderThreadTask * threadtask;
+
+	FLAC__mtx_lock(&encoder->private_->mutex_subframe_jobs);
+	threadtask = encoder->private_->threadtask[encoder->private_->next_subframe_threadtask++];
+	threadtask->disable_constant_subframes = encoder->private_->disable_constant_subframes;
+	while(1) {
+		while(encoder->private_->next_subframe_job == encoder->private_->num_subframe_jobs && !encoder->private_->finish_subframe_threads)
+			FLAC__cnd_wait(&encoder->private_->cond_subframe_jobs_available, &encoder->private_->mutex_subframe_jobs);
+		if(encoder->private_->finish_subframe_threads) {
+			FLAC__mtx_unlock(&encoder->private_->mutex_subframe_jobs);
+			return FLAC__thread_default_return_value;
+		}
+		run_subframe_jobs_(encoder, threadtask);
+	}
+}
+
+/* Run by a thread of the thread pool to help with the subframe jobs of the
+ * current frame. Jobs run for an earlier frame find nothing left to do. The
+ * pool runs no more jobs at once than there are scratch threadtasks */
+void process_subframe_pool_job_(void * args) {
+	FLAC__StreamEncoder * encoder = args;
+	FLAC__StreamEncoderThreadTask * threadtask;
+	uint32_t t;
+
+	FLAC__mtx_lock(&encoder->private_->mutex_subframe_jobs);
+	if(encoder->private_->next_subframe_job < encoder->private_->num_subframe_jobs) {
+		FLAC__ASSERT(encoder->private_->num_free_subframe_threadtasks > 0);
+		t = encoder->private_->free_subframe_threadtask[--encoder->private_->num_free_subframe_threadtasks];
+		threadtask = encoder->private_->threadtask[t];
+		threadtask->disable_constant_subframes = encoder->private_->disable_constant_subframes;
+		run_subframe_jobs_(encoder, threadtask);
+		encoder->private_->free_subframe_threadtask[encoder->private_->num_free_subframe_threadtasks++] = t;
+	}
+	FLAC__mtx_unlock(&encoder->private_->mutex_subframe_jobs);
+}
+
+/* Searches the subframes of one frame with all threads at once. The
+ * threadtask of the calling thread takes part, the other threads each use a
+ * threadtask of their own as scratch space. The result is the same as that of
+ * the passes in process_subframes_() */
+FLAC__bool process_subframes_concurrently_(FLAC__StreamEncoder *encoder, FLAC__StreamEncoderThreadTask *threadtask, uint32_t min_partition_order, uint32_t max_partition_order, const FLAC__FrameHeader *frame_header, FLAC__bool do_independent, FLAC__bool do_mid_side)
+{
+	FLAC__StreamEncoderSubframeJob *job;
+	uint32_t channel, t, num_jobs = 0;
+	FLAC__bool ok;
+
+	if(0 != encoder->protected_->thread_pool) {
+		if(0 == encoder->private_->thread_pool_client.pool) {
+			for(t = 1; t < encoder->protected_->num_threads; t++)
+				encoder->private_->free_subframe_threadtask[encoder->private_->num_free_subframe_threadtasks++] = t;
+			FLAC__thread_pool_attach(encoder->protected_->thread_pool, &encoder->private_->thread_pool_client, process_subframe_pool_job_, encoder, encoder->protected_->num_threads - 1, encoder->protected_->num_threads - 1);
+		}
+	}
+	else {
+		while(encoder->private_->num_created_threads < encoder->protected_->num_threads) {
+			FLAC__thrd_create(&encoder->private_->thread[encoder->private_->num_created_threads], process_subframe_thread_, encoder);
+			encoder->private_->num_created_threads++;
+		}
+	}
+
+	FLAC__mtx_lock(&encoder->private_->mutex_subframe_jobs);
+	if(do_independent) {
+		for(channel = 0; channel < encoder->protected_->channels; channel++) {
+			job = &encoder->private_->subframe_job[num_jobs++];
+			job->subframe_bps = threadtask->subframe_bps[channel];
+			job->integer_signal = threadtask->integer_signal[channel];
+			job->subframe = threadtask->subframe_workspace_ptr[channel];
+			job->partitioned_rice_contents = threadtask->partitioned_rice_contents_workspace_ptr[channel];
+			job->residual = threadtask->residual_workspace[channel];
+			job->best_subframe = threadtask->best_subframe + channel;
+			job->best_bits = threadtask->best_subframe_bits + channel;
+		}
+	}
+	if(do_mid_side) {
+		FLAC__ASSERT(encoder->protected_->channels == 2);
+		for(channel = 0; channel < 2; channel++) {
+			job = &encoder->private_->subframe_job[num_jobs++];
+			job->subframe_bps = threadtask->subframe_bps_mid_side[channel];
+			if(threadtask->subframe_bps_mid_side[channel] <= 32)
+				job->integer_signal = threadtask->integer_signal_mid_side[channel];
+			else
+				job->integer_signal = threadtask->integer_signal_33bit_side;
+			job->subframe = threadtask->subframe_workspace_ptr_mid_side[channel];
+			job->partitioned_rice_contents = threadtask->partitioned_rice_contents_workspace_ptr_mid_side[channel];
+			job->residual = threadtask->residual_workspace_mid_side[channel];
+			job->best_subframe = threadtask->best_subframe_mid_side + channel;
+			job->best_bits = threadtask->best_subframe_bits_mid_side + channel;
+		}
+	}
+	encoder->private_->subframe_min_partition_order = min_partition_order;
+	encoder->private_->subframe_max_partition_order = max_partition_order;
+	encoder->private_->subframe_frame_header = frame_header;
+	encoder->private_->subframe_jobs_ok = true;
+	encoder->private_->num_subframe_jobs_done = 0;
+	encoder->private_->next_subframe_job = 0;
+	encoder->private_->num_subframe_jobs = num_jobs;
+	FLAC__cnd_broadcast(&encoder->private_->cond_subframe_jobs_available);
+	for(t = 1; t < num_jobs && 0 != encoder->protected_->thread_pool; t++)
+		FLAC__thread_pool_submit(&encoder->private_->thread_pool_client);
+
+	run_subframe_jobs_(encoder, threadtask);
+	while(encoder->private_->num_subframe_jobs_done < num_jobs)
+		FLAC__cnd_wait(&encoder->private_->cond_subframe_jobs_done, &encoder->private_->mutex_subframe_jobs);
+	ok = encoder->private_->subframe_jobs_ok;
+	encoder->private_->num_subframe_jobs = encoder->private_->next_subframe_job = 0;
+	FLAC__mtx_unlock(&encoder->private_->mutex_subframe_jobs);
+	if(!ok)
+		return false;
+
+	/* Done one after the other, the last independent subframe and everything after it
+	 * is searched without constant subframes when all independent subframes before it
+	 * are constant, see process_subframes_(). That only changes subframes that came out
+	 * constant, so only those are searched again */
+	if(do_independent && encoder->protected_->limit_min_bitrate) {
+		FLAC__bool all_subframes_constant = true;
+		for(channel = 0; channel + 1 < encoder->protected_->channels; channel++)
+			if(threadtask->subframe_workspace[channel][threadtask->best_subframe[channel]].type != FLAC__SUBFRAME_TYPE_CONSTANT)
+				all_subframes_constant = false;
+		if(all_subframes_constant) {
+			uint32_t j;
+			threadtask->disable_constant_subframes = true;
+			for(j = encoder->protected_->channels - 1; j < num_jobs; j++) {
+				job = &encoder->private_->subframe_job[j];
+				if(job->subframe[*job->best_subframe]->type == FLAC__SUBFRAME_TYPE_CONSTANT && !run_subframe_job_(encoder, threadtask, job))
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+/* Runs subframe jobs until none are left to pick up. Must be called with
+ * mutex_subframe_jobs locked, which is released while searching */
+void run_subframe_jobs_(FLAC__StreamEncoder *encoder, FLAC__StreamEncoderThreadTask *threadtask)
+{
+	while(encoder->private_->next_subframe_job < encoder->private_->num_subframe_jobs) {
+		const FLAC__StreamEncoderSubframeJob *job = &encoder->private_->subframe_job[encoder->private_->next_subframe_job++];
+		FLAC__bool ok;
+		FLAC__mtx_unlock(&encoder->private_->mutex_subframe_jobs);
+		ok = run_subframe_job_(encoder, threadtask, job);
+		FLAC__mtx_lock(&encoder->private_->mutex_subframe_jobs);
+		if(!ok)
+			encoder->private_->subframe_jobs_ok = false;
+		if(++encoder->private_->num_subframe_jobs_done == encoder->private_->num_subframe_jobs)
+			FLAC__cnd_signal(&encoder->private_->cond_subframe_jobs_done);
+	}
+}
+
+FLAC__bool run_subframe_job_(FLAC__StreamEncoder *encoder, FLAC__StreamEncoderThreadTask *threadtask, const FLAC__StreamEncoderSubframeJob *job)
+{
+	return process_subframe_(
+		encoder,
+		threadtask,
+		encoder->private_->subframe_min_partition_order,
+		encoder->private_->subframe_max_partition_order,
+		encoder->private_->subframe_frame_header,
+		job->subframe_bps,
+		job->integer_signal,
+		job->subframe,
+		job->partitioned_rice_contents,
+		job->residual,
+		job->best_subframe,
+		job->best_bits
+	);
+}
+
 FLAC__bool process_frame_thread_inner_(FLAC__StreamEncoder * encoder, FLAC__StreamEncoderThreadTask * task) {
 	FLAC__bool ok = true;
 	FLAC__uint16 crc;
@@ -3724,6 +4171,14 @@ FLAC__bool process_frame_thread_inner_(FLAC__StreamEncoder * encoder, FLAC__Stre
 		encoder->protected_->state = FLAC__STREAM_ENCODER_MEMORY_ALLOCATION_ERROR;
 		ok = false;
 	}
+
+	/*
+	 * Decode it again and compare
+	 */
+	if(ok && encoder->private_->verify.per_threadtask && !verify_threadtask_frame_(encoder, task)) {
+		/* the above function sets the state for us in case of an error */
+		ok = false;
+	}
 	task->returnvalue = ok;
 	task->task_done = true;
 	FLAC__cnd_signal(&task->cond_task_done);
@@ -3736,7 +4191,7 @@ FLAC__bool process_subframes_(FLAC__StreamEncoder *encoder, FLAC__StreamEncoderT
 {
 	FLAC__FrameHeader frame_header;
 	uint32_t channel, min_partition_order = encoder->protected_->min_residual_partition_order, max_partition_order;
-	FLAC__bool do_independent, do_mid_side, all_subframes_constant = true;
+	FLAC__bool do_independent, do_mid_side, do_independent_pass, do_mid_side_pass, all_subframes_constant = true;
 
 	threadtask->disable_constant_subframes = encoder->private_->disable_constant_subframes;
 
@@ -3804,6 +4259,8 @@ FLAC__bool process_subframes_(FLAC__StreamEncoder *encoder, FLAC__StreamEncoderT
 	}
 
 	FLAC__ASSERT(do_independent || do_mid_side);
+	do_independent_pass = do_independent;
+	do_mid_side_pass = do_mid_side;
 
 	/*
 	 * Prepare mid-side signals if applicable
@@ -3854,10 +4311,18 @@ FLAC__bool process_subframes_(FLAC__StreamEncoder *encoder, FLAC__StreamEncoderT
 		}
 	}
 
+#ifdef FLAC__USE_THREADS
+	if(encoder->private_->subframe_threading) {
+		if(!process_subframes_concurrently_(encoder, threadtask, min_partition_order, max_partition_order, &frame_header, do_independent, do_mid_side))
+			return false;
+		do_independent_pass = do_mid_side_pass = false;
+	}
+#endif
+
 	/*
 	 * First do a normal encoding pass of each independent channel
 	 */
-	if(do_independent) {
+	if(do_independent_pass) {
 		for(channel = 0; channel < encoder->protected_->channels; channel++) {
 			if(encoder->protected_->limit_min_bitrate && all_subframes_constant && (channel + 1) == encoder->protected_->channels){
 				/* This frame contains only constant subframes at this point.
@@ -3890,7 +4355,7 @@ FLAC__bool process_subframes_(FLAC__StreamEncoder *encoder, FLAC__StreamEncoderT
 	/*
 	 * Now do mid and side channels if requested
 	 */
-	if(do_mid_side) {
+	if(do_mid_side_pass) {
 		FLAC__ASSERT(encoder->protected_->channels == 2);
 
 		for(channel = 0; channel < 2; channel++) {
@@ -4054,6 +4519,8 @@ FLAC__bool process_subframe_(
 	double lpc_residual_bits_per_sample;
 	apply_apodization_state_struct apply_apodization_state;
 	double lpc_error[FLAC__MAX_LPC_ORDER];
+	double lpc_expected_bits[FLAC__MAX_LPC_ORDER];
+	double max_lpc_expected_bits;
 	uint32_t min_lpc_order, max_lpc_order, lpc_order, guess_lpc_order;
 	uint32_t min_qlp_coeff_precision, max_qlp_coeff_precision, qlp_coeff_precision;
 #endif
@@ -4194,11 +4661,12 @@ FLAC__bool process_subframe_(
 					apply_apodization_state.a = 0;
 					apply_apodization_state.b = 1;
 					apply_apodization_state.c = 0;
+					apply_apodization_state.batch_b = 0; /* nothing computed ahead yet */
 					while (apply_apodization_state.a < encoder->protected_->num_apodizations) {
 						uint32_t max_lpc_order_this_apodization = max_lpc_order;
 
 						if(!apply_apodization_(encoder, threadtask, &apply_apodization_state,
-						                       frame_header->blocksize, lpc_error,
+						                       frame_header->blocksize, lpc_error, lpc_expected_bits,
 						                       &max_lpc_order_this_apodization,
 						                       subframe_bps, integer_signal,
 						                       &guess_lpc_order))
@@ -4211,10 +4679,17 @@ FLAC__bool process_subframe_(
 						else {
 							min_lpc_order = max_lpc_order_this_apodization = guess_lpc_order;
 						}
+						/* The expected sizes come from the same Levinson-Durbin
+						 * recursion for all orders, so orders that are expected
+						 * to be clearly larger than the guessed best one can be
+						 * skipped before computing their residual */
+						max_lpc_expected_bits = lpc_expected_bits[guess_lpc_order-1] + (double)frame_header->blocksize * LPC_ORDER_PRUNING_MARGIN_;
 						for(lpc_order = min_lpc_order; lpc_order <= max_lpc_order_this_apodization; lpc_order++) {
 							lpc_residual_bits_per_sample = FLAC__lpc_compute_expected_bits_per_residual_sample(lpc_error[lpc_order-1], frame_header->blocksize-lpc_order);
 							if(lpc_residual_bits_per_sample >= (double)subframe_bps)
 								continue; /* don't even try */
+							if(encoder->protected_->prune_lpc_orders && lpc_expected_bits[lpc_order-1] > max_lpc_expected_bits)
+								continue; /* not worth computing the residual */
 							if(encoder->protected_->do_qlp_coeff_prec_search) {
 								min_qlp_coeff_precision = FLAC__MIN_QLP_COEFF_PRECISION;
 								/* try to keep qlp coeff precision such that only 32-bit math is required for decode of <=16bps(+1bps for side channel) streams */
@@ -4308,20 +4783,39 @@ FLAC__bool apply_apodization_(FLAC__StreamEncoder *encoder,
                         apply_apodization_state_struct *apply_apodization_state,
                         uint32_t blocksize,
                         double *lpc_error,
+                        double *lpc_expected_bits,
                         uint32_t *max_lpc_order_this_apodization,
                         uint32_t subframe_bps,
                         const void *integer_signal,
                         uint32_t *guess_lpc_order)
 {
+	const FLAC__bool fused = encoder->protected_->fused_window_autocorrelation && subframe_bps <= 32;
+
 	apply_apodization_state->current_apodization = &encoder->protected_->apodizations[apply_apodization_state->a];
 
 	if(apply_apodization_state->b == 1) {
 		/* window full subblock */
-		if(subframe_bps <= 32)
-			FLAC__lpc_window_data(integer_signal, encoder->private_->window[apply_apodization_state->a], threadtask->windowed_signal, blocksize);
-		else
-			FLAC__lpc_window_data_wide(integer_signal, encoder->private_->window[apply_apodization_state->a], threadtask->windowed_signal, blocksize);
-		encoder->private_->local_lpc_compute_autocorrelation(threadtask->windowed_signal, blocksize, (*max_lpc_order_this_apodization)+1, apply_apodization_state->autoc);
+		if(fused) {
+			/* window the block with this and the next few apodizations at once */
+			if(apply_apodization_state->batch_b != 1 || apply_apodization_state->a < apply_apodization_state->batch_first || apply_apodization_state->a >= apply_apodization_state->batch_first + apply_apodization_state->batch_count) {
+				const FLAC__int32 *in[FLAC__MAX_LPC_WINDOWS];
+				uint32_t k;
+				apply_apodization_state->batch_b = 1;
+				apply_apodization_state->batch_first = apply_apodization_state->a;
+				apply_apodization_state->batch_count = flac_min(encoder->protected_->num_apodizations - apply_apodization_state->a, FLAC__MAX_LPC_WINDOWS);
+				for(k = 0; k < apply_apodization_state->batch_count; k++)
+					in[k] = integer_signal;
+				encoder->private_->local_lpc_compute_autocorrelation_windowed(in, encoder->private_->window + apply_apodization_state->a, apply_apodization_state->batch_count, blocksize, (*max_lpc_order_this_apodization)+1, apply_apodization_state->autoc_batch);
+			}
+			memcpy(apply_apodization_state->autoc, apply_apodization_state->autoc_batch[apply_apodization_state->a - apply_apodization_state->batch_first], ((*max_lpc_order_this_apodization)+1)*sizeof(apply_apodization_state->autoc[0]));
+		}
+		else {
+			if(subframe_bps <= 32)
+				FLAC__lpc_window_data(integer_signal, encoder->private_->window[apply_apodization_state->a], threadtask->windowed_signal, blocksize);
+			else
+				FLAC__lpc_window_data_wide(integer_signal, encoder->private_->window[apply_apodization_state->a], threadtask->windowed_signal, blocksize);
+			encoder->private_->local_lpc_compute_autocorrelation(threadtask->windowed_signal, blocksize, (*max_lpc_order_this_apodization)+1, apply_apodization_state->autoc);
+		}
 		if(apply_apodization_state->current_apodization->type == FLAC__APODIZATION_SUBDIVIDE_TUKEY){
 			uint32_t i;
 			for(i = 0; i < *max_lpc_order_this_apodization; i++)
@@ -4343,7 +4837,36 @@ FLAC__bool apply_apodization_(FLAC__StreamEncoder *encoder,
 			set_next_subdivide_tukey(apply_apodization_state->current_apodization->parameters.subdivide_tukey.parts, &apply_apodization_state->a, &apply_apodization_state->b, &apply_apodization_state->c);
 			return false;
 		}
-		if(!(apply_apodization_state->c % 2)) {
+		if(!(apply_apodization_state->c % 2) && fused) {
+			/* on even c, evaluate the (c/2)th partial window of size blocksize/b, for
+			 * the next few parts at once. All parts share the same partial window */
+			const uint32_t part = apply_apodization_state->c/2;
+			if(apply_apodization_state->batch_b != apply_apodization_state->b || apply_apodization_state->batch_a != apply_apodization_state->a || part < apply_apodization_state->batch_first || part >= apply_apodization_state->batch_first + apply_apodization_state->batch_count) {
+				const FLAC__int32 *in[FLAC__MAX_LPC_WINDOWS];
+				const FLAC__real *window[FLAC__MAX_LPC_WINDOWS];
+				const uint32_t part_len = blocksize/apply_apodization_state->b, part_size = part_len/2;
+				const FLAC__real *root = encoder->private_->window[apply_apodization_state->a];
+				uint32_t i, k;
+				/* the same window FLAC__lpc_window_data_partial() applies */
+				for(i = 0; i < part_size; i++)
+					threadtask->windowed_signal[i] = root[i];
+				for(; i < 2*part_size; i++)
+					threadtask->windowed_signal[i] = root[blocksize - 2*part_size + i];
+				for(; i < part_len; i++)
+					threadtask->windowed_signal[i] = 0.0f;
+				apply_apodization_state->batch_a = apply_apodization_state->a;
+				apply_apodization_state->batch_b = apply_apodization_state->b;
+				apply_apodization_state->batch_first = part;
+				apply_apodization_state->batch_count = flac_min(apply_apodization_state->b - part, FLAC__MAX_LPC_WINDOWS);
+				for(k = 0; k < apply_apodization_state->batch_count; k++) {
+					in[k] = (const FLAC__int32 *)integer_signal + ((part+k)*blocksize)/apply_apodization_state->b;
+					window[k] = threadtask->windowed_signal;
+				}
+				encoder->private_->local_lpc_compute_autocorrelation_windowed(in, window, apply_apodization_state->batch_count, part_len, (*max_lpc_order_this_apodization)+1, apply_apodization_state->autoc_batch);
+			}
+			memcpy(apply_apodization_state->autoc, apply_apodization_state->autoc_batch[part - apply_apodization_state->batch_first], ((*max_lpc_order_this_apodization)+1)*sizeof(apply_apodization_state->autoc[0]));
+		}
+		else if(!(apply_apodization_state->c % 2)) {
 			/* on even c, evaluate the (c/2)th partial window of size blocksize/b  */
 			if(subframe_bps <= 32)
 				FLAC__lpc_window_data_partial(integer_signal, encoder->private_->window[apply_apodization_state->a], threadtask->windowed_signal, blocksize, blocksize/apply_apodization_state->b/2, (apply_apodization_state->c/2*blocksize)/apply_apodization_state->b);
@@ -4366,7 +4889,7 @@ FLAC__bool apply_apodization_(FLAC__StreamEncoder *encoder,
 		return false;
 	FLAC__lpc_compute_lp_coefficients(apply_apodization_state->autoc, max_lpc_order_this_apodization, threadtask->lp_coeff, lpc_error);
 	*guess_lpc_order =
-	FLAC__lpc_compute_best_order(
+	FLAC__lpc_compute_expected_bits_per_order(
 		lpc_error,
 		*max_lpc_order_this_apodization,
 		blocksize,
@@ -4374,7 +4897,8 @@ FLAC__bool apply_apodization_(FLAC__StreamEncoder *encoder,
 			encoder->protected_->do_qlp_coeff_prec_search?
 				FLAC__MIN_QLP_COEFF_PRECISION : /* have to guess; use the min possible size to avoid accidentally favoring lower orders */
 				encoder->protected_->qlp_coeff_precision
-		)
+		),
+		lpc_expected_bits
 	);
 	return true;
 }
@@ -4723,9 +5247,11 @@ uint32_t find_best_partition_order_(
 		for(partition_order = (int)max_partition_order, sum = 0; partition_order >= (int)min_partition_order; partition_order--) {
 			FLAC__ASSERT(do_escape_coding != /* XOR */ (raw_bits_per_partition == NULL));
 			if(!
-				set_partitioned_rice_(
 #ifdef EXACT_RICE_BITS_CALCULATION
+				set_partitioned_rice_(
 					residual,
+#else
+				private_->local_set_partitioned_rice(
 #endif
 					abs_residual_partition_sums+sum,
 					do_escape_coding ? raw_bits_per_partition+sum : NULL,
@@ -4869,11 +5395,7 @@ void precompute_partition_info_escapes_(
 			rmax = 0;
 			for(partition_sample = 0; partition_sample < partition_samples; partition_sample++) {
 				r = residual[residual_sample++];
-				/* OPT: maybe faster: rmax |= r ^ (r>>31) */
-				if(r < 0)
-					rmax |= ~r;
-				else
-					rmax |= r;
+				rmax |= (FLAC__uint32)(r ^ (r >> 31)); /* r for positive and ~r for negative r, without a branch */
 			}
 			/* now we know all residual values are in the range [-rmax-1,rmax] */
 			raw_bits_per_partition[partition] = rmax? FLAC__bitmath_ilog2(rmax) + 2 : 1;
@@ -5140,6 +5662,99 @@ void append_to_verify_fifo_interleaved_(verify_input_fifo *fifo, const FLAC__int
 	FLAC__ASSERT(fifo->tail <= fifo->size);
 }
 
+/* Decodes the frame in the bitbuffer of threadtask with the decoder of
+ * the threadtask and compares it with verify_signal[].  The decoder is
+ * flushed first, as the frames a threadtask gets do not follow on each
+ * other.
+ */
+FLAC__bool verify_threadtask_frame_(FLAC__StreamEncoder *encoder, FLAC__StreamEncoderThreadTask *threadtask)
+{
+	const FLAC__uint64 sample_number = (FLAC__uint64)threadtask->current_frame_number * encoder->private_->streaminfo.data.stream_info.min_blocksize;
+	size_t bytes;
+	FLAC__bool ok;
+
+	FLAC__ASSERT(FLAC__bitwriter_is_byte_aligned(threadtask->frame));
+
+	if(!FLAC__bitwriter_get_buffer(threadtask->frame, &threadtask->verify_output.data, &bytes)) {
+		encoder->protected_->state = FLAC__STREAM_ENCODER_MEMORY_ALLOCATION_ERROR;
+		return false;
+	}
+	threadtask->verify_output.bytes = (uint32_t)bytes;
+	threadtask->verify_blocksize = 0;
+	threadtask->verify_mismatch = false;
+	threadtask->verify_decoder_error = false;
+
+	ok = FLAC__stream_decoder_flush(threadtask->verify_decoder) && FLAC__stream_decoder_process_single(threadtask->verify_decoder);
+	FLAC__bitwriter_release_buffer(threadtask->frame);
+
+	if(threadtask->verify_mismatch) {
+		encoder->protected_->state = FLAC__STREAM_ENCODER_VERIFY_MISMATCH_IN_AUDIO_DATA;
+		return false;
+	}
+	if(!ok || threadtask->verify_decoder_error || threadtask->verify_blocksize != encoder->protected_->blocksize || threadtask->verify_sample_number != sample_number) {
+		encoder->protected_->state = FLAC__STREAM_ENCODER_VERIFY_DECODER_ERROR;
+		return false;
+	}
+	return true;
+}
+
+FLAC__StreamDecoderReadStatus verify_threadtask_read_callback_(const FLAC__StreamDecoder *decoder, FLAC__byte buffer[], size_t *bytes, void *client_data)
+{
+	FLAC__StreamEncoderThreadTask *threadtask = (FLAC__StreamEncoderThreadTask*)client_data;
+	(void)decoder;
+
+	/* running out means the frame is shorter than its header says */
+	if(threadtask->verify_output.bytes == 0) {
+		*bytes = 0;
+		return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+	}
+	if(threadtask->verify_output.bytes < *bytes)
+		*bytes = threadtask->verify_output.bytes;
+	memcpy(buffer, threadtask->verify_output.data, *bytes);
+	threadtask->verify_output.data += *bytes;
+	threadtask->verify_output.bytes -= *bytes;
+	return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+}
+
+FLAC__StreamDecoderWriteStatus verify_threadtask_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data)
+{
+	FLAC__StreamEncoderThreadTask *threadtask = (FLAC__StreamEncoderThreadTask*)client_data;
+	const uint32_t blocksize = frame->header.blocksize;
+	uint32_t channel, i;
+
+	(void)decoder;
+
+	FLAC__ASSERT(frame->header.number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
+	threadtask->verify_blocksize = blocksize;
+	threadtask->verify_sample_number = frame->header.number.sample_number;
+	if(threadtask->verify_decoder_error)
+		return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
+	for(channel = 0; channel < frame->header.channels; channel++) {
+		if(0 != memcmp(buffer[channel], threadtask->verify_signal[channel], sizeof(FLAC__int32) * blocksize)) {
+			for(i = 0; i < blocksize && buffer[channel][i] == threadtask->verify_signal[channel][i]; i++)
+				;
+			FLAC__ASSERT(i < blocksize);
+			threadtask->verify_error_stats.absolute_sample = frame->header.number.sample_number + i;
+			threadtask->verify_error_stats.frame_number = threadtask->current_frame_number;
+			threadtask->verify_error_stats.channel = channel;
+			threadtask->verify_error_stats.sample = i;
+			threadtask->verify_error_stats.expected = threadtask->verify_signal[channel][i];
+			threadtask->verify_error_stats.got = buffer[channel][i];
+			threadtask->verify_mismatch = true;
+			return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+		}
+	}
+	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+void verify_threadtask_error_callback_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data)
+{
+	FLAC__StreamEncoderThreadTask *threadtask = (FLAC__StreamEncoderThreadTask*)client_data;
+	(void)decoder, (void)status;
+	threadtask->verify_decoder_error = true;
+}
+
 FLAC__StreamDecoderReadStatus verify_read_callback_(const FLAC__StreamDecoder *decoder, FLAC__byte buffer[], size_t *bytes, void *client_data)
 {
 	FLAC__StreamEncoder *encoder = (FLAC__StreamEncoder*)client_data;
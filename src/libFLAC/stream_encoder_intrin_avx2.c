@@ -40,6 +40,7 @@
 #if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
 #include "private/stream_encoder.h"
 #include "private/bitmath.h"
+#include "private/macros.h"
 #ifdef FLAC__AVX2_SUPPORTED
 
 #include <stdlib.h>    /* for abs() */
@@ -141,6 +142,112 @@ void FLAC__precompute_partition_info_sums_intrin_avx2(const FLAC__int32 residual
 	_mm256_zeroupper();
 }
 
+/* Picks the Rice parameter of a single partition and returns its size in
+ * bits, the same way set_partitioned_rice_() in stream_encoder.c does */
+FLAC__SSE_TARGET("avx2")
+static inline uint32_t set_rice_parameter_(const FLAC__uint64 abs_residual_partition_sum, uint32_t partition_samples, uint32_t partition_samples_fixed_point_divisor, uint32_t rice_parameter_limit, uint32_t *parameter)
+{
+	const FLAC__uint64 mean = abs_residual_partition_sum;
+	uint32_t rice_parameter;
+
+	if(mean < 2 || (((mean - 1)*partition_samples_fixed_point_divisor)>>18) == 0)
+		rice_parameter = 0;
+	else
+		rice_parameter = FLAC__bitmath_ilog2_wide(((mean - 1)*partition_samples_fixed_point_divisor)>>18) + 1;
+	if(rice_parameter >= rice_parameter_limit)
+		rice_parameter = rice_parameter_limit - 1;
+
+	*parameter = rice_parameter;
+	return (uint32_t)(flac_min(
+		FLAC__ENTROPY_CODING_METHOD_PARTITIONED_RICE_PARAMETER_LEN +
+		(1+rice_parameter) * partition_samples +
+		(rice_parameter? (mean >> (rice_parameter-1)) : (mean << 1)) -
+		(partition_samples >> 1), UINT32_MAX));
+}
+
+/* All partitions but the first have the same number of samples, so their
+ * Rice parameters and sizes are estimated four at a time with the formulas
+ * of the scalar routine. The integer logarithm is taken from the exponent of
+ * the value converted to double, which is exact as the average residual
+ * magnitude is far below 2^52. Escape codes are not considered, the encoder
+ * only picks this routine when it does not search for them */
+FLAC__SSE_TARGET("avx2")
+FLAC__bool FLAC__set_partitioned_rice_intrin_avx2(const FLAC__uint64 abs_residual_partition_sums[], const uint32_t raw_bits_per_partition[],
+		uint32_t residual_samples, uint32_t predictor_order, uint32_t rice_parameter_limit, uint32_t rice_parameter_search_dist, uint32_t partition_order,
+		FLAC__bool search_for_escapes, FLAC__EntropyCodingMethod_PartitionedRiceContents *partitioned_rice_contents, uint32_t *bits)
+{
+	const uint32_t partitions = 1u << partition_order;
+	const uint32_t partition_samples = (residual_samples+predictor_order) >> partition_order;
+	const uint32_t partition_samples_fixed_point_divisor = 0x40000 / partition_samples;
+	uint32_t *parameters = partitioned_rice_contents->parameters;
+	FLAC__uint64 bits_ = FLAC__ENTROPY_CODING_METHOD_TYPE_LEN + FLAC__ENTROPY_CODING_METHOD_PARTITIONED_RICE_ORDER_LEN;
+	uint32_t partition;
+	(void)raw_bits_per_partition;
+	(void)rice_parameter_search_dist;
+	(void)search_for_escapes;
+
+	FLAC__ASSERT(rice_parameter_limit <= FLAC__ENTROPY_CODING_METHOD_PARTITIONED_RICE2_ESCAPE_PARAMETER);
+	FLAC__ASSERT(!search_for_escapes);
+
+	if(partition_samples <= predictor_order)
+		return false;
+
+	bits_ += set_rice_parameter_(abs_residual_partition_sums[0], partition_samples - predictor_order, 0x40000 / (partition_samples - predictor_order), rice_parameter_limit, parameters);
+
+	partition = 1;
+	if(partitions > 4) {
+		const __m256i one = _mm256_set1_epi64x(1);
+		const __m256i two = _mm256_set1_epi64x(2);
+		const __m256i samples = _mm256_set1_epi64x(partition_samples);
+		const __m256i divisor = _mm256_set1_epi64x(partition_samples_fixed_point_divisor);
+		const __m256i max_rice_parameter = _mm256_set1_epi64x(rice_parameter_limit - 1);
+		const __m256i rice_bits_base = _mm256_set1_epi64x((long long)FLAC__ENTROPY_CODING_METHOD_PARTITIONED_RICE_PARAMETER_LEN - (long long)(partition_samples >> 1));
+		const __m256i max_bits = _mm256_set1_epi64x(UINT32_MAX);
+		const __m256i double_magic = _mm256_set1_epi64x(0x4330000000000000ll); /* 2^52 */
+		const __m256i exponent_bias = _mm256_set1_epi64x(1023 - 1); /* the -1 makes it ilog2() + 1 */
+		const __m256i even_words = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+		__m256i bits256 = _mm256_setzero_si256();
+		FLAC__uint64 bits4[4];
+
+		for( ; partition + 4 <= partitions; partition += 4) {
+			const __m256i sum = _mm256_loadu_si256((const __m256i*)(const void*)(abs_residual_partition_sums+partition));
+			const __m256i sum_minus_one = _mm256_sub_epi64(sum, one);
+			__m256i mean, rice_parameter, partition_bits, is_zero;
+			__m256d mean_pd;
+
+			/* ((mean - 1)*partition_samples_fixed_point_divisor)>>18, with a 64 by 32 bit multiply */
+			mean = _mm256_add_epi64(_mm256_mul_epu32(sum_minus_one, divisor), _mm256_slli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(sum_minus_one, 32), divisor), 32));
+			mean = _mm256_srli_epi64(mean, 18);
+			mean_pd = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(mean, double_magic)), _mm256_castsi256_pd(double_magic));
+			rice_parameter = _mm256_sub_epi64(_mm256_srli_epi64(_mm256_castpd_si256(mean_pd), 52), exponent_bias);
+			is_zero = _mm256_or_si256(_mm256_cmpgt_epi64(two, sum), _mm256_cmpeq_epi64(mean, _mm256_setzero_si256()));
+			rice_parameter = _mm256_andnot_si256(is_zero, rice_parameter);
+			rice_parameter = _mm256_blendv_epi8(rice_parameter, max_rice_parameter, _mm256_cmpgt_epi64(rice_parameter, max_rice_parameter));
+
+			/* the shift count of rice_parameter-1 wraps for parameter 0, which shifts out everything */
+			partition_bits = _mm256_blendv_epi8(
+				_mm256_srlv_epi64(sum, _mm256_sub_epi64(rice_parameter, one)),
+				_mm256_slli_epi64(sum, 1),
+				_mm256_cmpeq_epi64(rice_parameter, _mm256_setzero_si256()));
+			partition_bits = _mm256_add_epi64(partition_bits, _mm256_add_epi64(rice_bits_base, _mm256_mul_epu32(_mm256_add_epi64(rice_parameter, one), samples)));
+			partition_bits = _mm256_blendv_epi8(partition_bits, max_bits, _mm256_cmpgt_epi64(partition_bits, max_bits));
+
+			_mm_storeu_si128((__m128i*)(void*)(parameters+partition), _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(rice_parameter, even_words)));
+			bits256 = _mm256_add_epi64(bits256, partition_bits);
+		}
+
+		_mm256_storeu_si256((__m256i*)(void*)bits4, bits256);
+		bits_ += bits4[0] + bits4[1] + bits4[2] + bits4[3];
+	}
+	for( ; partition < partitions; partition++)
+		bits_ += set_rice_parameter_(abs_residual_partition_sums[partition], partition_samples, partition_samples_fixed_point_divisor, rice_parameter_limit, parameters+partition);
+
+	/* the scalar routine stops adding at UINT32_MAX, which gives the same */
+	*bits = (uint32_t)flac_min(bits_, UINT32_MAX);
+	_mm256_zeroupper();
+	return true;
+}
+
 #endif /* FLAC__AVX2_SUPPORTED */
 #endif /* (FLAC__CPU_IA32 || FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN */
 #endif /* FLAC__NO_ASM */
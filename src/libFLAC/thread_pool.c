@@ -0,0 +1,247 @@
+/* libFLAC - Free Lossless Audio Codec library
+ * Copyright (C) 2025  Xiph.Org Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <stdlib.h> /* for free() */
+#include "share/alloc.h"
+#include "FLAC/assert.h"
+#include "private/memory.h"
+#include "private/thread_pool.h"
+
+#ifdef FLAC__USE_THREADS
+
+struct FLAC__ThreadPool {
+	FLAC__mtx_t mutex; /* To lock everything in this struct and in the attached clients */
+	FLAC__cnd_t cond_work_available;
+	FLAC__cnd_t cond_job_done;
+	FLAC__thrd_t *thread;
+	uint32_t num_threads;
+	FLAC__ThreadPoolClient *next_client; /* the client served first when a thread looks for work, 0 if none is attached */
+	FLAC__bool finish;
+};
+
+/* Finds the first client from next_client on that has a job waiting and
+ * may have another one running, so the clients are served in turn. Must
+ * be called with the mutex locked */
+static FLAC__ThreadPoolClient *take_job_(FLAC__ThreadPool *pool)
+{
+	FLAC__ThreadPoolClient *client = pool->next_client;
+
+	if(0 == client)
+		return 0;
+	do {
+		if(client->num_pending > 0 && client->num_running < client->max_running) {
+			client->num_pending--;
+			client->num_running++;
+			pool->next_client = client->next;
+			return client;
+		}
+		client = client->next;
+	} while(client != pool->next_client);
+	return 0;
+}
+
+static FLAC__thread_return_type thread_pool_thread_(void *data)
+{
+	FLAC__ThreadPool *pool = (FLAC__ThreadPool *)data;
+	FLAC__ThreadPoolClient *client;
+
+	FLAC__mtx_lock(&pool->mutex);
+	while(1) {
+		if(0 != (client = take_job_(pool))) {
+			FLAC__mtx_unlock(&pool->mutex);
+			client->job(client->data);
+			FLAC__mtx_lock(&pool->mutex);
+			if(--client->num_running == 0)
+				FLAC__cnd_broadcast(&pool->cond_job_done);
+		}
+		else if(pool->finish)
+			break;
+		else
+			FLAC__cnd_wait(&pool->cond_work_available, &pool->mutex);
+	}
+	FLAC__mtx_unlock(&pool->mutex);
+	return FLAC__thread_default_return_value;
+}
+
+#endif
+
+FLAC_API FLAC__ThreadPool *FLAC__thread_pool_new(uint32_t num_threads)
+{
+#ifdef FLAC__USE_THREADS
+	FLAC__ThreadPool *pool;
+
+	if(num_threads == 0 || num_threads > FLAC__THREAD_POOL_MAX_THREADS)
+		return 0;
+	if(0 == (pool = safe_calloc_(1, sizeof(FLAC__ThreadPool))))
+		return 0;
+	if(0 == (pool->thread = safe_malloc_mul_2op_p(sizeof(FLAC__thrd_t), /*times*/num_threads))) {
+		free(pool);
+		return 0;
+	}
+	if(FLAC__mtx_init(&pool->mutex, FLAC__mtx_plain) != FLAC__thrd_success) {
+		free(pool->thread);
+		free(pool);
+		return 0;
+	}
+	if(FLAC__cnd_init(&pool->cond_work_available) != FLAC__thrd_success) {
+		FLAC__mtx_destroy(&pool->mutex);
+		free(pool->thread);
+		free(pool);
+		return 0;
+	}
+	if(FLAC__cnd_init(&pool->cond_job_done) != FLAC__thrd_success) {
+		FLAC__mtx_destroy(&pool->mutex);
+		FLAC__cnd_destroy(&pool->cond_work_available);
+		free(pool->thread);
+		free(pool);
+		return 0;
+	}
+	for(pool->num_threads = 0; pool->num_threads < num_threads; pool->num_threads++) {
+		if(FLAC__thrd_create(&pool->thread[pool->num_threads], thread_pool_thread_, pool) != FLAC__thrd_success) {
+			FLAC__thread_pool_delete(pool);
+			return 0;
+		}
+	}
+	return pool;
+#else
+	(void)num_threads;
+	return 0;
+#endif
+}
+
+FLAC_API void FLAC__thread_pool_delete(FLAC__ThreadPool *pool)
+{
+#ifdef FLAC__USE_THREADS
+	uint32_t t;
+
+	if(0 == pool)
+		return;
+	FLAC__ASSERT(0 == pool->next_client);
+
+	FLAC__mtx_lock(&pool->mutex);
+	pool->finish = true;
+	FLAC__cnd_broadcast(&pool->cond_work_available);
+	FLAC__mtx_unlock(&pool->mutex);
+	for(t = 0; t < pool->num_threads; t++)
+		FLAC__thrd_join(pool->thread[t], NULL);
+
+	FLAC__mtx_destroy(&pool->mutex);
+	FLAC__cnd_destroy(&pool->cond_work_available);
+	FLAC__cnd_destroy(&pool->cond_job_done);
+	free(pool->thread);
+	free(pool);
+#else
+	(void)pool;
+#endif
+}
+
+FLAC_API uint32_t FLAC__thread_pool_get_num_threads(const FLAC__ThreadPool *pool)
+{
+	FLAC__ASSERT(0 != pool);
+#ifdef FLAC__USE_THREADS
+	return pool->num_threads;
+#else
+	return 0;
+#endif
+}
+
+#ifdef FLAC__USE_THREADS
+
+void FLAC__thread_pool_attach(FLAC__ThreadPool *pool, FLAC__ThreadPoolClient *client, FLAC__ThreadPoolJob job, void *data, uint32_t max_running, uint32_t max_pending)
+{
+	FLAC__ASSERT(0 != pool);
+	FLAC__ASSERT(0 != client);
+	FLAC__ASSERT(max_running > 0);
+
+	client->pool = pool;
+	client->job = job;
+	client->data = data;
+	client->max_running = max_running;
+	client->max_pending = max_pending;
+	client->num_pending = 0;
+	client->num_running = 0;
+
+	/* a new client is served last in the current round */
+	FLAC__mtx_lock(&pool->mutex);
+	if(0 == pool->next_client) {
+		client->prev = client->next = client;
+		pool->next_client = client;
+	}
+	else {
+		client->next = pool->next_client;
+		client->prev = pool->next_client->prev;
+		client->prev->next = client;
+		client->next->prev = client;
+	}
+	FLAC__mtx_unlock(&pool->mutex);
+}
+
+void FLAC__thread_pool_submit(FLAC__ThreadPoolClient *client)
+{
+	FLAC__ThreadPool *pool = client->pool;
+
+	FLAC__ASSERT(0 != pool);
+	FLAC__mtx_lock(&pool->mutex);
+	if(client->num_pending < client->max_pending) {
+		client->num_pending++;
+		FLAC__cnd_signal(&pool->cond_work_available);
+	}
+	FLAC__mtx_unlock(&pool->mutex);
+}
+
+void FLAC__thread_pool_detach(FLAC__ThreadPoolClient *client)
+{
+	FLAC__ThreadPool *pool = client->pool;
+
+	if(0 == pool)
+		return;
+	FLAC__mtx_lock(&pool->mutex);
+	client->num_pending = 0;
+	while(client->num_running > 0)
+		FLAC__cnd_wait(&pool->cond_job_done, &pool->mutex);
+	if(client->next == client)
+		pool->next_client = 0;
+	else {
+		client->prev->next = client->next;
+		client->next->prev = client->prev;
+		if(pool->next_client == client)
+			pool->next_client = client->next;
+	}
+	FLAC__mtx_unlock(&pool->mutex);
+	client->pool = 0;
+}
+
+#endif
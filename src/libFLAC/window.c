@@ -37,7 +37,10 @@
 #include <math.h>
 #include "share/compat.h"
 #include "FLAC/assert.h"
+#include <stdlib.h> /* for free() */
+#include "share/compat_threads.h"
 #include "FLAC/format.h"
+#include "private/memory.h"
 #include "private/window.h"
 
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
@@ -305,4 +308,244 @@ void FLAC__window_welch(FLAC__real *window, const FLAC__int32 L)
 #pragma warning ( default : 4244 )
 #endif
 
+/* Windows no encoder holds on to are kept around, up to this number, so
+ * that encoders which are set up one after another for short files don't
+ * all calculate the same windows again */
+#define FLAC__WINDOW_CACHE_MAX_UNUSED 64
+
+typedef struct FLAC__WindowCacheEntry {
+	struct FLAC__WindowCacheEntry *next;
+	FLAC__ApodizationSpecification apodization;
+	uint32_t L;
+	uint32_t references;
+	FLAC__uint64 last_use; /* value of window_cache_.uses when last acquired, to find the least recently used window */
+	FLAC__real *window;
+	FLAC__real *window_unaligned;
+} FLAC__WindowCacheEntry;
+
+static struct {
+	FLAC__WindowCacheEntry *first;
+	uint32_t num_unused;
+	FLAC__uint64 uses;
+	FLAC__uint64 hits;
+	FLAC__uint64 misses;
+#ifdef FLAC__USE_THREADS
+	FLAC__mtx_t mutex; /* To lock everything in this struct, but not the windows, which are never written once they are in the cache */
+#endif
+} window_cache_;
+
+#ifdef FLAC__USE_THREADS
+static FLAC__once_flag window_cache_once_ = FLAC__ONCE_FLAG_INIT;
+static FLAC__bool window_cache_mutex_ok_ = false;
+
+static void window_cache_init_(void)
+{
+	window_cache_mutex_ok_ = (FLAC__mtx_init(&window_cache_.mutex, FLAC__mtx_plain) == FLAC__thrd_success);
+}
+
+static FLAC__bool window_cache_lock_(void)
+{
+	FLAC__call_once(&window_cache_once_, window_cache_init_);
+	if(!window_cache_mutex_ok_)
+		return false;
+	FLAC__mtx_lock(&window_cache_.mutex);
+	return true;
+}
+
+static void window_cache_unlock_(void)
+{
+	FLAC__mtx_unlock(&window_cache_.mutex);
+}
+#else
+static FLAC__bool window_cache_lock_(void)
+{
+	return true;
+}
+
+static void window_cache_unlock_(void)
+{
+}
+#endif
+
+static FLAC__bool window_cache_match_(const FLAC__ApodizationSpecification *a, const FLAC__ApodizationSpecification *b)
+{
+	if(a->type != b->type)
+		return false;
+	switch(a->type) {
+		case FLAC__APODIZATION_GAUSS:
+			return a->parameters.gauss.stddev == b->parameters.gauss.stddev;
+		case FLAC__APODIZATION_TUKEY:
+			return a->parameters.tukey.p == b->parameters.tukey.p;
+		case FLAC__APODIZATION_PARTIAL_TUKEY:
+		case FLAC__APODIZATION_PUNCHOUT_TUKEY:
+			return
+				a->parameters.multiple_tukey.p == b->parameters.multiple_tukey.p &&
+				a->parameters.multiple_tukey.start == b->parameters.multiple_tukey.start &&
+				a->parameters.multiple_tukey.end == b->parameters.multiple_tukey.end;
+		default:
+			return true;
+	}
+}
+
+static void window_cache_compute_(FLAC__real *window, const FLAC__ApodizationSpecification *apodization, const FLAC__int32 L)
+{
+	switch(apodization->type) {
+		case FLAC__APODIZATION_BARTLETT:
+			FLAC__window_bartlett(window, L);
+			break;
+		case FLAC__APODIZATION_BARTLETT_HANN:
+			FLAC__window_bartlett_hann(window, L);
+			break;
+		case FLAC__APODIZATION_BLACKMAN:
+			FLAC__window_blackman(window, L);
+			break;
+		case FLAC__APODIZATION_BLACKMAN_HARRIS_4TERM_92DB_SIDELOBE:
+			FLAC__window_blackman_harris_4term_92db_sidelobe(window, L);
+			break;
+		case FLAC__APODIZATION_CONNES:
+			FLAC__window_connes(window, L);
+			break;
+		case FLAC__APODIZATION_FLATTOP:
+			FLAC__window_flattop(window, L);
+			break;
+		case FLAC__APODIZATION_GAUSS:
+			FLAC__window_gauss(window, L, apodization->parameters.gauss.stddev);
+			break;
+		case FLAC__APODIZATION_HAMMING:
+			FLAC__window_hamming(window, L);
+			break;
+		case FLAC__APODIZATION_HANN:
+			FLAC__window_hann(window, L);
+			break;
+		case FLAC__APODIZATION_KAISER_BESSEL:
+			FLAC__window_kaiser_bessel(window, L);
+			break;
+		case FLAC__APODIZATION_NUTTALL:
+			FLAC__window_nuttall(window, L);
+			break;
+		case FLAC__APODIZATION_RECTANGLE:
+			FLAC__window_rectangle(window, L);
+			break;
+		case FLAC__APODIZATION_TRIANGLE:
+			FLAC__window_triangle(window, L);
+			break;
+		case FLAC__APODIZATION_TUKEY:
+			FLAC__window_tukey(window, L, apodization->parameters.tukey.p);
+			break;
+		case FLAC__APODIZATION_PARTIAL_TUKEY:
+			FLAC__window_partial_tukey(window, L, apodization->parameters.multiple_tukey.p, apodization->parameters.multiple_tukey.start, apodization->parameters.multiple_tukey.end);
+			break;
+		case FLAC__APODIZATION_PUNCHOUT_TUKEY:
+			FLAC__window_punchout_tukey(window, L, apodization->parameters.multiple_tukey.p, apodization->parameters.multiple_tukey.start, apodization->parameters.multiple_tukey.end);
+			break;
+		case FLAC__APODIZATION_WELCH:
+			FLAC__window_welch(window, L);
+			break;
+		default:
+			FLAC__ASSERT(0);
+			/* double protection */
+			FLAC__window_hann(window, L);
+			break;
+	}
+}
+
+/* Frees the least recently used window that no encoder holds on to. Must
+ * be called with the cache locked */
+static void window_cache_evict_(void)
+{
+	FLAC__WindowCacheEntry **link, **oldest = 0;
+
+	for(link = &window_cache_.first; 0 != *link; link = &(*link)->next)
+		if((*link)->references == 0 && (0 == oldest || (*link)->last_use < (*oldest)->last_use))
+			oldest = link;
+	if(0 != oldest) {
+		FLAC__WindowCacheEntry *entry = *oldest;
+		*oldest = entry->next;
+		free(entry->window_unaligned);
+		free(entry);
+		window_cache_.num_unused--;
+	}
+}
+
+const FLAC__real *FLAC__window_cache_acquire(const FLAC__ApodizationSpecification *apodization, uint32_t L)
+{
+	FLAC__ApodizationSpecification key = *apodization;
+	FLAC__WindowCacheEntry *entry;
+
+	FLAC__ASSERT(L > 0);
+
+	/* the subdivide_tukey apodization uses a plain tukey window as root window */
+	if(key.type == FLAC__APODIZATION_SUBDIVIDE_TUKEY)
+		key.type = FLAC__APODIZATION_TUKEY;
+
+	if(!window_cache_lock_())
+		return 0;
+
+	for(entry = window_cache_.first; 0 != entry; entry = entry->next)
+		if(entry->L == L && window_cache_match_(&entry->apodization, &key))
+			break;
+
+	if(0 != entry) {
+		window_cache_.hits++;
+		if(entry->references == 0)
+			window_cache_.num_unused--;
+	}
+	else {
+		/* The window is calculated with the cache locked, so that two
+		 * encoders starting at the same time don't both calculate it */
+		if(0 == (entry = calloc(1, sizeof(*entry))) || !FLAC__memory_alloc_aligned_real_array(L, &entry->window_unaligned, &entry->window)) {
+			free(entry);
+			window_cache_unlock_();
+			return 0;
+		}
+		entry->apodization = key;
+		entry->L = L;
+		window_cache_compute_(entry->window, &key, (FLAC__int32)L);
+		entry->next = window_cache_.first;
+		window_cache_.first = entry;
+		window_cache_.misses++;
+	}
+	entry->references++;
+	entry->last_use = ++window_cache_.uses;
+
+	window_cache_unlock_();
+	return entry->window;
+}
+
+void FLAC__window_cache_release(const FLAC__real *window)
+{
+	FLAC__WindowCacheEntry *entry;
+
+	if(0 == window || !window_cache_lock_())
+		return;
+
+	for(entry = window_cache_.first; 0 != entry; entry = entry->next)
+		if(entry->window == window)
+			break;
+
+	FLAC__ASSERT(0 != entry);
+	FLAC__ASSERT(0 != entry->references);
+	if(0 != entry && --entry->references == 0) {
+		if(++window_cache_.num_unused > FLAC__WINDOW_CACHE_MAX_UNUSED)
+			window_cache_evict_();
+	}
+
+	window_cache_unlock_();
+}
+
+void FLAC__window_cache_get_statistics(FLAC__uint64 *hits, FLAC__uint64 *misses)
+{
+	FLAC__uint64 h = 0, m = 0;
+
+	if(window_cache_lock_()) {
+		h = window_cache_.hits;
+		m = window_cache_.misses;
+		window_cache_unlock_();
+	}
+	if(0 != hits)
+		*hits = h;
+	if(0 != misses)
+		*misses = m;
+}
+
 #endif /* !defined FLAC__INTEGER_ONLY_LIBRARY */
@@ -297,6 +297,11 @@ static bool test_stream_encoder(Layer layer, bool is_ogg)
 		return die_s_("returned false", encoder);
 	printf("OK\n");
 
+	printf("testing set_prune_lpc_orders()... ");
+	if(!encoder->set_prune_lpc_orders(true))
+		return die_s_("returned false", encoder);
+	printf("OK\n");
+
 	printf("testing set_min_residual_partition_order()... ");
 	if(!encoder->set_min_residual_partition_order(0))
 		return die_s_("returned false", encoder);
@@ -327,6 +332,16 @@ static bool test_stream_encoder(Layer layer, bool is_ogg)
 		return die_s_("returned false", encoder);
 	printf("OK\n");
 
+	printf("testing set_intra_frame_threading()... ");
+	if(!encoder->set_intra_frame_threading(true))
+		return die_s_("returned false", encoder);
+	printf("OK\n");
+
+	printf("testing set_thread_pool()... ");
+	if(!encoder->set_thread_pool(0))
+		return die_s_("returned false", encoder);
+	printf("OK\n");
+
 	if(layer < LAYER_FILENAME) {
 		printf("opening file for FLAC output... ");
 		file = ::flac_fopen(flacfilename(is_ogg), "w+b");
@@ -475,6 +490,13 @@ static bool test_stream_encoder(Layer layer, bool is_ogg)
 	}
 	printf("OK\n");
 
+	printf("testing get_prune_lpc_orders()... ");
+	if(encoder->get_prune_lpc_orders() != true) {
+		printf("FAILED, expected true, got false\n");
+		return false;
+	}
+	printf("OK\n");
+
 	printf("testing get_min_residual_partition_order()... ");
 	if(encoder->get_min_residual_partition_order() != 0) {
 		printf("FAILED, expected %d, got %u\n", 0, encoder->get_min_residual_partition_order());
@@ -510,6 +532,20 @@ static bool test_stream_encoder(Layer layer, bool is_ogg)
 	}
 	printf("OK\n");
 
+	printf("testing get_intra_frame_threading()... ");
+	if(encoder->get_intra_frame_threading() != true) {
+		printf("FAILED, expected true, got false\n");
+		return false;
+	}
+	printf("OK\n");
+
+	printf("testing get_thread_pool()... ");
+	if(encoder->get_thread_pool() != 0) {
+		printf("FAILED, expected NULL\n");
+		return false;
+	}
+	printf("OK\n");
+
 	/* init the dummy sample buffer */
 	for(i = 0; i < sizeof(samples) / sizeof(FLAC__int32); i++)
 		samples[i] = i & 7;
@@ -24,8 +24,11 @@
 #include "FLAC/assert.h"
 #include "share/compat.h"
 #include "private/bitreader.h" /* from the libFLAC private include area */
+#include "private/bitwriter.h"
+#include "private/crc.h"
 #include "bitreader.h"
 #include <stdio.h>
+#include <stdlib.h> /* for malloc() */
 #include <string.h> /* for memcpy() */
 
 /*
@@ -64,9 +67,14 @@ struct FLAC__BitReader {
 	uint32_t last_seen_framesync; /* the location of the last seen framesync, if it is in the buffer, in bits from front of buffer */
 	FLAC__BitReaderReadCallback read_callback;
 	void *client_data;
+	const FLAC__byte *source; /* if set, the stream is read from here instead of through read_callback */
+	size_t source_length;
+	size_t *source_position; /* owned by whoever set the source, so it can seek */
+	FLAC__uint16 (*crc16_update_words)(const brword *words, uint32_t len, FLAC__uint16 crc); /* see FLAC__bitreader_set_cpu_info() */
 };
 
 static FLAC__bool read_callback(FLAC__byte buffer[], size_t *bytes, void *data);
+static FLAC__bool test_read_rice_signed_block_table(void);
 
 static void FLAC__bitreader_dump(const FLAC__BitReader *br, FILE *out)
 {
@@ -330,6 +338,31 @@ FLAC__bool test_bitreader(void)
 	printf("OK\n");
 	FLAC__bitreader_dump(br, stdout);
 
+	printf("testing CRC taken part way through... ");
+	FLAC__bitreader_clear(br);
+	FLAC__bitreader_skip_bits_no_crc(br, 8);
+	FLAC__bitreader_reset_read_crc16(br, 0);
+	for(i = 1; i <= 2; i++) {
+		/* the CRC covers everything since the reset, across words */
+		ok =
+			FLAC__bitreader_read_raw_uint32(br, &val_uint32, 24) &&
+			FLAC__bitreader_read_raw_uint32(br, &val_uint32, 32) &&
+			FLAC__bitreader_read_raw_uint32(br, &val_uint32, 8)
+		;
+		if(!ok) {
+			printf("FAILED\n");
+			FLAC__bitreader_dump(br, stdout);
+			return false;
+		}
+		crc = FLAC__bitreader_get_read_crc16(br);
+		if(crc != FLAC__crc16(data + 1, 8 * i)) {
+			printf("FAILED reported CRC 0x%04x does not match expected 0x%04x\n", crc, FLAC__crc16(data + 1, 8 * i));
+			FLAC__bitreader_dump(br, stdout);
+			return false;
+		}
+	}
+	printf("OK\n");
+
 	printf("testing free... ");
 	FLAC__bitreader_free(br);
 	printf("OK\n");
@@ -338,10 +371,105 @@ FLAC__bool test_bitreader(void)
 	FLAC__bitreader_delete(br);
 	printf("OK\n");
 
+	if(!test_read_rice_signed_block_table())
+		return false;
+
 	printf("\nPASSED!\n");
 	return true;
 }
 
+/*
+ * the table-driven Rice decoder must read what the regular one does,
+ * including codewords longer than a table lookup or a whole word, and
+ * partitions that run across buffer refills
+ */
+#define RICE_TABLE_TEST_VALUES 40000
+#define RICE_TABLE_TEST_PARTITION 1000
+
+static FLAC__bool test_read_rice_signed_block_table(void)
+{
+	static FLAC__BitReaderRiceTableEntry table[1u << FLAC__BITREADER_RICE_TABLE_BITS];
+	FLAC__int32 *residual = 0;
+	int *output = 0;
+	FLAC__BitWriter *bw = 0;
+	FLAC__BitReader *br = 0;
+	const FLAC__byte *buffer;
+	size_t bytes, position;
+	FLAC__uint32 header;
+	FLAC__bool ok = false;
+	uint32_t parameter, i;
+
+	printf("testing table Rice decoding... ");
+
+	if(
+		0 == (residual = malloc(sizeof(FLAC__int32) * RICE_TABLE_TEST_VALUES)) ||
+		0 == (output = malloc(sizeof(int) * RICE_TABLE_TEST_VALUES)) ||
+		0 == (bw = FLAC__bitwriter_new()) ||
+		0 == (br = FLAC__bitreader_new()) ||
+		!FLAC__bitwriter_init(bw) ||
+		!FLAC__bitreader_init(br, read_callback, 0)
+	) {
+		printf("FAILED, could not allocate\n");
+		goto done;
+	}
+
+	for(parameter = 0; parameter <= FLAC__BITREADER_RICE_TABLE_MAX_PARAMETER; parameter++) {
+		srand(parameter);
+		for(i = 0; i < RICE_TABLE_TEST_VALUES; i++) {
+			const int r = rand();
+			if(r % 1000 == 0)
+				residual[i] = (r & 1) ? 12 : 40; /* longer than a table lookup */
+			else if(r % 1000 == 1)
+				residual[i] = -200; /* longer than a word */
+			else
+				residual[i] = (r % 9) - 4;
+		}
+
+		/* an odd number of bits in front, so codewords straddle words */
+		FLAC__bitwriter_clear(bw);
+		if(
+			!FLAC__bitwriter_write_raw_uint32(bw, 0x55, 7) ||
+			!FLAC__bitwriter_write_rice_signed_block(bw, residual, RICE_TABLE_TEST_VALUES, parameter) ||
+			!FLAC__bitwriter_zero_pad_to_byte_boundary(bw) ||
+			!FLAC__bitwriter_get_buffer(bw, &buffer, &bytes)
+		) {
+			printf("FAILED, could not encode at parameter %u\n", parameter);
+			goto done;
+		}
+
+		FLAC__bitreader_build_rice_table(table, parameter);
+		position = 0;
+		FLAC__bitreader_set_source(br, buffer, bytes, &position);
+		FLAC__bitreader_clear(br);
+		ok = FLAC__bitreader_read_raw_uint32(br, &header, 7);
+		for(i = 0; ok && i < RICE_TABLE_TEST_VALUES; i += RICE_TABLE_TEST_PARTITION)
+			ok = FLAC__bitreader_read_rice_signed_block_table(br, output + i, RICE_TABLE_TEST_PARTITION, parameter, table);
+		FLAC__bitwriter_release_buffer(bw);
+		if(!ok || header != 0x55) {
+			printf("FAILED, could not read at parameter %u\n", parameter);
+			ok = false;
+			goto done;
+		}
+		for(i = 0; i < RICE_TABLE_TEST_VALUES; i++) {
+			if(output[i] != residual[i]) {
+				printf("FAILED, value %u at parameter %u is %d, expected %d\n", i, parameter, output[i], residual[i]);
+				ok = false;
+				goto done;
+			}
+		}
+	}
+	printf("OK\n");
+
+done:
+	if(0 != br)
+		FLAC__bitreader_delete(br);
+	if(0 != bw)
+		FLAC__bitwriter_delete(bw);
+	free(output);
+	free(residual);
+	return ok;
+}
+
 /*----------------------------------------------------------------------------*/
 
 static FLAC__bool read_callback(FLAC__byte buffer[], size_t *bytes, void *data)
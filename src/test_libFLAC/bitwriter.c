@@ -55,6 +55,7 @@ struct FLAC__BitWriter {
 	uint32_t capacity; /* capacity of buffer in words */
 	uint32_t words; /* # of complete words in buffer */
 	uint32_t bits; /* # of used bits in accum */
+	FLAC__uint16 (*crc16)(const FLAC__byte *data, uint32_t len); /* see FLAC__bitwriter_set_cpu_info() */
 };
 
 #define WORDS_TO_BITS(words) ((words) * FLAC__BITS_PER_WORD)
@@ -24,6 +24,7 @@
 
 #include "FLAC/assert.h"
 #include "share/compat.h"
+#include "private/cpu.h"
 #include "private/crc.h"
 #include "crc.h"
 
@@ -31,10 +32,13 @@ static FLAC__uint8 crc8_update_ref(FLAC__byte byte, FLAC__uint8 crc);
 static FLAC__uint16 crc16_update_ref(FLAC__byte byte, FLAC__uint16 crc);
 
 static FLAC__bool test_crc8(const FLAC__byte *data, size_t size);
-static FLAC__bool test_crc16(const FLAC__byte *data, size_t size);
+static FLAC__bool test_crc16(const FLAC__byte *data, size_t size, FLAC__uint16 (*crc16)(const FLAC__byte *data, uint32_t len), const char *name);
 static FLAC__bool test_crc16_update(const FLAC__byte *data, size_t size);
-static FLAC__bool test_crc16_32bit_words(const FLAC__uint32 *words, size_t size);
-static FLAC__bool test_crc16_64bit_words(const FLAC__uint64 *words, size_t size);
+static FLAC__bool test_crc16_32bit_words(const FLAC__uint32 *words, size_t size, FLAC__uint16 (*crc16_update_words32)(const FLAC__uint32 *words, uint32_t len, FLAC__uint16 crc), const char *name);
+static FLAC__bool test_crc16_64bit_words(const FLAC__uint64 *words, size_t size, FLAC__uint16 (*crc16_update_words64)(const FLAC__uint64 *words, uint32_t len, FLAC__uint16 crc), const char *name);
+
+/* word counts to test with, long enough for the vector code to fold several blocks */
+static const uint32_t word_counts[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 31, 32, 33, 100, 257 };
 
 #define DATA_SIZE 32768
 
@@ -42,6 +46,7 @@ FLAC__bool test_crc(void)
 {
 	uint32_t i;
 	FLAC__byte data[DATA_SIZE] = { 0 };
+	FLAC__CPUInfo cpuinfo;
 
 	/* Initialize data reproducibly with pseudo-random values. */
 	for (i = 1; i < DATA_SIZE; i++)
@@ -52,18 +57,36 @@ FLAC__bool test_crc(void)
 	if (! test_crc8(data, DATA_SIZE))
 		return false;
 
-	if (! test_crc16(data, DATA_SIZE))
+	if (! test_crc16(data, DATA_SIZE, FLAC__crc16, "FLAC__crc16"))
 		return false;
 
 	if (! test_crc16_update(data, DATA_SIZE))
 		return false;
 
-	if (! test_crc16_32bit_words((FLAC__uint32 *)data, DATA_SIZE / 4))
+	if (! test_crc16_32bit_words((FLAC__uint32 *)data, DATA_SIZE / 4, FLAC__crc16_update_words32, "FLAC__crc16_update_words32"))
 		return false;
 
-	if (! test_crc16_64bit_words((FLAC__uint64 *)data, DATA_SIZE / 8))
+	if (! test_crc16_64bit_words((FLAC__uint64 *)data, DATA_SIZE / 8, FLAC__crc16_update_words64, "FLAC__crc16_update_words64"))
 		return false;
 
+	FLAC__cpu_info(&cpuinfo);
+#if !defined FLAC__NO_ASM && (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN && defined FLAC__PCLMUL_SUPPORTED
+	if (cpuinfo.use_asm && cpuinfo.x86.pclmul && cpuinfo.x86.ssse3) {
+		if (! test_crc16(data, DATA_SIZE, FLAC__crc16_intrin_pclmul, "FLAC__crc16_intrin_pclmul"))
+			return false;
+
+		if (! test_crc16_32bit_words((FLAC__uint32 *)data, DATA_SIZE / 4, FLAC__crc16_update_words32_intrin_pclmul, "FLAC__crc16_update_words32_intrin_pclmul"))
+			return false;
+
+		if (! test_crc16_64bit_words((FLAC__uint64 *)data, DATA_SIZE / 8, FLAC__crc16_update_words64_intrin_pclmul, "FLAC__crc16_update_words64_intrin_pclmul"))
+			return false;
+	}
+	else
+		printf("no PCLMUL, skipping the vector CRC-16 tests\n");
+#else
+	(void)cpuinfo;
+#endif
+
 	printf("\nPASSED!\n");
 	return true;
 }
@@ -134,27 +157,27 @@ static FLAC__bool test_crc8(const FLAC__byte *data, size_t size)
 	return true;
 }
 
-static FLAC__bool test_crc16(const FLAC__byte *data, size_t size)
+static FLAC__bool test_crc16(const FLAC__byte *data, size_t size, FLAC__uint16 (*crc16)(const FLAC__byte *data, uint32_t len), const char *name)
 {
 	uint32_t i;
 	FLAC__uint16 crc0,crc1;
 
-	printf("testing FLAC__crc16 ... ");
+	printf("testing %s ... ", name);
 
 	crc0 = 0;
-	crc1 = FLAC__crc16(data, 0);
+	crc1 = crc16(data, 0);
 
 	if (crc1 != crc0) {
-		printf("FAILED, FLAC__crc16 returned non-zero CRC for zero bytes of data\n");
+		printf("FAILED, %s returned non-zero CRC for zero bytes of data\n", name);
 		return false;
 	}
 
 	for (i = 0; i < size; i++) {
 		crc0 = crc16_update_ref(data[i], crc0);
-		crc1 = FLAC__crc16(data, i + 1);
+		crc1 = crc16(data, i + 1);
 
 		if (crc1 != crc0) {
-			printf("FAILED, FLAC__crc16 result did not match reference CRC for %u bytes of test data\n", i + 1);
+			printf("FAILED, %s result did not match reference CRC for %u bytes of test data\n", name, i + 1);
 			return false;
 		}
 	}
@@ -189,13 +212,14 @@ static FLAC__bool test_crc16_update(const FLAC__byte *data, size_t size)
 	return true;
 }
 
-static FLAC__bool test_crc16_32bit_words(const FLAC__uint32 *words, size_t size)
+static FLAC__bool test_crc16_32bit_words(const FLAC__uint32 *words, size_t size, FLAC__uint16 (*crc16_update_words32)(const FLAC__uint32 *words, uint32_t len, FLAC__uint16 crc), const char *name)
 {
-	uint32_t n,i,k;
+	uint32_t j,n,i,k;
 	FLAC__uint16 crc0,crc1;
 
-	for (n = 1; n <= 16; n++) {
-		printf("testing FLAC__crc16_update_words32 (length=%i) ... ", n);
+	for (j = 0; j < sizeof(word_counts) / sizeof(word_counts[0]); j++) {
+		n = word_counts[j];
+		printf("testing %s (length=%i) ... ", name, n);
 
 		crc0 = 0;
 		crc1 = 0;
@@ -208,18 +232,18 @@ static FLAC__bool test_crc16_32bit_words(const FLAC__uint32 *words, size_t size)
 				crc0 = crc16_update_ref( words[i + k]        & 0xFF, crc0);
 			}
 
-			crc1 = FLAC__crc16_update_words32(words + i, n, crc1);
+			crc1 = crc16_update_words32(words + i, n, crc1);
 
 			if (crc1 != crc0) {
-				printf("FAILED, FLAC__crc16_update_words32 result did not match reference CRC after %u words of test data\n", i + n);
+				printf("FAILED, %s result did not match reference CRC after %u words of test data\n", name, i + n);
 				return false;
 			}
 		}
 
-		crc1 = FLAC__crc16_update_words32(words, 0, crc1);
+		crc1 = crc16_update_words32(words, 0, crc1);
 
 		if (crc1 != crc0) {
-			printf("FAILED, FLAC__crc16_update_words32 called with zero bytes changed CRC value\n");
+			printf("FAILED, %s called with zero bytes changed CRC value\n", name);
 			return false;
 		}
 
@@ -229,13 +253,14 @@ static FLAC__bool test_crc16_32bit_words(const FLAC__uint32 *words, size_t size)
 	return true;
 }
 
-static FLAC__bool test_crc16_64bit_words(const FLAC__uint64 *words, size_t size)
+static FLAC__bool test_crc16_64bit_words(const FLAC__uint64 *words, size_t size, FLAC__uint16 (*crc16_update_words64)(const FLAC__uint64 *words, uint32_t len, FLAC__uint16 crc), const char *name)
 {
-	uint32_t n,i,k;
+	uint32_t j,n,i,k;
 	FLAC__uint16 crc0,crc1;
 
-	for (n = 1; n <= 16; n++) {
-		printf("testing FLAC__crc16_update_words64 (length=%i) ... ", n);
+	for (j = 0; j < sizeof(word_counts) / sizeof(word_counts[0]); j++) {
+		n = word_counts[j];
+		printf("testing %s (length=%i) ... ", name, n);
 
 		crc0 = 0;
 		crc1 = 0;
@@ -252,18 +277,18 @@ static FLAC__bool test_crc16_64bit_words(const FLAC__uint64 *words, size_t size)
 				crc0 = crc16_update_ref( words[i + k]        & 0xFF, crc0);
 			}
 
-			crc1 = FLAC__crc16_update_words64(words + i, n, crc1);
+			crc1 = crc16_update_words64(words + i, n, crc1);
 
 			if (crc1 != crc0) {
-				printf("FAILED, FLAC__crc16_update_words64 result did not match reference CRC after %u words of test data\n", i + n);
+				printf("FAILED, %s result did not match reference CRC after %u words of test data\n", name, i + n);
 				return false;
 			}
 		}
 
-		crc1 = FLAC__crc16_update_words64(words, 0, crc1);
+		crc1 = crc16_update_words64(words, 0, crc1);
 
 		if (crc1 != crc0) {
-			printf("FAILED, FLAC__crc16_update_words64 called with zero bytes changed CRC value\n");
+			printf("FAILED, %s called with zero bytes changed CRC value\n", name);
 			return false;
 		}
 
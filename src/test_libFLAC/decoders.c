@@ -27,9 +27,12 @@
 #include <string.h>
 #include "decoders.h"
 #include "FLAC/assert.h"
+#include "FLAC/metadata.h"
 #include "FLAC/stream_decoder.h"
+#include "FLAC/stream_encoder.h"
 #include "share/grabbag.h"
 #include "share/compat.h"
+#include "share/private.h"
 #include "share/safe_str.h"
 #include "test_libs_common/file_utils_flac.h"
 #include "test_libs_common/metadata_utils.h"
@@ -38,20 +41,24 @@ typedef enum {
 	LAYER_STREAM = 0, /* FLAC__stream_decoder_init_[ogg_]stream() without seeking */
 	LAYER_SEEKABLE_STREAM, /* FLAC__stream_decoder_init_[ogg_]stream() with seeking */
 	LAYER_FILE, /* FLAC__stream_decoder_init_[ogg_]FILE() */
-	LAYER_FILENAME /* FLAC__stream_decoder_init_[ogg_]file() */
+	LAYER_FILENAME, /* FLAC__stream_decoder_init_[ogg_]file(), with FLAC__stream_decoder_set_mmap() */
+	LAYER_MEMORY /* FLAC__stream_decoder_init_[ogg_]memory() */
 } Layer;
 
 static const char * const LayerString[] = {
 	"Stream",
 	"Seekable Stream",
 	"FILE*",
-	"Filename"
+	"Filename",
+	"Memory"
 };
 
 typedef struct {
 	Layer layer;
 	FILE *file;
 	char filename[512];
+	FLAC__byte *memory;
+	size_t memory_length;
 	uint32_t current_metadata_number;
 	FLAC__bool got_audio;
 	FLAC__bool ignore_errors;
@@ -99,6 +106,23 @@ static void open_test_file(StreamDecoderClientData * pdcd, int is_ogg, int is_ch
 	safe_strncpy(pdcd->filename, flacfilename(is_ogg,is_chained_ogg), sizeof (pdcd->filename));
 }
 
+static FLAC__bool load_test_file_(StreamDecoderClientData *pdcd, int is_ogg, int is_chained_ogg)
+{
+	FILE *file;
+
+	pdcd->memory_length = (size_t)flacfilesize_;
+	if(0 == (pdcd->memory = malloc(pdcd->memory_length)))
+		return false;
+	if(0 == (file = flac_fopen(flacfilename(is_ogg,is_chained_ogg), "rb")))
+		return false;
+	if(fread(pdcd->memory, 1, pdcd->memory_length, file) != pdcd->memory_length) {
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+	return true;
+}
+
 static void init_metadata_blocks_(void)
 {
 	mutils__init_metadata_blocks(&streaminfo_, &padding_, &seektable_, &application1_, &application2_, &vorbiscomment_, &cuesheet_, &picture_, &unknown_);
@@ -352,6 +376,9 @@ static FLAC__bool stream_decoder_test_respond_(FLAC__StreamDecoder *decoder, Str
 	if(!FLAC__stream_decoder_set_md5_checking(decoder, true))
 		return die_s_("at FLAC__stream_decoder_set_md5_checking(), returned false", decoder);
 
+	if(dcd->layer == LAYER_FILENAME && !FLAC__stream_decoder_set_mmap(decoder, true))
+		return die_s_("at FLAC__stream_decoder_set_mmap(), returned false", decoder);
+
 	/* for FLAC__stream_encoder_init_FILE(), the FLAC__stream_encoder_finish() closes the file so we have to keep re-opening: */
 	if(dcd->layer == LAYER_FILE) {
 		printf("opening %sFLAC file... ", is_ogg? "Ogg ":"");
@@ -396,6 +423,12 @@ static FLAC__bool stream_decoder_test_respond_(FLAC__StreamDecoder *decoder, Str
 				FLAC__stream_decoder_init_ogg_file(decoder, flacfilename(is_ogg,is_chained_ogg), stream_decoder_write_callback_, stream_decoder_metadata_callback_, stream_decoder_error_callback_, dcd) :
 				FLAC__stream_decoder_init_file(decoder, flacfilename(is_ogg,is_chained_ogg), stream_decoder_write_callback_, stream_decoder_metadata_callback_, stream_decoder_error_callback_, dcd);
 			break;
+		case LAYER_MEMORY:
+			printf("testing FLAC__stream_decoder_init_%smemory()... ", is_ogg? "ogg_":"");
+			init_status = is_ogg?
+				FLAC__stream_decoder_init_ogg_memory(decoder, dcd->memory, dcd->memory_length, stream_decoder_write_callback_, stream_decoder_metadata_callback_, stream_decoder_error_callback_, dcd) :
+				FLAC__stream_decoder_init_memory(decoder, dcd->memory, dcd->memory_length, stream_decoder_write_callback_, stream_decoder_metadata_callback_, stream_decoder_error_callback_, dcd);
+			break;
 		default:
 			die_("internal error 000");
 			return false;
@@ -486,6 +519,8 @@ static FLAC__bool test_stream_decoder(Layer layer, FLAC__bool is_ogg, FLAC__bool
 	FLAC__uint64 total_samples;
 
 	decoder_client_data.layer = layer;
+	decoder_client_data.memory = 0;
+	decoder_client_data.memory_length = 0;
 	decoder_client_data.other_chain = false;
 	decoder_client_data.error_occurred = false;
 	decoder_client_data.got_audio = false;
@@ -493,6 +528,15 @@ static FLAC__bool test_stream_decoder(Layer layer, FLAC__bool is_ogg, FLAC__bool
 
 	printf("\n+++ libFLAC unit test: FLAC__StreamDecoder (layer: %s, format: %s)\n\n", LayerString[layer], is_chained_ogg? "chained Ogg FLAC" : is_ogg? "Ogg FLAC" : "FLAC");
 
+	if(layer == LAYER_MEMORY) {
+		printf("loading %sFLAC file into memory... ", is_ogg? "Ogg ":"");
+		if(!load_test_file_(&decoder_client_data, is_ogg, is_chained_ogg)) {
+			printf("ERROR (%s)\n", strerror(errno));
+			return false;
+		}
+		printf("OK\n");
+	}
+
 	printf("testing FLAC__stream_decoder_new()... ");
 	decoder = FLAC__stream_decoder_new();
 	if(0 == decoder) {
@@ -530,6 +574,13 @@ static FLAC__bool test_stream_decoder(Layer layer, FLAC__bool is_ogg, FLAC__bool
 		printf("OK\n");
 	}
 
+	if(layer == LAYER_FILENAME) {
+		printf("testing FLAC__stream_decoder_set_mmap()... ");
+		if(!FLAC__stream_decoder_set_mmap(decoder, true))
+			return die_s_("returned false", decoder);
+		printf("OK\n");
+	}
+
 	switch(layer) {
 		case LAYER_STREAM:
 			printf("testing FLAC__stream_decoder_init_%sstream()... ", is_ogg? "ogg_":"");
@@ -555,6 +606,12 @@ static FLAC__bool test_stream_decoder(Layer layer, FLAC__bool is_ogg, FLAC__bool
 				FLAC__stream_decoder_init_ogg_file(decoder, flacfilename(is_ogg,is_chained_ogg), stream_decoder_write_callback_, stream_decoder_metadata_callback_, stream_decoder_error_callback_, &decoder_client_data) :
 				FLAC__stream_decoder_init_file(decoder, flacfilename(is_ogg,is_chained_ogg), stream_decoder_write_callback_, stream_decoder_metadata_callback_, stream_decoder_error_callback_, &decoder_client_data);
 			break;
+		case LAYER_MEMORY:
+			printf("testing FLAC__stream_decoder_init_%smemory()... ", is_ogg? "ogg_":"");
+			init_status = is_ogg?
+				FLAC__stream_decoder_init_ogg_memory(decoder, decoder_client_data.memory, decoder_client_data.memory_length, stream_decoder_write_callback_, stream_decoder_metadata_callback_, stream_decoder_error_callback_, &decoder_client_data) :
+				FLAC__stream_decoder_init_memory(decoder, decoder_client_data.memory, decoder_client_data.memory_length, stream_decoder_write_callback_, stream_decoder_metadata_callback_, stream_decoder_error_callback_, &decoder_client_data);
+			break;
 		default:
 			die_("internal error 009");
 			return false;
@@ -626,6 +683,12 @@ static FLAC__bool test_stream_decoder(Layer layer, FLAC__bool is_ogg, FLAC__bool
 				FLAC__stream_decoder_init_ogg_file(decoder, flacfilename(is_ogg,is_chained_ogg), 0, 0, 0, 0) :
 				FLAC__stream_decoder_init_file(decoder, flacfilename(is_ogg,is_chained_ogg), 0, 0, 0, 0);
 			break;
+		case LAYER_MEMORY:
+			printf("testing FLAC__stream_decoder_init_%smemory()... ", is_ogg? "ogg_":"");
+			init_status = is_ogg?
+				FLAC__stream_decoder_init_ogg_memory(decoder, decoder_client_data.memory, decoder_client_data.memory_length, 0, 0, 0, 0) :
+				FLAC__stream_decoder_init_memory(decoder, decoder_client_data.memory, decoder_client_data.memory_length, 0, 0, 0, 0);
+			break;
 		default:
 			die_("internal error 003");
 			return false;
@@ -678,6 +741,13 @@ static FLAC__bool test_stream_decoder(Layer layer, FLAC__bool is_ogg, FLAC__bool
 		printf("OK\n");
 	}
 
+	if(layer == LAYER_FILENAME) {
+		printf("testing FLAC__stream_decoder_set_mmap()... ");
+		if(!FLAC__stream_decoder_set_mmap(decoder, true))
+			return die_s_("returned false", decoder);
+		printf("OK\n");
+	}
+
 	switch(layer) {
 		case LAYER_STREAM:
 			printf("testing FLAC__stream_decoder_init_%sstream()... ", is_ogg? "ogg_":"");
@@ -703,6 +773,12 @@ static FLAC__bool test_stream_decoder(Layer layer, FLAC__bool is_ogg, FLAC__bool
 				FLAC__stream_decoder_init_ogg_file(decoder, flacfilename(is_ogg,is_chained_ogg), stream_decoder_write_callback_, stream_decoder_metadata_callback_, stream_decoder_error_callback_, &decoder_client_data) :
 				FLAC__stream_decoder_init_file(decoder, flacfilename(is_ogg,is_chained_ogg), stream_decoder_write_callback_, stream_decoder_metadata_callback_, stream_decoder_error_callback_, &decoder_client_data);
 			break;
+		case LAYER_MEMORY:
+			printf("testing FLAC__stream_decoder_init_%smemory()... ", is_ogg? "ogg_":"");
+			init_status = is_ogg?
+				FLAC__stream_decoder_init_ogg_memory(decoder, decoder_client_data.memory, decoder_client_data.memory_length, stream_decoder_write_callback_, stream_decoder_metadata_callback_, stream_decoder_error_callback_, &decoder_client_data) :
+				FLAC__stream_decoder_init_memory(decoder, decoder_client_data.memory, decoder_client_data.memory_length, stream_decoder_write_callback_, stream_decoder_metadata_callback_, stream_decoder_error_callback_, &decoder_client_data);
+			break;
 		default:
 			die_("internal error 009");
 			return false;
@@ -1430,11 +1506,1220 @@ static FLAC__bool test_stream_decoder(Layer layer, FLAC__bool is_ogg, FLAC__bool
 	FLAC__stream_decoder_delete(decoder);
 	printf("OK\n");
 
+	free(decoder_client_data.memory);
+
 	printf("\nPASSED!\n");
 
 	return true;
 }
 
+typedef struct {
+	FLAC__uint64 samples;
+	FLAC__uint32 checksum;
+	uint32_t errors;
+	FLAC__bool out_of_order;
+} ThreadedDecodeResult;
+
+static FLAC__StreamDecoderWriteStatus threaded_decode_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data)
+{
+	ThreadedDecodeResult *result = (ThreadedDecodeResult*)client_data;
+	uint32_t channel, i;
+
+	(void)decoder;
+
+	if(frame->header.number_type != FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER || frame->header.number.sample_number != result->samples)
+		result->out_of_order = true;
+	for(channel = 0; channel < frame->header.channels; channel++)
+		for(i = 0; i < frame->header.blocksize; i++)
+			result->checksum = result->checksum * 31 + (FLAC__uint32)buffer[channel][i];
+	result->samples += frame->header.blocksize;
+
+	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+static void threaded_decode_error_callback_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data)
+{
+	ThreadedDecodeResult *result = (ThreadedDecodeResult*)client_data;
+
+	(void)decoder, (void)status;
+
+	result->errors++;
+}
+
+/* applies the settings a test compares to a decoder, returns false if a
+ * setter fails */
+typedef FLAC__bool (*DecoderSettingsCallback)(FLAC__StreamDecoder *decoder, const void *settings);
+
+/* decodes a file with MD5 checking, after the settings callback has set up
+ * the decoder, and deletes the decoder on every path */
+static FLAC__bool decode_with_settings_(const char *filename, DecoderSettingsCallback settings_callback, const void *settings, ThreadedDecodeResult *result, FLAC__bool *md5_ok)
+{
+	FLAC__StreamDecoder *decoder;
+	FLAC__bool ok = false;
+
+	memset(result, 0, sizeof(*result));
+
+	if(0 == (decoder = FLAC__stream_decoder_new()))
+		return die_("FLAC__stream_decoder_new() returned NULL");
+
+	if(!FLAC__stream_decoder_set_md5_checking(decoder, true))
+		die_s_("FLAC__stream_decoder_set_md5_checking() returned false", decoder);
+	else if(!settings_callback(decoder, settings))
+		die_s_("setting up the decoder", decoder);
+	else if(FLAC__stream_decoder_init_file(decoder, filename, threaded_decode_write_callback_, /*metadata_callback=*/0, threaded_decode_error_callback_, result) != FLAC__STREAM_DECODER_INIT_STATUS_OK)
+		die_s_("FLAC__stream_decoder_init_file() failed", decoder);
+	else if(!FLAC__stream_decoder_process_until_end_of_stream(decoder))
+		die_s_("FLAC__stream_decoder_process_until_end_of_stream() returned false", decoder);
+	else if(FLAC__stream_decoder_get_state(decoder) != FLAC__STREAM_DECODER_END_OF_STREAM)
+		die_s_("decoder did not reach the end of the stream", decoder);
+	else
+		ok = true;
+
+	*md5_ok = FLAC__stream_decoder_finish(decoder);
+	FLAC__stream_decoder_delete(decoder);
+	return ok;
+}
+
+typedef struct {
+	uint32_t num_threads;
+	FLAC__ThreadPool *pool;
+} ThreadSettings;
+
+static FLAC__bool thread_settings_(FLAC__StreamDecoder *decoder, const void *settings)
+{
+	const ThreadSettings *s = (const ThreadSettings*)settings;
+	const uint32_t retval = FLAC__stream_decoder_set_num_threads(decoder, s->num_threads);
+
+	if(retval != FLAC__STREAM_DECODER_SET_NUM_THREADS_OK && retval != FLAC__STREAM_DECODER_SET_NUM_THREADS_NOT_COMPILED_WITH_MULTITHREADING_ENABLED)
+		return false;
+	return FLAC__stream_decoder_set_thread_pool(decoder, s->pool);
+}
+
+static FLAC__bool threaded_decode_(const char *filename, uint32_t num_threads, FLAC__ThreadPool *pool, ThreadedDecodeResult *result, FLAC__bool *md5_ok)
+{
+	ThreadSettings settings;
+
+	settings.num_threads = num_threads;
+	settings.pool = pool;
+	return decode_with_settings_(filename, thread_settings_, &settings, result, md5_ok);
+}
+
+/* decodes with 2, 4 and 8 threads of the decoder's own, and with 4 threads
+ * taken from a pool of 2, and checks the outcome is as without threads */
+static FLAC__bool compare_threaded_decode_(const char *filename, FLAC__bool expect_errors)
+{
+	static const uint32_t num_threads[] = { 2, 4, 8, 4 };
+	static const FLAC__bool use_pool[] = { false, false, false, true };
+	ThreadedDecodeResult single, multi;
+	FLAC__bool single_md5_ok, multi_md5_ok;
+	FLAC__ThreadPool *pool;
+	uint32_t i;
+
+	if(!threaded_decode_(filename, 1, /*pool=*/0, &single, &single_md5_ok))
+		return false;
+	if((single.errors > 0) != expect_errors)
+		return die_("unexpected error count decoding single-threaded");
+	if(0 == (pool = FLAC__thread_pool_new(2)))
+		return die_("FLAC__thread_pool_new() returned NULL");
+
+	for(i = 0; i < sizeof(num_threads) / sizeof(num_threads[0]); i++) {
+		printf("%u threads%s... ", num_threads[i], use_pool[i]? " from a pool of 2" : "");
+		fflush(stdout);
+		if(!threaded_decode_(filename, num_threads[i], use_pool[i]? pool : 0, &multi, &multi_md5_ok))
+			return false;
+		/* read_frame_header_() numbers the frames of some streams by frame
+		 * number, with or without threads */
+		if(multi.out_of_order && !single.out_of_order)
+			return die_("frames were written out of order");
+		if(multi.samples != single.samples || multi.checksum != single.checksum)
+			return die_("decoded audio differs from single-threaded decoding");
+		if(multi.errors != single.errors) {
+			printf("got %u errors, expected %u... ", multi.errors, single.errors);
+			return die_("error callbacks differ from single-threaded decoding");
+		}
+		if(multi_md5_ok != single_md5_ok)
+			return die_("MD5 check differs from single-threaded decoding");
+	}
+	FLAC__thread_pool_delete(pool);
+	return true;
+}
+
+/* Encodes a stream with many LPC subframes with many residual
+ * partitions, so both ways of restoring them get a workout.  The last
+ * frame is cut short at a length that is not a multiple of 8. */
+static FLAC__bool generate_lpc_file_(const char *filename, uint32_t bps, uint32_t channels, uint32_t max_lpc_order)
+{
+	FLAC__StreamEncoder *encoder;
+	FLAC__int32 samples[3 * 1024];
+	/* the samples can be negative, so they are scaled up to bps bits with a multiply */
+	const FLAC__int32 scale = (FLAC__int32)1 << (bps - 16);
+	FLAC__uint32 noise = 1;
+	uint32_t i, block;
+	FLAC__bool ok;
+
+	FLAC__ASSERT(channels == 2 || channels == 3);
+
+	if(0 == (encoder = FLAC__stream_encoder_new()))
+		return die_("FLAC__stream_encoder_new() returned NULL");
+	ok = FLAC__stream_encoder_set_channels(encoder, channels);
+	ok &= FLAC__stream_encoder_set_bits_per_sample(encoder, bps);
+	ok &= FLAC__stream_encoder_set_sample_rate(encoder, 44100);
+	ok &= FLAC__stream_encoder_set_compression_level(encoder, 8);
+	ok &= FLAC__stream_encoder_set_streamable_subset(encoder, false);
+	ok &= FLAC__stream_encoder_set_max_lpc_order(encoder, max_lpc_order);
+	ok &= FLAC__stream_encoder_set_max_residual_partition_order(encoder, 8);
+	if(!ok || FLAC__stream_encoder_init_file(encoder, filename, /*progress_callback=*/0, /*client_data=*/0) != FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
+		FLAC__stream_encoder_delete(encoder);
+		return die_("initializing the encoder");
+	}
+	for(block = 0; block < 65; block++) {
+		const uint32_t blocksize = block < 64? 1024 : 13;
+		for(i = 0; i < blocksize; i++) {
+			const FLAC__int32 t = (FLAC__int32)(block * 1024 + i);
+			/* a few partials from a triangle wave plus noise */
+			const FLAC__int32 x = ((t * 7) % 400 - 200) * 40 + ((t * 3) % 1000 - 500) * 20;
+			const FLAC__int32 y = ((t * 5) % 300 - 150) * 60;
+			FLAC__int32 shared, other;
+			noise = noise * 1103515245 + 12345;
+			shared = (FLAC__int32)(noise >> 24) - 128;
+			other = (FLAC__int32)(noise >> 10 & 63) - 32;
+			/* vary how the noise in both channels relates every 4096
+			 * samples, to have the encoder pick every kind of stereo
+			 * decorrelation */
+			switch(block / 4 % 4) {
+				case 0: /* independent */
+					samples[channels*i] = other * scale;
+					samples[channels*i+1] = (x + shared) * scale;
+					break;
+				case 1: /* left-side */
+					samples[channels*i] = (x + shared) * scale;
+					samples[channels*i+1] = (x + 3 * shared + other) * scale;
+					break;
+				case 2: /* right-side */
+					samples[channels*i] = (x + 3 * shared + other) * scale;
+					samples[channels*i+1] = (x + shared) * scale;
+					break;
+				default: /* mid-side */
+					samples[channels*i] = (x + shared) * scale;
+					samples[channels*i+1] = (y - shared) * scale;
+					break;
+			}
+			if(channels == 3)
+				samples[channels*i+2] = (x / 3 - other) * scale;
+		}
+		if(!FLAC__stream_encoder_process_interleaved(encoder, samples, blocksize)) {
+			FLAC__stream_encoder_delete(encoder);
+			return die_("FLAC__stream_encoder_process_interleaved() returned false");
+		}
+	}
+	ok = FLAC__stream_encoder_finish(encoder);
+	FLAC__stream_encoder_delete(encoder);
+	return ok? true : die_("FLAC__stream_encoder_finish() returned false");
+}
+
+static FLAC__bool fused_lpc_restore_settings_(FLAC__StreamDecoder *decoder, const void *settings)
+{
+	return FLAC__stream_decoder_set_fused_lpc_restore(decoder, *(const FLAC__bool*)settings);
+}
+
+static FLAC__bool fused_lpc_restore_decode_(const char *filename, FLAC__bool fused_lpc_restore, ThreadedDecodeResult *result)
+{
+	FLAC__bool md5_ok;
+
+	if(!decode_with_settings_(filename, fused_lpc_restore_settings_, &fused_lpc_restore, result, &md5_ok))
+		return false;
+	if(!md5_ok)
+		return die_("MD5 mismatch");
+	if(result->errors > 0)
+		return die_("got error callbacks decoding a clean stream");
+	return true;
+}
+
+static FLAC__bool test_stream_decoder_fused_lpc_restore(void)
+{
+	const char *filename = "lpc_partitions.flac";
+	static const uint32_t bits_per_sample[] = { 16, 24 };
+	static const uint32_t max_lpc_orders[] = { 8, 12, 32 };
+	ThreadedDecodeResult two_passes, fused;
+	uint32_t i, j;
+
+	printf("\n+++ libFLAC unit test: FLAC__StreamDecoder (LPC restore by partition)\n\n");
+
+	for(i = 0; i < sizeof(bits_per_sample) / sizeof(bits_per_sample[0]); i++) {
+		for(j = 0; j < sizeof(max_lpc_orders) / sizeof(max_lpc_orders[0]); j++) {
+			printf("testing restore by partition against restore of the whole subframe, bps=%u max_lpc_order=%u... ", bits_per_sample[i], max_lpc_orders[j]);
+			if(!generate_lpc_file_(filename, bits_per_sample[i], /*channels=*/2, max_lpc_orders[j]))
+				return false;
+			if(!fused_lpc_restore_decode_(filename, /*fused_lpc_restore=*/false, &two_passes))
+				return false;
+			if(!fused_lpc_restore_decode_(filename, /*fused_lpc_restore=*/true, &fused))
+				return false;
+			if(fused.samples != two_passes.samples || fused.checksum != two_passes.checksum)
+				return die_("decoded audio differs");
+			printf("OK\n");
+		}
+	}
+	(void) grabbag__file_remove_file(filename);
+
+	return true;
+}
+
+typedef struct {
+	FLAC__StreamDecoderPCMFormat format;
+	FLAC__byte *data; /* the decoded samples, for the reference decode as interleaved FLAC__int32 */
+	size_t bytes, capacity;
+	FLAC__uint64 next_sample;
+	uint32_t channels, bps;
+	uint32_t errors;
+	FLAC__bool bad_frame;
+} InterleavedDecodeResult;
+
+static const uint32_t pcm_format_bytes_[] = { 2, 3, 4, 4 };
+
+static FLAC__bool interleaved_decode_append_(InterleavedDecodeResult *result, const void *data, size_t bytes)
+{
+	if(result->bytes + bytes > result->capacity) {
+		FLAC__byte *tmp;
+		size_t capacity = result->capacity? result->capacity : 65536;
+		while(capacity < result->bytes + bytes)
+			capacity *= 2;
+		if(0 == (tmp = realloc(result->data, capacity)))
+			return false;
+		result->data = tmp;
+		result->capacity = capacity;
+	}
+	memcpy(result->data + result->bytes, data, bytes);
+	result->bytes += bytes;
+	return true;
+}
+
+static FLAC__StreamDecoderWriteStatus interleaved_reference_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data)
+{
+	InterleavedDecodeResult *result = (InterleavedDecodeResult*)client_data;
+	uint32_t channel, i;
+
+	(void)decoder;
+
+	result->channels = frame->header.channels;
+	result->bps = frame->header.bits_per_sample;
+	for(i = 0; i < frame->header.blocksize; i++)
+		for(channel = 0; channel < frame->header.channels; channel++)
+			if(!interleaved_decode_append_(result, &buffer[channel][i], sizeof(FLAC__int32)))
+				return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
+	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+static FLAC__StreamDecoderWriteStatus interleaved_decode_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const void *buffer, size_t bytes, void *client_data)
+{
+	InterleavedDecodeResult *result = (InterleavedDecodeResult*)client_data;
+
+	(void)decoder;
+
+	if(frame->header.number.sample_number != result->next_sample || bytes != (size_t)frame->header.blocksize * frame->header.channels * pcm_format_bytes_[result->format])
+		result->bad_frame = true;
+	result->next_sample = frame->header.number.sample_number + frame->header.blocksize;
+	if(!interleaved_decode_append_(result, buffer, bytes))
+		return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
+	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+static void interleaved_decode_error_callback_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data)
+{
+	InterleavedDecodeResult *result = (InterleavedDecodeResult*)client_data;
+
+	(void)decoder, (void)status;
+
+	result->errors++;
+}
+
+/* Decodes filename with interleaved output, or to FLAC__int32 samples if
+ * reference is true */
+static FLAC__bool interleaved_decode_(const char *filename, FLAC__bool reference, FLAC__StreamDecoderPCMFormat format, FLAC__bool md5_checking, uint32_t num_threads, FLAC__uint64 seek_to, InterleavedDecodeResult *result)
+{
+	FLAC__StreamDecoder *decoder;
+	FLAC__StreamDecoderInitStatus init_status;
+
+	free(result->data);
+	memset(result, 0, sizeof(*result));
+	result->format = format;
+	result->next_sample = seek_to;
+
+	if(0 == (decoder = FLAC__stream_decoder_new()))
+		return die_("FLAC__stream_decoder_new() returned NULL");
+	if(!FLAC__stream_decoder_set_md5_checking(decoder, md5_checking))
+		return die_s_("FLAC__stream_decoder_set_md5_checking() returned false", decoder);
+	(void)FLAC__stream_decoder_set_num_threads(decoder, num_threads);
+	if(reference)
+		init_status = FLAC__stream_decoder_init_file(decoder, filename, interleaved_reference_write_callback_, /*metadata_callback=*/0, interleaved_decode_error_callback_, result);
+	else {
+		if(!FLAC__stream_decoder_set_interleaved_output(decoder, format, interleaved_decode_write_callback_))
+			return die_s_("FLAC__stream_decoder_set_interleaved_output() returned false", decoder);
+		init_status = FLAC__stream_decoder_init_file(decoder, filename, /*write_callback=*/0, /*metadata_callback=*/0, interleaved_decode_error_callback_, result);
+	}
+	if(init_status != FLAC__STREAM_DECODER_INIT_STATUS_OK)
+		return die_s_("FLAC__stream_decoder_init_file() failed", decoder);
+	if(FLAC__stream_decoder_set_interleaved_output(decoder, format, interleaved_decode_write_callback_))
+		return die_s_("FLAC__stream_decoder_set_interleaved_output() did not fail on an initialized decoder", decoder);
+	if(seek_to > 0 && !FLAC__stream_decoder_seek_absolute(decoder, seek_to))
+		return die_s_("FLAC__stream_decoder_seek_absolute() returned false", decoder);
+	if(!FLAC__stream_decoder_process_until_end_of_stream(decoder))
+		return die_s_("FLAC__stream_decoder_process_until_end_of_stream() returned false", decoder);
+	if(!FLAC__stream_decoder_finish(decoder)) {
+		FLAC__stream_decoder_delete(decoder);
+		return die_("MD5 mismatch");
+	}
+	FLAC__stream_decoder_delete(decoder);
+	if(result->errors > 0)
+		return die_("got error callbacks decoding a clean stream");
+	if(result->bad_frame)
+		return die_("interleaved write callback got a wrong sample number or size");
+	return true;
+}
+
+/* Converts the reference samples the way the decoder is documented to */
+static void pack_reference_(const InterleavedDecodeResult *reference, FLAC__StreamDecoderPCMFormat format, FLAC__byte *out)
+{
+	const FLAC__int32 *samples = (const FLAC__int32*)reference->data;
+	const size_t count = reference->bytes / sizeof(FLAC__int32);
+	const uint32_t width = 8 * pcm_format_bytes_[format];
+	const uint32_t bps = reference->bps;
+	size_t i;
+	uint32_t byte;
+
+	for(i = 0; i < count; i++) {
+		if(format == FLAC__STREAM_DECODER_PCM_FORMAT_FLOAT32) {
+			const float f = (float)((double)samples[i] / (double)((FLAC__int64)1 << (bps - 1)));
+			memcpy(out, &f, sizeof(f));
+			out += sizeof(f);
+		}
+		else {
+			const FLAC__int64 x = bps <= width? (FLAC__int64)samples[i] * ((FLAC__int64)1 << (width - bps)) : (FLAC__int64)(samples[i] >> (bps - width));
+			for(byte = 0; byte < width / 8; byte++)
+				*out++ = (FLAC__byte)(x >> (8 * byte));
+		}
+	}
+}
+
+static FLAC__bool test_stream_decoder_interleaved(void)
+{
+	const char *filename = "interleaved.flac";
+	static const uint32_t bits_per_sample[] = { 16, 24, 32 };
+	static const uint32_t channels[] = { 2, 3 };
+	InterleavedDecodeResult reference = { FLAC__STREAM_DECODER_PCM_FORMAT_S16LE, 0, 0, 0, 0, 0, 0, 0, false };
+	InterleavedDecodeResult interleaved = { FLAC__STREAM_DECODER_PCM_FORMAT_S16LE, 0, 0, 0, 0, 0, 0, 0, false };
+	FLAC__StreamDecoder *decoder;
+	FLAC__byte *expected = 0;
+	FLAC__bool float_supported;
+	uint32_t i, j, format;
+
+	printf("\n+++ libFLAC unit test: FLAC__StreamDecoder (interleaved output)\n\n");
+
+	printf("testing FLAC__stream_decoder_set_interleaved_output()... ");
+	if(0 == (decoder = FLAC__stream_decoder_new()))
+		return die_("FLAC__stream_decoder_new() returned NULL");
+	if(!FLAC__stream_decoder_set_interleaved_output(decoder, FLAC__STREAM_DECODER_PCM_FORMAT_S24LE, interleaved_decode_write_callback_))
+		return die_s_("FLAC__stream_decoder_set_interleaved_output() returned false", decoder);
+	if(FLAC__stream_decoder_set_interleaved_output(decoder, (FLAC__StreamDecoderPCMFormat)4, interleaved_decode_write_callback_))
+		return die_s_("FLAC__stream_decoder_set_interleaved_output() accepted an invalid format", decoder);
+	float_supported = FLAC__stream_decoder_set_interleaved_output(decoder, FLAC__STREAM_DECODER_PCM_FORMAT_FLOAT32, interleaved_decode_write_callback_);
+	if(!FLAC__stream_decoder_set_interleaved_output(decoder, FLAC__STREAM_DECODER_PCM_FORMAT_S16LE, /*write_callback=*/0))
+		return die_s_("FLAC__stream_decoder_set_interleaved_output() returned false", decoder);
+	if(FLAC__stream_decoder_init_file(decoder, flacfilename(/*is_ogg=*/false, /*is_chained_ogg=*/false), /*write_callback=*/0, /*metadata_callback=*/0, interleaved_decode_error_callback_, &interleaved) != FLAC__STREAM_DECODER_INIT_STATUS_INVALID_CALLBACKS)
+		return die_s_("FLAC__stream_decoder_init_file() accepted no write callback at all", decoder);
+	FLAC__stream_decoder_delete(decoder);
+	printf("OK\n");
+
+	for(i = 0; i < sizeof(bits_per_sample) / sizeof(bits_per_sample[0]); i++) {
+		for(j = 0; j < sizeof(channels) / sizeof(channels[0]); j++) {
+			if(!generate_lpc_file_(filename, bits_per_sample[i], channels[j], /*max_lpc_order=*/12))
+				return false;
+			if(!interleaved_decode_(filename, /*reference=*/true, FLAC__STREAM_DECODER_PCM_FORMAT_S16LE, /*md5_checking=*/true, /*num_threads=*/1, /*seek_to=*/0, &reference))
+				return false;
+			if(0 == (expected = realloc(expected, reference.bytes)))
+				return die_("out of memory");
+			for(format = FLAC__STREAM_DECODER_PCM_FORMAT_S16LE; format <= FLAC__STREAM_DECODER_PCM_FORMAT_FLOAT32; format++) {
+				const size_t frame_bytes = reference.channels * pcm_format_bytes_[format];
+				const size_t expected_bytes = reference.bytes / sizeof(FLAC__int32) * pcm_format_bytes_[format];
+				const FLAC__uint64 seek_to = reference.bytes / sizeof(FLAC__int32) / reference.channels / 3 + 5;
+				if(format == FLAC__STREAM_DECODER_PCM_FORMAT_FLOAT32 && !float_supported)
+					continue;
+				printf("testing %s, bps=%u channels=%u... ", FLAC__StreamDecoderPCMFormatString[format], bits_per_sample[i], channels[j]);
+				pack_reference_(&reference, (FLAC__StreamDecoderPCMFormat)format, expected);
+				if(!interleaved_decode_(filename, /*reference=*/false, (FLAC__StreamDecoderPCMFormat)format, /*md5_checking=*/false, /*num_threads=*/1, /*seek_to=*/0, &interleaved))
+					return false;
+				if(interleaved.bytes != expected_bytes || memcmp(interleaved.data, expected, expected_bytes))
+					return die_("interleaved output differs from the converted FLAC__int32 samples");
+				printf("with MD5 checking... ");
+				if(!interleaved_decode_(filename, /*reference=*/false, (FLAC__StreamDecoderPCMFormat)format, /*md5_checking=*/true, /*num_threads=*/1, /*seek_to=*/0, &interleaved))
+					return false;
+				if(interleaved.bytes != expected_bytes || memcmp(interleaved.data, expected, expected_bytes))
+					return die_("interleaved output differs from the converted FLAC__int32 samples");
+				printf("after seeking... ");
+				if(!interleaved_decode_(filename, /*reference=*/false, (FLAC__StreamDecoderPCMFormat)format, /*md5_checking=*/false, /*num_threads=*/1, seek_to, &interleaved))
+					return false;
+				if(interleaved.bytes != expected_bytes - seek_to * frame_bytes || memcmp(interleaved.data, expected + seek_to * frame_bytes, interleaved.bytes))
+					return die_("interleaved output differs from the converted FLAC__int32 samples");
+				printf("multithreaded... ");
+				if(!interleaved_decode_(filename, /*reference=*/false, (FLAC__StreamDecoderPCMFormat)format, /*md5_checking=*/false, /*num_threads=*/4, /*seek_to=*/0, &interleaved))
+					return false;
+				if(interleaved.bytes != expected_bytes || memcmp(interleaved.data, expected, expected_bytes))
+					return die_("interleaved output differs from the converted FLAC__int32 samples");
+				printf("OK\n");
+			}
+		}
+	}
+	free(reference.data);
+	free(interleaved.data);
+	free(expected);
+	(void) grabbag__file_remove_file(filename);
+
+	return true;
+}
+
+static FLAC__bool test_stream_decoder_threads(void)
+{
+	const char *damaged_filename = "metadata_damaged.flac";
+	const char *short_last_frame_filename = "short_last_frame.flac";
+	FLAC__byte *data;
+	FLAC__StreamDecoder *decoder;
+	ThreadedDecodeResult result;
+	FILE *file;
+	size_t i, bytes;
+
+	printf("\n+++ libFLAC unit test: FLAC__StreamDecoder (multithreaded)\n\n");
+
+	printf("testing FLAC__stream_decoder_set_num_threads()... ");
+	if(0 == (decoder = FLAC__stream_decoder_new()))
+		return die_("FLAC__stream_decoder_new() returned NULL");
+	if(FLAC__stream_decoder_set_num_threads(decoder, 4) == FLAC__STREAM_DECODER_SET_NUM_THREADS_NOT_COMPILED_WITH_MULTITHREADING_ENABLED) {
+		FLAC__stream_decoder_delete(decoder);
+		printf("not compiled with multithreading, skipped\n");
+		return true;
+	}
+	if(FLAC__stream_decoder_get_num_threads(decoder) != 4)
+		return die_s_("FLAC__stream_decoder_get_num_threads() returned the wrong value", decoder);
+	if(FLAC__stream_decoder_set_num_threads(decoder, 10000) != FLAC__STREAM_DECODER_SET_NUM_THREADS_TOO_MANY_THREADS)
+		return die_s_("accepted too many threads", decoder);
+	if(FLAC__stream_decoder_init_file(decoder, flacfilename(/*is_ogg=*/false, /*is_chained_ogg=*/false), threaded_decode_write_callback_, /*metadata_callback=*/0, threaded_decode_error_callback_, &result) != FLAC__STREAM_DECODER_INIT_STATUS_OK)
+		return die_s_("FLAC__stream_decoder_init_file() failed", decoder);
+	if(FLAC__stream_decoder_set_num_threads(decoder, 4) != FLAC__STREAM_DECODER_SET_NUM_THREADS_ALREADY_INITIALIZED)
+		return die_s_("FLAC__stream_decoder_set_num_threads() did not fail on an initialized decoder", decoder);
+	FLAC__stream_decoder_finish(decoder);
+	FLAC__stream_decoder_delete(decoder);
+	printf("OK\n");
+
+	printf("testing multithreaded decoding against single-threaded decoding... ");
+	if(!compare_threaded_decode_(flacfilename(/*is_ogg=*/false, /*is_chained_ogg=*/false), /*expect_errors=*/false))
+		return false;
+	printf("OK\n");
+
+	printf("testing multithreaded decoding of a damaged stream... ");
+	if(0 == (file = flac_fopen(flacfilename(/*is_ogg=*/false, /*is_chained_ogg=*/false), "rb")))
+		return die_("opening file");
+	bytes = (size_t)flacfilesize_;
+	if(0 == (data = malloc(bytes)) || fread(data, 1, bytes, file) != bytes) {
+		fclose(file);
+		free(data);
+		return die_("reading file");
+	}
+	fclose(file);
+	/* damage a stretch of frames in the second half, and cut a frame short near the end */
+	for(i = bytes / 2; i < bytes / 2 + 64; i += 7)
+		data[i] ^= 0x5a;
+	for(i = bytes * 3 / 4; i < bytes * 3 / 4 + 16; i++)
+		data[i] = 0xff;
+	bytes -= 3;
+	if(0 == (file = flac_fopen(damaged_filename, "wb")) || fwrite(data, 1, bytes, file) != bytes) {
+		if(file)
+			fclose(file);
+		free(data);
+		return die_("writing damaged file");
+	}
+	fclose(file);
+	free(data);
+	if(!compare_threaded_decode_(damaged_filename, /*expect_errors=*/true))
+		return false;
+	(void) grabbag__file_remove_file(damaged_filename);
+	printf("OK\n");
+
+	printf("testing multithreaded decoding of a fixed-blocksize stream with a short last frame in its STREAMINFO... ");
+	if(!generate_lpc_file_(short_last_frame_filename, /*bps=*/16, /*channels=*/2, /*max_lpc_order=*/8))
+		return false;
+	if(0 == (file = flac_fopen(short_last_frame_filename, "r+b")))
+		return die_("opening file");
+	/* min_blocksize, the first field of the STREAMINFO block, becomes the
+	 * 13 samples of the last frame */
+	if(fseeko(file, 8, SEEK_SET) < 0 || fputc(0, file) == EOF || fputc(13, file) == EOF) {
+		fclose(file);
+		return die_("patching STREAMINFO");
+	}
+	fclose(file);
+	if(!compare_threaded_decode_(short_last_frame_filename, /*expect_errors=*/false))
+		return false;
+	(void) grabbag__file_remove_file(short_last_frame_filename);
+	printf("OK\n");
+
+	return true;
+}
+
+typedef struct {
+	FILE *file;
+	FLAC__uint64 file_length;
+	FLAC__int32 *samples; /* the first channel of the whole stream */
+	uint32_t num_samples;
+	uint32_t seeks;
+	FLAC__uint64 target_sample;
+	FLAC__bool check_target;
+	FLAC__bool target_ok;
+} SeekIndexClientData;
+
+static FLAC__StreamDecoderReadStatus seek_index_read_callback_(const FLAC__StreamDecoder *decoder, FLAC__byte buffer[], size_t *bytes, void *client_data)
+{
+	SeekIndexClientData *dcd = (SeekIndexClientData*)client_data;
+	(void)decoder;
+	*bytes = fread(buffer, 1, *bytes, dcd->file);
+	if(ferror(dcd->file))
+		return FLAC__STREAM_DECODER_READ_STATUS_ABORT;
+	return *bytes == 0? FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM : FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+}
+
+static FLAC__StreamDecoderSeekStatus seek_index_seek_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 absolute_byte_offset, void *client_data)
+{
+	SeekIndexClientData *dcd = (SeekIndexClientData*)client_data;
+	(void)decoder;
+	dcd->seeks++;
+	return fseeko(dcd->file, (FLAC__off_t)absolute_byte_offset, SEEK_SET) < 0? FLAC__STREAM_DECODER_SEEK_STATUS_ERROR : FLAC__STREAM_DECODER_SEEK_STATUS_OK;
+}
+
+static FLAC__StreamDecoderTellStatus seek_index_tell_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 *absolute_byte_offset, void *client_data)
+{
+	SeekIndexClientData *dcd = (SeekIndexClientData*)client_data;
+	FLAC__off_t pos;
+	(void)decoder;
+	if((pos = ftello(dcd->file)) < 0)
+		return FLAC__STREAM_DECODER_TELL_STATUS_ERROR;
+	*absolute_byte_offset = (FLAC__uint64)pos;
+	return FLAC__STREAM_DECODER_TELL_STATUS_OK;
+}
+
+static FLAC__StreamDecoderLengthStatus seek_index_length_callback_(const FLAC__StreamDecoder *decoder, FLAC__uint64 *stream_length, void *client_data)
+{
+	SeekIndexClientData *dcd = (SeekIndexClientData*)client_data;
+	(void)decoder;
+	*stream_length = dcd->file_length;
+	return FLAC__STREAM_DECODER_LENGTH_STATUS_OK;
+}
+
+static FLAC__bool seek_index_eof_callback_(const FLAC__StreamDecoder *decoder, void *client_data)
+{
+	SeekIndexClientData *dcd = (SeekIndexClientData*)client_data;
+	(void)decoder;
+	return feof(dcd->file)? true : false;
+}
+
+static FLAC__StreamDecoderWriteStatus seek_index_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data)
+{
+	SeekIndexClientData *dcd = (SeekIndexClientData*)client_data;
+	const FLAC__uint64 sample_number = frame->header.number.sample_number;
+	(void)decoder;
+
+	if(dcd->check_target) {
+		/* the first frame after a seek starts at the target sample */
+		dcd->target_ok = sample_number == dcd->target_sample && sample_number < dcd->num_samples && buffer[0][0] == dcd->samples[sample_number];
+		dcd->check_target = false;
+	}
+	else if(sample_number == dcd->num_samples) {
+		if(0 == (dcd->samples = realloc(dcd->samples, (dcd->num_samples + frame->header.blocksize) * sizeof(FLAC__int32))))
+			return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+		memcpy(dcd->samples + dcd->num_samples, buffer[0], frame->header.blocksize * sizeof(FLAC__int32));
+		dcd->num_samples += frame->header.blocksize;
+	}
+	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+static void seek_index_error_callback_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data)
+{
+	(void)decoder, (void)client_data;
+	printf("ERROR: got error callback: err = %u (%s)\n", (uint32_t)status, FLAC__StreamDecoderErrorStatusString[status]);
+}
+
+static FLAC__bool seek_index_init_(FLAC__StreamDecoder *decoder, const char *filename, SeekIndexClientData *dcd)
+{
+	dcd->file_length = (FLAC__uint64)grabbag__file_get_filesize(filename);
+	if(0 == (dcd->file = flac_fopen(filename, "rb")))
+		return die_("opening file");
+	if(FLAC__stream_decoder_init_stream(decoder, seek_index_read_callback_, seek_index_seek_callback_, seek_index_tell_callback_, seek_index_length_callback_, seek_index_eof_callback_, seek_index_write_callback_, /*metadata_callback=*/0, seek_index_error_callback_, dcd) != FLAC__STREAM_DECODER_INIT_STATUS_OK)
+		return die_s_("FLAC__stream_decoder_init_stream() failed", decoder);
+	return true;
+}
+
+static FLAC__bool test_stream_decoder_seek_index(void)
+{
+	const char *filename = "seek_index.flac";
+	SeekIndexClientData dcd;
+	FLAC__StreamDecoder *decoder;
+	FLAC__StreamMetadata *seek_index, *padding;
+	FLAC__uint64 target_sample;
+	uint32_t i;
+
+	printf("\n+++ libFLAC unit test: FLAC__StreamDecoder (seek index)\n\n");
+
+	memset(&dcd, 0, sizeof(dcd));
+
+	/* a stream without a SEEKTABLE, ending in a short frame */
+	if(!generate_lpc_file_(filename, /*bps=*/16, /*channels=*/2, /*max_lpc_order=*/8))
+		return false;
+
+	printf("testing FLAC__stream_decoder_add_seek_index() with a block that is not a seek table... ");
+	if(0 == (decoder = FLAC__stream_decoder_new()))
+		return die_("FLAC__stream_decoder_new() returned NULL");
+	if(0 == (padding = FLAC__metadata_object_new(FLAC__METADATA_TYPE_PADDING)))
+		return die_("FLAC__metadata_object_new() returned NULL");
+	if(FLAC__stream_decoder_add_seek_index(decoder, padding))
+		return die_s_("FLAC__stream_decoder_add_seek_index() accepted a PADDING block", decoder);
+	FLAC__metadata_object_delete(padding);
+	printf("OK\n");
+
+	printf("testing FLAC__stream_decoder_set_build_seek_index()... ");
+	if(!FLAC__stream_decoder_set_build_seek_index(decoder, true))
+		return die_s_("FLAC__stream_decoder_set_build_seek_index() returned false", decoder);
+	if(!seek_index_init_(decoder, filename, &dcd))
+		return false;
+	if(FLAC__stream_decoder_set_build_seek_index(decoder, false))
+		return die_s_("FLAC__stream_decoder_set_build_seek_index() did not fail on an initialized decoder", decoder);
+	printf("OK\n");
+
+	printf("testing FLAC__stream_decoder_get_seek_index() after decoding... ");
+	if(!FLAC__stream_decoder_process_until_end_of_stream(decoder))
+		return die_s_("FLAC__stream_decoder_process_until_end_of_stream() returned false", decoder);
+	if(dcd.num_samples != 64 * 1024 + 13)
+		return die_("decoded the wrong number of samples");
+	if(0 == (seek_index = FLAC__stream_decoder_get_seek_index(decoder)))
+		return die_s_("FLAC__stream_decoder_get_seek_index() returned NULL", decoder);
+	if(seek_index->type != FLAC__METADATA_TYPE_SEEKTABLE || seek_index->data.seek_table.num_points < 2)
+		return die_("seek index has too few points");
+	/* there is a point for every frame, and the frames follow each other */
+	for(i = 0, target_sample = 0; i < seek_index->data.seek_table.num_points; i++) {
+		const FLAC__StreamMetadata_SeekPoint *point = &seek_index->data.seek_table.points[i];
+		if(point->sample_number != target_sample || point->frame_samples == 0)
+			return die_("seek point has the wrong sample number or frame length");
+		if(i == 0? point->stream_offset != 0 : point->stream_offset <= seek_index->data.seek_table.points[i-1].stream_offset)
+			return die_("seek point has the wrong stream offset");
+		target_sample += point->frame_samples;
+	}
+	if(target_sample != dcd.num_samples)
+		return die_("seek index does not cover the whole stream");
+	if(!FLAC__format_seektable_is_legal(&seek_index->data.seek_table))
+		return die_("seek index is not a legal seek table");
+	FLAC__stream_decoder_finish(decoder);
+	fclose(dcd.file);
+	printf("OK\n");
+
+	printf("testing FLAC__stream_decoder_finish() discards the seek index... ");
+	if(!seek_index_init_(decoder, filename, &dcd))
+		return false;
+	{
+		FLAC__StreamMetadata *empty = FLAC__stream_decoder_get_seek_index(decoder);
+		if(0 == empty)
+			return die_s_("FLAC__stream_decoder_get_seek_index() returned NULL", decoder);
+		if(empty->data.seek_table.num_points != 0)
+			return die_("seek index was kept by FLAC__stream_decoder_finish()");
+		FLAC__metadata_object_delete(empty);
+	}
+	FLAC__stream_decoder_finish(decoder);
+	fclose(dcd.file);
+	printf("OK\n");
+
+	printf("testing FLAC__stream_decoder_seek_absolute() with an imported seek index... ");
+	if(!FLAC__stream_decoder_add_seek_index(decoder, seek_index))
+		return die_s_("FLAC__stream_decoder_add_seek_index() returned false", decoder);
+	if(!seek_index_init_(decoder, filename, &dcd))
+		return false;
+	if(!FLAC__stream_decoder_process_until_end_of_metadata(decoder))
+		return die_s_("FLAC__stream_decoder_process_until_end_of_metadata() returned false", decoder);
+	/* jump back and forth; every seek lands in an indexed frame, so
+	 * takes a single seek callback */
+	for(i = 0, target_sample = 0; i < 40; i++) {
+		target_sample = (target_sample + 40009) % dcd.num_samples;
+		dcd.seeks = 0;
+		dcd.target_sample = target_sample;
+		dcd.check_target = true;
+		dcd.target_ok = false;
+		if(!FLAC__stream_decoder_seek_absolute(decoder, target_sample))
+			return die_s_("FLAC__stream_decoder_seek_absolute() returned false", decoder);
+		if(!dcd.target_ok)
+			return die_("seek did not land on the right sample");
+		if(dcd.seeks != 1) {
+			printf("seek to %" PRIu64 " took %u seek callbacks... ", target_sample, dcd.seeks);
+			return die_("seek did not use the seek index");
+		}
+	}
+	FLAC__stream_decoder_finish(decoder);
+	fclose(dcd.file);
+	printf("OK\n");
+
+	FLAC__metadata_object_delete(seek_index);
+	FLAC__stream_decoder_delete(decoder);
+	free(dcd.samples);
+	(void) grabbag__file_remove_file(filename);
+
+	return true;
+}
+
+static FLAC__bool write_damaged_file_(const char *filename, const FLAC__byte *data, size_t bytes)
+{
+	FILE *file;
+	if(0 == (file = flac_fopen(filename, "wb")) || fwrite(data, 1, bytes, file) != bytes) {
+		if(file)
+			fclose(file);
+		return die_("writing damaged file");
+	}
+	fclose(file);
+	return true;
+}
+
+typedef struct {
+	const FLAC__int32 *reference; /* interleaved samples of the whole stream */
+	FLAC__uint64 total_samples;
+	uint32_t channels;
+	const FLAC__StreamDecoderSampleRange *ranges;
+	uint32_t first_range; /* of the ranges passed to the current call */
+	FLAC__uint64 next_sample[8];
+	FLAC__bool bad_range;
+	uint32_t crc_mismatches;
+	uint32_t errors;
+} SampleRangesClientData;
+
+static FLAC__StreamDecoderWriteStatus sample_ranges_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data)
+{
+	(void)decoder, (void)frame, (void)buffer, (void)client_data;
+	/* the range write callback replaces this one */
+	return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+}
+
+static FLAC__StreamDecoderWriteStatus sample_ranges_range_write_callback_(const FLAC__StreamDecoder *decoder, uint32_t range, FLAC__uint64 sample_number, uint32_t samples, const FLAC__int32 * const buffer[], void *client_data)
+{
+	SampleRangesClientData *dcd = (SampleRangesClientData*)client_data;
+	const FLAC__StreamDecoderSampleRange *r = &dcd->ranges[dcd->first_range + range];
+	uint32_t channel, i;
+
+	(void)decoder;
+
+	/* each range is passed in order, without gaps, and only inside itself */
+	if(sample_number != dcd->next_sample[dcd->first_range + range] || samples == 0 || sample_number + samples > r->sample_number + r->samples || sample_number + samples > dcd->total_samples) {
+		dcd->bad_range = true;
+		return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+	}
+	for(i = 0; i < samples; i++) {
+		for(channel = 0; channel < dcd->channels; channel++) {
+			if(buffer[channel][i] != dcd->reference[(sample_number + i) * dcd->channels + channel]) {
+				dcd->bad_range = true;
+				return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+			}
+		}
+	}
+	dcd->next_sample[dcd->first_range + range] += samples;
+	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+static void sample_ranges_error_callback_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data)
+{
+	SampleRangesClientData *dcd = (SampleRangesClientData*)client_data;
+	(void)decoder;
+	if(status == FLAC__STREAM_DECODER_ERROR_STATUS_FRAME_CRC_MISMATCH) {
+		dcd->crc_mismatches++;
+		return;
+	}
+	printf("ERROR: got error callback: err = %u (%s)\n", (uint32_t)status, FLAC__StreamDecoderErrorStatusString[status]);
+	dcd->errors++;
+}
+
+static FLAC__bool test_stream_decoder_sample_ranges(void)
+{
+	const char *filename = "sample_ranges.flac";
+	const char *damaged_filename = "sample_ranges_damaged.flac";
+	/* sorted, overlapping, across frame boundaries, empty, running
+	 * past the end and starting past the end */
+	static const FLAC__StreamDecoderSampleRange ranges[] = {
+		{ 5, 10 }, { 100, 5000 }, { 4000, 200 }, { 4100, 0 }, { 20000, 1 },
+		{ 40000, 20000 }, { 64 * 1024, 1000 }, { 70000, 5 }
+	};
+	static const FLAC__StreamDecoderSampleRange unsorted[] = { { 100, 10 }, { 50, 10 } };
+	/* the second range starts past the end, so every frame after the
+	 * first is skipped, the last one included */
+	static const FLAC__StreamDecoderSampleRange skip_to_end[] = { { 5, 10 }, { 70000, 5 } };
+	const uint32_t num_ranges = sizeof(ranges) / sizeof(ranges[0]);
+	InterleavedDecodeResult reference = { FLAC__STREAM_DECODER_PCM_FORMAT_S16LE, 0, 0, 0, 0, 0, 0, 0, false };
+	SampleRangesClientData dcd;
+	FLAC__StreamDecoder *decoder;
+	FLAC__byte *data;
+	FILE *file;
+	size_t bytes;
+	uint32_t i;
+
+	printf("\n+++ libFLAC unit test: FLAC__StreamDecoder (sample ranges)\n\n");
+
+	if(!generate_lpc_file_(filename, /*bps=*/16, /*channels=*/2, /*max_lpc_order=*/8))
+		return false;
+	if(!interleaved_decode_(filename, /*reference=*/true, FLAC__STREAM_DECODER_PCM_FORMAT_S16LE, /*md5_checking=*/true, /*num_threads=*/1, /*seek_to=*/0, &reference))
+		return false;
+
+	memset(&dcd, 0, sizeof(dcd));
+	dcd.reference = (const FLAC__int32*)reference.data;
+	dcd.channels = reference.channels;
+	dcd.total_samples = reference.bytes / sizeof(FLAC__int32) / reference.channels;
+	dcd.ranges = ranges;
+	for(i = 0; i < num_ranges; i++)
+		dcd.next_sample[i] = ranges[i].sample_number;
+
+	if(0 == (decoder = FLAC__stream_decoder_new()))
+		return die_("FLAC__stream_decoder_new() returned NULL");
+	if(FLAC__stream_decoder_init_file(decoder, filename, sample_ranges_write_callback_, /*metadata_callback=*/0, sample_ranges_error_callback_, &dcd) != FLAC__STREAM_DECODER_INIT_STATUS_OK)
+		return die_s_("FLAC__stream_decoder_init_file() failed", decoder);
+
+	printf("testing FLAC__stream_decoder_process_sample_ranges() with unsorted ranges... ");
+	if(FLAC__stream_decoder_process_sample_ranges(decoder, unsorted, 2, sample_ranges_range_write_callback_))
+		return die_s_("FLAC__stream_decoder_process_sample_ranges() accepted unsorted ranges", decoder);
+	printf("OK\n");
+
+	/* in two calls, to check decoding carries on where the first left off */
+	printf("testing FLAC__stream_decoder_process_sample_ranges()... ");
+	if(!FLAC__stream_decoder_process_sample_ranges(decoder, ranges, 5, sample_ranges_range_write_callback_))
+		return die_s_("FLAC__stream_decoder_process_sample_ranges() returned false", decoder);
+	dcd.first_range = 5;
+	if(!FLAC__stream_decoder_process_sample_ranges(decoder, ranges + 5, num_ranges - 5, sample_ranges_range_write_callback_))
+		return die_s_("FLAC__stream_decoder_process_sample_ranges() returned false", decoder);
+	if(dcd.bad_range)
+		return die_("range write callback got the wrong samples");
+	if(dcd.errors > 0 || dcd.crc_mismatches > 0)
+		return die_("got error callbacks decoding a clean stream");
+	for(i = 0; i < num_ranges; i++) {
+		FLAC__uint64 end = ranges[i].sample_number + ranges[i].samples;
+		if(end > dcd.total_samples)
+			end = ranges[i].sample_number < dcd.total_samples? dcd.total_samples : ranges[i].sample_number;
+		if(dcd.next_sample[i] != end) {
+			printf("range %u ended at sample %" PRIu64 " instead of %" PRIu64 "... ", i, dcd.next_sample[i], end);
+			return die_("range was not passed in full");
+		}
+	}
+	if(FLAC__stream_decoder_get_state(decoder) != FLAC__STREAM_DECODER_END_OF_STREAM)
+		return die_s_("decoder is not at the end of the stream", decoder);
+	printf("OK\n");
+
+	printf("testing FLAC__stream_decoder_process_sample_ranges() skipping a damaged last frame... ");
+	FLAC__stream_decoder_finish(decoder);
+	bytes = (size_t)grabbag__file_get_filesize(filename);
+	if(0 == (file = flac_fopen(filename, "rb")))
+		return die_("opening file");
+	if(0 == (data = malloc(bytes)) || fread(data, 1, bytes, file) != bytes) {
+		fclose(file);
+		free(data);
+		return die_("reading file");
+	}
+	fclose(file);
+	/* the frame CRC-16 is the last thing in the stream */
+	data[bytes-1] ^= 0x01;
+	if(!write_damaged_file_(damaged_filename, data, bytes)) {
+		free(data);
+		return false;
+	}
+	free(data);
+	dcd.ranges = skip_to_end;
+	dcd.first_range = 0;
+	for(i = 0; i < 2; i++)
+		dcd.next_sample[i] = skip_to_end[i].sample_number;
+	if(FLAC__stream_decoder_init_file(decoder, damaged_filename, sample_ranges_write_callback_, /*metadata_callback=*/0, sample_ranges_error_callback_, &dcd) != FLAC__STREAM_DECODER_INIT_STATUS_OK)
+		return die_s_("FLAC__stream_decoder_init_file() failed", decoder);
+	if(!FLAC__stream_decoder_process_sample_ranges(decoder, skip_to_end, 2, sample_ranges_range_write_callback_))
+		return die_s_("FLAC__stream_decoder_process_sample_ranges() returned false", decoder);
+	if(dcd.bad_range || dcd.next_sample[0] != skip_to_end[0].sample_number + skip_to_end[0].samples || dcd.next_sample[1] != skip_to_end[1].sample_number)
+		return die_("range was not passed in full");
+	if(dcd.crc_mismatches != 1 || dcd.errors > 0)
+		return die_("damaged last frame was not reported");
+	if(FLAC__stream_decoder_get_state(decoder) != FLAC__STREAM_DECODER_END_OF_STREAM)
+		return die_s_("decoder is not at the end of the stream", decoder);
+	printf("OK\n");
+
+	FLAC__stream_decoder_delete(decoder);
+	free(reference.data);
+	(void) grabbag__file_remove_file(filename);
+	(void) grabbag__file_remove_file(damaged_filename);
+
+	return true;
+}
+
+typedef struct {
+	FLAC__uint32 crc_mismatches;
+	FLAC__uint32 other_errors;
+} ScanClientData;
+
+static FLAC__StreamDecoderWriteStatus scan_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data)
+{
+	(void)decoder, (void)frame, (void)buffer, (void)client_data;
+	/* scanned frames are not decoded */
+	return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+}
+
+static void scan_error_callback_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data)
+{
+	ScanClientData *dcd = (ScanClientData*)client_data;
+	(void)decoder;
+	if(status == FLAC__STREAM_DECODER_ERROR_STATUS_FRAME_CRC_MISMATCH)
+		dcd->crc_mismatches++;
+	else
+		dcd->other_errors++;
+}
+
+/* scans filename to the end, storing the offset of each frame by its
+ * index in the stream, or 0 if the frame was not found */
+static FLAC__bool scan_frames_(const char *filename, FLAC__uint64 offsets[], uint32_t max_frames, uint32_t *frames, ScanClientData *dcd)
+{
+	FLAC__StreamDecoder *decoder;
+	FLAC__FrameHeader header;
+	FLAC__uint64 offset;
+
+	memset(dcd, 0, sizeof(*dcd));
+	memset(offsets, 0, max_frames * sizeof(offsets[0]));
+	*frames = 0;
+
+	if(0 == (decoder = FLAC__stream_decoder_new()))
+		return die_("FLAC__stream_decoder_new() returned NULL");
+	if(FLAC__stream_decoder_init_file(decoder, filename, scan_write_callback_, /*metadata_callback=*/0, scan_error_callback_, dcd) != FLAC__STREAM_DECODER_INIT_STATUS_OK)
+		return die_s_("FLAC__stream_decoder_init_file() failed", decoder);
+	if(FLAC__stream_decoder_scan_single_frame(decoder, &header, &offset))
+		return die_s_("FLAC__stream_decoder_scan_single_frame() did not fail in a metadata state", decoder);
+	if(!FLAC__stream_decoder_process_until_end_of_metadata(decoder))
+		return die_s_("FLAC__stream_decoder_process_until_end_of_metadata() returned false", decoder);
+
+	while(1) {
+		if(!FLAC__stream_decoder_scan_single_frame(decoder, &header, &offset))
+			return die_s_("FLAC__stream_decoder_scan_single_frame() returned false", decoder);
+		if(header.blocksize == 0)
+			break;
+		/* every frame but the short last one holds 4096 samples */
+		if(header.number_type != FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER || header.number.sample_number % 4096 != 0 || header.number.sample_number / 4096 >= max_frames || (header.blocksize != 4096 && header.blocksize != 13))
+			return die_s_("scanned a frame with an unexpected header", decoder);
+		if(offset == 0 || offsets[header.number.sample_number / 4096] != 0)
+			return die_s_("scanned a frame at a bad offset, or twice", decoder);
+		offsets[header.number.sample_number / 4096] = offset;
+		(*frames)++;
+	}
+	if(FLAC__stream_decoder_get_state(decoder) != FLAC__STREAM_DECODER_END_OF_STREAM)
+		return die_s_("decoder is not at the end of the stream", decoder);
+
+	FLAC__stream_decoder_delete(decoder);
+	return true;
+}
+
+static FLAC__bool test_stream_decoder_scan(void)
+{
+	const char *filename = "scan.flac";
+	const char *damaged_filename = "scan_damaged.flac";
+	const uint32_t num_frames = 17, damaged_frame = 10;
+	FLAC__uint64 offsets[17], damaged_offsets[17];
+	ScanClientData dcd;
+	FLAC__byte *data, byte;
+	FILE *file;
+	size_t bytes, i;
+	uint32_t frames;
+
+	printf("\n+++ libFLAC unit test: FLAC__StreamDecoder (frame scan)\n\n");
+
+	if(!generate_lpc_file_(filename, /*bps=*/16, /*channels=*/2, /*max_lpc_order=*/8))
+		return false;
+	bytes = (size_t)grabbag__file_get_filesize(filename);
+	if(0 == (file = flac_fopen(filename, "rb")))
+		return die_("opening file");
+	if(0 == (data = malloc(bytes)) || fread(data, 1, bytes, file) != bytes) {
+		fclose(file);
+		free(data);
+		return die_("reading file");
+	}
+	fclose(file);
+
+	printf("testing FLAC__stream_decoder_scan_single_frame()... ");
+	if(!scan_frames_(filename, offsets, num_frames, &frames, &dcd))
+		return false;
+	if(frames != num_frames || dcd.crc_mismatches > 0 || dcd.other_errors > 0)
+		return die_("did not scan every frame of a clean stream");
+	for(i = 0; i < num_frames; i++) {
+		if(offsets[i] + 2 > bytes || data[offsets[i]] != 0xff || data[offsets[i]+1] >> 1 != 0x7c || (i > 0 && offsets[i] <= offsets[i-1]))
+			return die_("frame offset does not point at a frame sync code");
+	}
+	printf("OK\n");
+
+	printf("testing FLAC__stream_decoder_scan_single_frame() on a damaged frame... ");
+	/* a byte in the subframes that cannot make up a sync code */
+	i = (size_t)(offsets[damaged_frame] + offsets[damaged_frame+1]) / 2;
+	byte = data[i];
+	data[i] = byte == 0? 1 : 0;
+	if(!write_damaged_file_(damaged_filename, data, bytes)) {
+		free(data);
+		return false;
+	}
+	data[i] = byte;
+	if(!scan_frames_(damaged_filename, damaged_offsets, num_frames, &frames, &dcd)) {
+		free(data);
+		return false;
+	}
+	if(frames != num_frames - 1 || damaged_offsets[damaged_frame] != 0 || dcd.crc_mismatches == 0) {
+		free(data);
+		return die_("damaged frame was not reported and passed over");
+	}
+	for(i = 0; i < num_frames; i++) {
+		if(i != damaged_frame && damaged_offsets[i] != offsets[i]) {
+			free(data);
+			return die_("frames after the damaged one were not scanned");
+		}
+	}
+	printf("OK\n");
+
+	printf("testing FLAC__stream_decoder_scan_single_frame() on a damaged last frame... ");
+	/* no sync code follows the last frame, so only its CRC-16 tells */
+	i = (size_t)(offsets[num_frames-1] + bytes) / 2;
+	data[i] = data[i] == 0? 1 : 0;
+	if(!write_damaged_file_(damaged_filename, data, bytes)) {
+		free(data);
+		return false;
+	}
+	free(data);
+	if(!scan_frames_(damaged_filename, damaged_offsets, num_frames, &frames, &dcd))
+		return false;
+	if(frames != num_frames - 1 || damaged_offsets[num_frames-1] != 0 || dcd.crc_mismatches != 1 || dcd.other_errors > 0)
+		return die_("damaged last frame was not reported");
+	printf("OK\n");
+
+	(void) grabbag__file_remove_file(filename);
+	(void) grabbag__file_remove_file(damaged_filename);
+
+	return true;
+}
+
+static FLAC__StreamDecoderWriteStatus verify_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data)
+{
+	(void)decoder, (void)frame, (void)buffer, (void)client_data;
+	/* verified frames are not written */
+	return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+}
+
+static FLAC__StreamDecoderWriteStatus verify_interleaved_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const void *buffer, size_t bytes, void *client_data)
+{
+	(void)decoder, (void)frame, (void)buffer, (void)bytes, (void)client_data;
+	return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+}
+
+static void verify_error_callback_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data)
+{
+	uint32_t *errors = (uint32_t*)client_data;
+	(void)decoder, (void)status;
+	(*errors)++;
+}
+
+/* verifies filename to the end and returns what FLAC__stream_decoder_finish() does */
+static FLAC__bool verify_frames_(const char *filename, FLAC__bool interleaved, FLAC__bool *md5_ok, FLAC__uint64 *samples, uint32_t *errors)
+{
+	FLAC__StreamDecoder *decoder;
+	FLAC__FrameHeader header;
+
+	*samples = 0;
+	*errors = 0;
+
+	if(0 == (decoder = FLAC__stream_decoder_new()))
+		return die_("FLAC__stream_decoder_new() returned NULL");
+	if(!FLAC__stream_decoder_set_md5_checking(decoder, true))
+		return die_s_("FLAC__stream_decoder_set_md5_checking() returned false", decoder);
+	if(interleaved && !FLAC__stream_decoder_set_interleaved_output(decoder, FLAC__STREAM_DECODER_PCM_FORMAT_S16LE, verify_interleaved_write_callback_))
+		return die_s_("FLAC__stream_decoder_set_interleaved_output() returned false", decoder);
+	if(FLAC__stream_decoder_init_file(decoder, filename, verify_write_callback_, /*metadata_callback=*/0, verify_error_callback_, errors) != FLAC__STREAM_DECODER_INIT_STATUS_OK)
+		return die_s_("FLAC__stream_decoder_init_file() failed", decoder);
+	if(FLAC__stream_decoder_verify_single_frame(decoder, &header))
+		return die_s_("FLAC__stream_decoder_verify_single_frame() did not fail in a metadata state", decoder);
+	if(!FLAC__stream_decoder_process_until_end_of_metadata(decoder))
+		return die_s_("FLAC__stream_decoder_process_until_end_of_metadata() returned false", decoder);
+
+	while(1) {
+		if(!FLAC__stream_decoder_verify_single_frame(decoder, &header))
+			return die_s_("FLAC__stream_decoder_verify_single_frame() returned false", decoder);
+		if(header.blocksize == 0)
+			break;
+		if(header.number_type != FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER || header.number.sample_number != *samples)
+			return die_s_("verified a frame with an unexpected header", decoder);
+		*samples += header.blocksize;
+	}
+	if(FLAC__stream_decoder_get_state(decoder) != FLAC__STREAM_DECODER_END_OF_STREAM)
+		return die_s_("decoder is not at the end of the stream", decoder);
+
+	*md5_ok = FLAC__stream_decoder_finish(decoder);
+	FLAC__stream_decoder_delete(decoder);
+	return true;
+}
+
+static FLAC__bool test_stream_decoder_verify(void)
+{
+	const char *filename = "verify.flac";
+	const char *damaged_filename = "verify_damaged.flac";
+	/* "fLaC", the metadata block header and STREAMINFO up to the MD5 sum */
+	const size_t md5_offset = 4 + 4 + 18;
+	const FLAC__uint64 total_samples = 64 * 1024 + 13;
+	FLAC__bool md5_ok;
+	FLAC__uint64 samples;
+	FLAC__byte *data;
+	FILE *file;
+	size_t bytes;
+	uint32_t errors;
+
+	printf("\n+++ libFLAC unit test: FLAC__StreamDecoder (verify)\n\n");
+
+	if(!generate_lpc_file_(filename, /*bps=*/16, /*channels=*/2, /*max_lpc_order=*/8))
+		return false;
+
+	printf("testing FLAC__stream_decoder_verify_single_frame()... ");
+	if(!verify_frames_(filename, /*interleaved=*/false, &md5_ok, &samples, &errors))
+		return false;
+	if(samples != total_samples || errors > 0 || !md5_ok)
+		return die_("did not verify every sample of a clean stream");
+	printf("OK\n");
+
+	printf("testing FLAC__stream_decoder_verify_single_frame() with interleaved output set... ");
+	if(!verify_frames_(filename, /*interleaved=*/true, &md5_ok, &samples, &errors))
+		return false;
+	if(samples != total_samples || errors > 0 || !md5_ok)
+		return die_("did not verify every sample of a clean stream");
+	printf("OK\n");
+
+	printf("testing FLAC__stream_decoder_verify_single_frame() against a wrong MD5 sum... ");
+	bytes = (size_t)grabbag__file_get_filesize(filename);
+	if(0 == (file = flac_fopen(filename, "rb")))
+		return die_("opening file");
+	if(0 == (data = malloc(bytes)) || fread(data, 1, bytes, file) != bytes) {
+		fclose(file);
+		free(data);
+		return die_("reading file");
+	}
+	fclose(file);
+	data[md5_offset] ^= 0x01;
+	if(0 == (file = flac_fopen(damaged_filename, "wb")) || fwrite(data, 1, bytes, file) != bytes) {
+		if(file)
+			fclose(file);
+		free(data);
+		return die_("writing damaged file");
+	}
+	fclose(file);
+	free(data);
+	if(!verify_frames_(damaged_filename, /*interleaved=*/false, &md5_ok, &samples, &errors))
+		return false;
+	if(samples != total_samples || errors > 0 || md5_ok)
+		return die_("MD5 sum mismatch was not reported");
+	printf("OK\n");
+
+	(void) grabbag__file_remove_file(filename);
+	(void) grabbag__file_remove_file(damaged_filename);
+
+	return true;
+}
+
 FLAC__bool test_decoders(void)
 {
 	FLAC__bool is_ogg = false;
@@ -1459,6 +2744,30 @@ FLAC__bool test_decoders(void)
 		if(!test_stream_decoder(LAYER_FILENAME, is_ogg, is_chained_ogg))
 			return false;
 
+		if(!test_stream_decoder(LAYER_MEMORY, is_ogg, is_chained_ogg))
+			return false;
+
+		if(!is_ogg && !test_stream_decoder_threads())
+			return false;
+
+		if(!is_ogg && !test_stream_decoder_fused_lpc_restore())
+			return false;
+
+		if(!is_ogg && !test_stream_decoder_interleaved())
+			return false;
+
+		if(!is_ogg && !test_stream_decoder_seek_index())
+			return false;
+
+		if(!is_ogg && !test_stream_decoder_sample_ranges())
+			return false;
+
+		if(!is_ogg && !test_stream_decoder_scan())
+			return false;
+
+		if(!is_ogg && !test_stream_decoder_verify())
+			return false;
+
 		(void) grabbag__file_remove_file(flacfilename(is_ogg, is_chained_ogg));
 
 		free_metadata_blocks_();
@@ -22,14 +22,17 @@
 #endif
 
 #include <errno.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "encoders.h"
 #include "FLAC/assert.h"
 #include "FLAC/stream_encoder.h"
+#include "protected/stream_encoder.h" /* from the libFLAC private include area */
 #include "share/grabbag.h"
 #include "share/compat.h"
+#include "share/private.h"
 #include "test_libs_common/file_utils_flac.h"
 #include "test_libs_common/metadata_utils.h"
 
@@ -250,6 +253,11 @@ static FLAC__bool test_stream_encoder(Layer layer, FLAC__bool is_ogg)
 		return die_s_("returned false", encoder);
 	printf("OK\n");
 
+	printf("testing FLAC__stream_encoder_set_prune_lpc_orders()... ");
+	if(!FLAC__stream_encoder_set_prune_lpc_orders(encoder, true))
+		return die_s_("returned false", encoder);
+	printf("OK\n");
+
 	printf("testing FLAC__stream_encoder_set_min_residual_partition_order()... ");
 	if(!FLAC__stream_encoder_set_min_residual_partition_order(encoder, 0))
 		return die_s_("returned false", encoder);
@@ -280,6 +288,16 @@ static FLAC__bool test_stream_encoder(Layer layer, FLAC__bool is_ogg)
 		return die_s_("returned false", encoder);
 	printf("OK\n");
 
+	printf("testing FLAC__stream_encoder_set_intra_frame_threading()... ");
+	if(!FLAC__stream_encoder_set_intra_frame_threading(encoder, true))
+		return die_s_("returned false", encoder);
+	printf("OK\n");
+
+	printf("testing FLAC__stream_encoder_set_thread_pool()... ");
+	if(!FLAC__stream_encoder_set_thread_pool(encoder, 0))
+		return die_s_("returned false", encoder);
+	printf("OK\n");
+
 	if(layer < LAYER_FILENAME) {
 		printf("opening file for FLAC output... ");
 		file = flac_fopen(flacfilename(is_ogg), "w+b");
@@ -433,6 +451,13 @@ static FLAC__bool test_stream_encoder(Layer layer, FLAC__bool is_ogg)
 	}
 	printf("OK\n");
 
+	printf("testing FLAC__stream_encoder_get_prune_lpc_orders()... ");
+	if(FLAC__stream_encoder_get_prune_lpc_orders(encoder) != true) {
+		printf("FAILED, expected true, got false\n");
+		return false;
+	}
+	printf("OK\n");
+
 	printf("testing FLAC__stream_encoder_get_min_residual_partition_order()... ");
 	if(FLAC__stream_encoder_get_min_residual_partition_order(encoder) != 0) {
 		printf("FAILED, expected %d, got %u\n", 0, FLAC__stream_encoder_get_min_residual_partition_order(encoder));
@@ -467,6 +492,20 @@ static FLAC__bool test_stream_encoder(Layer layer, FLAC__bool is_ogg)
 		return false;
 	}
 
+	printf("testing FLAC__stream_encoder_get_intra_frame_threading()... ");
+	if(FLAC__stream_encoder_get_intra_frame_threading(encoder) != true) {
+		printf("FAILED, expected true, got false\n");
+		return false;
+	}
+	printf("OK\n");
+
+	printf("testing FLAC__stream_encoder_get_thread_pool()... ");
+	if(FLAC__stream_encoder_get_thread_pool(encoder) != 0) {
+		printf("FAILED, expected NULL\n");
+		return false;
+	}
+	printf("OK\n");
+
 	/* init the dummy sample buffer */
 	for(i = 0; i < sizeof(samples) / sizeof(FLAC__int32); i++)
 		samples[i] = i & 7;
@@ -498,6 +537,534 @@ static FLAC__bool test_stream_encoder(Layer layer, FLAC__bool is_ogg)
 	return true;
 }
 
+typedef struct {
+	FLAC__byte *data;
+	size_t bytes, capacity;
+} EncodedStream;
+
+static FLAC__StreamEncoderWriteStatus memory_write_callback_(const FLAC__StreamEncoder *encoder, const FLAC__byte buffer[], size_t bytes, uint32_t samples, uint32_t current_frame, void *client_data)
+{
+	EncodedStream *stream = (EncodedStream*)client_data;
+	(void)encoder, (void)samples, (void)current_frame;
+	if(stream->bytes + bytes > stream->capacity) {
+		FLAC__byte *data = realloc(stream->data, (stream->bytes + bytes) * 2);
+		if(0 == data)
+			return FLAC__STREAM_ENCODER_WRITE_STATUS_FATAL_ERROR;
+		stream->data = data;
+		stream->capacity = (stream->bytes + bytes) * 2;
+	}
+	memcpy(stream->data + stream->bytes, buffer, bytes);
+	stream->bytes += bytes;
+	return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+}
+
+static FLAC__StreamEncoder *new_verified_encoder_(uint32_t channels, uint32_t num_threads, FLAC__bool intra_frame_threading, FLAC__ThreadPool *pool, EncodedStream *stream)
+{
+	FLAC__StreamEncoder *encoder;
+	FLAC__bool ok;
+
+	memset(stream, 0, sizeof(*stream));
+	if(0 == (encoder = FLAC__stream_encoder_new())) {
+		die_("FLAC__stream_encoder_new() returned NULL");
+		return 0;
+	}
+	ok = FLAC__stream_encoder_set_verify(encoder, true);
+	ok &= FLAC__stream_encoder_set_channels(encoder, channels);
+	ok &= FLAC__stream_encoder_set_bits_per_sample(encoder, 16);
+	ok &= FLAC__stream_encoder_set_sample_rate(encoder, 44100);
+	ok &= FLAC__stream_encoder_set_compression_level(encoder, 5);
+	ok &= FLAC__stream_encoder_set_limit_min_bitrate(encoder, true);
+	ok &= FLAC__stream_encoder_set_intra_frame_threading(encoder, intra_frame_threading);
+	ok &= FLAC__stream_encoder_set_thread_pool(encoder, pool);
+	if(!ok) {
+		die_s_("setting up the encoder", encoder);
+		return 0;
+	}
+	if(FLAC__stream_encoder_set_num_threads(encoder, num_threads) != FLAC__STREAM_ENCODER_SET_NUM_THREADS_OK) {
+		die_s_("FLAC__stream_encoder_set_num_threads() failed", encoder);
+		return 0;
+	}
+	if(FLAC__stream_encoder_init_stream(encoder, memory_write_callback_, /*seek_callback=*/0, /*tell_callback=*/0, /*metadata_callback=*/0, stream) != FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
+		die_s_("FLAC__stream_encoder_init_stream() failed", encoder);
+		return 0;
+	}
+	return encoder;
+}
+
+/* fills samples with one block of a stream of 40 frames plus a short one,
+ * every third frame having wasted bits and every fifth one being silent.
+ * Channels past the first two are silent in every other frame. Returns the
+ * blocksize */
+static uint32_t fill_verified_block_(uint32_t channels, uint32_t block, FLAC__int32 *samples, FLAC__uint32 *noise)
+{
+	const uint32_t blocksize = block < 40? 4096 : 1000;
+	const uint32_t shift = block % 3 == 0? 3 : 0;
+	uint32_t i, c;
+
+	for(i = 0; i < blocksize; i++) {
+		const FLAC__int32 t = (FLAC__int32)(block * 4096 + i);
+		for(c = 0; c < channels; c++) {
+			*noise = *noise * 1103515245 + 12345;
+			if(block % 5 == 2 || (c >= 2 && block % 2 == 1))
+				samples[channels*i+c] = 0;
+			else
+				samples[channels*i+c] = ((((t * (7 + 2 * (FLAC__int32)c)) % 400 - 200) * 20 + (FLAC__int32)(*noise >> 24) - 128) >> shift) * (1 << shift);
+		}
+	}
+	return blocksize;
+}
+
+/* encodes one block of the stream of fill_verified_block_() */
+static FLAC__bool encode_verified_block_(FLAC__StreamEncoder *encoder, uint32_t channels, uint32_t block, FLAC__int32 *samples, FLAC__uint32 *noise)
+{
+	const uint32_t blocksize = fill_verified_block_(channels, block, samples, noise);
+
+	if(!FLAC__stream_encoder_process_interleaved(encoder, samples, blocksize))
+		return die_s_("FLAC__stream_encoder_process_interleaved() returned false", encoder);
+	return true;
+}
+
+/* encodes the whole stream of encode_verified_block_() with verify on */
+static FLAC__bool encode_verified_(uint32_t channels, uint32_t num_threads, FLAC__bool intra_frame_threading, EncodedStream *stream)
+{
+	FLAC__StreamEncoder *encoder;
+	FLAC__int32 *samples;
+	FLAC__uint32 noise = 1;
+	uint32_t block;
+
+	if(0 == (samples = malloc(sizeof(FLAC__int32) * channels * 4096)))
+		return die_("out of memory");
+	if(0 == (encoder = new_verified_encoder_(channels, num_threads, intra_frame_threading, /*pool=*/0, stream)))
+		return false;
+	for(block = 0; block < 41; block++)
+		if(!encode_verified_block_(encoder, channels, block, samples, &noise))
+			return false;
+	if(!FLAC__stream_encoder_finish(encoder))
+		return die_s_("FLAC__stream_encoder_finish() returned false", encoder);
+	FLAC__stream_encoder_delete(encoder);
+	free(samples);
+	return true;
+}
+
+/* checks that encoding with threads gives the same stream as without */
+static FLAC__bool test_threads_(uint32_t channels, uint32_t num_threads, FLAC__bool intra_frame_threading)
+{
+	EncodedStream single, threaded;
+
+	printf("testing %u channels with %u threads%s... ", channels, num_threads, intra_frame_threading? " within frames" : "");
+	if(!encode_verified_(channels, 1, false, &single))
+		return false;
+	if(!encode_verified_(channels, num_threads, intra_frame_threading, &threaded))
+		return false;
+	if(threaded.bytes != single.bytes || memcmp(threaded.data, single.data, single.bytes))
+		return die_("encoding with threads gave a different stream");
+	printf("OK\n");
+
+	free(single.data);
+	free(threaded.data);
+	return true;
+}
+
+/* checks that encoders sharing a pool with fewer threads than they ask for,
+ * fed one block at a time in turn, give the same streams as without threads */
+static FLAC__bool test_thread_pool_(void)
+{
+	static const uint32_t channels[] = { 2, 2, 6 }, num_threads[] = { 4, 4, 3 };
+	static const FLAC__bool intra_frame_threading[] = { false, true, false };
+	FLAC__StreamEncoder *encoder[3];
+	FLAC__int32 *samples[3];
+	FLAC__uint32 noise[3];
+	EncodedStream single, pooled[3];
+	FLAC__ThreadPool *pool;
+	uint32_t e, block;
+
+	printf("testing FLAC__thread_pool_new()... ");
+	if(0 != FLAC__thread_pool_new(0))
+		return die_("accepted a pool without threads");
+	if(0 != FLAC__thread_pool_new(FLAC__THREAD_POOL_MAX_THREADS + 1))
+		return die_("accepted too many threads");
+	if(0 == (pool = FLAC__thread_pool_new(2)))
+		return die_("FLAC__thread_pool_new() returned NULL");
+	if(FLAC__thread_pool_get_num_threads(pool) != 2)
+		return die_("FLAC__thread_pool_get_num_threads() returned the wrong value");
+	printf("OK\n");
+
+	printf("testing 3 encoders sharing a pool of 2 threads... ");
+	for(e = 0; e < 3; e++) {
+		noise[e] = 1;
+		if(0 == (samples[e] = malloc(sizeof(FLAC__int32) * channels[e] * 4096)))
+			return die_("out of memory");
+		if(0 == (encoder[e] = new_verified_encoder_(channels[e], num_threads[e], intra_frame_threading[e], pool, &pooled[e])))
+			return false;
+		if(FLAC__stream_encoder_get_thread_pool(encoder[e]) != pool)
+			return die_s_("FLAC__stream_encoder_get_thread_pool() returned the wrong pool", encoder[e]);
+		if(FLAC__stream_encoder_set_thread_pool(encoder[e], 0))
+			return die_s_("FLAC__stream_encoder_set_thread_pool() did not fail on an initialized encoder", encoder[e]);
+	}
+	for(block = 0; block < 41; block++)
+		for(e = 0; e < 3; e++)
+			if(!encode_verified_block_(encoder[e], channels[e], block, samples[e], &noise[e]))
+				return false;
+	for(e = 0; e < 3; e++) {
+		if(!FLAC__stream_encoder_finish(encoder[e]))
+			return die_s_("FLAC__stream_encoder_finish() returned false", encoder[e]);
+		FLAC__stream_encoder_delete(encoder[e]);
+		free(samples[e]);
+	}
+	FLAC__thread_pool_delete(pool);
+	for(e = 0; e < 3; e++) {
+		if(!encode_verified_(channels[e], 1, false, &single))
+			return false;
+		if(pooled[e].bytes != single.bytes || memcmp(pooled[e].data, single.data, single.bytes))
+			return die_("encoding with a thread pool gave a different stream");
+		free(single.data);
+		free(pooled[e].data);
+	}
+	printf("OK\n");
+
+	return true;
+}
+
+static FLAC__bool test_stream_encoder_window_cache(void)
+{
+	EncodedStream first, second;
+	FLAC__uint64 hits[3], misses[3];
+
+	printf("\n+++ libFLAC unit test: FLAC__StreamEncoder (window cache)\n\n");
+
+	printf("testing FLAC__stream_encoder_get_window_cache_statistics()... ");
+	FLAC__stream_encoder_get_window_cache_statistics(0, 0);
+	FLAC__stream_encoder_get_window_cache_statistics(&hits[0], &misses[0]);
+	if(!encode_verified_(2, 1, false, &first))
+		return false;
+	FLAC__stream_encoder_get_window_cache_statistics(&hits[1], &misses[1]);
+	if(!encode_verified_(2, 1, false, &second))
+		return false;
+	FLAC__stream_encoder_get_window_cache_statistics(&hits[2], &misses[2]);
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+	/* compression level 5 uses a single tukey window, for blocksizes 4096 and 1000 */
+	if(hits[1] + misses[1] < hits[0] + misses[0] + 2)
+		return die_("encoding did not look up its windows in the cache");
+	if(misses[2] != misses[1])
+		return die_("encoding again with the same settings calculated windows again");
+	if(hits[2] < hits[1] + 2)
+		return die_("encoding again with the same settings did not find its windows in the cache");
+#endif
+	if(second.bytes != first.bytes || memcmp(second.data, first.data, first.bytes))
+		return die_("encoding with cached windows gave a different stream");
+	printf("OK\n");
+
+	free(first.data);
+	free(second.data);
+	return true;
+}
+
+/* applies the settings a test compares to an encoder, returns false if a
+ * setter fails */
+typedef FLAC__bool (*EncoderSettingsCallback)(FLAC__StreamEncoder *encoder, const void *settings);
+
+/* fills samples with block number block of a stereo test signal, returns
+ * the blocksize, or 0 past the end of the signal */
+typedef uint32_t (*EncoderSignalCallback)(uint32_t block, FLAC__int32 *samples, void *state);
+
+/* encodes a stereo test signal with verify on, after the settings callback
+ * has set up the encoder. Frees everything it allocated on every path, the
+ * stream data is only left for the caller to free on success */
+static FLAC__bool encode_with_settings_(EncoderSettingsCallback settings_callback, const void *settings, EncoderSignalCallback signal_callback, void *signal_state, EncodedStream *stream)
+{
+	FLAC__StreamEncoder *encoder = 0;
+	FLAC__int32 *samples;
+	uint32_t block, blocksize = 0;
+	FLAC__bool ok = false;
+
+	memset(stream, 0, sizeof(*stream));
+	if(0 == (samples = malloc(sizeof(FLAC__int32) * 2 * 4096)))
+		die_("out of memory");
+	else if(0 == (encoder = FLAC__stream_encoder_new()))
+		die_("FLAC__stream_encoder_new() returned NULL");
+	else if(
+		!FLAC__stream_encoder_set_verify(encoder, true) ||
+		!FLAC__stream_encoder_set_channels(encoder, 2) ||
+		!FLAC__stream_encoder_set_streamable_subset(encoder, false) ||
+		!settings_callback(encoder, settings)
+	)
+		die_s_("setting up the encoder", encoder);
+	else if(FLAC__stream_encoder_init_stream(encoder, memory_write_callback_, /*seek_callback=*/0, /*tell_callback=*/0, /*metadata_callback=*/0, stream) != FLAC__STREAM_ENCODER_INIT_STATUS_OK)
+		die_s_("FLAC__stream_encoder_init_stream() failed", encoder);
+	else {
+		for(block = 0; 0 != (blocksize = signal_callback(block, samples, signal_state)); block++)
+			if(!FLAC__stream_encoder_process_interleaved(encoder, samples, blocksize))
+				break;
+		if(blocksize != 0)
+			die_s_("FLAC__stream_encoder_process_interleaved() returned false", encoder);
+		else if(!FLAC__stream_encoder_finish(encoder))
+			die_s_("FLAC__stream_encoder_finish() returned false", encoder);
+		else
+			ok = true;
+	}
+	if(0 != encoder)
+		FLAC__stream_encoder_delete(encoder);
+	free(samples);
+	if(!ok) {
+		free(stream->data);
+		memset(stream, 0, sizeof(*stream));
+	}
+	return ok;
+}
+
+/* the stream of fill_verified_block_(), state is the noise generator */
+static uint32_t verified_signal_(uint32_t block, FLAC__int32 *samples, void *state)
+{
+	return block < 41? fill_verified_block_(2, block, samples, (FLAC__uint32*)state) : 0;
+}
+
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+typedef struct {
+	uint32_t max_lpc_order;
+	const char *apodization;
+	FLAC__bool disable_fused_window_autocorrelation;
+} FusedWindowAutocorrelationSettings;
+
+static FLAC__bool fused_window_autocorrelation_settings_(FLAC__StreamEncoder *encoder, const void *settings)
+{
+	const FusedWindowAutocorrelationSettings *s = (const FusedWindowAutocorrelationSettings*)settings;
+
+	return
+		FLAC__stream_encoder_set_compression_level(encoder, 8) &&
+		FLAC__stream_encoder_set_max_lpc_order(encoder, s->max_lpc_order) &&
+		FLAC__stream_encoder_set_apodization(encoder, s->apodization) &&
+		FLAC__stream_encoder_disable_fused_window_autocorrelation(encoder, s->disable_fused_window_autocorrelation);
+}
+
+static FLAC__bool test_stream_encoder_fused_window_autocorrelation(void)
+{
+	/* more windows and more parts than FLAC__lpc_compute_autocorrelation_windowed() takes at once */
+	static const char * const apodizations[] = {
+		"subdivide_tukey(3)",
+		"tukey(5e-1);partial_tukey(2);punchout_tukey(3);hann;welch;bartlett;blackman;gauss(0.3);flattop",
+		"subdivide_tukey(10);welch"
+	};
+	static const uint32_t max_lpc_orders[] = { 6, 12, 32 };
+	FusedWindowAutocorrelationSettings settings;
+	EncodedStream two_passes, fused;
+	FLAC__uint32 noise;
+	uint32_t i, j;
+
+	printf("\n+++ libFLAC unit test: FLAC__StreamEncoder (windowing inside the autocorrelation)\n\n");
+
+	for(i = 0; i < sizeof(apodizations) / sizeof(apodizations[0]); i++) {
+		for(j = 0; j < sizeof(max_lpc_orders) / sizeof(max_lpc_orders[0]); j++) {
+			printf("testing against windowing first, apodization=%s max_lpc_order=%u... ", apodizations[i], max_lpc_orders[j]);
+			/* the encoder only windows inside the autocorrelation routine when
+			 * the result matches that of the autocorrelation routine it picks */
+			settings.max_lpc_order = max_lpc_orders[j];
+			settings.apodization = apodizations[i];
+			settings.disable_fused_window_autocorrelation = true;
+			noise = 1;
+			if(!encode_with_settings_(fused_window_autocorrelation_settings_, &settings, verified_signal_, &noise, &two_passes))
+				return false;
+			settings.disable_fused_window_autocorrelation = false;
+			noise = 1;
+			if(!encode_with_settings_(fused_window_autocorrelation_settings_, &settings, verified_signal_, &noise, &fused))
+				return false;
+			if(fused.bytes != two_passes.bytes || memcmp(fused.data, two_passes.data, two_passes.bytes))
+				return die_("encoded streams differ");
+			printf("OK\n");
+			free(two_passes.data);
+			free(fused.data);
+		}
+	}
+
+	return true;
+}
+
+typedef struct {
+	uint32_t max_lpc_order;
+	FLAC__bool do_qlp_coeff_prec_search;
+	FLAC__bool prune_lpc_orders;
+} LpcOrderPruningSettings;
+
+static FLAC__bool lpc_order_pruning_settings_(FLAC__StreamEncoder *encoder, const void *settings)
+{
+	const LpcOrderPruningSettings *s = (const LpcOrderPruningSettings*)settings;
+
+	return
+		FLAC__stream_encoder_set_compression_level(encoder, 8) &&
+		FLAC__stream_encoder_set_max_lpc_order(encoder, s->max_lpc_order) &&
+		FLAC__stream_encoder_set_do_exhaustive_model_search(encoder, true) &&
+		FLAC__stream_encoder_set_prune_lpc_orders(encoder, s->prune_lpc_orders) &&
+		FLAC__stream_encoder_set_do_qlp_coeff_prec_search(encoder, s->do_qlp_coeff_prec_search);
+}
+
+typedef struct {
+	FLAC__uint32 noise;
+	double state[2][2][2];
+} ResonatorSignalState;
+
+/* noise through two resonators, which LPC predicts well, 20 blocks long */
+static uint32_t resonator_signal_(uint32_t block, FLAC__int32 *samples, void *state)
+{
+	ResonatorSignalState *s = (ResonatorSignalState*)state;
+	uint32_t i, c, r;
+
+	if(block >= 20)
+		return 0;
+	for(i = 0; i < 4096; i++) {
+		for(c = 0; c < 2; c++) {
+			double x, y = 0.0;
+			s->noise = s->noise * 1103515245 + 12345;
+			x = (double)(FLAC__int32)(s->noise >> 16 & 0xff) - 128.0;
+			for(r = 0; r < 2; r++) {
+				/* poles at radius 0.999 and 0.995, moving with the block number */
+				static const double radius[2] = { 0.999, 0.995 };
+				const double angle = 0.05 + 0.3 * r + 0.01 * (block % 7) + 0.02 * c;
+				const double v = x + 2.0 * radius[r] * cos(angle) * s->state[c][r][0] - radius[r] * radius[r] * s->state[c][r][1];
+				s->state[c][r][1] = s->state[c][r][0];
+				s->state[c][r][0] = v;
+				y += v;
+			}
+			samples[2*i+c] = (FLAC__int32)(y * 0.25); /* stays within 16 bits */
+		}
+	}
+	return 4096;
+}
+
+static FLAC__bool test_stream_encoder_lpc_order_pruning(void)
+{
+	static const uint32_t max_lpc_orders[] = { 8, 12, 32 };
+	LpcOrderPruningSettings settings;
+	ResonatorSignalState signal;
+	EncodedStream pruned, all_orders;
+	uint32_t i, do_qlp_coeff_prec_search;
+
+	printf("\n+++ libFLAC unit test: FLAC__StreamEncoder (LPC order pruning)\n\n");
+
+	for(i = 0; i < sizeof(max_lpc_orders) / sizeof(max_lpc_orders[0]); i++) {
+		for(do_qlp_coeff_prec_search = 0; do_qlp_coeff_prec_search <= 1; do_qlp_coeff_prec_search++) {
+			printf("testing against trying all orders, max_lpc_order=%u do_qlp_coeff_prec_search=%u... ", max_lpc_orders[i], do_qlp_coeff_prec_search);
+			settings.max_lpc_order = max_lpc_orders[i];
+			settings.do_qlp_coeff_prec_search = do_qlp_coeff_prec_search;
+			settings.prune_lpc_orders = false;
+			memset(&signal, 0, sizeof(signal));
+			signal.noise = 1;
+			if(!encode_with_settings_(lpc_order_pruning_settings_, &settings, resonator_signal_, &signal, &all_orders))
+				return false;
+			settings.prune_lpc_orders = true;
+			memset(&signal, 0, sizeof(signal));
+			signal.noise = 1;
+			if(!encode_with_settings_(lpc_order_pruning_settings_, &settings, resonator_signal_, &signal, &pruned))
+				return false;
+			/* skipping orders may cost a little compression, but not much */
+			if(pruned.bytes > all_orders.bytes + all_orders.bytes / 1000)
+				return die_("skipping LPC orders made the stream more than 0.1% larger");
+			printf("OK (%u vs %u bytes)\n", (uint32_t)pruned.bytes, (uint32_t)all_orders.bytes);
+			free(pruned.data);
+			free(all_orders.data);
+		}
+	}
+
+	return true;
+}
+#endif
+
+typedef struct {
+	FLAC__bool disable_simd;
+	uint32_t max_residual_partition_order;
+} PartitionSimdSettings;
+
+/* fixed predictors only, so that the result does not depend on
+ * floating-point routines */
+static FLAC__bool partition_simd_settings_(FLAC__StreamEncoder *encoder, const void *settings)
+{
+	const PartitionSimdSettings *s = (const PartitionSimdSettings*)settings;
+
+	return
+		FLAC__stream_encoder_set_max_lpc_order(encoder, 0) &&
+		FLAC__stream_encoder_set_min_residual_partition_order(encoder, 0) &&
+		FLAC__stream_encoder_set_max_residual_partition_order(encoder, s->max_residual_partition_order) &&
+		FLAC__stream_encoder_disable_instruction_set(encoder, s->disable_simd ? 0x7f : 0);
+}
+
+/* the stream of fill_verified_block_(), followed by uniform noise of varying
+ * width, which needs large Rice parameters */
+static uint32_t partition_simd_signal_(uint32_t block, FLAC__int32 *samples, void *state)
+{
+	FLAC__uint32 *noise = (FLAC__uint32*)state;
+	uint32_t i;
+
+	if(block < 41)
+		return fill_verified_block_(2, block, samples, noise);
+	if(block >= 45)
+		return 0;
+	block -= 41;
+	for(i = 0; i < 2 * 4096; i++) {
+		*noise = *noise * 1103515245 + 12345;
+		samples[i] = (FLAC__int32)(*noise >> (16 + (i / 512 + block) % 8)) - (FLAC__int32)(1u << (15 - (i / 512 + block) % 8));
+	}
+	return 4096;
+}
+
+static FLAC__bool test_stream_encoder_partition_simd(void)
+{
+	static const uint32_t max_residual_partition_orders[] = { 2, 6, 8, 12 };
+	PartitionSimdSettings settings;
+	EncodedStream plain, simd;
+	FLAC__uint32 noise;
+	uint32_t i;
+
+	printf("\n+++ libFLAC unit test: FLAC__StreamEncoder (SIMD residual partitioning)\n\n");
+
+	for(i = 0; i < sizeof(max_residual_partition_orders) / sizeof(max_residual_partition_orders[0]); i++) {
+		printf("testing against the C routines, max_residual_partition_order=%u... ", max_residual_partition_orders[i]);
+		settings.max_residual_partition_order = max_residual_partition_orders[i];
+		settings.disable_simd = true;
+		noise = 1;
+		if(!encode_with_settings_(partition_simd_settings_, &settings, partition_simd_signal_, &noise, &plain))
+			return false;
+		settings.disable_simd = false;
+		noise = 1;
+		if(!encode_with_settings_(partition_simd_settings_, &settings, partition_simd_signal_, &noise, &simd))
+			return false;
+		if(simd.bytes != plain.bytes || memcmp(simd.data, plain.data, plain.bytes))
+			return die_("encoded streams differ");
+		printf("OK\n");
+		free(plain.data);
+		free(simd.data);
+	}
+
+	return true;
+}
+
+static FLAC__bool test_stream_encoder_threads(void)
+{
+	FLAC__StreamEncoder *encoder;
+	uint32_t status;
+
+	printf("\n+++ libFLAC unit test: FLAC__StreamEncoder (threads, with verify)\n\n");
+
+	if(0 == (encoder = FLAC__stream_encoder_new()))
+		return die_("FLAC__stream_encoder_new() returned NULL");
+	status = FLAC__stream_encoder_set_num_threads(encoder, 4);
+	FLAC__stream_encoder_delete(encoder);
+	if(status == FLAC__STREAM_ENCODER_SET_NUM_THREADS_NOT_COMPILED_WITH_MULTITHREADING_ENABLED) {
+		printf("not compiled with multithreading, skipped\n");
+		return true;
+	}
+
+	if(!test_threads_(2, 4, false))
+		return false;
+	if(!test_threads_(2, 4, true))
+		return false;
+	if(!test_threads_(6, 3, true))
+		return false;
+	if(!test_threads_(1, 2, true))
+		return false;
+	if(!test_thread_pool_())
+		return false;
+
+	return true;
+}
+
 FLAC__bool test_encoders(void)
 {
 	FLAC__bool is_ogg = false;
@@ -517,6 +1084,22 @@ FLAC__bool test_encoders(void)
 		if(!test_stream_encoder(LAYER_FILENAME, is_ogg))
 			return false;
 
+		if(!is_ogg && !test_stream_encoder_window_cache())
+			return false;
+
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+		if(!is_ogg && !test_stream_encoder_fused_window_autocorrelation())
+			return false;
+		if(!is_ogg && !test_stream_encoder_lpc_order_pruning())
+			return false;
+#endif
+
+		if(!is_ogg && !test_stream_encoder_partition_simd())
+			return false;
+
+		if(!is_ogg && !test_stream_encoder_threads())
+			return false;
+
 		(void) grabbag__file_remove_file(flacfilename(is_ogg));
 
 		free_metadata_blocks_();
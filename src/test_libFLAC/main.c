@@ -30,6 +30,7 @@
 #include "format.h"
 #include "metadata.h"
 #include "md5.h"
+#include "predictors.h"
 
 int main(void)
 {
@@ -48,6 +49,9 @@ int main(void)
 	if(!test_bitwriter())
 		return 1;
 
+	if(!test_predictors())
+		return 1;
+
 	if(!test_format())
 		return 1;
 
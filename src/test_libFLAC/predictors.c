@@ -0,0 +1,195 @@
+/* test_libFLAC - Unit tester for libFLAC
+ * Copyright (C) 2025  Xiph.Org Foundation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FLAC/assert.h"
+#include "FLAC/format.h"
+#include "share/compat.h"
+#include "private/cpu.h"
+#include "private/fixed.h"
+#include "predictors.h"
+
+typedef void (*fixed_restore_signal_func)(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[]);
+
+typedef struct {
+	const char *name;
+	fixed_restore_signal_func func;
+	FLAC__bool handles_overflow;
+} FixedRestoreSignalImplementation;
+
+static FLAC__bool test_fixed_restore_signal(const FixedRestoreSignalImplementation *implementation);
+
+#define ITERATIONS 20000
+#define MAX_DATA_LEN 600
+#define GUARD_LEN 16
+#define GUARD_VALUE 0x5a5a5a5a
+
+static FLAC__uint32 random_state_;
+
+/* Reproducible pseudo-random numbers, so a failure can be reproduced */
+static FLAC__uint32 random_(void)
+{
+	random_state_ ^= random_state_ << 13;
+	random_state_ ^= random_state_ >> 17;
+	random_state_ ^= random_state_ << 5;
+	return random_state_;
+}
+
+/* A random value that fits in a signed integer of bits bits */
+static FLAC__int32 random_signed_(uint32_t bits)
+{
+	FLAC__ASSERT(bits >= 1 && bits <= 32);
+	return (FLAC__int32)(random_() << (32 - bits)) >> (32 - bits);
+}
+
+FLAC__bool test_predictors(void)
+{
+	FixedRestoreSignalImplementation implementations[4];
+	uint32_t i, num_implementations = 0;
+	FLAC__CPUInfo cpuinfo;
+
+	printf("\n+++ libFLAC unit test: predictors\n\n");
+
+	FLAC__cpu_info(&cpuinfo);
+	implementations[num_implementations].name = "FLAC__fixed_restore_signal";
+	implementations[num_implementations].func = FLAC__fixed_restore_signal;
+	implementations[num_implementations].handles_overflow = false;
+	num_implementations++;
+	implementations[num_implementations].name = "FLAC__fixed_restore_signal_wide";
+	implementations[num_implementations].func = FLAC__fixed_restore_signal_wide;
+	implementations[num_implementations].handles_overflow = false;
+	num_implementations++;
+#ifndef FLAC__NO_ASM
+#if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
+	if(cpuinfo.use_asm) {
+# ifdef FLAC__SSE2_SUPPORTED
+		if(cpuinfo.x86.sse2) {
+			implementations[num_implementations].name = "FLAC__fixed_restore_signal_intrin_sse2";
+			implementations[num_implementations].func = FLAC__fixed_restore_signal_intrin_sse2;
+			implementations[num_implementations].handles_overflow = true;
+			num_implementations++;
+		}
+# endif
+# ifdef FLAC__AVX2_SUPPORTED
+		if(cpuinfo.x86.avx2) {
+			implementations[num_implementations].name = "FLAC__fixed_restore_signal_intrin_avx2";
+			implementations[num_implementations].func = FLAC__fixed_restore_signal_intrin_avx2;
+			implementations[num_implementations].handles_overflow = true;
+			num_implementations++;
+		}
+# endif
+	}
+#endif
+#endif
+	(void)cpuinfo;
+
+	for(i = 0; i < num_implementations; i++) {
+		if(!test_fixed_restore_signal(&implementations[i]))
+			return false;
+	}
+
+	printf("\nPASSED!\n");
+	return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static FLAC__bool check_guard_(const FLAC__int32 *guard, const char *name)
+{
+	uint32_t i;
+	for(i = 0; i < GUARD_LEN; i++) {
+		if(guard[i] != GUARD_VALUE) {
+			printf("FAILED, %s wrote past the end of the signal\n", name);
+			return false;
+		}
+	}
+	return true;
+}
+
+static FLAC__bool test_fixed_restore_signal(const FixedRestoreSignalImplementation *implementation)
+{
+	FLAC__int32 signal[FLAC__MAX_FIXED_ORDER + MAX_DATA_LEN];
+	FLAC__int32 residual[MAX_DATA_LEN];
+	FLAC__int32 expected[FLAC__MAX_FIXED_ORDER + MAX_DATA_LEN + GUARD_LEN];
+	FLAC__int32 restored[FLAC__MAX_FIXED_ORDER + MAX_DATA_LEN + GUARD_LEN];
+	uint32_t iteration, i;
+
+	printf("testing %s restores encoded signals ... ", implementation->name);
+	random_state_ = 0x2545f491;
+	for(iteration = 0; iteration < ITERATIONS; iteration++) {
+		const uint32_t order = random_() % (FLAC__MAX_FIXED_ORDER + 1);
+		const uint32_t data_len = random_() % MAX_DATA_LEN;
+		const uint32_t bps = 4 + random_() % (32 - 4 - FLAC__MAX_FIXED_ORDER + 1);
+
+		for(i = 0; i < order + data_len; i++)
+			signal[i] = random_signed_(bps);
+		FLAC__fixed_compute_residual(signal + order, data_len, order, residual);
+
+		for(i = 0; i < FLAC__MAX_FIXED_ORDER + MAX_DATA_LEN + GUARD_LEN; i++)
+			restored[i] = GUARD_VALUE;
+		memcpy(restored, signal, sizeof(signal[0]) * order);
+		implementation->func(residual, data_len, order, restored + order);
+		if(memcmp(restored, signal, sizeof(signal[0]) * (order + data_len)) != 0) {
+			printf("FAILED, signal differs at iteration %u (order=%u data_len=%u bps=%u)\n", iteration, order, data_len, bps);
+			return false;
+		}
+		if(!check_guard_(restored + order + data_len, implementation->name))
+			return false;
+	}
+	printf("OK\n");
+
+	if(!implementation->handles_overflow)
+		return true;
+
+	/* The decoder has to cope with whatever a damaged or malicious stream
+	 * holds, so random residuals of any size must give the same samples as
+	 * the C code, overflow included */
+	printf("testing %s against FLAC__fixed_restore_signal_wide with random residuals ... ", implementation->name);
+	random_state_ = 0x9e3779b9;
+	for(iteration = 0; iteration < ITERATIONS; iteration++) {
+		const uint32_t order = random_() % (FLAC__MAX_FIXED_ORDER + 1);
+		const uint32_t data_len = random_() % MAX_DATA_LEN;
+		const uint32_t residual_bits = 1 + random_() % 32;
+		const uint32_t warmup_bits = 1 + random_() % 32;
+
+		for(i = 0; i < data_len; i++)
+			residual[i] = random_signed_(residual_bits);
+		for(i = 0; i < FLAC__MAX_FIXED_ORDER + MAX_DATA_LEN + GUARD_LEN; i++)
+			expected[i] = restored[i] = GUARD_VALUE;
+		for(i = 0; i < order; i++)
+			expected[i] = restored[i] = random_signed_(warmup_bits);
+
+		FLAC__fixed_restore_signal_wide(residual, data_len, order, expected + order);
+		implementation->func(residual, data_len, order, restored + order);
+		if(memcmp(restored, expected, sizeof(expected[0]) * (order + data_len)) != 0) {
+			printf("FAILED, signal differs at iteration %u (order=%u data_len=%u residual_bits=%u)\n", iteration, order, data_len, residual_bits);
+			return false;
+		}
+		if(!check_guard_(restored + order + data_len, implementation->name))
+			return false;
+	}
+	printf("OK\n");
+
+	return true;
+}
@@ -0,0 +1,1342 @@
+/* flacbench - Measures the speed of the optimized decoding routines of libFLAC
+ * Copyright (C) 2025  Xiph.Org Foundation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * flacbench links against the private libFLAC headers and times the
+ * different implementations of a routine against each other on the same
+ * data, checking along the way that all of them produce identical output.
+ * Only the implementations the running CPU supports are measured.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+#include "share/compat.h"
+#include "share/private.h"
+#include "FLAC/format.h"
+#include "FLAC/stream_decoder.h"
+#include "FLAC/stream_encoder.h"
+#include "private/bitreader.h"
+#include "private/bitwriter.h"
+#include "private/cpu.h"
+#include "private/crc.h"
+#include "private/fixed.h"
+#include "private/lpc.h"
+#include "private/window.h"
+
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+
+#define BLOCKSIZE 4096
+#define SAMPLES_PER_MEASUREMENT (1u << 24)
+
+typedef void (*restore_signal_func)(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[]);
+
+typedef struct {
+	const char *name;
+	restore_signal_func restore_signal;
+	restore_signal_func restore_signal_wide;
+} RestoreSignalImplementation;
+
+typedef void (*fixed_restore_signal_func)(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[]);
+
+typedef struct {
+	const char *name;
+	fixed_restore_signal_func restore_signal;
+} FixedRestoreSignalImplementation;
+
+typedef void (*autocorrelation_windowed_func)(const FLAC__int32 * const in[], const FLAC__real * const window[], uint32_t num_windows, uint32_t data_len, uint32_t lag, double autoc[][FLAC__MAX_LPC_ORDER+1]);
+
+typedef struct {
+	const char *name;
+	autocorrelation_windowed_func autocorrelation_windowed;
+} AutocorrelationImplementation;
+
+static const uint32_t lpc_orders[] = { 2, 4, 8, 10, 12, 16, 20, 24, 32 };
+
+static FLAC__int32 signal_[FLAC__MAX_LPC_ORDER + BLOCKSIZE];
+static FLAC__int32 residual_[BLOCKSIZE];
+static FLAC__int32 output_[FLAC__MAX_LPC_ORDER + BLOCKSIZE];
+
+static uint32_t get_restore_signal_implementations_(RestoreSignalImplementation implementations[])
+{
+	FLAC__CPUInfo cpuinfo;
+	uint32_t count = 0;
+
+	FLAC__cpu_info(&cpuinfo);
+
+	implementations[count].name = "C";
+	implementations[count].restore_signal = FLAC__lpc_restore_signal;
+	implementations[count].restore_signal_wide = FLAC__lpc_restore_signal_wide;
+	count++;
+
+#ifndef FLAC__NO_ASM
+#if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
+	if(cpuinfo.use_asm) {
+# ifdef FLAC__SSE4_1_SUPPORTED
+		if(cpuinfo.x86.sse41) {
+			implementations[count].name = "SSE4.1";
+			implementations[count].restore_signal = FLAC__lpc_restore_signal_intrin_sse41;
+			implementations[count].restore_signal_wide = FLAC__lpc_restore_signal_wide_intrin_sse41;
+			count++;
+		}
+# endif
+# ifdef FLAC__AVX2_SUPPORTED
+		if(cpuinfo.x86.avx2) {
+			implementations[count].name = "AVX2";
+			implementations[count].restore_signal = FLAC__lpc_restore_signal_intrin_avx2;
+			implementations[count].restore_signal_wide = FLAC__lpc_restore_signal_wide_intrin_avx2;
+			count++;
+		}
+# endif
+	}
+#endif
+#endif
+	(void)cpuinfo;
+	return count;
+}
+
+static uint32_t get_fixed_restore_signal_implementations_(FixedRestoreSignalImplementation implementations[])
+{
+	FLAC__CPUInfo cpuinfo;
+	uint32_t count = 0;
+
+	FLAC__cpu_info(&cpuinfo);
+
+	implementations[count].name = "C";
+	implementations[count].restore_signal = FLAC__fixed_restore_signal;
+	count++;
+
+#ifndef FLAC__NO_ASM
+#if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
+	if(cpuinfo.use_asm) {
+# ifdef FLAC__SSE2_SUPPORTED
+		if(cpuinfo.x86.sse2) {
+			implementations[count].name = "SSE2";
+			implementations[count].restore_signal = FLAC__fixed_restore_signal_intrin_sse2;
+			count++;
+		}
+# endif
+# ifdef FLAC__AVX2_SUPPORTED
+		if(cpuinfo.x86.avx2) {
+			implementations[count].name = "AVX2";
+			implementations[count].restore_signal = FLAC__fixed_restore_signal_intrin_avx2;
+			count++;
+		}
+# endif
+	}
+#endif
+#endif
+	(void)cpuinfo;
+	return count;
+}
+
+static uint32_t get_autocorrelation_implementations_(AutocorrelationImplementation implementations[])
+{
+	FLAC__CPUInfo cpuinfo;
+	uint32_t count = 0;
+
+	FLAC__cpu_info(&cpuinfo);
+
+	implementations[count].name = "C";
+	implementations[count].autocorrelation_windowed = FLAC__lpc_compute_autocorrelation_windowed;
+	count++;
+
+#ifndef FLAC__NO_ASM
+#if defined FLAC__CPU_X86_64 && FLAC__HAS_X86INTRIN
+	if(cpuinfo.use_asm) {
+# ifdef FLAC__FMA_SUPPORTED
+		if(cpuinfo.x86.fma) {
+			implementations[count].name = "FMA";
+			implementations[count].autocorrelation_windowed = FLAC__lpc_compute_autocorrelation_windowed_intrin_fma;
+			count++;
+		}
+# endif
+	}
+#endif
+#endif
+	(void)cpuinfo;
+	return count;
+}
+
+/* A few decaying partials plus some noise, which gives LPC coefficients
+ * that look like those of real music rather than of a pure tone */
+static void generate_signal_(uint32_t bps)
+{
+	const double amplitude = (double)((1u << (bps - 1)) - 1);
+	uint32_t i;
+
+	srand(bps);
+	for(i = 0; i < FLAC__MAX_LPC_ORDER + BLOCKSIZE; i++) {
+		const double t = (double)i / 44100.0;
+		double x = 0.45 * sin(2.0 * M_PI * 220.0 * t) + 0.2 * sin(2.0 * M_PI * 661.0 * t) * exp(-t * 3.0) + 0.1 * sin(2.0 * M_PI * 1753.0 * t);
+		x += 0.05 * ((double)rand() / RAND_MAX - 0.5);
+		signal_[i] = (FLAC__int32)lround(x * amplitude);
+	}
+}
+
+/* Returns the number of bits the prediction needs or 0 on failure */
+static uint32_t prepare_residual_(uint32_t bps, uint32_t order, FLAC__int32 qlp_coeff[], int *lp_quantization)
+{
+	static FLAC__real real_signal[FLAC__MAX_LPC_ORDER + BLOCKSIZE];
+	FLAC__real lp_coeff[FLAC__MAX_LPC_ORDER][FLAC__MAX_LPC_ORDER];
+	double autoc[FLAC__MAX_LPC_ORDER + 1], error[FLAC__MAX_LPC_ORDER];
+	uint32_t i, max_order = order;
+	const uint32_t precision = bps <= 16 ? 12 : 15;
+
+	for(i = 0; i < FLAC__MAX_LPC_ORDER + BLOCKSIZE; i++)
+		real_signal[i] = (FLAC__real)signal_[i];
+	FLAC__lpc_compute_autocorrelation(real_signal, FLAC__MAX_LPC_ORDER + BLOCKSIZE, order + 1, autoc);
+	FLAC__lpc_compute_lp_coefficients(autoc, &max_order, lp_coeff, error);
+	if(max_order < order)
+		return 0;
+	if(FLAC__lpc_quantize_coefficients(lp_coeff[order - 1], order, precision, qlp_coeff, lp_quantization) != 0)
+		return 0;
+	if(FLAC__lpc_max_residual_bps(bps, qlp_coeff, order, *lp_quantization) > 32)
+		return 0;
+
+	if(FLAC__lpc_max_prediction_before_shift_bps(bps, qlp_coeff, order) <= 32) {
+		FLAC__lpc_compute_residual_from_qlp_coefficients(signal_ + FLAC__MAX_LPC_ORDER, BLOCKSIZE, qlp_coeff, order, *lp_quantization, residual_);
+		return 32;
+	}
+	else {
+		FLAC__lpc_compute_residual_from_qlp_coefficients_wide(signal_ + FLAC__MAX_LPC_ORDER, BLOCKSIZE, qlp_coeff, order, *lp_quantization, residual_);
+		return 64;
+	}
+}
+
+/* Returns nanoseconds per sample or a negative value if the output is wrong */
+static double time_restore_signal_(restore_signal_func restore_signal, uint32_t order, const FLAC__int32 qlp_coeff[], int lp_quantization)
+{
+	const uint32_t iterations = SAMPLES_PER_MEASUREMENT / BLOCKSIZE;
+	clock_t start, end;
+	uint32_t i;
+
+	memcpy(output_, signal_, sizeof(output_[0]) * FLAC__MAX_LPC_ORDER);
+	memset(output_ + FLAC__MAX_LPC_ORDER, 0, sizeof(output_[0]) * BLOCKSIZE);
+	restore_signal(residual_, BLOCKSIZE, qlp_coeff, order, lp_quantization, output_ + FLAC__MAX_LPC_ORDER);
+	if(memcmp(output_, signal_, sizeof(output_)) != 0)
+		return -1.0;
+
+	start = clock();
+	for(i = 0; i < iterations; i++)
+		restore_signal(residual_, BLOCKSIZE, qlp_coeff, order, lp_quantization, output_ + FLAC__MAX_LPC_ORDER);
+	end = clock();
+
+	return (double)(end - start) / CLOCKS_PER_SEC * 1e9 / ((double)iterations * BLOCKSIZE);
+}
+
+/* Returns nanoseconds per sample or a negative value if the output is wrong */
+static double time_fixed_restore_signal_(fixed_restore_signal_func restore_signal, uint32_t order)
+{
+	const uint32_t iterations = SAMPLES_PER_MEASUREMENT / BLOCKSIZE;
+	clock_t start, end;
+	uint32_t i;
+
+	memcpy(output_, signal_, sizeof(output_[0]) * FLAC__MAX_LPC_ORDER);
+	memset(output_ + FLAC__MAX_LPC_ORDER, 0, sizeof(output_[0]) * BLOCKSIZE);
+	restore_signal(residual_, BLOCKSIZE, order, output_ + FLAC__MAX_LPC_ORDER);
+	if(memcmp(output_, signal_, sizeof(output_)) != 0)
+		return -1.0;
+
+	start = clock();
+	for(i = 0; i < iterations; i++)
+		restore_signal(residual_, BLOCKSIZE, order, output_ + FLAC__MAX_LPC_ORDER);
+	end = clock();
+
+	return (double)(end - start) / CLOCKS_PER_SEC * 1e9 / ((double)iterations * BLOCKSIZE);
+}
+
+static FLAC__bool benchmark_fixed_restore_signal_(uint32_t bps)
+{
+	FixedRestoreSignalImplementation implementations[3];
+	const uint32_t num_implementations = get_fixed_restore_signal_implementations_(implementations);
+	uint32_t order, j;
+
+	generate_signal_(bps);
+
+	printf("\nFLAC__fixed_restore_signal, %u bps, blocksize %u, ns/sample (speedup over C)\n", bps, BLOCKSIZE);
+	printf("order");
+	for(j = 0; j < num_implementations; j++)
+		printf("  %-15s", implementations[j].name);
+	printf("\n");
+
+	for(order = 0; order <= FLAC__MAX_FIXED_ORDER; order++) {
+		double reference = 0.0;
+
+		FLAC__fixed_compute_residual(signal_ + FLAC__MAX_LPC_ORDER, BLOCKSIZE, order, residual_);
+		printf("%5u", order);
+		for(j = 0; j < num_implementations; j++) {
+			const double ns = time_fixed_restore_signal_(implementations[j].restore_signal, order);
+			if(ns < 0.0) {
+				printf("\nERROR: %s implementation does not restore the signal at order %u\n", implementations[j].name, order);
+				return false;
+			}
+			if(j == 0) {
+				reference = ns;
+				printf("  %-15.2f", ns);
+			}
+			else
+				printf("  %5.2f (%4.2fx)  ", ns, ns > 0.0 ? reference / ns : 0.0);
+		}
+		printf("\n");
+	}
+	return true;
+}
+
+static FLAC__bool benchmark_lpc_restore_signal_(uint32_t bps)
+{
+	RestoreSignalImplementation implementations[4];
+	const uint32_t num_implementations = get_restore_signal_implementations_(implementations);
+	FLAC__int32 qlp_coeff[FLAC__MAX_LPC_ORDER];
+	int lp_quantization;
+	uint32_t i, j;
+
+	generate_signal_(bps);
+
+	printf("\nFLAC__lpc_restore_signal, %u bps, blocksize %u, ns/sample (speedup over C)\n", bps, BLOCKSIZE);
+	printf("order  width");
+	for(j = 0; j < num_implementations; j++)
+		printf("  %-15s", implementations[j].name);
+	printf("\n");
+
+	for(i = 0; i < sizeof(lpc_orders) / sizeof(lpc_orders[0]); i++) {
+		const uint32_t order = lpc_orders[i];
+		const uint32_t width = prepare_residual_(bps, order, qlp_coeff, &lp_quantization);
+		double reference = 0.0;
+
+		if(width == 0) {
+			printf("%5u  could not compute a usable predictor\n", order);
+			continue;
+		}
+		printf("%5u  %5u", order, width);
+		for(j = 0; j < num_implementations; j++) {
+			const double ns = time_restore_signal_(width == 32 ? implementations[j].restore_signal : implementations[j].restore_signal_wide, order, qlp_coeff, lp_quantization);
+			if(ns < 0.0) {
+				printf("\nERROR: %s implementation does not restore the signal at order %u\n", implementations[j].name, order);
+				return false;
+			}
+			if(j == 0) {
+				reference = ns;
+				printf("  %-15.2f", ns);
+			}
+			else
+				printf("  %5.2f (%4.2fx)  ", ns, ns > 0.0 ? reference / ns : 0.0);
+		}
+		printf("\n");
+	}
+	return true;
+}
+
+/* Returns nanoseconds per sample of windowing followed by
+ * FLAC__lpc_compute_autocorrelation(), as the encoder did before the
+ * windowed routines */
+static double time_window_then_autocorrelation_(const FLAC__int32 in[], const FLAC__real window[], FLAC__real windowed[], uint32_t blocksize, uint32_t lag, double autoc[])
+{
+	const uint32_t iterations = SAMPLES_PER_MEASUREMENT / blocksize;
+	clock_t start, end;
+	uint32_t i;
+
+	start = clock();
+	for(i = 0; i < iterations; i++) {
+		FLAC__lpc_window_data(in, window, windowed, blocksize);
+		FLAC__lpc_compute_autocorrelation(windowed, blocksize, lag, autoc);
+	}
+	end = clock();
+
+	return (double)(end - start) / CLOCKS_PER_SEC * 1e9 / ((double)iterations * blocksize);
+}
+
+/* Returns nanoseconds per sample or a negative value if the output differs
+ * from that of windowing first */
+static double time_autocorrelation_windowed_(autocorrelation_windowed_func autocorrelation_windowed, const FLAC__int32 in[], const FLAC__real window[], uint32_t blocksize, uint32_t lag, const double reference[])
+{
+	const uint32_t iterations = SAMPLES_PER_MEASUREMENT / blocksize;
+	double autoc[1][FLAC__MAX_LPC_ORDER+1];
+	clock_t start, end;
+	uint32_t i;
+
+	autocorrelation_windowed(&in, &window, 1, blocksize, lag, autoc);
+	if(memcmp(autoc[0], reference, sizeof(reference[0]) * lag) != 0)
+		return -1.0;
+
+	start = clock();
+	for(i = 0; i < iterations; i++)
+		autocorrelation_windowed(&in, &window, 1, blocksize, lag, autoc);
+	end = clock();
+
+	return (double)(end - start) / CLOCKS_PER_SEC * 1e9 / ((double)iterations * blocksize);
+}
+
+static FLAC__bool benchmark_autocorrelation_(void)
+{
+	static const uint32_t blocksizes[] = { 4096, 16384, 65535 };
+	static const uint32_t lags[] = { 9, 13, 17, 25, 33 };
+	AutocorrelationImplementation implementations[2];
+	const uint32_t num_implementations = get_autocorrelation_implementations_(implementations);
+	const uint32_t max_blocksize = blocksizes[sizeof(blocksizes) / sizeof(blocksizes[0]) - 1];
+	FLAC__int32 *in = malloc(sizeof(FLAC__int32) * max_blocksize);
+	FLAC__real *window = malloc(sizeof(FLAC__real) * max_blocksize);
+	FLAC__real *windowed = malloc(sizeof(FLAC__real) * max_blocksize);
+	uint32_t i, j, k;
+
+	if(0 == in || 0 == window || 0 == windowed) {
+		printf("ERROR: out of memory\n");
+		free(in);
+		free(window);
+		free(windowed);
+		return false;
+	}
+	srand(1);
+	for(i = 0; i < max_blocksize; i++)
+		in[i] = (FLAC__int32)lround(20000.0 * sin((double)i * 0.031) + 5000.0 * sin((double)i * 0.27) + 100.0 * ((double)rand() / RAND_MAX - 0.5));
+
+	printf("\nFLAC__lpc_compute_autocorrelation_windowed, tukey(5e-1), ns/sample (speedup over windowing first)\n");
+	printf("blocksize  lag  window first");
+	for(k = 0; k < num_implementations; k++)
+		printf("  %-15s", implementations[k].name);
+	printf("\n");
+
+	for(i = 0; i < sizeof(blocksizes) / sizeof(blocksizes[0]); i++) {
+		FLAC__window_tukey(window, (FLAC__int32)blocksizes[i], 0.5f);
+		for(j = 0; j < sizeof(lags) / sizeof(lags[0]); j++) {
+			double reference[FLAC__MAX_LPC_ORDER+1];
+			const double two_passes = time_window_then_autocorrelation_(in, window, windowed, blocksizes[i], lags[j], reference);
+			printf("%9u  %3u  %12.2f", blocksizes[i], lags[j], two_passes);
+			for(k = 0; k < num_implementations; k++) {
+				const double ns = time_autocorrelation_windowed_(implementations[k].autocorrelation_windowed, in, window, blocksizes[i], lags[j], reference);
+				if(ns < 0.0) {
+					printf("\nERROR: %s implementation does not compute the same autocorrelation at lag %u\n", implementations[k].name, lags[j]);
+					free(in);
+					free(window);
+					free(windowed);
+					return false;
+				}
+				printf("  %5.2f (%4.2fx)  ", ns, ns > 0.0 ? two_passes / ns : 0.0);
+			}
+			printf("\n");
+		}
+	}
+	free(in);
+	free(window);
+	free(windowed);
+	return true;
+}
+
+#endif /* !defined FLAC__INTEGER_ONLY_LIBRARY */
+
+#define RICE_BLOCKSIZE 4096
+#define RICE_PARTITIONS 16
+#define RICE_MAX_PARAMETER 20
+/* room after the codewords, so the end of the data does not fall inside
+ * the block as it would not in a real stream */
+#define RICE_PADDING 1024
+
+typedef FLAC__bool (*read_rice_signed_block_func)(FLAC__BitReader *br, int vals[], uint32_t nvals, uint32_t parameter);
+
+typedef struct {
+	const char *name;
+	read_rice_signed_block_func read_rice_signed_block;
+	uint32_t max_parameter;
+} ReadRiceImplementation;
+
+/* FLAC__bitreader_read_rice_signed_block_table() with the table for the
+ * parameter built on first use, as the decoder does */
+static FLAC__bool read_rice_signed_block_table_(FLAC__BitReader *br, int vals[], uint32_t nvals, uint32_t parameter)
+{
+	static FLAC__BitReaderRiceTableEntry table[FLAC__BITREADER_RICE_TABLE_MAX_PARAMETER+1][1u << FLAC__BITREADER_RICE_TABLE_BITS];
+	static FLAC__bool built[FLAC__BITREADER_RICE_TABLE_MAX_PARAMETER+1];
+
+	if(!built[parameter]) {
+		FLAC__bitreader_build_rice_table(table[parameter], parameter);
+		built[parameter] = true;
+	}
+	return FLAC__bitreader_read_rice_signed_block_table(br, vals, nvals, parameter, table[parameter]);
+}
+
+static uint32_t get_read_rice_implementations_(ReadRiceImplementation implementations[])
+{
+	FLAC__CPUInfo cpuinfo;
+	uint32_t count = 0;
+
+	FLAC__cpu_info(&cpuinfo);
+
+	implementations[count].name = "C";
+	implementations[count].read_rice_signed_block = FLAC__bitreader_read_rice_signed_block;
+	implementations[count].max_parameter = RICE_MAX_PARAMETER;
+	count++;
+
+	implementations[count].name = "table";
+	implementations[count].read_rice_signed_block = read_rice_signed_block_table_;
+	implementations[count].max_parameter = FLAC__BITREADER_RICE_TABLE_MAX_PARAMETER;
+	count++;
+
+#ifdef FLAC__BMI2_SUPPORTED
+	if(cpuinfo.x86.bmi2) {
+		implementations[count].name = "BMI2";
+		implementations[count].read_rice_signed_block = FLAC__bitreader_read_rice_signed_block_bmi2;
+		implementations[count].max_parameter = RICE_MAX_PARAMETER;
+		count++;
+	}
+#endif
+	(void)cpuinfo;
+	return count;
+}
+
+static FLAC__bool rice_read_callback_(FLAC__byte buffer[], size_t *bytes, void *client_data)
+{
+	(void)buffer, (void)client_data;
+	/* everything comes from the source set with FLAC__bitreader_set_source() */
+	*bytes = 0;
+	return false;
+}
+
+/* Codewords that Rice parameter fits: the unary part follows the
+ * geometric distribution of a Laplacian residual, the binary part is
+ * uniform.  They come after a byte standing in for the subframe header,
+ * which gets the bit reader to fill its buffer as it would in a stream.
+ * Returns the number of encoded bytes or 0 on failure. */
+static size_t encode_rice_block_(uint32_t parameter, FLAC__int32 residual[], FLAC__byte **data)
+{
+	FLAC__BitWriter *bw;
+	const FLAC__byte *buffer;
+	size_t bytes = 0;
+	uint32_t i;
+
+	srand(parameter);
+	for(i = 0; i < RICE_BLOCKSIZE; i++) {
+		const FLAC__uint32 lsbs = parameter > 0 ? (FLAC__uint32)rand() & ((1u << parameter) - 1) : 0;
+		FLAC__uint32 msbs = 0, u;
+		while(msbs < 20 && (rand() & 1))
+			msbs++;
+		u = (msbs << parameter) | lsbs;
+		residual[i] = (FLAC__int32)(u >> 1) ^ -(FLAC__int32)(u & 1);
+	}
+
+	if(0 == (bw = FLAC__bitwriter_new()))
+		return 0;
+	if(
+		FLAC__bitwriter_init(bw) &&
+		FLAC__bitwriter_write_raw_uint32(bw, 0, 8) &&
+		FLAC__bitwriter_write_rice_signed_block(bw, residual, RICE_BLOCKSIZE, parameter) &&
+		FLAC__bitwriter_zero_pad_to_byte_boundary(bw) &&
+		FLAC__bitwriter_get_buffer(bw, &buffer, &bytes) &&
+		0 != (*data = calloc(bytes + RICE_PADDING, 1))
+	) {
+		memcpy(*data, buffer, bytes);
+		FLAC__bitwriter_release_buffer(bw);
+	}
+	else
+		bytes = 0;
+	FLAC__bitwriter_delete(bw);
+	return bytes;
+}
+
+/* Reads the block the way the decoder does, one partition per call */
+static FLAC__bool read_rice_block_(FLAC__BitReader *br, read_rice_signed_block_func read_rice_signed_block, uint32_t parameter, int output[])
+{
+	FLAC__uint32 header;
+	uint32_t partition;
+
+	FLAC__bitreader_clear(br);
+	if(!FLAC__bitreader_read_raw_uint32(br, &header, 8))
+		return false;
+	for(partition = 0; partition < RICE_PARTITIONS; partition++) {
+		if(!read_rice_signed_block(br, output + partition * (RICE_BLOCKSIZE / RICE_PARTITIONS), RICE_BLOCKSIZE / RICE_PARTITIONS, parameter))
+			return false;
+	}
+	return true;
+}
+
+/* Returns nanoseconds per value or a negative value if the output is wrong */
+static double time_read_rice_(FLAC__BitReader *br, read_rice_signed_block_func read_rice_signed_block, const FLAC__byte *data, size_t bytes, uint32_t parameter, const FLAC__int32 residual[])
+{
+	const uint32_t iterations = SAMPLES_PER_MEASUREMENT / RICE_BLOCKSIZE;
+	static int output[RICE_BLOCKSIZE];
+	clock_t start, end;
+	size_t position = 0;
+	uint32_t i;
+
+	FLAC__bitreader_set_source(br, data, bytes + RICE_PADDING, &position);
+	if(!read_rice_block_(br, read_rice_signed_block, parameter, output) || memcmp(output, residual, sizeof(output)) != 0)
+		return -1.0;
+
+	start = clock();
+	for(i = 0; i < iterations; i++) {
+		position = 0;
+		if(!read_rice_block_(br, read_rice_signed_block, parameter, output))
+			return -1.0;
+	}
+	end = clock();
+
+	return (double)(end - start) / CLOCKS_PER_SEC * 1e9 / ((double)iterations * RICE_BLOCKSIZE);
+}
+
+static FLAC__bool benchmark_read_rice_(void)
+{
+	static FLAC__int32 residual[RICE_BLOCKSIZE];
+	ReadRiceImplementation implementations[3];
+	const uint32_t num_implementations = get_read_rice_implementations_(implementations);
+	FLAC__BitReader *br;
+	uint32_t parameter, j;
+
+	if(0 == (br = FLAC__bitreader_new()) || !FLAC__bitreader_init(br, rice_read_callback_, 0)) {
+		printf("ERROR: could not set up a bit reader\n");
+		FLAC__bitreader_delete(br);
+		return false;
+	}
+
+	printf("\nFLAC__bitreader_read_rice_signed_block, blocksize %u, ns/value (speedup over C)\n", RICE_BLOCKSIZE);
+	printf("parameter");
+	for(j = 0; j < num_implementations; j++)
+		printf("  %-15s", implementations[j].name);
+	printf("\n");
+
+	for(parameter = 0; parameter <= RICE_MAX_PARAMETER; parameter++) {
+		FLAC__byte *data = 0;
+		const size_t bytes = encode_rice_block_(parameter, residual, &data);
+		double reference = 0.0;
+
+		if(bytes == 0) {
+			printf("ERROR: could not encode the test block\n");
+			FLAC__bitreader_delete(br);
+			return false;
+		}
+		printf("%9u", parameter);
+		for(j = 0; j < num_implementations; j++) {
+			double ns;
+			if(parameter > implementations[j].max_parameter) {
+				printf("  %-15s", "-");
+				continue;
+			}
+			ns = time_read_rice_(br, implementations[j].read_rice_signed_block, data, bytes, parameter, residual);
+			if(ns < 0.0) {
+				printf("\nERROR: %s implementation does not read the residual at parameter %u\n", implementations[j].name, parameter);
+				free(data);
+				FLAC__bitreader_delete(br);
+				return false;
+			}
+			if(j == 0) {
+				reference = ns;
+				printf("  %-15.2f", ns);
+			}
+			else
+				printf("  %5.2f (%4.2fx)  ", ns, ns > 0.0 ? reference / ns : 0.0);
+		}
+		printf("\n");
+		free(data);
+	}
+	FLAC__bitreader_delete(br);
+	return true;
+}
+
+#define CRC_BYTES_PER_MEASUREMENT (1u << 28)
+
+typedef struct {
+	const char *name;
+	FLAC__uint16 (*crc16_update_words64)(const FLAC__uint64 *words, uint32_t len, FLAC__uint16 crc);
+} Crc16Implementation;
+
+static uint32_t get_crc16_implementations_(Crc16Implementation implementations[])
+{
+	FLAC__CPUInfo cpuinfo;
+	uint32_t count = 0;
+
+	FLAC__cpu_info(&cpuinfo);
+
+	implementations[count].name = "C";
+	implementations[count].crc16_update_words64 = FLAC__crc16_update_words64;
+	count++;
+
+#if !defined FLAC__NO_ASM && (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN && defined FLAC__PCLMUL_SUPPORTED
+	if(cpuinfo.use_asm && cpuinfo.x86.pclmul && cpuinfo.x86.ssse3) {
+		implementations[count].name = "PCLMUL";
+		implementations[count].crc16_update_words64 = FLAC__crc16_update_words64_intrin_pclmul;
+		count++;
+	}
+#endif
+	(void)cpuinfo;
+	return count;
+}
+
+/* Returns bytes per nanosecond, the CRC of the data goes to *crc */
+static double time_crc16_(FLAC__uint16 (*crc16_update_words64)(const FLAC__uint64 *words, uint32_t len, FLAC__uint16 crc), const FLAC__uint64 *words, uint32_t len, FLAC__uint16 *crc)
+{
+	const uint32_t iterations = CRC_BYTES_PER_MEASUREMENT / (len * 8);
+	clock_t start, end;
+	uint32_t i;
+
+	*crc = crc16_update_words64(words, len, 0);
+	start = clock();
+	for(i = 0; i < iterations; i++)
+		*crc = crc16_update_words64(words, len, *crc);
+	end = clock();
+	*crc = crc16_update_words64(words, len, 0);
+
+	return (double)iterations * len * 8 / ((double)(end - start) / CLOCKS_PER_SEC * 1e9);
+}
+
+static FLAC__bool benchmark_crc16_(void)
+{
+	/* from a short frame header to the whole buffer of the bit reader */
+	static const uint32_t lengths[] = { 4, 16, 64, 256, 1024 };
+	static FLAC__uint64 words[1024];
+	Crc16Implementation implementations[2];
+	const uint32_t num_implementations = get_crc16_implementations_(implementations);
+	uint32_t i, j;
+
+	srand(16);
+	for(i = 0; i < sizeof(words) / sizeof(words[0]); i++)
+		words[i] = (FLAC__uint64)rand() << 40 ^ (FLAC__uint64)rand() << 20 ^ (FLAC__uint64)rand();
+
+	printf("\nFLAC__crc16_update_words64, bytes/ns (speedup over C)\n");
+	printf("    bytes");
+	for(j = 0; j < num_implementations; j++)
+		printf("  %-15s", implementations[j].name);
+	printf("\n");
+
+	for(i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+		double reference = 0.0;
+		FLAC__uint16 reference_crc = 0;
+
+		printf("%9u", lengths[i] * 8);
+		for(j = 0; j < num_implementations; j++) {
+			FLAC__uint16 crc;
+			const double speed = time_crc16_(implementations[j].crc16_update_words64, words, lengths[i], &crc);
+			if(j == 0) {
+				reference = speed;
+				reference_crc = crc;
+				printf("  %-15.2f", speed);
+			}
+			else if(crc != reference_crc) {
+				printf("\nERROR: %s implementation does not compute the CRC of %u bytes\n", implementations[j].name, lengths[i] * 8);
+				return false;
+			}
+			else
+				printf("  %5.2f (%4.2fx)  ", speed, reference > 0.0 ? speed / reference : 0.0);
+		}
+		printf("\n");
+	}
+	return true;
+}
+
+#define STREAM_CHANNELS 2
+#define STREAM_SAMPLES (44100 * 20)
+#define STREAM_DECODE_PASSES 3
+#define STREAM_DECODE_RUNS 3
+
+typedef struct {
+	FLAC__byte *data;
+	size_t length, capacity, position;
+	FLAC__uint32 checksum; /* of the decoded samples */
+	FLAC__bool error_occurred;
+} MemoryStream;
+
+static FLAC__StreamEncoderWriteStatus encoder_write_callback_(const FLAC__StreamEncoder *encoder, const FLAC__byte buffer[], size_t bytes, uint32_t samples, uint32_t current_frame, void *client_data)
+{
+	MemoryStream *stream = (MemoryStream*)client_data;
+	(void)encoder, (void)samples, (void)current_frame;
+
+	if(stream->length + bytes > stream->capacity) {
+		FLAC__byte *data;
+		size_t capacity = (stream->length + bytes) * 2;
+		if(0 == (data = realloc(stream->data, capacity)))
+			return FLAC__STREAM_ENCODER_WRITE_STATUS_FATAL_ERROR;
+		stream->data = data;
+		stream->capacity = capacity;
+	}
+	memcpy(stream->data + stream->length, buffer, bytes);
+	stream->length += bytes;
+	return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+}
+
+static FLAC__StreamDecoderReadStatus decoder_read_callback_(const FLAC__StreamDecoder *decoder, FLAC__byte buffer[], size_t *bytes, void *client_data)
+{
+	MemoryStream *stream = (MemoryStream*)client_data;
+	(void)decoder;
+
+	if(stream->position >= stream->length) {
+		*bytes = 0;
+		return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+	}
+	if(*bytes > stream->length - stream->position)
+		*bytes = stream->length - stream->position;
+	memcpy(buffer, stream->data + stream->position, *bytes);
+	stream->position += *bytes;
+	return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+}
+
+static FLAC__StreamDecoderWriteStatus decoder_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data)
+{
+	MemoryStream *stream = (MemoryStream*)client_data;
+	uint32_t channel, i;
+	(void)decoder;
+
+	for(channel = 0; channel < frame->header.channels; channel++) {
+		FLAC__uint32 sum = 0;
+		for(i = 0; i < frame->header.blocksize; i++)
+			sum += (FLAC__uint32)buffer[channel][i] ^ i;
+		stream->checksum = stream->checksum * 31 + sum;
+	}
+	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+static void decoder_error_callback_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data)
+{
+	(void)decoder, (void)status;
+	((MemoryStream*)client_data)->error_occurred = true;
+}
+
+/* Returns an interleaved stereo test signal, to be freed by the caller */
+static FLAC__int32 *make_stream_signal_(uint32_t bps)
+{
+	FLAC__int32 *signal;
+	const double amplitude = (double)((1u << (bps - 1)) - 1);
+	uint32_t i;
+
+	if(0 == (signal = malloc(sizeof(FLAC__int32) * STREAM_CHANNELS * STREAM_SAMPLES)))
+		return 0;
+	srand(bps);
+	for(i = 0; i < STREAM_SAMPLES; i++) {
+		const double t = (double)i / 44100.0;
+		const double x = 0.3 * sin(2.0 * M_PI * 220.0 * t) + 0.2 * sin(2.0 * M_PI * (440.0 + 30.0 * sin(t)) * t) + 0.1 * sin(2.0 * M_PI * 1753.0 * t) * sin(3.0 * t);
+		signal[i * 2] = (FLAC__int32)lround((x + 0.02 * ((double)rand() / RAND_MAX - 0.5)) * amplitude);
+		signal[i * 2 + 1] = (FLAC__int32)lround((0.8 * x + 0.02 * ((double)rand() / RAND_MAX - 0.5)) * amplitude);
+	}
+	return signal;
+}
+
+static FLAC__StreamEncoder *new_encoder_(MemoryStream *stream, uint32_t bps, uint32_t blocksize, uint32_t max_lpc_order, uint32_t num_threads, FLAC__bool intra_frame_threading, FLAC__ThreadPool *pool)
+{
+	FLAC__StreamEncoder *encoder;
+	FLAC__bool ok;
+
+	if(0 == (encoder = FLAC__stream_encoder_new()))
+		return 0;
+	ok = FLAC__stream_encoder_set_channels(encoder, STREAM_CHANNELS);
+	ok &= FLAC__stream_encoder_set_bits_per_sample(encoder, bps);
+	ok &= FLAC__stream_encoder_set_sample_rate(encoder, 44100);
+	ok &= FLAC__stream_encoder_set_compression_level(encoder, 8);
+	ok &= FLAC__stream_encoder_set_streamable_subset(encoder, false);
+	ok &= FLAC__stream_encoder_set_blocksize(encoder, blocksize);
+	ok &= FLAC__stream_encoder_set_max_lpc_order(encoder, max_lpc_order);
+	ok &= FLAC__stream_encoder_set_total_samples_estimate(encoder, STREAM_SAMPLES);
+	ok &= FLAC__stream_encoder_set_num_threads(encoder, num_threads) == FLAC__STREAM_ENCODER_SET_NUM_THREADS_OK;
+	ok &= FLAC__stream_encoder_set_intra_frame_threading(encoder, intra_frame_threading);
+	ok &= FLAC__stream_encoder_set_thread_pool(encoder, pool);
+	ok &= FLAC__stream_encoder_init_stream(encoder, encoder_write_callback_, 0, 0, 0, stream) == FLAC__STREAM_ENCODER_INIT_STATUS_OK;
+	if(!ok) {
+		FLAC__stream_encoder_delete(encoder);
+		return 0;
+	}
+	return encoder;
+}
+
+static FLAC__bool encode_signal_(MemoryStream *stream, const FLAC__int32 *signal, uint32_t bps, uint32_t blocksize, uint32_t max_lpc_order, uint32_t num_threads, FLAC__bool intra_frame_threading)
+{
+	FLAC__StreamEncoder *encoder;
+	FLAC__bool ok;
+
+	if(0 == (encoder = new_encoder_(stream, bps, blocksize, max_lpc_order, num_threads, intra_frame_threading, /*pool=*/0)))
+		return false;
+	ok = FLAC__stream_encoder_process_interleaved(encoder, signal, STREAM_SAMPLES);
+	ok = ok && FLAC__stream_encoder_finish(encoder);
+
+	FLAC__stream_encoder_delete(encoder);
+	return ok;
+}
+
+static FLAC__bool encode_stream_(MemoryStream *stream, uint32_t bps, uint32_t blocksize, uint32_t max_lpc_order)
+{
+	FLAC__int32 *signal;
+	FLAC__bool ok;
+
+	if(0 == (signal = make_stream_signal_(bps)))
+		return false;
+	ok = encode_signal_(stream, signal, bps, blocksize, max_lpc_order, 1, false);
+	free(signal);
+	return ok;
+}
+
+/* Returns nanoseconds per sample or a negative value on failure */
+static double time_decode_stream_run_(MemoryStream *stream, FLAC__bool fused_lpc_restore)
+{
+	FLAC__StreamDecoder *decoder;
+	clock_t start, end;
+	uint32_t pass;
+	FLAC__bool ok = true;
+
+	if(0 == (decoder = FLAC__stream_decoder_new()))
+		return -1.0;
+
+	stream->checksum = 0;
+	stream->error_occurred = false;
+	start = clock();
+	for(pass = 0; ok && pass < STREAM_DECODE_PASSES; pass++) {
+		stream->position = 0;
+		ok = FLAC__stream_decoder_set_fused_lpc_restore(decoder, fused_lpc_restore);
+		ok = ok && FLAC__stream_decoder_init_stream(decoder, decoder_read_callback_, 0, 0, 0, 0, decoder_write_callback_, 0, decoder_error_callback_, stream) == FLAC__STREAM_DECODER_INIT_STATUS_OK;
+		ok = ok && FLAC__stream_decoder_process_until_end_of_stream(decoder);
+		ok = ok && FLAC__stream_decoder_finish(decoder);
+	}
+	end = clock();
+
+	FLAC__stream_decoder_delete(decoder);
+	if(!ok || stream->error_occurred)
+		return -1.0;
+	return (double)(end - start) / CLOCKS_PER_SEC * 1e9 / ((double)STREAM_DECODE_PASSES * STREAM_SAMPLES * STREAM_CHANNELS);
+}
+
+/* Returns nanoseconds per sample, the best of a few runs, or a negative
+ * value on failure */
+static double time_decode_stream_(MemoryStream *stream, FLAC__bool fused_lpc_restore)
+{
+	double best = -1.0;
+	uint32_t run;
+
+	for(run = 0; run < STREAM_DECODE_RUNS; run++) {
+		const double ns = time_decode_stream_run_(stream, fused_lpc_restore);
+		if(ns < 0.0)
+			return ns;
+		if(best < 0.0 || ns < best)
+			best = ns;
+	}
+	return best;
+}
+
+static FLAC__bool benchmark_decode_stream_(void)
+{
+	static const uint32_t blocksizes[] = { 4096, 16384 };
+	static const uint32_t bits_per_sample[] = { 16, 24 };
+	static const uint32_t max_lpc_orders[] = { 12, 32 };
+	uint32_t i, j, k;
+
+	printf("\nFLAC__stream_decoder, 2 channels, ns/sample (speedup over two passes)\n");
+	printf("blocksize  bps  lpc order  two passes  fused\n");
+
+	for(i = 0; i < sizeof(blocksizes) / sizeof(blocksizes[0]); i++) {
+		for(j = 0; j < sizeof(bits_per_sample) / sizeof(bits_per_sample[0]); j++) {
+			for(k = 0; k < sizeof(max_lpc_orders) / sizeof(max_lpc_orders[0]); k++) {
+				MemoryStream stream;
+				double two_passes, fused;
+				FLAC__uint32 checksum;
+
+				memset(&stream, 0, sizeof(stream));
+				if(!encode_stream_(&stream, bits_per_sample[j], blocksizes[i], max_lpc_orders[k])) {
+					printf("ERROR: could not encode the test stream\n");
+					free(stream.data);
+					return false;
+				}
+				two_passes = time_decode_stream_(&stream, false);
+				checksum = stream.checksum;
+				fused = time_decode_stream_(&stream, true);
+				free(stream.data);
+				if(two_passes < 0.0 || fused < 0.0) {
+					printf("ERROR: could not decode the test stream\n");
+					return false;
+				}
+				if(checksum != stream.checksum) {
+					printf("ERROR: fused decoding gives different samples than decoding in two passes\n");
+					return false;
+				}
+				printf("%9u  %3u  %9u  %10.2f  %5.2f (%4.2fx)\n", blocksizes[i], bits_per_sample[j], max_lpc_orders[k], two_passes, fused, fused > 0.0 ? two_passes / fused : 0.0);
+			}
+		}
+	}
+	return true;
+}
+
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+/* Returns nanoseconds per sample, the best of a few runs, or a negative
+ * value on failure */
+static double time_encode_level_(const FLAC__int32 *signal, uint32_t level, FLAC__bool disable_fused_window_autocorrelation, MemoryStream *stream)
+{
+	double best = -1.0;
+	uint32_t run;
+
+	for(run = 0; run < STREAM_DECODE_RUNS; run++) {
+		FLAC__StreamEncoder *encoder;
+		clock_t start, end;
+		FLAC__bool ok;
+
+		if(0 == (encoder = FLAC__stream_encoder_new()))
+			return -1.0;
+		stream->length = 0;
+		ok = FLAC__stream_encoder_set_channels(encoder, STREAM_CHANNELS);
+		ok &= FLAC__stream_encoder_set_bits_per_sample(encoder, 16);
+		ok &= FLAC__stream_encoder_set_sample_rate(encoder, 44100);
+		ok &= FLAC__stream_encoder_set_compression_level(encoder, level);
+		ok &= FLAC__stream_encoder_disable_fused_window_autocorrelation(encoder, disable_fused_window_autocorrelation);
+		ok &= FLAC__stream_encoder_init_stream(encoder, encoder_write_callback_, 0, 0, 0, stream) == FLAC__STREAM_ENCODER_INIT_STATUS_OK;
+		start = clock();
+		ok = ok && FLAC__stream_encoder_process_interleaved(encoder, signal, STREAM_SAMPLES);
+		ok = ok && FLAC__stream_encoder_finish(encoder);
+		end = clock();
+		FLAC__stream_encoder_delete(encoder);
+		if(!ok)
+			return -1.0;
+		if(best < 0.0 || (double)(end - start) < best)
+			best = (double)(end - start);
+	}
+	return best / CLOCKS_PER_SEC * 1e9 / ((double)STREAM_SAMPLES * STREAM_CHANNELS);
+}
+
+static FLAC__bool benchmark_encode_fused_window_autocorrelation_(void)
+{
+	FLAC__int32 *signal;
+	uint32_t level;
+
+	if(0 == (signal = make_stream_signal_(16)))
+		return false;
+
+	/* init only windows inside the autocorrelation routine for the
+	 * autocorrelation routines it gives the same result with */
+	printf("\nFLAC__stream_encoder, 2 channels, 16 bps, ns/sample (speedup over windowing first)\n");
+	printf("level  windowing first  as picked for this CPU\n");
+
+	for(level = 0; level <= 8; level++) {
+		MemoryStream two_passes, fused;
+		double two_passes_ns, fused_ns;
+		FLAC__bool same;
+
+		memset(&two_passes, 0, sizeof(two_passes));
+		memset(&fused, 0, sizeof(fused));
+		two_passes_ns = time_encode_level_(signal, level, /*disable_fused_window_autocorrelation=*/true, &two_passes);
+		fused_ns = time_encode_level_(signal, level, /*disable_fused_window_autocorrelation=*/false, &fused);
+		same = two_passes.length == fused.length && 0 == memcmp(two_passes.data, fused.data, fused.length);
+		free(two_passes.data);
+		free(fused.data);
+		if(two_passes_ns < 0.0 || fused_ns < 0.0) {
+			printf("ERROR: could not encode the test stream\n");
+			free(signal);
+			return false;
+		}
+		if(!same) {
+			printf("ERROR: windowing inside the autocorrelation routine gives a different stream\n");
+			free(signal);
+			return false;
+		}
+		printf("%5u  %15.2f  %12.2f (%4.2fx)\n", level, two_passes_ns, fused_ns, fused_ns > 0.0 ? two_passes_ns / fused_ns : 0.0);
+	}
+	free(signal);
+	return true;
+}
+
+/* Returns nanoseconds per sample of an exhaustive model search at level 8,
+ * the best of a few runs, or a negative value on failure */
+static double time_encode_exhaustive_(const FLAC__int32 *signal, FLAC__bool do_qlp_coeff_prec_search, FLAC__bool prune_lpc_orders, MemoryStream *stream)
+{
+	double best = -1.0;
+	uint32_t run;
+
+	for(run = 0; run < STREAM_DECODE_RUNS; run++) {
+		FLAC__StreamEncoder *encoder;
+		clock_t start, end;
+		FLAC__bool ok;
+
+		if(0 == (encoder = FLAC__stream_encoder_new()))
+			return -1.0;
+		stream->length = 0;
+		ok = FLAC__stream_encoder_set_channels(encoder, STREAM_CHANNELS);
+		ok &= FLAC__stream_encoder_set_bits_per_sample(encoder, 16);
+		ok &= FLAC__stream_encoder_set_sample_rate(encoder, 44100);
+		ok &= FLAC__stream_encoder_set_compression_level(encoder, 8);
+		ok &= FLAC__stream_encoder_set_do_exhaustive_model_search(encoder, true);
+		ok &= FLAC__stream_encoder_set_prune_lpc_orders(encoder, prune_lpc_orders);
+		ok &= FLAC__stream_encoder_set_do_qlp_coeff_prec_search(encoder, do_qlp_coeff_prec_search);
+		ok &= FLAC__stream_encoder_init_stream(encoder, encoder_write_callback_, 0, 0, 0, stream) == FLAC__STREAM_ENCODER_INIT_STATUS_OK;
+		start = clock();
+		ok = ok && FLAC__stream_encoder_process_interleaved(encoder, signal, STREAM_SAMPLES);
+		ok = ok && FLAC__stream_encoder_finish(encoder);
+		end = clock();
+		FLAC__stream_encoder_delete(encoder);
+		if(!ok)
+			return -1.0;
+		if(best < 0.0 || (double)(end - start) < best)
+			best = (double)(end - start);
+	}
+	return best / CLOCKS_PER_SEC * 1e9 / ((double)STREAM_SAMPLES * STREAM_CHANNELS);
+}
+
+static FLAC__bool benchmark_encode_lpc_order_pruning_(void)
+{
+	FLAC__int32 *signal;
+	uint32_t do_qlp_coeff_prec_search;
+
+	if(0 == (signal = make_stream_signal_(16)))
+		return false;
+
+	printf("\nFLAC__stream_encoder, level 8 with exhaustive model search, 2 channels, 16 bps, ns/sample (speedup over trying all orders)\n");
+	printf("options  all orders          pruned\n");
+
+	for(do_qlp_coeff_prec_search = 0; do_qlp_coeff_prec_search <= 1; do_qlp_coeff_prec_search++) {
+		MemoryStream all_orders, pruned;
+		double all_orders_ns, pruned_ns;
+
+		memset(&all_orders, 0, sizeof(all_orders));
+		memset(&pruned, 0, sizeof(pruned));
+		all_orders_ns = time_encode_exhaustive_(signal, do_qlp_coeff_prec_search, false, &all_orders);
+		pruned_ns = time_encode_exhaustive_(signal, do_qlp_coeff_prec_search, true, &pruned);
+		free(all_orders.data);
+		free(pruned.data);
+		if(all_orders_ns < 0.0 || pruned_ns < 0.0) {
+			printf("ERROR: could not encode the test stream\n");
+			free(signal);
+			return false;
+		}
+		printf("%-7s  %7.2f (%7u B)  %7.2f (%7u B, %4.2fx)\n", do_qlp_coeff_prec_search ? "-8ep" : "-8e", all_orders_ns, (uint32_t)all_orders.length, pruned_ns, (uint32_t)pruned.length, pruned_ns > 0.0 ? all_orders_ns / pruned_ns : 0.0);
+	}
+	free(signal);
+	return true;
+}
+#endif
+
+/* Returns wall clock time in seconds, as the encoder threads make the
+ * processor time of the process meaningless */
+static double wall_clock_(void)
+{
+#ifdef HAVE_SYS_TIME_H
+	struct timeval tv;
+	if(gettimeofday(&tv, 0) == 0)
+		return (double)tv.tv_sec + (double)tv.tv_usec * 1e-6;
+#endif
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/* Returns the best wall clock time of two encodes in seconds, or a negative
+ * value on failure or when the stream differs from the reference */
+static double time_encode_threads_(const FLAC__int32 *signal, uint32_t blocksize, uint32_t num_threads, FLAC__bool intra_frame_threading, MemoryStream *reference)
+{
+	double best = -1.0;
+	uint32_t run;
+
+	for(run = 0; run < 2; run++) {
+		MemoryStream stream;
+		double start, seconds;
+		FLAC__bool same;
+		memset(&stream, 0, sizeof(stream));
+		start = wall_clock_();
+		if(!encode_signal_(&stream, signal, 16, blocksize, 12, num_threads, intra_frame_threading)) {
+			printf("ERROR: could not encode the test stream with %u threads\n", num_threads);
+			free(stream.data);
+			return -1.0;
+		}
+		seconds = wall_clock_() - start;
+		if(best < 0.0 || seconds < best)
+			best = seconds;
+		if(reference->data == 0) {
+			*reference = stream;
+			continue;
+		}
+		same = stream.length == reference->length && memcmp(stream.data, reference->data, stream.length) == 0;
+		free(stream.data);
+		if(!same) {
+			printf("ERROR: encoding with %u threads gives a different stream than with 1 thread\n", num_threads);
+			return -1.0;
+		}
+	}
+	return best;
+}
+
+static FLAC__bool benchmark_encode_threads_(void)
+{
+	static const uint32_t num_threads[] = { 1, 2, 4, 8, 16, 32, 64 };
+	const uint32_t blocksize = 4096, frames = (STREAM_SAMPLES + blocksize - 1) / blocksize;
+	FLAC__StreamEncoder *encoder;
+	FLAC__int32 *signal;
+	MemoryStream reference;
+	double single = 0.0;
+	uint32_t i;
+	FLAC__bool threads_available;
+
+	if(0 == (encoder = FLAC__stream_encoder_new()))
+		return false;
+	threads_available = FLAC__stream_encoder_set_num_threads(encoder, 2) == FLAC__STREAM_ENCODER_SET_NUM_THREADS_OK;
+	FLAC__stream_encoder_delete(encoder);
+	if(!threads_available) {
+		printf("\nFLAC__stream_encoder threads: not compiled with multithreading, skipped\n");
+		return true;
+	}
+
+	if(0 == (signal = make_stream_signal_(16)))
+		return false;
+	memset(&reference, 0, sizeof(reference));
+
+	printf("\nFLAC__stream_encoder, 2 channels, 16 bps, blocksize %u, %u frames, frames/s (speedup over 1 thread)\n", blocksize, frames);
+	printf("threads  across frames     within frames\n");
+
+	for(i = 0; i < sizeof(num_threads) / sizeof(num_threads[0]); i++) {
+		const double across = time_encode_threads_(signal, blocksize, num_threads[i], false, &reference);
+		const double within = across < 0.0 ? across : time_encode_threads_(signal, blocksize, num_threads[i], true, &reference);
+		if(within < 0.0) {
+			free(reference.data);
+			free(signal);
+			return false;
+		}
+		if(i == 0)
+			single = across;
+		printf("%7u  %6.0f (%5.2fx)  %6.0f (%5.2fx)\n", num_threads[i],
+			across > 0.0 ? frames / across : 0.0, across > 0.0 ? single / across : 0.0,
+			within > 0.0 ? frames / within : 0.0, within > 0.0 ? single / within : 0.0);
+	}
+	free(reference.data);
+	free(signal);
+	return true;
+}
+
+#define POOL_ENCODERS 16
+
+/* Encodes the signal with POOL_ENCODERS encoders of 4 threads each, fed one
+ * block at a time in turn. Returns the wall clock time in seconds, or a
+ * negative value on failure or when a stream differs from the reference */
+static double time_encode_many_(const FLAC__int32 *signal, FLAC__ThreadPool *pool, const MemoryStream *reference)
+{
+	const uint32_t blocksize = 4096;
+	FLAC__StreamEncoder *encoder[POOL_ENCODERS];
+	MemoryStream stream[POOL_ENCODERS];
+	double start, seconds;
+	uint32_t e, offset, num_encoders;
+	FLAC__bool ok = true;
+
+	memset(stream, 0, sizeof(stream));
+	for(num_encoders = 0; num_encoders < POOL_ENCODERS; num_encoders++)
+		if(0 == (encoder[num_encoders] = new_encoder_(&stream[num_encoders], 16, blocksize, 12, 4, false, pool))) {
+			ok = false;
+			break;
+		}
+
+	start = wall_clock_();
+	for(offset = 0; ok && offset < STREAM_SAMPLES; offset += blocksize) {
+		const uint32_t samples = STREAM_SAMPLES - offset < blocksize ? STREAM_SAMPLES - offset : blocksize;
+		for(e = 0; ok && e < num_encoders; e++)
+			ok = FLAC__stream_encoder_process_interleaved(encoder[e], signal + offset * STREAM_CHANNELS, samples);
+	}
+	for(e = 0; e < num_encoders; e++) {
+		ok = ok && FLAC__stream_encoder_finish(encoder[e]);
+		FLAC__stream_encoder_delete(encoder[e]);
+	}
+	seconds = wall_clock_() - start;
+
+	for(e = 0; e < POOL_ENCODERS; e++) {
+		if(ok && (stream[e].length != reference->length || memcmp(stream[e].data, reference->data, reference->length) != 0)) {
+			printf("ERROR: encoders sharing threads give a different stream than a single encoder\n");
+			ok = false;
+		}
+		free(stream[e].data);
+	}
+	return ok ? seconds : -1.0;
+}
+
+static FLAC__bool benchmark_encode_pool_(void)
+{
+	static const uint32_t pool_threads[] = { 1, 2, 4, 8 };
+	const uint32_t frames = POOL_ENCODERS * ((STREAM_SAMPLES + 4095) / 4096);
+	FLAC__ThreadPool *pool;
+	FLAC__int32 *signal;
+	MemoryStream reference;
+	double seconds;
+	uint32_t i;
+
+	if(0 == (pool = FLAC__thread_pool_new(1))) {
+		printf("\nFLAC__ThreadPool: not compiled with multithreading, skipped\n");
+		return true;
+	}
+	FLAC__thread_pool_delete(pool);
+
+	if(0 == (signal = make_stream_signal_(16)))
+		return false;
+	memset(&reference, 0, sizeof(reference));
+	if(!encode_signal_(&reference, signal, 16, 4096, 12, 1, false)) {
+		free(signal);
+		return false;
+	}
+
+	printf("\n%u FLAC__stream_encoders of 4 threads each, fed in turn, frames/s\n", POOL_ENCODERS);
+	printf("threads          frames/s\n");
+	if((seconds = time_encode_many_(signal, 0, &reference)) < 0.0) {
+		free(reference.data);
+		free(signal);
+		return false;
+	}
+	printf("%3u own          %8.0f\n", POOL_ENCODERS * 3, seconds > 0.0 ? frames / seconds : 0.0);
+	for(i = 0; i < sizeof(pool_threads) / sizeof(pool_threads[0]); i++) {
+		if(0 == (pool = FLAC__thread_pool_new(pool_threads[i])))
+			seconds = -1.0;
+		else {
+			seconds = time_encode_many_(signal, pool, &reference);
+			FLAC__thread_pool_delete(pool);
+		}
+		if(seconds < 0.0) {
+			free(reference.data);
+			free(signal);
+			return false;
+		}
+		printf("%3u from a pool  %8.0f\n", pool_threads[i], seconds > 0.0 ? frames / seconds : 0.0);
+	}
+	free(reference.data);
+	free(signal);
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	(void)argv;
+	if(argc > 1) {
+		printf("usage: flacbench\n");
+		return 1;
+	}
+
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+	if(!benchmark_fixed_restore_signal_(16))
+		return 1;
+	if(!benchmark_fixed_restore_signal_(24))
+		return 1;
+	if(!benchmark_lpc_restore_signal_(16))
+		return 1;
+	if(!benchmark_lpc_restore_signal_(24))
+		return 1;
+	if(!benchmark_autocorrelation_())
+		return 1;
+#endif
+	if(!benchmark_read_rice_())
+		return 1;
+	if(!benchmark_crc16_())
+		return 1;
+	if(!benchmark_decode_stream_())
+		return 1;
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+	if(!benchmark_encode_fused_window_autocorrelation_())
+		return 1;
+	if(!benchmark_encode_lpc_order_pruning_())
+		return 1;
+#endif
+	if(!benchmark_encode_threads_())
+		return 1;
+	if(!benchmark_encode_pool_())
+		return 1;
+
+	return 0;
+}
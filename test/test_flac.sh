@@ -108,6 +108,44 @@ fi
 
 rm -f exist.wav exist.flac
 
+############################################################################
+# test the levels of -t
+############################################################################
+
+echo $ECHO_N "Encoding for the test levels... " $ECHO_C
+run_flac --force --force-raw-format --endian=little --sign=signed --sample-rate=44100 --bps=16 --channels=2 -o levels.flac noise.raw || die "ERROR"
+echo "OK"
+for level in md5 decode crc ; do
+	echo $ECHO_N "Testing with --test-level=$level... " $ECHO_C
+	run_flac -t --test-level=$level levels.flac || die "ERROR"
+	echo "OK"
+done
+
+# damage one byte in the middle of the audio, which every level must catch
+size=$(wc -c < levels.flac)
+cp levels.flac levels-damaged.flac
+printf 'U' | dd of=levels-damaged.flac bs=1 seek=$((size / 2)) conv=notrunc 2>/dev/null || $dddie
+for level in md5 decode crc ; do
+	echo $ECHO_N "Testing a damaged file with --test-level=$level; should fail... " $ECHO_C
+	if run_flac -t --test-level=$level levels-damaged.flac ; then
+		die "ERROR: it should have failed but didn't"
+	fi
+	echo "OK"
+done
+
+# damage one byte of the last frame, which no sync code follows
+cp levels.flac levels-damaged.flac
+printf 'U' | dd of=levels-damaged.flac bs=1 seek=$((size - 20)) conv=notrunc 2>/dev/null || $dddie
+for level in md5 decode crc ; do
+	echo $ECHO_N "Testing a file with a damaged last frame with --test-level=$level; should fail... " $ECHO_C
+	if run_flac -t --test-level=$level levels-damaged.flac ; then
+		die "ERROR: it should have failed but didn't"
+	fi
+	echo "OK"
+done
+
+rm -f levels.flac levels-damaged.flac
+
 ############################################################################
 # test fractional block sizes
 ############################################################################